@@ -9,6 +9,7 @@ LD/24.04.14
      Provides version information then exits
   
 Changes:
+  AG/17.10.26 - options -x and -S
 
 *********************************************************************/
 
@@ -66,6 +67,16 @@ void usage(FILE *output) {
     fprintf(output, "\n	  arguments: floating point number [eV].");
     fprintf(output, "\n	  default: 4.0");
     fprintf(output, "\n");
+    fprintf(output, "\n  --external");
+    fprintf(output, "\n  -x ");
+    fprintf(output, "\n      call $CAOI_RFAC for each angle of incidence instead of");
+    fprintf(output, "\n      calculating all angles in one process.");
+    fprintf(output, "\n");
+    fprintf(output, "\n  --common-shift");
+    fprintf(output, "\n  -S ");
+    fprintf(output, "\n      use the same shift for all angles of incidence");
+    fprintf(output, "\n	  default: optimise shift for each angle.");
+    fprintf(output, "\n");
     fprintf(output, "\n  --write");
     fprintf(output, "\n  -w <filename> ");
     fprintf(output, "\n      specify file name for iv curves output.");
@@ -7,6 +7,9 @@ ZZ/03.03.08
      (calls crfac program for each angle of incidence)
 
 Changes:
+  AG/17.10.26 - R factors of all angles calculated in this process
+                (caoi_rfac_mult); option -x for the old scheme calling
+                $CAOI_RFAC for each angle, option -S for a common shift.
 
 *********************************************************************/
 
@@ -46,6 +49,11 @@ int main(int argc, char *argv[])
   float sterror;
   float sum1;
 
+  int external;                           /* call $CAOI_RFAC per angle */
+  int common_shift;                       /* one shift for all angles */
+  struct crargs args;
+  real r_mult, rr_mult, s_mult, e_mult;
+
 
 /*********************************************************************
  set default values 
@@ -57,12 +65,19 @@ int main(int argc, char *argv[])
   strncpy(res_file,"---", STRSIZE);
   strncpy(ctr_file,"---", STRSIZE);
   iaux = 0;
+  external = 0;
+  common_shift = 0;
 /*********************************************************************
   Decode arguments:
 
     -c <ctr_file> - control file 
 
     -t <res_file> - (output file) IV output.
+
+    -x - call $CAOI_RFAC for each angle instead of the built-in
+         multi-angle R factor.
+
+    -S - use the same shift for all angles.
 *********************************************************************/
 
   if (argc < 2) 
@@ -128,6 +143,20 @@ int main(int argc, char *argv[])
 	
       } /* -s */
       
+      /* external R factor program for each angle */
+      if ((strcmp(argv[i_arg], "-x") == 0) ||
+          (strcmp(argv[i_arg], "--external") == 0))
+      {
+        external = 1;
+      }
+
+      /* same shift for all angles */
+      if ((strcmp(argv[i_arg], "-S") == 0) ||
+          (strcmp(argv[i_arg], "--common-shift") == 0))
+      {
+        common_shift = 1;
+      }
+
       /* help */
       if ((strcmp(argv[i_arg], "-h") == 0) || 
           (strcmp(argv[i_arg], "--help") == 0))
@@ -209,6 +238,45 @@ int main(int argc, char *argv[])
   sprintf(string+length,".ctr");
   ctrinp(string);
 
+/********** Built-in multi-angle R factor ********************/
+
+  if (!external)
+  {
+    args.ctrfile = NULL;
+    args.thefile = NULL;
+    args.outfile = NULL;
+    args.iv_file = NULL;
+    args.iv_out = 0;
+    args.all_groups = 0;
+    args.vi = 4.0;
+    args.s_ini = m_rfac_shift_range;
+    args.s_fin = p_rfac_shift_range;
+    args.s_step = rfac_shift_step;
+
+    if (!strncasecmp(rfac_type, "r1", 2))      args.r_type = R1_FACTOR;
+    else if (!strncasecmp(rfac_type, "r2", 2)) args.r_type = R2_FACTOR;
+    else if (!strncasecmp(rfac_type, "rb", 2)) args.r_type = RB_FACTOR;
+    else                                       args.r_type = RP_FACTOR;
+
+    if (caoi_rfac_mult(proj_name, sa, &args, common_shift,
+                       &r_mult, &rr_mult, &s_mult, &e_mult) < 0)
+    {
+      #ifdef ERROR
+      fprintf(STDERR,
+        "*** error (caoi_rfac_main): multi-angle R factor failed\n");
+      #endif
+      exit(1);
+    }
+
+    fprintf(STDERR, "<R> = %f\n", r_mult);
+    fprintf(STDERR, 
+            "\n%f %f %f %f     #     Rp  RR  shift range\n", 
+            r_mult, rr_mult, s_mult, e_mult);
+    printf("\n%f %f %f %f     #     Rp  RR  shift range\n", 
+           r_mult, rr_mult, s_mult, e_mult);
+    exit(0);
+  }
+
 /********** Calls rfac progam sa times ********************/
 
 
@@ -0,0 +1,326 @@
+/*********************************************************************
+AG/17.10.26
+  file contains functions:
+
+  caoi_rfac_mult (17.10.26)
+     Combined R factor of all angles of incidence in one process.
+
+  The data sets of all angles are read and prepared (smoothing, cubic
+  spline) once. The R factors of all angles and shifts are calculated
+  in one parallel loop (OpenMP), each angle/shift pair is independent.
+  The minimum search and the average over all angles are then done on
+  the table of R factors.
+
+Changes:
+  AG/17.10.26 - Creation
+  AG/17.10.26 - check the result of cr_input for each angle.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "crfac.h"
+#include "caoi_rfac.h"
+
+#define ERROR
+#define WARNING
+
+/*======================================================================*/
+
+int caoi_rfac_mult(char *proj, int n_ang, struct crargs *args,
+                   int common_shift, real *p_rfac, real *p_rr,
+                   real *p_shift, real *p_e_range)
+
+/*********************************************************************
+  Combined R factor of all angles of incidence.
+
+ INPUT:
+
+  char *proj - project name; the control and theory files of angle i
+         are <proj>ia_<i>.ctr and <proj>ia_<i>.res (see ctrinp).
+  int n_ang - number of angles of incidence.
+  struct crargs *args - R factor type, vi and shift range.
+  int common_shift - if 0, the shift is optimised for each angle
+         independently (same result as separate crfac runs). Otherwise
+         one shift is used for all angles and the combined R factor is
+         minimised.
+  real *p_rfac - (output) average R factor (weighted with energy range).
+  real *p_rr - (output) RR (variance) of the average R factor.
+  real *p_shift - (output) average shift.
+  real *p_e_range - (output) total energy range.
+
+ DESIGN:
+
+  The R factor of angle i_ang for shift i_shift is stored in
+  r_tab[i_ang*n_shift + i_shift] together with its energy range. The
+  shifts are generated in the same way as in cr_rmin.
+
+ RETURN VALUE:
+
+  1 if ok.
+ -1 if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+int i_ang, i_list, i_shift, n_shift, i_min;
+int i_task, n_task;
+int n_leng, err;
+
+real shift, faux, r_ang, e_ang;
+real *shifts, *r_tab, *n_tab, *e_tab;
+
+char t[2], e[2];
+char ctr_file[STRSZ], the_file[STRSZ];
+
+struct crivcur **iv_cur;
+
+ strcpy(t, "t"); strcpy(e, "e");
+
+/*********************************************************************
+  Read and prepare data of all angles
+*********************************************************************/
+
+ iv_cur = (struct crivcur **)calloc(n_ang, sizeof(struct crivcur *));
+
+ n_shift = 0;
+ for(shift = args->s_ini; shift <= args->s_fin; shift += args->s_step)
+   n_shift ++;
+ n_task = n_ang * n_shift;
+ shifts = (real *)malloc((n_shift + 1) * sizeof(real));
+ r_tab = (real *)malloc((n_task + 1) * sizeof(real));
+ n_tab = (real *)malloc((n_task + 1) * sizeof(real));
+ e_tab = (real *)malloc((n_task + 1) * sizeof(real));
+
+ if( (iv_cur == NULL) || (shifts == NULL) ||
+     (r_tab == NULL) || (n_tab == NULL) || (e_tab == NULL) || (n_shift < 1) )
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (caoi_rfac_mult): allocation error "
+                   "or empty shift range\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+ i_shift = 0;
+ for(shift = args->s_ini; shift <= args->s_fin; shift += args->s_step)
+   shifts[i_shift ++] = shift;
+
+ for(i_ang = 0; i_ang < n_ang; i_ang ++)
+ {
+   sprintf(ctr_file, "%sia_%d.ctr", proj, i_ang+1);
+   sprintf(the_file, "%sia_%d.res", proj, i_ang+1);
+   iv_cur[i_ang] = cr_input(ctr_file, the_file);
+   if(iv_cur[i_ang] == NULL)
+   {
+#ifdef ERROR
+     fprintf(STDERR, "*** error (caoi_rfac_mult): could not read \"%s\" "
+                     "or \"%s\"\n", ctr_file, the_file);
+#endif
+#ifdef EXIT_ON_ERROR
+     exit(1);
+#else
+     while(i_ang -- > 0)
+     {
+       for(i_list = 0; iv_cur[i_ang][i_list].group_id != I_END_OF_LIST;
+           i_list ++)
+       {
+         free(iv_cur[i_ang][i_list].exp_list);
+         free(iv_cur[i_ang][i_list].the_list);
+       }
+       free(iv_cur[i_ang]);
+     }
+     free(iv_cur);
+     free(shifts); free(r_tab); free(n_tab); free(e_tab);
+     return(-1);
+#endif
+   }
+ }
+
+ n_leng = 0;
+#ifdef _USE_OPENMP
+#pragma omp parallel for schedule(dynamic) private(i_list)
+#endif
+ for(i_ang = 0; i_ang < n_ang; i_ang ++)
+ {
+   for(i_list = 0; iv_cur[i_ang][i_list].group_id != I_END_OF_LIST; i_list ++)
+   {
+     cr_lorentz(iv_cur[i_ang]+i_list, args->vi / 2., e);
+     cr_lorentz(iv_cur[i_ang]+i_list, args->vi / 2., t);
+
+     cr_spline((iv_cur[i_ang]+i_list)->exp_list,
+               (iv_cur[i_ang]+i_list)->exp_leng);
+     (iv_cur[i_ang]+i_list)->exp_spline = 1;
+     cr_spline((iv_cur[i_ang]+i_list)->the_list,
+               (iv_cur[i_ang]+i_list)->the_leng);
+     (iv_cur[i_ang]+i_list)->the_spline = 1;
+   }
+ }
+
+ for(i_ang = 0; i_ang < n_ang; i_ang ++)
+   n_leng = MAX(n_leng, cr_rleng(iv_cur[i_ang], args));
+
+/*********************************************************************
+  Table of R factors for all angles and shifts
+*********************************************************************/
+
+ err = 0;
+
+#ifdef _USE_OPENMP
+#pragma omp parallel private(i_task, i_ang, i_shift)
+#endif
+ {
+ real *eng, *e_int, *t_int;
+
+   eng   = (real *)malloc(n_leng * sizeof(real));
+   e_int = (real *)malloc(n_leng * sizeof(real));
+   t_int = (real *)malloc(n_leng * sizeof(real));
+
+#ifdef _USE_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+   for(i_task = 0; i_task < n_task; i_task ++)
+   {
+     if( (eng == NULL) || (e_int == NULL) || (t_int == NULL) )
+     {
+#ifdef _USE_OPENMP
+#pragma omp atomic write
+#endif
+       err = 1;
+       continue;
+     }
+
+     i_ang = i_task / n_shift;
+     i_shift = i_task % n_shift;
+     r_tab[i_task] = cr_rshift(iv_cur[i_ang], args, shifts[i_shift],
+                               eng, e_int, t_int,
+                               n_tab + i_task, e_tab + i_task);
+   }
+
+   free(eng);
+   free(e_int);
+   free(t_int);
+ }  /* parallel */
+
+ for(i_task = 0; (i_task < n_task) && (! err); i_task ++)
+ {
+   if(IS_EQUAL_REAL(n_tab[i_task], 0.))
+   {
+#ifdef ERROR
+     fprintf(STDERR, "*** error (caoi_rfac_mult): "
+             "no overlap for angle %d and shift %.1f eV\n",
+             i_task / n_shift + 1, shifts[i_task % n_shift]);
+#endif
+     err = 1;
+   }
+   else r_tab[i_task] /= n_tab[i_task];
+ }
+
+ if(err)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (caoi_rfac_mult): R factor calculation failed\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+/*********************************************************************
+  Minimum with respect to the shift(s) and average over all angles
+*********************************************************************/
+
+ *p_rfac = 100.;
+ *p_shift = 0.;
+ *p_e_range = 0.;
+
+ if(common_shift)
+ {
+   /* one shift for all angles: minimise average R factor */
+   i_min = 0;
+   for(i_shift = 0; i_shift < n_shift; i_shift ++)
+   {
+     r_ang = e_ang = 0.;
+     for(i_ang = 0; i_ang < n_ang; i_ang ++)
+     {
+       i_task = i_ang * n_shift + i_shift;
+       r_ang += r_tab[i_task] * e_tab[i_task];
+       e_ang += e_tab[i_task];
+     }
+     r_ang /= e_ang;
+
+     if(r_ang < *p_rfac)
+     {
+       *p_rfac = r_ang;
+       *p_shift = shifts[i_shift];
+       *p_e_range = e_ang;
+       i_min = i_shift;
+     }
+   }
+
+   for(i_ang = 0; i_ang < n_ang; i_ang ++)
+     fprintf(STDERR, "\nR%d = %f\n", i_ang+1, r_tab[i_ang * n_shift + i_min]);
+ }
+ else
+ {
+   /* independent shift for each angle (as crfac) */
+   faux = 0.;
+   for(i_ang = 0; i_ang < n_ang; i_ang ++)
+   {
+     r_ang = 100.;
+     e_ang = 0.;
+     shift = 0.;
+     for(i_shift = 0; i_shift < n_shift; i_shift ++)
+     {
+       i_task = i_ang * n_shift + i_shift;
+       if(r_tab[i_task] < r_ang)
+       {
+         r_ang = r_tab[i_task];
+         e_ang = e_tab[i_task];
+         shift = shifts[i_shift];
+       }
+     }
+
+     fprintf(STDERR, "\nR%d = %f\n", i_ang+1, r_ang);
+     faux += r_ang * e_ang;
+     *p_shift += shift;
+     *p_e_range += e_ang;
+   }
+
+   *p_rfac = faux / *p_e_range;
+   *p_shift /= n_ang;
+ }
+
+/* RR of all angles: 1/RR^2 = sum of 1/RR_i^2, RR_i^2 = 8 vi / e_range_i */
+ *p_rr = R_sqrt(args->vi * 8. / *p_e_range);
+
+/*********************************************************************
+  Free memory
+*********************************************************************/
+
+ for(i_ang = 0; i_ang < n_ang; i_ang ++)
+ {
+   for(i_list = 0; iv_cur[i_ang][i_list].group_id != I_END_OF_LIST; i_list ++)
+   {
+     free(iv_cur[i_ang][i_list].exp_list);
+     free(iv_cur[i_ang][i_list].the_list);
+   }
+   free(iv_cur[i_ang]);
+ }
+ free(iv_cur);
+
+ free(shifts);
+ free(r_tab);
+ free(n_tab);
+ free(e_tab);
+
+ return(1);
+} /* end of function caoi_rfac_mult */
@@ -52,6 +52,14 @@ int sa;
 int ctrinp (char filectr[STRSIZE]);
 char proj_name[STRSIZE];
 
+/*********************************************************************
+multi-angle R factor (caoi_rfac_mult.c)
+*********************************************************************/
+#include "crfac.h"
+
+int caoi_rfac_mult(char *, int, struct crargs *, int,
+                   real *, real *, real *, real *);
+
 /*********************************************************************
 END
 *********************************************************************/
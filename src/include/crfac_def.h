@@ -11,6 +11,7 @@ GH/25.09.92
 GH/03.03.93
 GH/10.08.95 - Create (copy from rfdefines.h and rftypes.h)
 GH/10.08.95 - modify structure crargs (output)
+AG/17.10.26 - crivcur: the_front_eng, the_end_eng (partial theo. input)
 
 *********************************************************************/
 
@@ -60,6 +61,9 @@ struct crivcur
  real    the_first_eng;      /* first energy in theo. list */
  real    the_last_eng;       /* last energy in theo. list */
  real    the_max_int;        /* max. intensity value in list */
+ real    the_front_eng;      /* last energy read from theo. file */
+ real    the_end_eng;        /* last energy of the complete theo. file
+                                (> the_front_eng if read in part) */
 
 /* experimental data */
  struct crelist *exp_list;   /* expt. IV curve */
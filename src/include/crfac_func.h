@@ -27,6 +27,7 @@ struct crivcur *cr_input( char *, char *);                     /* read control f
 struct crelist *cr_rdcleed( struct crivcur *, char *, char *); /* input of theor. data */
 struct crelist *cr_rdexpt( struct crivcur *, char *);          /* input of expt. data */
 void cr_intindl( char *, struct rfspot *, int);                /* line interpreter */
+int cr_rdcleed_part(int );                  /* accept incomplete theor. data */
 
 /* data output */
 /*
@@ -64,6 +65,14 @@ real cr_rb( real *, real *, real *);            /* Rb1 factor */
 real cr_rp( real *, real *, real *, real );     /* Pendry's R factor */
 
 real cr_rmin( struct crivcur *, struct crargs *, real *, real *, real *);
+int  cr_rleng( struct crivcur *, struct crargs *);
+                                                /* work space for cr_rshift */
+real cr_rshift( struct crivcur *, struct crargs *, real,
+                real *, real *, real *, real *, real *);
+                                                /* R factor for one shift */
+real cr_rbound( struct crivcur *, struct crargs *);
+double cr_rbound_args(int , char * *);
+                                      /* lower bound for incomplete data */
 
 
 #endif /* CRFAC_FUNC_H */
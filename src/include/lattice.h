@@ -3,6 +3,7 @@
                         
 Changes:
  LD/29.04.14 - Added header for latt.c                 
+ AG/17.10.26 - Output formats, layer-wise atom generation
          
 ****************************************************************************/
 #ifndef LATTICE_H
@@ -40,6 +41,11 @@ extern "C" {
 
 #define LAT_INP  100
 
+/* number of unit cell layers generated in one block (in parallel) */
+#ifndef LAT_LAYER_BLOCK
+#define LAT_LAYER_BLOCK 16
+#endif
+
 #define LATTICE_OPERATION_SUCCESS 0
 #define LATTICE_ATOM_INDEX_OUT_OF_RANGE_FAILURE 10
 #define LATTICE_ALLOC_FAILURE 1
@@ -56,6 +62,15 @@ typedef enum {
   LAT_UNKNOWN
 } latt_type_t;
 
+/*! \enum latt_out_format_t
+ *  \brief output formats
+ */
+typedef enum {
+  LAT_OUT_XYZ=0,        /*!< XYZ file of atoms within image */
+  LAT_OUT_BUL,          /*!< CLEED bulk file (*.bul) lattice vectors and basis */
+  LAT_OUT_INP           /*!< CLEED overlayer positions (*.inp) */
+} latt_out_format_t;
+
 /*! \typedef lattice_t
  *  \brief lattice struct.
  *
@@ -80,6 +95,7 @@ typedef struct {
   char *input_filename; 
   char *output_filename;
   char *script;         /*!< do jmol script to write to xyz output */
+  int out_format;       /*!< Output format (see latt_out_format_t). */
   atom_t *atoms;        /*!< Array of atoms. */
   size_t n_atoms;
   size_t allocated_atoms;
@@ -108,6 +124,11 @@ void lattice_read(lattice_t *lat, coord_t *a1, coord_t *a2, coord_t *a3,
 int lattice_set_atom(lattice_t *lat, const atom_t *atom, size_t index);
 int lattice_set_atom_list(lattice_t *lat, const atom_t *atoms, size_t n_atoms);
 void lattice_printf(FILE *output, const lattice_t *lat);
+void lattice_printf_header(FILE *output, const lattice_t *lat, size_t n_atoms,
+                           const coord_t *b1, const coord_t *b2, 
+                           const coord_t *b3);
+void lattice_printf_atoms(FILE *output, const lattice_t *lat, 
+                          const atom_t *atoms, size_t n_atoms);
 void lattice_debug(const lattice_t *lat);
 
 double lattice_get_a(const lattice_t *lat);
@@ -126,6 +147,16 @@ size_t lattice_get_n_atoms(const lattice_t *lat);
 const atom_t *lattice_get_atom_list(const lattice_t *lat);
 atom_t *lattice_get_atom(const lattice_t *lat, size_t index);
 void lattice_atom_index_swap(const lattice_t *lat, size_t i, size_t j);
+int lattice_atom_cmp_z(const void *p1, const void *p2);
+
+void lattice_index_bounds(const coord_t *a1, const coord_t *a2, 
+                          const coord_t *a3, double len, int n_bnd[3]);
+size_t lattice_layer_atoms(atom_t **p_atoms, const coord_t *b1, 
+                           const coord_t *b2, const coord_t *b3, 
+                           const coord_t *bas, char *bas_name, int n_bas,
+                           int n3, int max_cells, double image_len);
+size_t lattice_cell_atoms(atom_t **p_atoms, const coord_t *b3, 
+                          const coord_t *bas, char *bas_name, int n_bas, int n3);
 
 coord_t *lattice_get_surface_normal(const lattice_t *lat, const coord_t *a1,
                                     const coord_t *a2, const coord_t *a3);
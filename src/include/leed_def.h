@@ -16,6 +16,13 @@ WB/27.08.98 - include symmetry flags in crystal struct
 GH/03.05.00 - include t_type in atom_str.
             - include t_type in phs_str.
 LD/28.07.14 - added struct typedefs and doxygen compatible comments
+AG/17.10.26 - add set_end and i_out to beam_str.
+AG/17.10.26 - add calc_eng_str and calc_cache_str.
+AG/17.10.26 - add mem_str; scratch (calc_cache_str), spilled (calc_eng_str).
+AG/17.10.26 - add n_mix, mix_type, mix_wgt to phs_str (average t matrix).
+AG/17.10.26 - add beam_tab_str (packed beam table).
+AG/17.10.26 - typedef leed_energy_t (used by the function prototypes).
+AG/17.10.26 - add prune_str and prune_amp_str (beam pruning context).
 
 version SYM 1.1 + TEMP 0.5
 GH/27.09.00 - same include file for version SYM 1.1 + TEMP 0.5
@@ -168,6 +175,21 @@ typedef struct layer_str
                           * (or Bravais) layers */
 } leed_layer_t;
 
+/*********************************************************************
+  struct domain_str contains the operation and weight of a domain of
+  the overlayer (see ldomnd.c)
+*********************************************************************/
+/*! \struct leed_domain_t
+ *  \brief rotation/mirror of an overlayer domain. */
+typedef struct domain_str
+{
+ real m[5];              /*!< 2x2 transformation matrix of (x,y):
+                          *    x' = m[1]*x + m[2]*y
+                          *    y' = m[3]*x + m[4]*y
+                          */
+ real weight;            /*!< weight in the average of the intensities */
+} leed_domain_t;
+
 /*********************************************************************
   struct cryst_str contains all crystal specific program parameters
 *********************************************************************/
@@ -189,6 +211,10 @@ typedef struct cryst_str
  real *alpha;     /*!< angle in degree */
  int symmetry;    /*!< NOSYM(0) ROTSYM(1) MIRRORSYM(2) RMSYM(3)*/
 
+/* domains (overlayer only) */
+ int n_dom;       /*!< number of domains (0: no domain averaging) */
+ leed_domain_t *dom; /*!< operations and weights of the domains */
+
 /* 1x1 unit cell */
  real a[5];       /*!< basis vectors of the real 2-dim unit cell stored as
                    *   standard matrix (a1,a2): 
@@ -255,6 +281,12 @@ typedef struct phs_str
  
  real dr[4];
  char *input_file;    /*!< name of input file */
+
+ int  n_mix;          /*!< average t matrix (ATA): number of components,
+                           0 for a single atom type */
+ int  *mix_type;      /*!< ATA: sets of phase shifts of the components */
+ real *mix_wgt;       /*!< ATA: concentrations of the components (the 
+                           remainder to 1 is vacancy) */
 } leed_phs_t;
 
 /*********************************************************************
@@ -293,8 +325,33 @@ typedef struct beam_str
  real *ein_s_i;
 
  int  set;         /*!< beam set, where the beam belongs to */
+ int  set_end;     /*!< position of the first beam after the beam set in the
+                    *   list created by leed_beam_gen (beams sorted by k_par
+                    *   within each set); 0 if not available */
+ int  i_out;       /*!< position of the beam in the list of output beams
+                    *   (see leed_output_beam_list); -1 if not in the list */
 } leed_beam_t;
 
+/*********************************************************************
+  struct beam_tab_str contains the k vectors of a beam list as separate
+  arrays (see lbmtab.c), for loops over all beams.
+*********************************************************************/
+/*! \struct leed_beam_tab_t
+ *  \brief packed table of the k vectors of a beam list. */
+typedef struct beam_tab_str
+{
+ int  n_beams;     /*!< number of beams in the table */
+ int  n_max;       /*!< allocated length of the arrays */
+ real *k_x;        /*!< x component of k_par (k_r[1]) */
+ real *k_y;        /*!< y component of k_par (k_r[2]) */
+ real *kz_r;       /*!< real part of k_z (k_r[3]) */
+ real *kz_i;       /*!< imaginary part of k_z (k_i[3]) */
+ real *Akz_r;      /*!< real part of 1/(A kz) (Akz_r) */
+ real *Akz_i;      /*!< imaginary part of 1/(A kz) (Akz_i) */
+ real *ph_r;       /*!< real part of phase factors (leed_beam_tab_phase) */
+ real *ph_i;       /*!< imaginary part of phase factors */
+} leed_beam_tab_t;
+
 /*********************************************************************
   struct var_str contains all parameters that change during the energy 
   loop and the parameters controlling them.
@@ -336,6 +393,155 @@ typedef struct eng_str  /*!< contains all parameters that change during the
  real stp;      /*!< energy step */
 } leed_eng_t;
 
+typedef leed_eng_t leed_energy_t;   /* name used by the LEED functions */
+
+/*********************************************************************
+  struct calc_eng_str and calc_cache_str contain the results of a 
+  previous calculation which are reused if only parts of the geometry 
+  change (see leed_calc_iv_delta_nd).
+*********************************************************************/
+/*! \struct leed_calc_eng_t
+ *  \brief layer matrices stored for a single energy. */
+typedef struct calc_eng_str
+{
+ real energy;          /*!< vacuum energy */
+ leed_var_t par;       /*!< parameters used for the calculation */
+ int  n_beams;         /*!< number of beams used */
+ real *ind;            /*!< indices of the beams used (ind_1, ind_2) */
+ int  n_bulk;          /*!< number of bulk layers */
+ leed_layer_t *bulk;   /*!< geometry of the bulk layers */
+ mat  R_bulk;          /*!< bulk reflection matrix (block diagonal) */
+ int  n_over;          /*!< number of overlayer layers */
+ leed_layer_t *over;   /*!< geometry of the overlayer layers */
+ mat  *Tpp, *Tmm;      /*!< transmission matrices of each overlayer layer */
+ mat  *Rpm, *Rmp;      /*!< reflection matrices of each overlayer layer */
+ mat  *R_tot;          /*!< reflection matrix of bulk + overlayer layers 
+                        *   up to (and including) each layer (top-most 
+                        *   layer: first column only, LEED_TOP_COLUMN) */
+ int  spilled;         /*!< 1: Tpp ... R_tot are stored in a scratch file */
+} leed_calc_eng_t;
+
+/* layer doubling of the top-most overlayer layer (leed_calc_top_mode) */
+#define LEED_TOP_FULL      0   /* full reflection matrix R+- */
+#define LEED_TOP_COLUMN    1   /* first column of R+- only (default) */
+
+/*! \struct leed_calc_cache_t
+ *  \brief layer matrices stored for all energies. */
+typedef struct calc_cache_str
+{
+ int n_eng;            /*!< number of energies */
+ leed_calc_eng_t *eng; /*!< stored matrices for each energy */
+ int n_calc;           /*!< number of layers calculated (statistics) */
+ int n_reuse;          /*!< number of layers reused (statistics) */
+ char *scratch;        /*!< name prefix of the scratch files; if not NULL,
+                        *   the matrices of each energy are written to 
+                        *   <scratch>.<i_eng> while other energies are 
+                        *   calculated */
+ int n_phs;            /*!< number of sets of phase shifts in phs */
+ leed_phs_t *phs;      /*!< copies of the phase shifts of the previous call
+                        *   (all input of the atomic t matrices) */
+ int *phs_ok;          /*!< 1: set of phase shifts unchanged since the 
+                        *   previous call */
+} leed_calc_cache_t;
+
+/*********************************************************************
+  struct prune_str contains the beams pruned in each validation interval
+  of an energy grid, struct prune_amp_str the amplitudes recorded at a
+  validation energy (see lbmprune.c).
+*********************************************************************/
+/*! \struct leed_prune_t
+ *  \brief beam pruning of an energy sequence. */
+typedef struct prune_str
+{
+ real eps;             /*!< threshold of the relative amplitudes */
+ int  n_val;           /*!< number of energies in a validation interval;
+                        *   validation at e_ini + i*n_val*e_stp */
+ real e_ini;           /*!< first energy of the grid */
+ real e_stp;           /*!< energy step of the grid */
+ int  n_int;           /*!< number of intervals in n_pruned, pruned */
+ int  *n_pruned;       /*!< number of pruned beams of each interval
+                        *   (-1: not validated yet) */
+ real **pruned;        /*!< indices (ind_1, ind_2) of the pruned beams of
+                        *   each interval */
+} leed_prune_t;
+
+/*! \struct leed_prune_amp_t
+ *  \brief amplitudes recorded at a validation energy. */
+typedef struct prune_amp_str
+{
+ int  i_int;           /*!< validation interval (-1: nothing recorded) */
+ int  n_amp;           /*!< number of beams */
+ real *amp;            /*!< max. |R|^2 (relative) of each beam */
+ int  *prop;           /*!< 1 for propagating beams */
+ real *kz_i;           /*!< decay constant (Im k_z) of each beam at the
+                        *   end of the validation interval */
+} leed_prune_amp_t;
+
+/*********************************************************************
+  struct mem_str contains the estimated memory requirements and the 
+  settings chosen to fit into a memory budget (see lmemnd.c).
+*********************************************************************/
+/*! \struct leed_mem_t
+ *  \brief memory estimate and memory saving settings. */
+typedef struct mem_str
+{
+ int  n_beams;         /*!< max. number of beams (at the final energy) */
+ int  n_max_set;       /*!< max. number of beams in one beam set */
+ int  n_comp;          /*!< max. dimension of the combined (l,m,atom) 
+                        *   space of composite layers */
+ int  n_over;          /*!< number of overlayer layers */
+ int  n_eng;           /*!< number of energies stored in delta mode
+                        *   (0: no delta mode) */
+ double r_bulk;        /*!< memory of R_bulk (bytes) */
+
+ int  n_threads;       /*!< number of threads (bulk beam sets in delta
+                        *   mode, energies otherwise) */
+ int  inv_inplace;     /*!< 1: invert matrices in place (matinvmode) */
+ int  spill;           /*!< 1: write delta mode matrices to scratch files */
+
+ double peak;          /*!< estimated peak memory for one energy (bytes) */
+ double cache;         /*!< estimated memory kept by the delta mode (bytes) */
+} leed_mem_t;
+
+/*********************************************************************
+  struct gaunt_str contains the C.G. coupling tensor for the set-up of
+  the Green's function matrices (see lmsgaunt.c).
+*********************************************************************/
+#define LEED_GAUNT_II      0   /* Gii (leed_ms_tmat_ii, leed_ms_tmat_nd_ii) */
+#define LEED_GAUNT_IJ      1   /* Gij (leed_ms_tmat_ij) */
+#define LEED_GAUNT_NTYPES  2
+
+/*! \struct leed_gaunt_t
+ *  \brief sparse (CSR) coupling tensor of (l1,m1; l2,m2) and L(l3,m3). */
+typedef struct gaunt_str
+{
+ int  l_max;           /*!< max. angular momentum quantum number */
+ int  n_lm;            /*!< (l_max+1)^2 */
+ int  *row;            /*!< first entry of each (l1,m1; l2,m2) pair 
+                        *   (n_lm*n_lm + 1 elements) */
+ int  *i3;             /*!< position of L(l3,m3) in Llm */
+ real *coef;           /*!< C.G. coefficient including sign */
+} leed_gaunt_t;
+
+/*********************************************************************
+  struct ylm_str contains the spherical harmonics of one beam set at
+  one energy and the forms derived from them (see lmsymat.c).
+*********************************************************************/
+/*! \struct leed_ylm_t
+ *  \brief cached transformation matrices Ylm(k) of a beam set. */
+typedef struct ylm_str
+{
+ int  n_beams;         /*!< number of beams (key) */
+ int  l_max;           /*!< max. angular momentum quantum number (key) */
+ real k_r;             /*!< |k| (real part): energy */
+ real k_i;             /*!< |k| (imag. part): energy */
+ real *ang;            /*!< cth_r, cth_i, phi of all beams (key) */
+ mat  Yp;              /*!< Ylm(k+)   (leed_ms_ymat) */
+ mat  Ym;              /*!< Ylm(k-)   (leed_ms_yp_ym) */
+ mat  Yxp;             /*!< Y*lm(k+)  (leed_ms_yp_yxp) */
+ mat  Yxm;             /*!< Y*lm(k-)  (leed_ms_yp_yxm) */
+} leed_ylm_t;
+
 #endif /* LEED_DEF_H */
 
 #ifdef __cplusplus /* If this is a C++ compiler, use C linkage */
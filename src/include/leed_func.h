@@ -33,20 +33,34 @@ mat leed_inp_mat_lm(mat , int , const char *);
 
    /* read phase shifts; file linpphase.c */
 int leed_inp_phase(char * , real * , leed_phs_t **);
-int leed_leed_inp_phase_nd(char * , real * , int , leed_phs_t **);
+int leed_inp_phase_nd(char * , real * , int , leed_phs_t **);
+int leed_inp_phase_mem_nd(const char * , real * , int , int , int , 
+                          real * , real * , leed_phs_t **);
+int leed_inp_phase_mix_nd(const char * , real * , int , leed_phs_t **);
 int leed_update_phase(int);
 
    /* read bulk parameters; file linprdbul.c */
 int leed_inp_read_bul(leed_cryst_t ** , leed_phs_t ** , char *);
 int leed_inp_read_bul_nd(leed_cryst_t ** , leed_phs_t ** , char *);
 int leed_inp_read_bul_sym(leed_cryst_t ** , leed_phs_t ** , char *);
+int leed_inp_bul_setup_nd(leed_cryst_t *, leed_atom_t *, int , 
+                          real *, real *, real *);
 
    /* read overlayer parameters; file linprdovl.c */
 int leed_read_overlayer(leed_cryst_t ** , leed_phs_t ** , leed_cryst_t * , char *);
 int leed_read_overlayer_nd(leed_cryst_t **, leed_phs_t **, leed_cryst_t *, char *);
 int leed_read_overlayer_sym(leed_cryst_t ** , leed_phs_t ** , leed_cryst_t * , char *);
+int leed_inp_over_setup_nd(leed_cryst_t *, leed_cryst_t *, leed_atom_t *, int);
    /* read other parameters; file linprdpar.c */
 int leed_inp_leed_read_par(leed_var_t **, leed_energy_t **, leed_cryst_t * , char *);
+int leed_inp_par_setup(leed_var_t *, leed_energy_t *);
+   /* parameters from memory; file linpmemnd.c */
+int leed_inp_bul_mem_nd(leed_cryst_t **, real *, real *, real *, real *,
+                        leed_atom_t *, int , real , real , real );
+int leed_inp_over_mem_nd(leed_cryst_t **, leed_cryst_t *, leed_atom_t *, int);
+int leed_inp_par_mem(leed_var_t **, leed_energy_t **, leed_cryst_t *,
+                     real , real , real , real , real , int , real , real );
+void leed_inp_free_nd(leed_cryst_t *, int );
    /* show all parameters; file linpshowbop.c */
 int leed_inp_show_beam_op(leed_cryst_t *, leed_cryst_t *, leed_phs_t *);
    /* read and write parameters */
@@ -77,6 +91,28 @@ int leed_beam_get_selection(leed_beam_t **, leed_beam_t *,
              leed_var_t *, real);
     /* Find the beams of a particular beam set (lbmset.c) */
 int leed_beam_set(leed_beam_t **, leed_beam_t *, int);
+int leed_beam_set_copy(leed_beam_t **, leed_beam_t *, int *, int);
+    /* Find the positions of all beam sets in a beam list (lbmset.c) */
+int leed_beam_set_offsets(int **, leed_beam_t *, int);
+    /* Dynamic pruning of beams with small amplitudes (lbmprune.c) */
+leed_prune_t *leed_beam_prune_alloc(real , int , leed_energy_t *);
+void leed_beam_prune_free(leed_prune_t *);
+int leed_beam_prune_int(leed_prune_t *, real );
+int leed_beam_prune_plan(leed_prune_t *, real *, int , int *, real **);
+int leed_beam_prune(leed_prune_t *, leed_prune_amp_t *, real , 
+                    leed_beam_t *, int );
+void leed_beam_prune_amp(leed_prune_amp_t *, mat , int , real );
+void leed_beam_prune_amp_bulk(leed_prune_amp_t *, mat , leed_beam_t *, int ,
+                              real );
+int leed_beam_prune_update(leed_prune_t *, leed_prune_amp_t *, 
+                           leed_beam_t *, int );
+    /* Packed table of the k vectors of a beam list (lbmtab.c) */
+int leed_beam_tab(leed_beam_tab_t *, leed_beam_t *, int );
+void leed_beam_tab_free(leed_beam_tab_t *);
+void leed_beam_tab_phase(real *, real *, leed_beam_tab_t *, int , int ,
+                         real *, real , real );
+void leed_beam_tab_mul_cols(mat , real *, real *);
+void leed_beam_tab_mul_rows(mat , real *, real *);
 
 /*********************************************************************
  Parameter control
@@ -101,12 +137,78 @@ int pc_mk_ms(mat * , mat *, mat *, mat *, mat *, mat *, int );
 int leed_out_head(FILE *);
 int leed_out_head_2(const char *, const char *, FILE *);
 int leed_output_beam_list(leed_beam_t **, leed_beam_t *, leed_energy_t *, FILE *);
+int leed_output_beam_head(FILE *, leed_beam_t *, int , int , real , real , real );
+int leed_output_beam_ctr(real **, const char *);
+int leed_output_beam_select(leed_beam_t *, leed_beam_t *, real *, int );
 int leed_output_int(mat , leed_beam_t *, leed_beam_t *, leed_var_t *, FILE * );
+int leed_output_int_buf(real *, mat , leed_beam_t *, leed_beam_t *, leed_var_t *);
+int leed_output_int_list(real *, int , leed_var_t *, FILE * );
+int leed_chk_read(const char *, int , real **);
+int leed_chk_done(real , real *, int );
+int leed_chk_range(const char *, real *, real *);
+int leed_chk_shard(leed_energy_t *, real , real , int , int );
 int leed_output_iint_sym(mat , leed_beam_t *, leed_beam_t *, leed_var_t *, FILE * );
 
     /* check cpu time */
 double leed_cpu_time(FILE *, const char *);
 
+/*********************************************************************
+ Calculation without file input/output (lcalcnd.c)
+*********************************************************************/
+mat leed_calc_amp_nd(mat , leed_beam_t **, int *, leed_cryst_t *, 
+                     leed_cryst_t *, leed_phs_t *, leed_var_t *, 
+                     leed_beam_t *, int , real );
+int leed_calc_beams_nd(leed_beam_t **, leed_beam_t **, int *, 
+                       leed_cryst_t *, leed_var_t *, leed_energy_t *);
+int leed_calc_n_eng(leed_energy_t *);
+int leed_calc_iv_nd(real *, int , leed_beam_t *, int , leed_beam_t *,
+                    leed_cryst_t *, leed_cryst_t *, leed_phs_t *, 
+                    leed_var_t *, leed_energy_t *);
+int leed_calc_iv_delta_nd(real *, int , leed_beam_t *, int , leed_beam_t *,
+                    leed_cryst_t *, leed_cryst_t *, leed_phs_t *, 
+                    leed_var_t *, leed_energy_t *, leed_calc_cache_t **);
+int leed_calc_top_mode(int );
+leed_calc_cache_t *leed_calc_cache_alloc(const char *);
+void leed_calc_cache_free(leed_calc_cache_t *);
+int leed_calc_int_dom_nd(real *, leed_beam_t **, int *, leed_beam_t *,
+                         leed_cryst_t *, leed_cryst_t *, leed_phs_t *,
+                         leed_var_t *, leed_beam_t *, int , real );
+int leed_calc_int_list_nd(real *, real *, int , leed_beam_t *, int ,
+                          leed_beam_t *, leed_cryst_t *, leed_cryst_t *,
+                          leed_phs_t *, leed_var_t *, leed_prune_t *);
+
+/*********************************************************************
+ Worker processes for lists of energies (lfarmnd.c)
+*********************************************************************/
+int leed_farm_mode(int );
+int leed_calc_int_farm_nd(real *, real *, int , leed_beam_t *, int ,
+                          leed_beam_t *, leed_cryst_t *, leed_cryst_t *,
+                          leed_phs_t *, leed_var_t *, leed_prune_t *,
+                          int , FILE *);
+
+/*********************************************************************
+ Adaptive energy grid (ladaptnd.c)
+*********************************************************************/
+int leed_calc_iv_adapt_nd(real **, real **, leed_beam_t *, int ,
+                          leed_beam_t *, leed_cryst_t *, leed_cryst_t *,
+                          leed_phs_t *, leed_var_t *, leed_energy_t *,
+                          real , int , leed_prune_t *);
+
+/*********************************************************************
+ Domain averaging (ldomnd.c)
+*********************************************************************/
+int leed_dom_check_nd(leed_cryst_t *);
+int leed_dom_over_nd(leed_cryst_t *, leed_cryst_t *, leed_domain_t *);
+void leed_dom_over_free_nd(leed_cryst_t *);
+
+/*********************************************************************
+ Memory estimate (lmemnd.c)
+*********************************************************************/
+int leed_mem_estimate_nd(leed_mem_t *, leed_beam_t *, int , leed_cryst_t *, 
+                         leed_cryst_t *, leed_var_t *, int );
+double leed_mem_peak_nd(leed_mem_t *);
+int leed_mem_plan_nd(leed_mem_t *, double );
+
 /*********************************************************************
  Layer doubling (ld)
 *********************************************************************/
@@ -116,6 +218,8 @@ int leed_ld_2lay (mat *, mat *, mat *, mat *,
              leed_beam_t *, real *);
 mat leed_ld_2lay_rpm (mat, mat, mat, mat, mat, mat,
              leed_beam_t *, real *);
+mat leed_ld_2lay_rpm1 (mat, mat, mat, mat, mat, mat,
+             leed_beam_t *, real *);
    /* LD for periodic layers */
 mat leed_ld_2n (mat, mat, mat, mat, mat, leed_beam_t *, real *);
    /* LD for potential step */
@@ -156,11 +260,17 @@ mat leed_ms_tmat_nd_ii (mat , mat, mat, int );
 mat leed_ms_tmat_ij (mat , mat, mat, int );
 mat leed_ms_tmat_ij_sym (mat, mat, mat, int, int );
 
+   /* C.G. coupling tensor for Green's functions (lmsgaunt.c) */
+leed_gaunt_t *leed_ms_gaunt(int , int );
+void leed_ms_gaunt_free(void);
+
    /* Transformation L -> k (lmsymat.c/lmsymmat.c) */
 mat leed_ms_ymat  (mat , int , leed_beam_t *, int );
 mat leed_ms_ymat_set  (mat , int , leed_beam_t *, int );
 mat leed_ms_ymmat (mat , int , leed_beam_t *, int );
 mat leed_ms_ymat_r (mat , int , leed_beam_t *, int );
+leed_ylm_t *leed_ms_ymat_cache(int , leed_beam_t *, int );
+void leed_ms_ymat_cache_free(void);
 
    /* Transformations of Ylm (lmsypy.c) */
 mat leed_ms_yp_ym  (mat , mat);
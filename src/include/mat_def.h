@@ -57,6 +57,17 @@ extern "C" {
 #define BLK_ARRAY      0x4000   /* part of a matrix array */
 #define BLK_END        0x5000   /* terminator of a matrix array */
 
+/*
+ * A block-diagonal matrix is stored as a matrix array (BLK_ARRAY) of its
+ * square diagonal blocks in the order along the diagonal (see matbd*.c).
+ */
+
+/*
+ * inversion modes (matinvmode)
+ */
+#define MAT_INV_COPY    0       /* invert a copy of the input matrix */
+#define MAT_INV_INPLACE 1       /* invert in place if output == input */
+
 /*
  * number types:
  * Use only low bytes for num_type, i.e. NUM_* <= 0xFF (NUM_MASK)
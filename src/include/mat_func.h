@@ -21,6 +21,11 @@ mat matalloc(mat, int, int, int);
 mat matarralloc(mat, int);
   /* free array of matrices in file matarrfree.c*/
 int matarrfree(mat);
+  /* block-diagonal matrices (matrix arrays of diagonal blocks) */
+int matbddim(mat);                    /* in file matbdexp.c */
+mat matbdexp(mat, mat);               /* in file matbdexp.c */
+mat matbdmul(mat, mat, mat);          /* in file matbdmul.c */
+mat matmulbd(mat, mat, mat);          /* in file matbdmul.c */
   /* check validity of pointer */
 int matcheck(mat); 
   /*  extract a column from a matrix */
@@ -42,6 +47,8 @@ mat matins(mat, mat, int, int);
   /* matrix inversion in file matinv.c */
 mat matinv(mat, mat);
 mat matinv_old(mat, mat);
+int matinvmode(int);
+mat matsolve(mat, mat, mat);
   /* matrix multiplication in file matmul.c */
 mat matmul(mat, mat, mat);
   /* convert order */
@@ -87,7 +94,9 @@ real *r_lubksb( real *, int *, real *, int);
   /* LU decomposition (complex) in file matclu.c */
 int  c_ludcmp( real *, real *, int *, int);
 int  c_luinv( real *, real *, real *, real *, int *, int);
+int  c_luinv_ip( real *, real *, int *, int);
 int  c_lubksb( real *, real *, int *, real *, real *, int);
+int  c_lusolve( real *, real *, int *, real *, real *, int, int);
   /* matrix multiplication for square mat. in file matrm.c */
 real * r_sqmul( real *, real *, real *, int);
 
@@ -4,7 +4,8 @@
     version information for patt
 
 Changes:
-         
+2026-10-17/AG - declare line_buffer extern (multiple definitions with
+                -fno-common).
 ****************************************************************************/
 
 #ifdef __cplusplus /* If this is a C++ compiler, use C linkage */
@@ -99,7 +100,8 @@ typedef enum {
 /* map to postscript symbol font */
 extern const char substitutes[NUM_SUBS][2][STRSZ];
 
-char line_buffer[STRSZ];
+/* input line buffer, defined in patt_fget_nocomm.c */
+extern char line_buffer[STRSZ];
 
 /*******************************************************
 Pattern Structures
@@ -0,0 +1,116 @@
+#ifndef PATT_MATCH_H
+#define PATT_MATCH_H
+
+#include <stddef.h>
+#include "pattern.h"
+
+#ifdef __cplusplus /* If this is a C++ compiler, use C linkage */
+  extern "C" {
+#endif
+
+/*! \def PATT_MATCH_MAX_SYM
+ *  \brief Maximum number of symmetry operations of the substrate lattice.
+ */
+#define PATT_MATCH_MAX_SYM 12
+
+/*! \struct patt_kdtree_t
+ *  \brief Two-dimensional k-d tree of spot positions.
+ *
+ * The tree is stored implicitly: the points are reordered such that the
+ * median of each sub-range [lo, hi) is at (lo + hi)/2, split along x for
+ * even and along y for odd depths.
+ */
+typedef struct patt_kdtree_t
+{
+  double *x;                /*!< x positions (reordered) */
+  double *y;                /*!< y positions (reordered) */
+  size_t *index;            /*!< original index of each point */
+  size_t n_points;          /*!< number of points */
+} patt_kdtree_t;
+
+/*! \struct patt_candidate_t
+ *  \brief Superstructure candidate with its domains and matching score.
+ */
+typedef struct patt_candidate_t
+{
+  int M[4];                     /*!< SS matrix (M11, M12, M21, M22) in HNF */
+  int n_domains;                /*!< number of symmetry equivalent domains */
+  int M_dom[PATT_MATCH_MAX_SYM][4]; /*!< SS matrices of all domains */
+  size_t n_spots;               /*!< number of predicted spots on screen */
+  size_t n_matched;             /*!< predicted spots with a measured spot */
+  size_t n_explained;           /*!< measured spots with a predicted spot */
+  double rms;                   /*!< rms distance of matched spots */
+  double score;                 /*!< F-score of precision and recall */
+} patt_candidate_t;
+
+/*! \fn patt_kdtree_t *patt_kdtree_build(const double *x, const double *y,
+ *                                       size_t n_points)
+ *  \brief Build k-d tree from arrays of spot positions (arrays are copied).
+ *  \return Pointer to tree or NULL on allocation failure.
+ */
+patt_kdtree_t *patt_kdtree_build(const double *x, const double *y,
+                                 size_t n_points);
+
+/*! \fn void patt_kdtree_free(patt_kdtree_t *tree)
+ *  \brief Free k-d tree.
+ */
+void patt_kdtree_free(patt_kdtree_t *tree);
+
+/*! \fn size_t patt_kdtree_nearest(const patt_kdtree_t *tree,
+ *                                 double x, double y, double *dist)
+ *  \brief Find the nearest point to (x, y).
+ *  \param *dist Distance to the nearest point (output).
+ *  \return Original index of the nearest point (n_points if tree is empty).
+ */
+size_t patt_kdtree_nearest(const patt_kdtree_t *tree,
+                           double x, double y, double *dist);
+
+/*! \fn int patt_match_symmetry(const pattern_t *pat, int S[][4])
+ *  \brief Find the point group operations of the substrate lattice.
+ *  \param *pat Pattern with real space lattice vectors a1, a2.
+ *  \param S Array of PATT_MATCH_MAX_SYM integer matrices (output).
+ *  \return Number of operations.
+ */
+int patt_match_symmetry(const pattern_t *pat, int S[][4]);
+
+/*! \fn patt_candidate_t *patt_match_candidates(const pattern_t *pat,
+ *                                              int det_max, size_t *n_cand)
+ *  \brief Enumerate all commensurate superstructures up to \a det_max.
+ *  \param *pat Pattern with real space lattice vectors a1, a2.
+ *  \param det_max Maximum determinant of the SS matrices.
+ *  \param *n_cand Number of candidates (output).
+ *  \return Array of candidates (with domains), NULL on failure.
+ *
+ * Each superlattice is enumerated once in Hermite normal form,
+ * superlattices related by a symmetry operation of the substrate are
+ * combined into one candidate with several domains.
+ */
+patt_candidate_t *patt_match_candidates(const pattern_t *pat, int det_max,
+                                        size_t *n_cand);
+
+/*! \fn int patt_match_score(const pattern_t *pat,
+ *                           const patt_kdtree_t *measured, double tol,
+ *                           patt_candidate_t *cand, size_t n_cand)
+ *  \brief Score candidates against measured spot positions.
+ *  \param *pat Pattern with lattice vectors and radius (screen units).
+ *  \param *measured k-d tree of measured spots (same units as spots_t).
+ *  \param tol Maximum distance of matching spots.
+ *  \param *cand Array of candidates (scores are written).
+ *  \param n_cand Number of candidates.
+ *  \return 0 on success, -1 on failure.
+ *
+ * The candidates are scored in parallel if compiled with OpenMP.
+ */
+int patt_match_score(const pattern_t *pat, const patt_kdtree_t *measured,
+                     double tol, patt_candidate_t *cand, size_t n_cand);
+
+/*! \fn void patt_match_sort(patt_candidate_t *cand, size_t n_cand)
+ *  \brief Sort candidates by decreasing score.
+ */
+void patt_match_sort(patt_candidate_t *cand, size_t n_cand);
+
+#ifdef __cplusplus /* If this is a C++ compiler, use C linkage */
+} /* extern "C" */
+#endif
+
+#endif /* PATT_MATCH_H */
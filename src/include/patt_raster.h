@@ -0,0 +1,85 @@
+#ifndef PATT_RASTER_H
+#define PATT_RASTER_H
+
+#include <stddef.h>
+#include "spots.h"
+#include "pattern.h"
+#include "patt_colors.h"
+
+#ifdef __cplusplus /* If this is a C++ compiler, use C linkage */
+  extern "C" {
+#endif
+
+/*! \def PATT_RASTER_SIZE
+ *  \brief Default width and height of raster images in pixels.
+ */
+#define PATT_RASTER_SIZE 512
+
+/*! \struct patt_raster_t
+ *  \brief RGB raster image for fast (batch) rendering of LEED patterns.
+ *
+ * The drawing coordinates of spots_t (origin at the centre, screen 
+ * radius MAX_RADIUS, y pointing up) are mapped onto the pixels with 
+ * \a scale pixels per drawing unit.
+ */
+typedef struct patt_raster_t
+{
+  size_t width;             /*!< width of image in pixels */
+  size_t height;            /*!< height of image in pixels */
+  double scale;             /*!< pixels per drawing unit */
+  unsigned char *pixels;    /*!< RGB pixels (3 bytes each), row by row */
+} patt_raster_t;
+
+/*! \fn patt_raster_t *patt_raster_init(size_t width, size_t height)
+ *  \brief Allocate raster image and clear it to white.
+ *  \param width Width of image in pixels.
+ *  \param height Height of image in pixels.
+ *  \return Pointer to raster or NULL if allocation failed.
+ */
+patt_raster_t *patt_raster_init(size_t width, size_t height);
+
+/*! \fn void patt_raster_free(patt_raster_t *raster)
+ *  \brief Free raster image.
+ */
+void patt_raster_free(patt_raster_t *raster);
+
+/*! \fn void patt_raster_clear(patt_raster_t *raster, 
+ *                             const patt_color_rgb_t *color)
+ *  \brief Fill the whole image with \a color.
+ */
+void patt_raster_clear(patt_raster_t *raster, const patt_color_rgb_t *color);
+
+/*! \fn void patt_raster_draw_spots(patt_raster_t *raster, 
+ *                                  const spots_t *spots,
+ *                                  const patt_color_rgb_t *color)
+ *  \brief Draw all spots of a list with radius, shape and fill of \a spots.
+ *
+ * Circles are drawn as discs (or rings if not filled), all other shapes
+ * as squares.
+ */
+void patt_raster_draw_spots(patt_raster_t *raster, const spots_t *spots,
+                            const patt_color_rgb_t *color);
+
+/*! \fn int patt_raster_draw_pattern(patt_raster_t *raster, 
+ *                                   const pattern_t *pat, size_t i_file)
+ *  \brief Draw substrate and superstructure spots of a pattern.
+ *  \param i_file Index of the pattern used for the color scheme.
+ *  \return 0 on success, -1 if spots could not be calculated.
+ *
+ * Equivalent domains are drawn only once (pattern_get_unique_domains).
+ */
+int patt_raster_draw_pattern(patt_raster_t *raster, const pattern_t *pat, 
+                             size_t i_file);
+
+/*! \fn int patt_raster_write_png(const patt_raster_t *raster, 
+ *                                const char *filename)
+ *  \brief Write raster image to PNG file (libpng).
+ *  \return 0 on success, -1 on failure.
+ */
+int patt_raster_write_png(const patt_raster_t *raster, const char *filename);
+
+#ifdef __cplusplus /* If this is a C++ compiler, use C linkage */
+} /* extern "C" */
+#endif
+
+#endif /* PATT_RASTER_H */
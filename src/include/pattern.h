@@ -230,6 +230,26 @@ spots_t *pattern_calculate_substrate_spots(const pattern_t *pat);
  */
 spots_t *pattern_calculate_superstructure_spots(const pattern_t *pat, size_t domain);
 
+/*! \fn bool pattern_domains_are_equivalent(const pattern_t *pat, 
+ *                                          size_t i_dom, size_t j_dom)
+ *  \brief Check whether two domains produce the same spots.
+ *  \param *pat Pointer to pattern_t struct.
+ *  \param i_dom Index of first domain.
+ *  \param j_dom Index of second domain.
+ *  \return true if the superstructure lattices of both domains coincide.
+ */
+bool pattern_domains_are_equivalent(const pattern_t *pat, 
+                                    size_t i_dom, size_t j_dom);
+
+/*! \fn size_t pattern_get_unique_domains(const pattern_t *pat, 
+ *                                        size_t *domains)
+ *  \brief List the domains which produce distinct spots.
+ *  \param *pat Pointer to pattern_t struct.
+ *  \param *domains Array of \a n_domains indices (output).
+ *  \return Number of unique domains written to \a domains.
+ */
+size_t pattern_get_unique_domains(const pattern_t *pat, size_t *domains);
+
 #ifdef __cplusplus /* If this is a C++ compiler, use C linkage */
 } /* extern "C" */
 
@@ -0,0 +1,34 @@
+/*********************************************************************
+AG/17.10.26
+
+include file for angular momentum kernels with fixed l_max
+
+ The kernels (r_ylm, c_hank1, lattice sums) are written as a core 
+ function with l_max as argument. For the common values of l_max 
+ (QM_L_FIX_MIN ... QM_L_FIX_MAX) a copy of the core is generated for 
+ each l_max with QM_L_FIX_ALL, in which l_max is a constant: the 
+ compiler knows all loop trip counts and index offsets and can unroll 
+ and keep the prefactor arrays in registers. The copies are selected 
+ at runtime through a table of function pointers (index l_max - 
+ QM_L_FIX_MIN); other values of l_max use the core directly.
+*********************************************************************/
+#ifndef QM_LFIX_H
+#define QM_LFIX_H
+
+#define QM_L_FIX_MIN  6
+#define QM_L_FIX_MAX 14
+
+#define QM_L_FIX(l_max) \
+        ( ((l_max) >= QM_L_FIX_MIN) && ((l_max) <= QM_L_FIX_MAX) )
+
+/* apply macro F to all fixed values of l_max */
+#define QM_L_FIX_ALL(F) F(6) F(7) F(8) F(9) F(10) F(11) F(12) F(13) F(14)
+
+/* the core must be inlined into each copy */
+#if defined(__GNUC__)
+#define QM_L_CORE static inline __attribute__((always_inline))
+#else
+#define QM_L_CORE static
+#endif
+
+#endif /* QM_LFIX_H */
@@ -11,6 +11,7 @@ GH/16.08.95 - Create (copy from srdefines.h )
 GH/20.09.95 - Include parameters for R factor program here
 GH/20.06.06 - Change number of iterations in amoeba to 2000.
 LD/29.04.14 - Removed RFAC_PRG & LEED_PRG from defines as no longer used.
+AG/17.10.26 - Add occupancy search (i_par_occ, sr_occ, n_par_occ, FAC_OCC).
 
 *********************************************************************/
 
@@ -47,6 +48,9 @@ struct sratom_str
  real *y_par;     /* coefficients used to determine shifts in y */
  real *z_par;     /* coefficients used to determine shifts in z */
  real *dr_par;    /* coefficients used to determine shifts in dr */
+
+ int i_par_occ;   /* search parameter for the concentration of a mixture
+                     (average t matrix, e.g. "Ni*0.8+Cu*0.2"); 0: none */
 };
 
 struct search_str
@@ -76,6 +80,9 @@ struct search_str
  real theta_0;    /* theta start value */
  real phi_0;      /* phi start value */
 
+/* occupancy search */
+ int sr_occ;      /* flag for the search of concentrations */
+ int n_par_occ;   /* number of concentration parameters */
 
 /* symmeties of search */
  int z_only;           /* xyz search or z search only */
@@ -168,6 +175,10 @@ struct search_str
     
     \def FAC_PHI
     Factor for displacement in phi.
+
+    \def FAC_OCC
+    Factor for the change of the concentration of the first component
+    of a mixture.
 */    
 #define R_TOLERANCE     5.0e-4  /* tolerance of R factors for termination */
 
@@ -182,6 +193,7 @@ struct search_str
 
 #define FAC_THETA       5.      /* factor for displacement in theta */
 #define FAC_PHI         50.     /* factor for displacement in phi */
+#define FAC_OCC         1.      /* factor for change of concentration */
 
 /* 
   R-factor parameters  (used in sr_evalrf)
@@ -43,6 +43,8 @@ real sr_ckgeo(real *);
 int  sr_ckrot(struct sratom_str * , struct search_str * );
 real sr_evalrf(real *);
 int  sr_mkinp(real *, int, char *);
+int  sr_occ_name(char *, const char *, real );
+real sr_occ_conc(const char *, real );
 int  sr_rdinp(const char * );
 int  sr_rdver(char * , real *, real **, int );
 
@@ -76,11 +78,31 @@ real sr_ckgeo_gsl(const gsl_vector *);
 int  sr_ckrot(struct sratom_str * , struct search_str * );
 double sr_evalrf_gsl(const gsl_vector *);
 int  sr_mkinp_gsl(const gsl_vector *, int, const char *);
+int  sr_occ_name(char *, const char *, real );
+real sr_occ_conc(const char *, real );
 int  sr_rdinp(const char * );
 int  sr_rdver_gsl(const char *, gsl_vector *, gsl_matrix *);
 
 #endif 
 
+/* early abort of LEED calculations (srrfbound.c, interface uses double) */
+int    sr_rf_abort_mode(int );
+double sr_rf_threshold(double );
+int    sr_leed_stream(const char *, const char *, int , char * *, double ,
+                      double *);
+
+/* in-process LEED calculation (srleed.c) */
+int    sr_leed_mode(int );
+double sr_leed_budget(double );
+int    sr_leed_delta(char *, char *, char *);
+
+/* low fidelity screening (srlofi.c) */
+int  sr_lofi_mode(int , real , real );
+int  sr_lofi_eval(real *);
+int  sr_lofi_screen(real , real , real *);
+void sr_lofi_calib(real , real , real );
+double sr_lofi_time(void);
+
 /* debye temperature */
 real leed_inp_debye_temp(real , real , real );
 
@@ -12,9 +12,16 @@ CHANGES
             - [LD] max displacement options
  02.06.2013 - [LD] --version option added
  29.04.2014 - [LD] Moved preprocessor information into header "latt.h"
+ 17.10.2026 - [AG] bounded search for lattice vectors.
+            - [AG] generate atoms layer by layer and write them directly to
+                   the output stream (in order of layers, parallel with OpenMP).
+            - [AG] output formats for CLEED input (-f bul|inp).
  
 Format of output file will be:
      <atom_name>  <x> <y> <z>
+or (-f bul/inp) lines of CLEED input files:
+     a1: ... a3: ...
+     pb:/po: <atom_name> <x> <y> <z> dr3 0.0 0.0 0.0
 Lines beginning with '#' are interpreted as comments.
 
 ****************************************************************************/
@@ -31,13 +38,14 @@ int main(int argc, char *argv[])
   char line_buffer[STRSZ];
   
   int n1, n2, n3;
+  int n_bnd[3];
   
   int n_bas=0, i_bas;
-  size_t i_atom, j_atom;
+  size_t i_atom;
   
   double faux_x, faux_y, faux_z, faux_len;
   
-  char *bas_name = malloc(sizeof(char) * NAMSZ);
+  char *bas_name = malloc(sizeof(char) * NAMSZ * MAX_INP_ATOMS);
   
   double b1_len = 0., b2_len = 0., b3_len = 0.;
   double nor_len = 0.0;
@@ -48,8 +56,12 @@ int main(int argc, char *argv[])
   /* variables for print out */
   double dist_min, dist_max;
   
-  int n_max, n_atoms;
-  int i_pass;
+  int n_max;
+  int n3_min, n3_max, n3_blk, i_blk, i_blk_max, max_cells;
+  size_t n_atoms, n_out;
+  double z_last = 0.;
+  atom_t **layer_atoms;
+  size_t *n_layer_atoms;
   
   FILE *out_stream;
   
@@ -149,7 +161,8 @@ int main(int argc, char *argv[])
   coord_t *a2 = coord_init();
   coord_t *a3 = coord_init();  
   coord_t *nor = coord_init();
-  coord_t *bas = coord_init();
+  /* lattice_setup cannot reallocate bas and bas_name: allocate max. size */
+  coord_t *bas = (coord_t *) calloc(MAX_INP_ATOMS, sizeof(coord_t));
   
   basis_t *a = basis_init();
   
@@ -248,11 +261,23 @@ int main(int argc, char *argv[])
   
   coord_t *faux = coord_init();
   
-  for(n1 = -n_max; n1 <= n_max; n1 ++)
+  /* 
+   * Only vectors shorter than b1_len or b3_len are accepted, which limits 
+   * the indices n1, n2, n3 individually (see lattice_index_bounds). 
+   * The search order is the same as for the full cube [-n_max, n_max]^3.
+   */
+  faux_len = ((b1_len > b3_len) ? b1_len : b3_len) + TOLERANCE;
+  lattice_index_bounds(a1, a2, a3, faux_len, n_bnd);
+  for (i_bas = 0; i_bas < 3; i_bas++)
   {
-    for(n2 = -n_max; n2 <= n_max; n2 ++)
+    if (n_bnd[i_bas] > n_max) n_bnd[i_bas] = n_max;
+  }
+
+  for(n1 = -n_bnd[0]; n1 <= n_bnd[0]; n1 ++)
+  {
+    for(n2 = -n_bnd[1]; n2 <= n_bnd[1]; n2 ++)
     {
-      for(n3 = -n_max; n3 <= n_max; n3 ++)
+      for(n3 = -n_bnd[2]; n3 <= n_bnd[2]; n3 ++)
       {
         faux->z = (n1 * a1->z) + (n2 * a2->z) + (n3 * a3->z);
         
@@ -472,156 +497,129 @@ int main(int argc, char *argv[])
 
 /********************************************************
  Create list of atoms
- i_pass = 0: find number of atoms in list (n_atoms).
- i_pass = 1: write atoms to list.
+ The atoms are generated for each layer of unit cells (n3)
+ separately, only the in-plane cells which can contribute 
+ to the image are visited (lattice_layer_atoms).
+ First pass: find number of atoms (n_atoms), needed for the
+ header of the xyz file.
+ Second pass: generate blocks of layers (in parallel if
+ compiled with OpenMP) and write them to the output stream.
+ The atoms are sorted by z within each layer of unit cells,
+ i.e. the output is in the order of the layers.
 ********************************************************/
 
-/* n_atom will be changed later */
-  n_atoms = lat->n_atoms;
-  
 /* cycle through layers */
   if (lat->max_layers == 0) 
   {
     lat->max_layers = (int)( rint (-3. * lat->a_nn / (b3->z) ) );
   }
 
-  faux->x = lat->image_len / b1->x;
-  if( (lat->image_len / b2->y) > faux->x) 
+  max_cells = lat->max_cells;
+  if (lat->out_format == LAT_OUT_BUL)
   {
-    faux->x = lat->image_len / b2->y;
+    /* bulk: basis of the unit cell at the origin */
+    n3_min = 0;
+    n3_max = 1;
   }
-  n_max = (int)( rint( 4. * faux->x) );
-
-  for(i_pass = 0; i_pass < 2; i_pass ++)
+  else if (lat->out_format == LAT_OUT_INP)
   {
-    i_atom = 0;
+    /* overlayer: unit cells on top of the bulk unit cell (z > 0) */
+    n3_min = -lat->max_layers;
+    n3_max = 0;
+  }
+  else
+  {
+    n3_min = -1;
+    n3_max = lat->max_layers;
+  }
 
-    if(i_pass > 0) 
+  n_atoms = 0;
+  for(n3 = n3_min; n3 < n3_max; n3 ++)
+  {
+    if (lat->out_format == LAT_OUT_XYZ)
+    {
+      n_atoms += lattice_layer_atoms(NULL, b1, b2, b3, bas, bas_name, n_bas,
+                                     n3, max_cells, lat->image_len);
+    }
+    else
     {
-      fprintf(ctr_stream, " n_atom = %d; n_layers = %d\n", 
-              lat->n_atoms, lat->max_layers); 
+      n_atoms += n_bas;
     }
+  }
+  lat->n_atoms = n_atoms;
+
+  fprintf(ctr_stream, " n_atom = %u; n_layers = %u\n", 
+          (unsigned int)n_atoms, (unsigned int)lat->max_layers); 
 
+  lattice_printf_header(out_stream, lat, n_atoms, b1, b2, b3);
 
-/* complete unit cells if n_unit_cell > 0 */
+  layer_atoms = (atom_t **) calloc(LAT_LAYER_BLOCK, sizeof(atom_t *));
+  n_layer_atoms = (size_t *) calloc(LAT_LAYER_BLOCK, sizeof(size_t));
 
-    n_max = lat->max_cells;
+  dist_min = lat->a_nn;
+  dist_max = 0.;
+  n_out = 0;
+  
+  for(n3_blk = n3_min; n3_blk < n3_max; n3_blk += LAT_LAYER_BLOCK)
+  {
+    i_blk_max = n3_max - n3_blk;
+    if (i_blk_max > LAT_LAYER_BLOCK) i_blk_max = LAT_LAYER_BLOCK;
 
-    if(lat->max_cells > 0)
+    #ifdef _USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for(i_blk = 0; i_blk < i_blk_max; i_blk ++)
     {
-      for(n3 = -1; n3 < lat->max_layers; n3 ++)
+      if (lat->out_format == LAT_OUT_XYZ)
       {
-      /* n_max -> n_cells */
-        for(n1 = -n_max; n1 < n_max; n1 ++)
-        {
-          for(n2 = -n_max; n2 < n_max; n2 ++)
-          {
-  
-            faux->x = n1 * b1->x + n2 * b2->x + n3 * b3->x;
-            faux->y = n1 * b1->y + n2 * b2->y + n3 * b3->y;
-            faux->z = n1 * b1->z + n2 * b2->z + n3 * b3->z;
-  
-            if(    (faux->x >= -TOLERANCE ) && (faux->x < lat->image_len)
-                && (faux->y >= -TOLERANCE ) && (faux->y < lat->image_len)
-                && (faux->z <= TOLERANCE)  )
-            {
-              for(i_bas = 0; i_bas < n_bas; i_bas ++)
-              {
-  
-                if(i_pass > 0)
-                {
-                  lat->atoms[i_atom].x = n1 * b1->x + 
-                                         n2 * b2->x + n3 * b3->x + bas[i_bas].x;
-                  lat->atoms[i_atom].y = n1 * b1->y + 
-                                         n2 * b2->y + n3 * b3->y + bas[i_bas].y;
-                  lat->atoms[i_atom].z = n1 * b1->z +
-                                         n2 * b2->z + n3 * b3->z + bas[i_bas].z;
-                  strncpy(lat->atoms[i_atom].element, 
-                          bas_name+(i_bas+NAMSZ), NAMSZ);
-                }
-  
-                i_atom ++;
-  
-              }  /* for i_bas */
-            }  /* if */
-          } 
-        }/* for n1, n2 */
-      } /* for n3 */
-    } /* keep unit cell */
-
-/* only atoms within limits if n_unit_cell <= 0 */
-    else 
+        n_layer_atoms[i_blk] = lattice_layer_atoms(&layer_atoms[i_blk], 
+                                  b1, b2, b3, bas, bas_name, n_bas, 
+                                  n3_blk + i_blk, max_cells, lat->image_len);
+      }
+      else
+      {
+        /* single unit cell */
+        n_layer_atoms[i_blk] = lattice_cell_atoms(&layer_atoms[i_blk], 
+                                  b3, bas, bas_name, n_bas, n3_blk + i_blk);
+      }
+    }
+
+    /* write layers in order */
+    for(i_blk = 0; i_blk < i_blk_max; i_blk ++)
     {
-      for(n3 = -1; n3 < lat->max_layers; n3 ++)
+      for(i_atom = 0; i_atom < n_layer_atoms[i_blk]; i_atom ++)
       {
-        for(n1 = -n_max; n1 < n_max; n1 ++)
+        if (n_out > 0)
         {
-          for(n2 = -n_max; n2 < n_max; n2 ++)
-          {
-            for(i_bas = 0; i_bas < n_bas; i_bas ++)
-            {
-              faux->x = n1 * b1->x + n2 * b2->x + n3 * b3->x + bas[i_bas].x;
-              faux->y = n1 * b1->y + n2 * b2->y + n3 * b3->y + bas[i_bas].y;
-              faux->z = n1 * b1->z + n2 * b2->z + n3 * b3->z + bas[i_bas].z;
-  
-              if (   (faux->x >= -TOLERANCE ) && (faux->x < lat->image_len)
-                  && (faux->y >= -TOLERANCE ) && (faux->y < lat->image_len) 
-                  && (faux->z <= TOLERANCE)  )
-              {
-                if(i_pass > 0) 
-                {
-                  lat->atoms[i_atom].x = faux->x;
-                  lat->atoms[i_atom].y = faux->y;
-                  lat->atoms[i_atom].z = faux->z;
-                  strncpy(lat->atoms[i_atom].element, 
-                          bas_name+(i_bas+NAMSZ), NAMSZ);
-                }
-  
-                i_atom ++;
-  
-              }
-  
-            }  /* for i_bas */
-          }
-        }        /* for n1, n2 */
-      } /* for n3 */
-    } /* n_unit_cell <= 0 */
-
-    n_atoms = i_atom;
-
-  } /* i_pass */
-
-/********************************************************
- Sort list of atoms
- Find shortest / longest inter-layer distance
-********************************************************/
+          faux_z = z_last - layer_atoms[i_blk][i_atom].z;
+          if( (faux_z > TOLERANCE) && (faux_z < dist_min) ) dist_min = faux_z;
+          if( faux_z > dist_max ) dist_max = faux_z;
+        }
+        z_last = layer_atoms[i_blk][i_atom].z;
+        n_out ++;
+      }
 
-  for(i_atom = 0; i_atom < lat->n_atoms; i_atom ++)
-  {
-    for(j_atom = i_atom+1; j_atom < lat->n_atoms; j_atom ++)
-    {
-      if(lat->atoms[j_atom].z > lat->atoms[i_atom].z + TOLERANCE)
+      if ( (lat->out_format == LAT_OUT_INP) && (n_layer_atoms[i_blk] > 0) )
       {
-        lattice_atom_index_swap(lat, i_atom, j_atom);
+        fprintf(out_stream, "# layer %d\n", n3_blk + i_blk);
       }
-    } /* for j_atoms */
-  } /* for i_atoms */
+      lattice_printf_atoms(out_stream, lat, 
+                           layer_atoms[i_blk], n_layer_atoms[i_blk]);
+      
+      free(layer_atoms[i_blk]);
+      layer_atoms[i_blk] = NULL;
+    }
+  } /* for n3_blk */
 
-  dist_min = lat->a_nn;
-  dist_max = 0.;
-  for(i_atom = 1; i_atom < lat->n_atoms; i_atom ++)
-  {
-    faux_z = lat->atoms[i_atom-1].z - lat->atoms[i_atom].z;
-    if( (faux_z > TOLERANCE) && (faux_z < dist_min) ) dist_min = faux_z;
-    if( faux_z > dist_max ) dist_max = faux_z;
-  }
+  free(layer_atoms);
+  free(n_layer_atoms);
 
   fprintf(ctr_stream, " dist_min/dist_max = %.3f /%.3f \n", dist_min, dist_max);
   fprintf(inf_stream, " shortest/longest layer distance = %.3f /%.3f \n", 
           dist_min, dist_max);
 
-  lattice_printf(stdout, lat);
-  fprintf(inf_stream, "\n Atoms in list = %d; layers = %d\n", n_atoms, lat->max_layers);
+  fprintf(inf_stream, "\n Atoms in list = %u; layers = %u\n", 
+          (unsigned int)n_out, (unsigned int)lat->max_layers);
   
   fclose(inf_stream);
   fclose(ctr_stream);
@@ -9,6 +9,7 @@ LD/24.04.14
      Provides version information then exits
   
 Changes:
+AG/17.10.26 - added -f --format option
 
 *********************************************************************/
 
@@ -22,6 +23,8 @@ void latt_usage(FILE *output) {
     fprintf(output, "  -c <lattice_constant> : specify lattice constant c\n");
     fprintf(output, "  -d <max displacement> : max displacement in unit cells\n");
     fprintf(output, "                          [equiv. to d1=d2=a, d3=c*d]\n");
+    fprintf(output, "  -f --format <format>  : output format 'xyz' (default),\n");
+    fprintf(output, "                          'bul' or 'inp' (CLEED input)\n");
     fprintf(output, "  -h --help             : print help and exit\n");
     fprintf(output, "                          Note argument must not follow -h\n");
 	fprintf(output, "  -i --input <input>    : input of basis vectors\n");
@@ -39,6 +42,7 @@ void latt_usage(FILE *output) {
     fprintf(output, "\n");
     fprintf(output, "Output files:\n");
     fprintf(output, "  <output>: XYZ format atom output [with script]\n"); 
+    fprintf(output, "            or CLEED bulk (a1-a3, pb:) / overlayer (po:)\n");
 }
 
 void latt_info()
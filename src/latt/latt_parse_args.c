@@ -104,6 +104,27 @@ void latt_parse_args(int argc, char *argv[], lattice_t *latt)
         }
       }
 
+      /* f: output format */
+      if (ARG_ISH("-f", 2) || ARG_IS("--format"))
+      {
+        i_arg++;
+        if (i_arg >= argc)
+        {
+          fprintf(stderr, "*** error (latt_main): "
+                  "missing format argument for '-f'\n");
+          exit(INVALID_ARGUMENT_ERROR);
+        }
+        if      ARG_ISH("xyz", 3) {latt->out_format = LAT_OUT_XYZ;}
+        else if ARG_ISH("bul", 3) {latt->out_format = LAT_OUT_BUL;}
+        else if ARG_ISH("inp", 3) {latt->out_format = LAT_OUT_INP;}
+        else 
+        {
+          fprintf(stderr, "*** error: "
+                  "%s is an invalid argument\n", argv[i_arg]);
+          exit(INVALID_ARGUMENT_ERROR);
+        }
+      }
+
       /* help */
       if ARG_ISH("--help", 6)
       {
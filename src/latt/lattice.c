@@ -109,6 +109,7 @@ lattice_t *lattice_init(size_t n_atoms)
   lat->max_cells = 5;
   lat->image_len = IMAGE_LEN;
   lat->max_atoms = MAX_OUT_ATOMS;
+  lat->out_format = LAT_OUT_XYZ;
   
   lat->vec_h = 0.;
   lat->vec_k = 0.;
@@ -802,3 +803,281 @@ void lattice_read(lattice_t *lat, coord_t *a1, coord_t *a2, coord_t *a3,
   #endif
 
 }
+
+/********************************************************
+ Bounds of the lattice vector indices n1, n2, n3 for all
+ vectors n1*a1 + n2*a2 + n3*a3 shorter than len:
+ n_i = v . r_i with the reciprocal vectors r_i = (a_j x a_k) / V,
+ therefore |n_i| <= len * |a_j x a_k| / |V|.
+********************************************************/
+void lattice_index_bounds(const coord_t *a1, const coord_t *a2, 
+                          const coord_t *a3, double len, int n_bnd[3])
+{
+  const coord_t *a[3];
+  coord_t cross;
+  double vol;
+  int i;
+  
+  a[0] = a1; a[1] = a2; a[2] = a3;
+  
+  vol = fabs( a1->x * (a2->y*a3->z - a2->z*a3->y) + 
+              a1->y * (a2->z*a3->x - a2->x*a3->z) + 
+              a1->z * (a2->x*a3->y - a2->y*a3->x) );
+  
+  for (i = 0; i < 3; i++)
+  {
+    const coord_t *aj = a[(i+1) % 3];
+    const coord_t *ak = a[(i+2) % 3];
+    
+    cross.x = aj->y*ak->z - aj->z*ak->y;
+    cross.y = aj->z*ak->x - aj->x*ak->z;
+    cross.z = aj->x*ak->y - aj->y*ak->x;
+    
+    if (vol > TOLERANCE * TOLERANCE * TOLERANCE)
+    {
+      n_bnd[i] = (int) ceil(len * sqrt(cross.x*cross.x + cross.y*cross.y + 
+                                       cross.z*cross.z) / vol);
+    }
+    else 
+    {
+      n_bnd[i] = INT_MAX;
+    }
+  }
+}
+
+/********************************************************
+ Range of the in-plane indices n1, n2 for which 
+ n1*b1 + n2*b2 + c lies within the square 
+ [-TOLERANCE, image_len) x [-TOLERANCE, image_len):
+ the corners of the square are transformed into (n1, n2)
+ coordinates; the range is the bounding box (+1 on each side 
+ for rounding).
+********************************************************/
+static void lattice_cell_range(const coord_t *b1, const coord_t *b2,
+                               double c_x, double c_y, double image_len,
+                               int n_min[2], int n_max[2])
+{
+  double det, px, py, f1, f2;
+  double f_min[2], f_max[2];
+  int i_corner;
+  
+  det = b1->x * b2->y - b2->x * b1->y;
+  
+  f_min[0] = f_min[1] = DBL_MAX;
+  f_max[0] = f_max[1] = -DBL_MAX;
+  
+  for (i_corner = 0; i_corner < 4; i_corner++)
+  {
+    px = ((i_corner & 1) ? image_len : -TOLERANCE) - c_x;
+    py = ((i_corner & 2) ? image_len : -TOLERANCE) - c_y;
+    
+    f1 = ( b2->y * px - b2->x * py) / det;
+    f2 = (-b1->y * px + b1->x * py) / det;
+    
+    if (f1 < f_min[0]) f_min[0] = f1;
+    if (f1 > f_max[0]) f_max[0] = f1;
+    if (f2 < f_min[1]) f_min[1] = f2;
+    if (f2 > f_max[1]) f_max[1] = f2;
+  }
+  
+  n_min[0] = (int) floor(f_min[0]) - 1;
+  n_max[0] = (int) ceil(f_max[0]) + 1;
+  n_min[1] = (int) floor(f_min[1]) - 1;
+  n_max[1] = (int) ceil(f_max[1]) + 1;
+}
+
+/********************************************************
+ Generate the atoms of unit cell layer n3 within the
+ image (0 <= x,y < image_len, z <= 0).
+ 
+ If max_cells > 0, complete unit cells are used (the cell
+ origin must be within the image) and n1, n2 are limited to
+ [-max_cells, max_cells); otherwise each atom is tested.
+ 
+ If p_atoms is NULL, the atoms are only counted; else 
+ *p_atoms is allocated and contains the atoms sorted by z 
+ (top-most first). The element names point into bas_name.
+ 
+ Returns the number of atoms.
+********************************************************/
+size_t lattice_layer_atoms(atom_t **p_atoms, const coord_t *b1, 
+                           const coord_t *b2, const coord_t *b3, 
+                           const coord_t *bas, char *bas_name, int n_bas,
+                           int n3, int max_cells, double image_len)
+{
+  int n1, n2, i_bas;
+  int n_min[2], n_max[2];
+  size_t n_atoms, n_alloc;
+  double x, y, z, c_x, c_y;
+  atom_t *atoms = NULL;
+  
+  n_atoms = n_alloc = 0;
+  
+  for (i_bas = 0; i_bas < n_bas; i_bas++)
+  {
+    /* the cell origin (max_cells > 0) or the atom must be in the image */
+    c_x = n3 * b3->x;
+    c_y = n3 * b3->y;
+    if (max_cells <= 0)
+    {
+      c_x += bas[i_bas].x;
+      c_y += bas[i_bas].y;
+    }
+    
+    lattice_cell_range(b1, b2, c_x, c_y, image_len, n_min, n_max);
+    if (max_cells > 0)
+    {
+      if (n_min[0] < -max_cells) n_min[0] = -max_cells;
+      if (n_max[0] > max_cells - 1) n_max[0] = max_cells - 1;
+      if (n_min[1] < -max_cells) n_min[1] = -max_cells;
+      if (n_max[1] > max_cells - 1) n_max[1] = max_cells - 1;
+    }
+    
+    for (n1 = n_min[0]; n1 <= n_max[0]; n1++)
+    {
+      for (n2 = n_min[1]; n2 <= n_max[1]; n2++)
+      {
+        x = n1 * b1->x + n2 * b2->x + c_x;
+        y = n1 * b1->y + n2 * b2->y + c_y;
+        z = n1 * b1->z + n2 * b2->z + n3 * b3->z;
+        if (max_cells <= 0) z += bas[i_bas].z;
+        
+        if ( (x < -TOLERANCE) || (x >= image_len) || 
+             (y < -TOLERANCE) || (y >= image_len) || 
+             (z > TOLERANCE) ) continue;
+        
+        if (p_atoms != NULL)
+        {
+          if (n_atoms >= n_alloc)
+          {
+            n_alloc = 2 * n_alloc + 16;
+            atoms = (atom_t *) realloc(atoms, n_alloc * sizeof(atom_t));
+          }
+          
+          atoms[n_atoms].element = bas_name + (i_bas * NAMSZ);
+          atoms[n_atoms].x = n1 * b1->x + n2 * b2->x + n3 * b3->x + bas[i_bas].x;
+          atoms[n_atoms].y = n1 * b1->y + n2 * b2->y + n3 * b3->y + bas[i_bas].y;
+          atoms[n_atoms].z = n1 * b1->z + n2 * b2->z + n3 * b3->z + bas[i_bas].z;
+        }
+        n_atoms++;
+        
+      } 
+    } /* for n1, n2 */
+  } /* for i_bas */
+  
+  if (p_atoms != NULL)
+  {
+    if (n_atoms > 1) qsort(atoms, n_atoms, sizeof(atom_t), lattice_atom_cmp_z);
+    *p_atoms = atoms;
+  }
+  
+  return (n_atoms);
+}
+
+/********************************************************
+ Generate the atoms of the single unit cell n3 * b3 
+ (basis atoms shifted by n3 * b3), sorted by z.
+ Returns the number of atoms (n_bas).
+********************************************************/
+size_t lattice_cell_atoms(atom_t **p_atoms, const coord_t *b3, 
+                          const coord_t *bas, char *bas_name, int n_bas, int n3)
+{
+  int i_bas;
+  atom_t *atoms = (atom_t *) malloc((n_bas + 1) * sizeof(atom_t));
+  
+  for (i_bas = 0; i_bas < n_bas; i_bas++)
+  {
+    atoms[i_bas].element = bas_name + (i_bas * NAMSZ);
+    atoms[i_bas].x = n3 * b3->x + bas[i_bas].x;
+    atoms[i_bas].y = n3 * b3->y + bas[i_bas].y;
+    atoms[i_bas].z = n3 * b3->z + bas[i_bas].z;
+  }
+  
+  if (n_bas > 1) qsort(atoms, n_bas, sizeof(atom_t), lattice_atom_cmp_z);
+  *p_atoms = atoms;
+  
+  return ((size_t) n_bas);
+}
+
+/********************************************************
+ Compare atoms for sorting by z (top-most first), then y, x.
+********************************************************/
+int lattice_atom_cmp_z(const void *p1, const void *p2)
+{
+  const atom_t *at1 = (const atom_t *) p1;
+  const atom_t *at2 = (const atom_t *) p2;
+  
+  if (at1->z > at2->z) return (-1);
+  if (at1->z < at2->z) return (1);
+  if (at1->y < at2->y) return (-1);
+  if (at1->y > at2->y) return (1);
+  if (at1->x < at2->x) return (-1);
+  if (at1->x > at2->x) return (1);
+  return (0);
+}
+
+/********************************************************
+ Write the header of the output file:
+ LAT_OUT_XYZ: number of atoms, script, Miller indices;
+ LAT_OUT_BUL / LAT_OUT_INP: CLEED lattice vectors 
+ (a3 only for the bulk file).
+********************************************************/
+void lattice_printf_header(FILE *output, const lattice_t *lat, size_t n_atoms,
+                           const coord_t *b1, const coord_t *b2, 
+                           const coord_t *b3)
+{
+  if (lat->out_format == LAT_OUT_XYZ)
+  {
+    fprintf(output, "%u\n", (unsigned int) n_atoms);
+    if (strlen(lat->script) > 0) 
+    {
+      if (lat->script[0] != '#') fprintf(output, "#");
+      fprintf(output, "%s #\n", lat->script);
+    }
+    fprintf(output, "# (%.0f;%.0f;%.0f)\n", 
+            lat->vec_h, lat->vec_k, lat->vec_l);
+  }
+  else
+  {
+    fprintf(output, "# (%.0f;%.0f;%.0f) %u atoms (generated by latt)\n", 
+            lat->vec_h, lat->vec_k, lat->vec_l, (unsigned int) n_atoms);
+    fprintf(output, "a1: %9.4f %9.4f %9.4f\n", b1->x, b1->y, 0.);
+    fprintf(output, "a2: %9.4f %9.4f %9.4f\n", b2->x, b2->y, 0.);
+    if (lat->out_format == LAT_OUT_BUL)
+    {
+      fprintf(output, "a3: %9.4f %9.4f %9.4f\n", b3->x, b3->y, b3->z);
+    }
+  }
+}
+
+/********************************************************
+ Write a list of atoms:
+ LAT_OUT_XYZ: <atom_name> <x> <y> <z>
+ LAT_OUT_BUL: pb: <atom_name> <x> <y> <z> (bulk atoms)
+ LAT_OUT_INP: po: <atom_name> <x> <y> <z> (overlayer atoms)
+ The atom name is used as the name of the phase shift file in
+ the CLEED formats.
+********************************************************/
+void lattice_printf_atoms(FILE *output, const lattice_t *lat, 
+                          const atom_t *atoms, size_t n_atoms)
+{
+  size_t i_atom;
+  
+  for (i_atom = 0; i_atom < n_atoms; i_atom++)
+  {
+    if (lat->out_format == LAT_OUT_XYZ)
+    {
+      fprintf(output, "%s%s %7.3f %7.3f %7.3f\n", 
+              atoms[i_atom].element, 
+              (strlen(atoms[i_atom].element) == 1) ? " " : "",
+              atoms[i_atom].x, atoms[i_atom].y, atoms[i_atom].z);
+    }
+    else 
+    {
+      fprintf(output, "%s %-16s %9.4f %9.4f %9.4f  dr3 0.0 0.0 0.0\n", 
+              (lat->out_format == LAT_OUT_BUL) ? "pb:" : "po:",
+              atoms[i_atom].element, 
+              atoms[i_atom].x, atoms[i_atom].y, atoms[i_atom].z);
+    }
+  }
+}
@@ -0,0 +1,118 @@
+/****************************************************************************
+                TEST_LATTICE_BOUNDS.C (AG 17.10.26)
+
+ Compares the bounded enumeration of latt with a search over all indices
+ up to N_FULL:
+
+ - lattice_index_bounds: every lattice vector n1*a1 + n2*a2 + n3*a3 of
+   length <= len must have |n_i| <= n_bnd[i] (fcc and monoclinic cells);
+ - lattice_layer_atoms: a layer of unit cells must contain the same atoms
+   within the image as a scan of a large square of cells.
+
+ Exit status 1 if any of the comparisons fails, 0 otherwise.
+
+****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "lattice.h"
+
+#define N_FULL 40                 /* range of the full search */
+
+FILE *ctr_stream;                 /* used by lattice.c (see latt.c) */
+FILE *inf_stream;
+
+static int test_bounds(const coord_t *a1, const coord_t *a2,
+                       const coord_t *a3, double len)
+{
+  int n_bnd[3], n1, n2, n3, n_fail = 0;
+  double x, y, z;
+
+  lattice_index_bounds(a1, a2, a3, len, n_bnd);
+
+  for (n1 = -N_FULL; n1 <= N_FULL; n1++)
+    for (n2 = -N_FULL; n2 <= N_FULL; n2++)
+      for (n3 = -N_FULL; n3 <= N_FULL; n3++)
+      {
+        x = n1*a1->x + n2*a2->x + n3*a3->x;
+        y = n1*a1->y + n2*a2->y + n3*a3->y;
+        z = n1*a1->z + n2*a2->z + n3*a3->z;
+        if ( (sqrt(x*x + y*y + z*z) <= len) &&
+             ( (abs(n1) > n_bnd[0]) || (abs(n2) > n_bnd[1]) ||
+               (abs(n3) > n_bnd[2]) ) )
+        {
+          if (n_fail++ == 0)
+            fprintf(stderr, "bounds (%d %d %d): (%d %d %d) missed\n",
+                    n_bnd[0], n_bnd[1], n_bnd[2], n1, n2, n3);
+        }
+      }
+
+  printf("index bounds len = %5.1f: (%d %d %d) %s\n", len,
+         n_bnd[0], n_bnd[1], n_bnd[2], (n_fail) ? "FAILED" : "ok");
+  return (n_fail);
+}
+
+static int test_layer(const coord_t *b1, const coord_t *b2, const coord_t *b3,
+                      const coord_t *bas, char *bas_name, int n_bas, int n3,
+                      double image_len)
+{
+  atom_t *atoms = NULL;
+  size_t n_atoms, n_full = 0;
+  int n1, n2, i_bas;
+  double x, y, z;
+
+  n_atoms = lattice_layer_atoms(&atoms, b1, b2, b3, bas, bas_name, n_bas,
+                                n3, 0, image_len);
+
+  for (i_bas = 0; i_bas < n_bas; i_bas++)
+    for (n1 = -N_FULL; n1 <= N_FULL; n1++)
+      for (n2 = -N_FULL; n2 <= N_FULL; n2++)
+      {
+        x = n1*b1->x + n2*b2->x + n3*b3->x + bas[i_bas].x;
+        y = n1*b1->y + n2*b2->y + n3*b3->y + bas[i_bas].y;
+        z = n1*b1->z + n2*b2->z + n3*b3->z + bas[i_bas].z;
+        if ( (x >= -TOLERANCE) && (x < image_len) &&
+             (y >= -TOLERANCE) && (y < image_len) && (z <= TOLERANCE) )
+          n_full++;
+      }
+
+  printf("layer n3 = %3d: %u atoms (full search: %u) %s\n", n3,
+         (unsigned int)n_atoms, (unsigned int)n_full,
+         (n_atoms == n_full) ? "ok" : "FAILED");
+  free(atoms);
+  return (n_atoms != n_full);
+}
+
+int main()
+{
+  int n3, n_fail = 0;
+
+  /* fcc primitive vectors, skewed monoclinic cell */
+  coord_t fcc[3] = { {0., 1.76, 1.76}, {1.76, 0., 1.76}, {1.76, 1.76, 0.} };
+  coord_t mon[3] = { {2.5, 0., 0.}, {0.7, 3.1, 0.}, {1.3, -0.4, 4.2} };
+
+  /* surface cell of a hexagonal layer with a two atom basis */
+  coord_t b1 = {2.49, 0., 0.};
+  coord_t b2 = {1.245, 2.1564, 0.};
+  coord_t b3 = {1.245, 0.7188, -2.033};
+  coord_t bas[2] = { {0., 0., 0.}, {1.245, 0.7188, -1.0} };
+  char bas_name[2 * NAMSZ] = "Ni";
+
+  ctr_stream = stdout;
+  inf_stream = stderr;
+
+  sprintf(bas_name + NAMSZ, "O");
+
+  n_fail += test_bounds(fcc, fcc + 1, fcc + 2, 10.);
+  n_fail += test_bounds(fcc, fcc + 1, fcc + 2, 25.);
+  n_fail += test_bounds(mon, mon + 1, mon + 2, 10.);
+  n_fail += test_bounds(mon, mon + 1, mon + 2, 30.);
+
+  for (n3 = 0; n3 < 12; n3 += 3)
+    n_fail += test_layer(&b1, &b2, &b3, bas, bas_name, 2, n3, 20.);
+
+  printf("%s\n", (n_fail) ? "FAILED" : "all tests passed");
+  return (n_fail) ? 1 : 0;
+}
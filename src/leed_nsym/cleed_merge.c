@@ -0,0 +1,328 @@
+/*********************************************************************
+AG/17.10.26
+  file contains functions:
+
+  main
+    Merge the output files (*.res) of energy shards of a LEED
+    calculation (cleed_nsym/cleed_sym --energy-shard, --energy-range)
+    into one output file.
+
+  Usage: cleed_merge [-o <res_file>] <shard_file> <shard_file> ...
+
+  The header of the first file is used; the "#en" line is replaced by
+  the number, range and step of the merged energies. The end of the
+  range is the largest end energy in the "#en" lines of all files (the
+  final energy of the input, if the last shard is present). All files must
+  have the same list of output beams ("#bn", "#bi"). The lines of
+  intensities are sorted by energy; energies contained in more than one
+  file (e.g. overlapping ranges) are written only once.
+
+Changes:
+AG/17.10.26 - Creation
+AG/17.10.26 - end energy of the "#en" line from the shard headers.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gh_stddef.h"
+#include "real.h"
+
+#define ERROR
+#define WARNING
+
+/* energies are written with two decimals (eV) */
+#define MERGE_E_TOLERANCE 0.005
+
+typedef struct merge_line
+{
+  real energy;
+  char *text;
+} merge_line_t;
+
+/*======================================================================*/
+
+static char *merge_read(const char *file_name)
+
+/*********************************************************************
+  Read a file into a string (terminated by '\0').
+  Returns NULL if failed.
+*********************************************************************/
+{
+long n_size;
+char *buf;
+FILE *stream;
+
+ if((stream = fopen(file_name, "r")) == NULL) return(NULL);
+
+ fseek(stream, 0L, SEEK_END);
+ n_size = ftell(stream);
+ rewind(stream);
+
+ buf = (char *)malloc(n_size + 1);
+ if(buf != NULL)
+ {
+   n_size = (long)fread(buf, 1, n_size, stream);
+   buf[n_size] = '\0';
+ }
+ fclose(stream);
+
+ return(buf);
+} /* end of function merge_read */
+
+/*======================================================================*/
+
+static int merge_cmp(const void *a, const void *b)
+
+/*********************************************************************
+  Compare the energies of two lines (qsort).
+*********************************************************************/
+{
+ if( ((const merge_line_t *)a)->energy < ((const merge_line_t *)b)->energy )
+   return(-1);
+ if( ((const merge_line_t *)a)->energy > ((const merge_line_t *)b)->energy )
+   return(1);
+ return(0);
+} /* end of function merge_cmp */
+
+/*======================================================================*/
+
+int main(int argc, char *argv[])
+
+/*********************************************************************
+ Merge the output files of energy shards.
+*********************************************************************/
+{
+int i_arg, i_file, n_files;
+int i_line, n_lines, n_max, n_eng;
+int i_beam, n_beams;
+
+real e_stp, e_fin;
+double e_aux[3];
+
+char *line;
+char **buf;
+char **file_names;
+char **beams_first;
+
+merge_line_t *lines;
+
+FILE *res_stream;
+
+ res_stream = stdout;
+ file_names = (char **)malloc(argc * sizeof(char *));
+ buf = (char **)calloc(argc, sizeof(char *));
+ n_files = 0;
+
+/*********************************************************************
+  Decode arguments
+*********************************************************************/
+
+ for (i_arg = 1; i_arg < argc; i_arg++)
+ {
+   if( (strcmp(argv[i_arg], "-o") == 0) && (i_arg + 1 < argc) )
+   {
+     i_arg++;
+     if ((res_stream = fopen(argv[i_arg], "w")) == NULL)
+     {
+#ifdef ERROR
+       fprintf(STDERR,
+       "*** error (cleed_merge): could not open output file \"%s\"\n",
+       argv[i_arg]);
+#endif
+       exit(1);
+     }
+   }
+   else if(*argv[i_arg] == '-')
+   {
+#ifdef ERROR
+     fprintf(STDERR, "*** error (cleed_merge):\tsyntax error:\n");
+     fprintf(STDERR, "\tusage: \tcleed_merge [-o <res_file>] "
+                     "<shard_file> <shard_file> ...\n");
+#endif
+     exit(1);
+   }
+   else
+     file_names[n_files ++] = argv[i_arg];
+ }
+
+ if(n_files < 1)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (cleed_merge): no input files\n");
+#endif
+   exit(1);
+ }
+
+/*********************************************************************
+  Read all files
+*********************************************************************/
+
+ n_max = 0;
+ for(i_file = 0; i_file < n_files; i_file ++)
+ {
+   if((buf[i_file] = merge_read(file_names[i_file])) == NULL)
+   {
+#ifdef ERROR
+     fprintf(STDERR, "*** error (cleed_merge): could not read file \"%s\"\n",
+             file_names[i_file]);
+#endif
+     exit(1);
+   }
+   for(line = buf[i_file]; *line != '\0'; line ++)
+     if(*line == '\n') n_max ++;
+   n_max ++;
+ }
+
+ lines = (merge_line_t *)malloc(n_max * sizeof(merge_line_t));
+ beams_first = (char **)malloc(n_max * sizeof(char *));
+ if( (lines == NULL) || (beams_first == NULL) )
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (cleed_merge): allocation error\n");
+#endif
+   exit(1);
+ }
+
+/*********************************************************************
+  Split into lines:
+  - header of the first file is kept ("#bn" and "#bi" lines in 
+    beams_first for comparison).
+  - the "#bn"/"#bi" lines of all other files must be the same.
+  - lines of intensities of all files are collected in lines.
+  An incomplete last line (interrupted run) is ignored.
+*********************************************************************/
+
+ n_lines = 0;
+ n_beams = 0;
+ e_stp = -1.;
+ e_fin = -1.;
+ for(i_file = 0; i_file < n_files; i_file ++)
+ {
+   i_beam = 0;
+   for(line = buf[i_file]; *line != '\0'; )
+   {
+     char *next;
+
+     next = strchr(line, '\n');
+     if(next == NULL) break;
+     *next = '\0';
+
+     if( (strncmp(line, "#bn", 3) == 0) || (strncmp(line, "#bi", 3) == 0) )
+     {
+       if(i_file == 0)
+         beams_first[n_beams ++] = line;
+       else if( (i_beam >= n_beams) || 
+                (strcmp(line, beams_first[i_beam]) != 0) )
+       {
+#ifdef ERROR
+         fprintf(STDERR, "*** error (cleed_merge): beam list of \"%s\" "
+                 "differs from \"%s\"\n", file_names[i_file], file_names[0]);
+#endif
+         exit(1);
+       }
+       i_beam ++;
+     }
+     else if( (strncmp(line, "#en", 3) == 0) &&
+              (sscanf(line + 3, "%*d %lf %lf %lf", 
+                      e_aux, e_aux+1, e_aux+2) == 3) )
+     {
+       /* "#en <n_eng> <e_ini> <e_fin> <e_stp>": 
+          e_stp of the first file, largest e_fin */
+       if(i_file == 0) e_stp = (real)e_aux[2];
+       e_fin = MAX(e_fin, (real)e_aux[1]);
+     }
+     else if( (*line != '#') && (*line != '\0') )
+     {
+       lines[n_lines].energy = (real)atof(line);
+       lines[n_lines].text = line;
+       n_lines ++;
+     }
+
+     line = next + 1;
+   }
+
+   if( (n_beams == 0) || ( (i_file > 0) && (i_beam != n_beams) ) )
+   {
+#ifdef ERROR
+     fprintf(STDERR, "*** error (cleed_merge): no or different beam list "
+             "in \"%s\"\n", file_names[i_file]);
+#endif
+     exit(1);
+   }
+ }
+
+/*********************************************************************
+  Sort by energy and remove multiple energies
+*********************************************************************/
+
+ qsort(lines, n_lines, sizeof(merge_line_t), merge_cmp);
+
+ for(i_line = 1, n_eng = (n_lines > 0); i_line < n_lines; i_line ++)
+ {
+   if(lines[i_line].energy - lines[n_eng - 1].energy > MERGE_E_TOLERANCE)
+     lines[n_eng ++] = lines[i_line];
+ }
+
+ if(n_eng < 1)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (cleed_merge): no intensities found\n");
+#endif
+   exit(1);
+ }
+
+ if(e_stp <= 0.)
+ {
+   for(i_line = 1, e_stp = 0.; i_line < n_eng; i_line ++)
+     if( (e_stp <= 0.) || 
+         (lines[i_line].energy - lines[i_line-1].energy < e_stp) )
+       e_stp = lines[i_line].energy - lines[i_line-1].energy;
+ }
+
+#ifdef WARNING
+ for(i_line = 1; i_line < n_eng; i_line ++)
+ {
+   if(lines[i_line].energy - lines[i_line-1].energy > 
+      1.5 * e_stp + MERGE_E_TOLERANCE)
+     fprintf(STDWAR, "* warning (cleed_merge): missing energies between "
+             "%.2f and %.2f eV\n", lines[i_line-1].energy, lines[i_line].energy);
+ }
+#endif
+
+/*********************************************************************
+  Write the header of the first file with new "#en" line and all 
+  intensities.
+*********************************************************************/
+
+ e_fin = MAX(e_fin, lines[n_eng-1].energy);
+
+ for(line = buf[0]; *line == '#'; line += strlen(line) + 1)
+ {
+   if(strncmp(line, "#en", 3) == 0)
+     fprintf(res_stream, "#en %d %f %f %f\n", n_eng, 
+             lines[0].energy, e_fin, e_stp);
+   else
+     fprintf(res_stream, "%s\n", line);
+ }
+
+ for(i_line = 0; i_line < n_eng; i_line ++)
+   fprintf(res_stream, "%s\n", lines[i_line].text);
+
+ if(res_stream != stdout) fclose(res_stream);
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(cleed_merge): %d energies from %d files\n", 
+         n_eng, n_files);
+#endif
+
+ for(i_file = 0; i_file < n_files; i_file ++) free(buf[i_file]);
+ free(buf);
+ free(file_names);
+ free(beams_first);
+ free(lines);
+
+ return(0);
+} /* end of main */
@@ -13,6 +13,42 @@ LD/27.03.14 - added OMP parallel for loop for energy and inverted
               (use '-D_USE_OPENMP' & '-fopenmp' flags when compiling)
 LD/02.04.14 - added '--help', '-h' & '-V' options for usage and info,
               respectively (added functions usage() & info() )
+AG/17.10.26 - bulk: beam sets are computed concurrently (OpenMP) with
+              thread-local layer matrices; the reflection matrix of each
+              set is written into R_bulk at pre-computed offsets.
+              The energy loop runs up to eng->fin (it ran for no energy)
+              and is serial (the OpenMP loop over the energies used a
+              zero step and shared all matrices between the threads).
+AG/17.10.26 - R_bulk is stored block diagonal (one block per beam set).
+AG/17.10.26 - the calculation for a single energy is done in 
+              leed_calc_amp_nd (lcalcnd.c).
+AG/17.10.26 - memory budget option (-m).
+AG/17.10.26 - C.G. coupling tensors (leed_ms_gaunt) are set up before
+              the energy loop.
+AG/17.10.26 - domain averaging ('do' input): bulk once per energy, 
+              domain averaged intensities (leed_calc_int_dom_nd).
+AG/17.10.26 - adaptive energy grid (-a <tol>, leed_calc_iv_adapt_nd).
+AG/17.10.26 - restart from an interrupted output file (--restart) and 
+              energy sub-ranges/shards (--energy-range, --energy-shard).
+              The output file is opened after the input has been read.
+AG/17.10.26 - dynamic beam pruning (-p <eps>, leed_beam_prune_mode).
+AG/17.10.26 - output only the beams of an R factor control file 
+              (-c <ctr_file>, leed_output_beam_select).
+AG/17.10.26 - worker processes for the energies (-j <n_proc>, 
+              leed_calc_int_farm_nd).
+AG/17.10.26 - energy loop: list of energies calculated in blocks of one
+              energy per thread by leed_calc_int_list_nd.
+AG/17.10.26 - --energy-range checked by leed_chk_range (invalid or empty
+              range is an error).
+AG/17.10.26 - beam pruning context (leed_beam_prune_alloc) on the full
+              energy grid, passed to the energy loops; blocks of
+              PRUNE_N_VAL energies per thread.
+AG/17.10.26 - adaptive energy grid starts at es*2^ADAPT_N_REF and is
+              refined towards es (subset of the input grid).
+AG/17.10.26 - usage: -m does not spill matrices in cleed_nsym.
+AG/17.10.26 - --energy-range/--energy-shard without value is an error.
+AG/17.10.26 - abort if the beam sets are not contiguous 
+              (leed_beam_set_offsets).
 
 *********************************************************************/
 
@@ -43,6 +79,9 @@ LD/02.04.14 - added '--help', '-h' & '-V' options for usage and info,
 #define CTR_NORMAL       998
 #define CTR_EARLY_RETURN 999
 
+#define ADAPT_N_REF        3     /* refinement levels: coarse step = es*2^3 */
+#define PRUNE_N_VAL        8     /* beam pruning: validate every 8 energies */
+
 /*======================================================================*/
 
 int main(int argc, char *argv[])
@@ -61,24 +100,35 @@ leed_cryst_t *over;
 leed_phs_t *phs_shifts;
 leed_beam_t *beams_all;
 leed_beam_t *beams_out;
-leed_beam_t *beams_now;
-leed_beam_t *beams_set;
 leed_var_t *v_par;
 leed_energy_t *eng;
 
-mat Tpp,   Tmm,   Rpm,   Rmp;
-mat Tpp_s, Tmm_s, Rpm_s, Rmp_s;
-mat R_bulk, R_tot;
-mat Amp;
 
 int ctr_flag;
-int i_c, i_arg;
-int n_beams_now, n_beams_set;
-int i_set, n_set, offset;
-int i_layer;
+int i_arg;
+int n_set;
+int n_out;
+int n_eng, i_eng;
+int n_done, restart;
+int i_shard, n_shard;
+int n_sel;
+int n_proc, n_list;
+int n_blk, i_blk;
+int *set_off;
 
 real energy;
-real vec[4];
+real mem_budget;
+real adapt_tol;
+real prune_eps;
+real *int_blk;
+real *int_adapt, *eng_adapt;
+real *eng_done;
+real *ind_sel;
+real *eng_list;
+real e_lo, e_hi;
+
+leed_mem_t mem;
+leed_prune_t *prune;
 
 char linebuffer[STRSZ];
 
@@ -86,21 +136,22 @@ char bul_file[STRSZ];                 /* input/output files */
 char par_file[STRSZ];
 char pro_name[STRSZ];
 char res_file[STRSZ];
+char ctr_file[STRSZ];
 
 FILE *res_stream;
 
-  Tpp   =  Tmm   =  Rpm   =  Rmp   = NULL;
-  Tpp_s =  Tmm_s =  Rpm_s =  Rmp_s = NULL;
-  R_bulk = R_tot = NULL;
-  Amp = NULL;
+  int_blk = NULL;
+  int_adapt = eng_adapt = NULL;
+  eng_done = NULL;
+  ind_sel = NULL;
+  eng_list = NULL;
 
   res_stream = NULL;
   bulk = over = NULL;
   phs_shifts  = NULL;
   beams_all   = NULL;
-  beams_now   = NULL;
-  beams_set   = NULL;
   beams_out   = NULL;
+  set_off     = NULL;
   v_par = NULL;
   eng   = NULL;
 
@@ -110,12 +161,21 @@ FILE *res_stream;
 *********************************************************************/
 
   ctr_flag = CTR_NORMAL;
+  mem_budget = 0.;
+  adapt_tol = 0.;
+  prune_eps = 0.;
+  n_proc = 0;
+  restart = 0;
+  n_done = -1;
+  i_shard = n_shard = 0;
+  e_lo = e_hi = 0.;
 
   strncpy(bul_file,"---", STRSZ);
 
   strncpy(par_file,"---", STRSZ);
   strncpy(res_file,"leed.res", STRSZ);
   strncpy(pro_name,"leed.pro", STRSZ);
+  strncpy(ctr_file,"---", STRSZ);
 
 /*********************************************************************
   Decode arguments:
@@ -125,6 +185,31 @@ FILE *res_stream;
     -i <par_file> - (mandatory input file) overlayer parameters of all 
                     parameters (if bul_file does not exist).
     -o <res_file> - (output file) IV output.
+    -c <ctr_file> - (optional) R factor control file: only the beams 
+                    used in ctr_file ("ti=") are written to res_file.
+    -m <budget>   - (optional) memory budget in MB: in-place matrix
+                    inversion and fewer threads. No matrices are kept
+                    between energies, i.e. nothing is spilled to
+                    scratch files (only csearch -l -m spills).
+    -a <tol>      - (optional) adaptive energy grid: start with the 
+                    step es*2^ADAPT_N_REF and refine towards es where 
+                    the interpolation error exceeds tol (relative to the
+                    max. intensity of each beam).
+    -p <eps>      - (optional) beam pruning: evanescent beams whose 
+                    amplitudes in the reflection matrices are below eps
+                    (relative) are removed; re-validated at every 
+                    PRUNE_N_VAL-th energy of the grid.
+    -j <n_proc>   - (optional) calculate the energies in n_proc worker
+                    processes (forked after the input has been read).
+    --restart     - (optional) continue an interrupted calculation: 
+                    energies already in res_file are not calculated 
+                    again, output is appended.
+    --energy-range <e1>:<e2> 
+                  - (optional) calculate only energies e1 <= E <= e2 
+                    (eV) of the energy grid.
+    --energy-shard <i>/<N>
+                  - (optional) calculate only the i-th of N blocks of
+                    energies (merge the output files with cleed_merge).
 *********************************************************************/
 
   for (i_arg = 1; i_arg < argc; i_arg++)
@@ -134,7 +219,10 @@ FILE *res_stream;
 #ifdef ERROR
       fprintf(STDERR,"*** error (CLEED_NSYM):\tsyntax error:\n");
       fprintf(STDERR,"\tusage: \tcleed -i <par_file> -o <res_file>");
-      fprintf(STDERR," [-b <bul_file> -e]\n");
+      fprintf(STDERR," [-b <bul_file> -c <ctr_file> -m <budget> -a <tol>"
+                     " -p <eps> -j <n_proc> -e]\n");
+      fprintf(STDERR,"\t\t[--restart --energy-range <e1>:<e2>"
+                     " --energy-shard <i>/<N>]\n");
 #endif
       exit(1);
     }
@@ -176,16 +264,97 @@ FILE *res_stream;
       {
         i_arg++;
         strncpy(res_file, argv[i_arg], STRSZ);
-        if ((res_stream = fopen(res_file,"w")) == NULL)
+      }  /* -o */
+
+/* Read R factor control file (output beams) */
+      if(strncmp(argv[i_arg], "-c", 2) == 0)
+      {
+        i_arg++;
+        strncpy(ctr_file, argv[i_arg], STRSZ);
+      }  /* -c */
+
+/* Read memory budget (MB) */
+      if(strncmp(argv[i_arg], "-m", 2) == 0)
+      {
+        i_arg++;
+        mem_budget = (real)atof(argv[i_arg]) * 1048576.;
+      } /* -m */
+
+/* Read tolerance of the adaptive energy grid */
+      if(strncmp(argv[i_arg], "-a", 2) == 0)
+      {
+        i_arg++;
+        adapt_tol = (real)atof(argv[i_arg]);
+      } /* -a */
+
+/* Read threshold of the beam pruning */
+      if(strncmp(argv[i_arg], "-p", 2) == 0)
+      {
+        i_arg++;
+        prune_eps = (real)atof(argv[i_arg]);
+      } /* -p */
+
+/* Number of worker processes */
+      if(strncmp(argv[i_arg], "-j", 2) == 0)
+      {
+        i_arg++;
+        n_proc = atoi(argv[i_arg]);
+      } /* -j */
+
+/* Restart from existing output file */
+      if(strcmp(argv[i_arg], "--restart") == 0)
+      {
+        restart = 1;
+      } /* --restart */
+
+/* Energy sub-range (eV) */
+      if(strcmp(argv[i_arg], "--energy-range") == 0)
+      {
+        if(i_arg + 1 >= argc)
         {
 #ifdef ERROR
           fprintf(STDERR,
-          "*** error (CLEED_NSYM): could not open output file \"%s\"\n",
-          res_file);
+          "*** error (CLEED_NSYM):\tsyntax error: "
+          "no value of --energy-range\n");
 #endif
           exit(1);
         }
-      }  /* -o */
+        i_arg++;
+        if(leed_chk_range(argv[i_arg], &e_lo, &e_hi) < 0)
+        {
+#ifdef ERROR
+          fprintf(STDERR,
+          "*** error (CLEED_NSYM): invalid energy range \"%s\"\n",
+          argv[i_arg]);
+#endif
+          exit(1);
+        }
+      } /* --energy-range */
+
+/* Energy shard */
+      if(strcmp(argv[i_arg], "--energy-shard") == 0)
+      {
+        if(i_arg + 1 >= argc)
+        {
+#ifdef ERROR
+          fprintf(STDERR,
+          "*** error (CLEED_NSYM):\tsyntax error: "
+          "no value of --energy-shard\n");
+#endif
+          exit(1);
+        }
+        i_arg++;
+        if( (sscanf(argv[i_arg], "%d/%d", &i_shard, &n_shard) != 2) ||
+            (i_shard < 1) || (i_shard > n_shard) )
+        {
+#ifdef ERROR
+          fprintf(STDERR,
+          "*** error (CLEED_NSYM): invalid energy shard \"%s\"\n",
+          argv[i_arg]);
+#endif
+          exit(1);
+        }
+      } /* --energy-shard */
 
 /* Read parameter input file */
       if(strncmp(argv[i_arg], "-e", 2) == 0)
@@ -225,16 +394,6 @@ FILE *res_stream;
             "* warning (CLEED_NSYM): no output file (option -o) specified\n");
     fprintf(STDWAR,"\toutput will be written to file \"%s\"\n", res_file);
 #endif
-
-    if ((res_stream = fopen(res_file,"w")) == NULL)
-    {
-#ifdef ERROR
-      fprintf(STDERR,
-      "*** error (CLEED_NSYM): could not open output file \"%s\"\n",
-      res_file);
-#endif
-     exit(1);
-    } 
   }
 
 /*********************************************************************
@@ -245,6 +404,17 @@ FILE *res_stream;
   leed_inp_leed_read_par(&v_par, &eng, bulk, bul_file);
   leed_read_overlayer_nd(&over, &phs_shifts, bulk, par_file);
   n_set = leed_beam_gen(&beams_all, bulk, v_par, eng->fin);
+
+/* the blocks of R_bulk require contiguous beam sets */
+  if(leed_beam_set_offsets(&set_off, beams_all, n_set) < 0)
+  {
+#ifdef ERROR
+    fprintf(STDERR, "*** error (CLEED_NSYM): the beam sets of the bulk "
+            "are not stored contiguously\n");
+#endif
+    exit(1);
+  }
+  free(set_off);
    
   leed_inp_show_beam_op(bulk, over, phs_shifts);
 
@@ -254,8 +424,64 @@ FILE *res_stream;
     exit(0);
   }
 
-  leed_out_head(res_stream);
-  leed_output_beam_list(&beams_out, beams_all, eng, res_stream);
+/*********************************************************************
+  Output beams (always for the full energy range, so that all shards 
+  have the same beams; with -c only the beams of the control file), 
+  energy range of this run, and output file.
+  With --restart, the output of an interrupted run is continued.
+*********************************************************************/
+
+  n_out = leed_output_beam_list(&beams_out, beams_all, eng, NULL);
+
+  if(strncmp(ctr_file, "---", 3) != 0)
+  {
+    if( (n_sel = leed_output_beam_ctr(&ind_sel, ctr_file)) < 1) exit(1);
+    n_out = leed_output_beam_select(beams_out, beams_all, ind_sel, n_sel);
+    free(ind_sel);
+  }
+
+/* validation energies of the beam pruning on the full energy grid */
+  prune = leed_beam_prune_alloc(prune_eps, PRUNE_N_VAL, eng);
+
+  if( (e_lo < e_hi) || (n_shard > 0) )
+  {
+    if(leed_chk_shard(eng, e_lo, e_hi, i_shard, n_shard) < 1) exit(1);
+  }
+
+  if(restart)
+  {
+    if(adapt_tol > 0.)
+    {
+#ifdef WARNING
+      fprintf(STDWAR, "* warning (CLEED_NSYM): --restart is ignored for "
+              "the adaptive energy grid (-a)\n");
+#endif
+    }
+    else
+    {
+      n_done = leed_chk_read(res_file, n_out, &eng_done);
+      if(n_done < -1) exit(1);
+    }
+  }
+
+  if ((res_stream = fopen(res_file, (n_done < 0)? "w": "a")) == NULL)
+  {
+#ifdef ERROR
+    fprintf(STDERR,
+    "*** error (CLEED_NSYM): could not open output file \"%s\"\n",
+    res_file);
+#endif
+    exit(1);
+  }
+
+  if(n_done < 0)
+  {
+    leed_out_head(res_stream);
+    if(adapt_tol <= 0.)   /* else: energies known after the calculation */
+      leed_output_beam_head(res_stream, beams_out, n_out, 
+                            leed_calc_n_eng(eng), eng->ini, eng->fin, 
+                            eng->stp);
+  }
 
 /*********************************************************************
  Prepare some often used parameters.
@@ -263,6 +489,9 @@ FILE *res_stream;
 
   mk_cg_coef (2*v_par->l_max);
   mk_ylm_coef(2*v_par->l_max);
+  leed_ms_gaunt(LEED_GAUNT_II, v_par->l_max);
+  leed_ms_gaunt(LEED_GAUNT_IJ, v_par->l_max);
+  leed_farm_mode(n_proc);
 
 #ifdef CONTROL
   fprintf(STDCTR, "(CLEED_NSYM): E_ini = %.1f, E_fin = %.1f, E_stp %.1f\n", 
@@ -272,321 +501,153 @@ FILE *res_stream;
 #endif
 
 /*********************************************************************
- Energy Loop
+ Memory budget (option -m): estimate the memory needed and choose 
+ memory saving settings before entering the energy loop. The energies
+ are calculated concurrently and no matrices are kept between them
+ (n_eng = 0), i.e. there is nothing to spill; the number of threads 
+ is the number of energies calculated at the same time.
 *********************************************************************/
 
-#ifdef _USE_OPENMP
-  
-  /* OpenMP control loops can only iterate using integers, so energy 
-     variables need to be converted using a multiplication factor */
-  #define IFAC 1e6
-  unsigned long int ienergy, istep, istop;
-  istep = (unsigned long int) eng->stp * IFAC;
-  istop = (unsigned long int) (eng->ini - E_TOLERANCE) * IFAC;
-  
-  #pragma omp parallel for 
-  for( ienergy = eng->fin*IFAC; ienergy > istop; 
-       ienergy -= istep) /* energy loop inverted to try to sync finish */
+  if(mem_budget > 0.)
   {
-    energy = (real) ienergy/IFAC; /* convert back integer representation of energy */
-#else
-  for( energy = eng->ini; energy > eng->fin + E_TOLERANCE; energy += eng->stp)
-  {
-#endif
+    leed_mem_estimate_nd(&mem, beams_all, n_set, bulk, over, v_par, 0);
+    leed_mem_plan_nd(&mem, mem_budget);
 
-    leed_par_update_nd(v_par, phs_shifts, energy);
-    n_beams_now = leed_beam_get_selection(&beams_now, beams_all, v_par, bulk->dmin);
+    if(mem.inv_inplace) matinvmode(MAT_INV_INPLACE);
+#ifdef _USE_OPENMP
+    omp_set_num_threads(mem.n_threads);
+#endif
 
 #ifdef CONTROL
-    fprintf(STDCTR, "(CLEED_NSYM):\n\t => E = %.1f eV (%d beams used) <=\n\n",
-              v_par->eng_v*HART, n_beams_now);
+    fprintf(STDCTR, "(CLEED_NSYM): memory estimate %.1f MB (budget %.1f MB)\n",
+            mem.peak / 1048576., mem_budget / 1048576.);
+    fprintf(STDCTR, "\t%d beams (max. %d per set), combined space %d\n",
+            mem.n_beams, mem.n_max_set, mem.n_comp);
+    fprintf(STDCTR, "\tin-place inversion: %d, threads: %d\n",
+            mem.inv_inplace, mem.n_threads);
 #endif
-  
+  }
 
 /*********************************************************************
-  BULK:
-  Loop over beam sets
-
-  Create matrix R_bulk that will eventually contain the bulk 
-  reflection matrix 
+ Adaptive energy grid (option -a): all energies are calculated first,
+ then header and intensities are written.
 *********************************************************************/
 
-    R_bulk = matalloc(R_bulk, n_beams_now, n_beams_now, NUM_COMPLEX);
-    for(offset = 1, i_set = 0; i_set < n_set; i_set ++)
+  if(adapt_tol > 0.)
+  {
+    n_eng = leed_calc_iv_adapt_nd(&int_adapt, &eng_adapt, beams_all, n_set,
+                                  beams_out, bulk, over, phs_shifts, v_par,
+                                  eng, adapt_tol, ADAPT_N_REF, prune);
+    if(n_eng < 1)
     {
-      n_beams_set = leed_beam_set(&beams_set, beams_now, i_set);
-
-/*********************************************************************
-    Loop over periodic bulk layers
-*********************************************************************/
-
-    /**********************************************************
-     Compute scattering matrices for bottom-most bulk layer:
-     - single Bravais layer or composite layer
-    **********************************************************/
-
-#ifdef CONTROL_FLOW
-      fprintf(STDCTR, "(CLEED_NSYM periodic): bulk layer %d/%d, set %d/%d\n", 
-                        0, bulk->nlayers - 1, i_set, n_set - 1);
-#endif
-        
-      if( (bulk->layers + 0)->natoms == 1)
-      {
-        leed_ms_nd( &Tpp, &Tmm, &Rpm, &Rmp,
-                     v_par, (bulk->layers + 0), beams_set);
-      }
-      else
-      {
-        leed_ms_compl_nd( &Tpp, &Tmm, &Rpm, &Rmp,
-                     v_par, (bulk->layers + 0), beams_set);
-      }
-
-#ifdef CONTROL_X
-      fprintf(STDCTR, "(CLEED_NSYM): after leed_ms_nd: Tpp:");
-      matshow(Tpp);
-      fprintf(STDCTR, "(CLEED_NSYM): after leed_ms_nd: Tmm:");
-      matshow(Tmm);
-      fprintf(STDCTR, "(CLEED_NSYM): after leed_ms_nd: Rpm:");
-      matshow(Rpm);
-      fprintf(STDCTR, "(CLEED_NSYM): after leed_ms_nd: Rmp:");
-      matshow(Rmp);
-#endif
-       
-    /**********************************************************
-      Loop over the other bulk layers 
-    **********************************************************/
-
-      for(i_layer = 1; 
-          ( (bulk->layers+i_layer)->periodic == 1) && 
-          (i_layer < bulk->nlayers); 
-          i_layer ++)
-      {
-#ifdef CONTROL_FLOW
-        fprintf(STDCTR, "(CLEED_NSYM periodic): bulk layer %d/%d, set %d/%d\n", 
-                        i_layer, bulk->nlayers - 1, i_set, n_set - 1);
-#endif
-
-    /************************************************************** 
-      Compute scattering matrices R/T_s for a single bulk layer 
-       - single Bravais layer or composite layer
-    ***************************************************************/
-
-        if( (bulk->layers + i_layer)->natoms == 1)
-        {
-          leed_ms_nd ( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                        v_par, (bulk->layers + i_layer), beams_set);
-        }
-        else
-        {
-          leed_ms_compl_nd( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                       v_par, (bulk->layers + i_layer), beams_set);
-        }
-
-    /*************************************************************************** 
-       Add the single layer matrices to the rest by layer doubling 
-       - inter layer vector is the vector between layers
-         (i_layer - 1) and (i_layer): 
-         (bulk->layers + i_layer)->vec_from_last
-    ****************************************************************************/ 
-#ifdef CONTROL_FLOW
-        fprintf(STDCTR, 
-                "(CLEED_NSYM): before leed_ld_2lay vec_from...(%.2f %.2f %.2f)\n",
-                       (bulk->layers + i_layer)->vec_from_last[1] * BOHR,
-                       (bulk->layers + i_layer)->vec_from_last[2] * BOHR,
-                       (bulk->layers + i_layer)->vec_from_last[3] * BOHR); 
+#ifdef ERROR
+      fprintf(STDERR, "*** error (CLEED_NSYM): adaptive energy grid failed\n");
 #endif
+      exit(1);
+    }
 
-        leed_ld_2lay( &Tpp,  &Tmm,  &Rpm,  &Rmp,
-                 Tpp,   Tmm,   Rpm,   Rmp,
-                 Tpp_s, Tmm_s, Rpm_s, Rmp_s,
-                 beams_set, (bulk->layers + i_layer)->vec_from_last);
-
-      } /* for i_layer (bulk) */
-
-   /********************************************************************* 
-      Layer doubling for all periodic bulk layers until convergence is 
-      reached:
-       - inter layer vector is (bulk->layers + 0)->vec_from_last
-   **********************************************************************/
-#ifdef CONTROL_FLOW
-      fprintf(STDCTR, "(CLEED_NSYM): before leed_ld_2n vec_from...(%.2f %.2f %.2f)\n",
-                      (bulk->layers + 0)->vec_from_last[1] * BOHR,
-                      (bulk->layers + 0)->vec_from_last[2] * BOHR,
-                      (bulk->layers + 0)->vec_from_last[3] * BOHR);
+#ifdef CONTROL
+    fprintf(STDCTR, "(CLEED_NSYM): adaptive energy grid: %d energies\n", 
+            n_eng);
 #endif
 
-      Rpm = leed_ld_2n( Rpm, Tpp, Tmm, Rpm, Rmp, 
-                   beams_set, (bulk->layers + 0)->vec_from_last);
+    leed_output_beam_head(res_stream, beams_out, n_out, n_eng, 
+                          eng_adapt[0], eng_adapt[n_eng - 1], eng->stp);
+    for(i_eng = 0; i_eng < n_eng; i_eng ++)
+    {
+      v_par->eng_v = eng_adapt[i_eng];
+      leed_output_int_list(int_adapt + i_eng*n_out, n_out, v_par, res_stream);
+    }
 
-   /*******************************************************************
-     Compute scattering matrices for top-most bulk layer if it is
-     not periodic.
-      - single Bravais layer or composite layer
-   **********************************************************************/
+    free(int_adapt);
+    free(eng_adapt);
+  }
 
-      if( i_layer == bulk->nlayers - 1 )
-      {
-#ifdef CONTROL_FLOW
-        fprintf(STDCTR, 
-                "(CLEED_NSYM not periodic): bulk layer %d/%d, set %d/%d\n", 
-                i_layer, bulk->nlayers - 1, i_set, n_set - 1);
-#endif
-    
-        if( (bulk->layers + i_layer)->natoms == 1)
-        {
-          leed_ms_nd( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                    v_par, (bulk->layers + i_layer), beams_set);
-        }
-        else
-        {
-          leed_ms_compl_nd( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                       v_par, (bulk->layers + i_layer), beams_set);
-        }
-   
-    /**************************************************************************
-       Add the single layer matrices of the top-most layer to the rest 
-       by layer doubling:
-       - inter layer vector is the vector between layers
-         (i_layer - 1) and (i_layer): 
-         (bulk->layers + i_layer)->vec_from_last
-    ***************************************************************************/
-
-        Rpm = leed_ld_2lay_rpm(Rpm, Rpm, Tpp_s, Tmm_s, Rpm_s, Rmp_s,
-                          beams_set, (bulk->layers + i_layer)->vec_from_last);
-
-      }  /* if( i_layer == bulk->nlayers - 1 ) */
-
-   /*******************************************************
-     Insert reflection matrix for this beam set into R_bulk.
-   ********************************************************/
-
-      R_bulk = matins(R_bulk, Rpm, offset, offset);
-      offset += n_beams_set;
-
-   /*************************
-     Write cpu time to output
-   **************************/
-
-      sprintf(linebuffer,"(CLEED_NSYM): bulk layers set %d, E = %.1f", 
-              i_set, energy*HART);
-      leed_cpu_time(STDCPU,linebuffer);
-    }  /* for i_set */
-      
 /*********************************************************************
-  OVERLAYER
-  Loop over all overlayer layers
+ Energy loop: the energies which are not completed yet (--restart) are
+ calculated in blocks of one energy per thread (leed_calc_int_list_nd);
+ the lines of intensities of each block are written and flushed in the
+ order of energies, i.e. the output file is the checkpoint. With beam
+ pruning a block has PRUNE_N_VAL energies per thread, so that the
+ validation energies of a block are calculated concurrently.
+ Worker processes (option -j): the energies are distributed to the 
+ workers, the coordinator writes the lines as they are completed.
 *********************************************************************/
 
-    for(i_layer = 0; i_layer < over->nlayers; i_layer ++)
+  else
+  {
+    n_eng = leed_calc_n_eng(eng);
+    eng_list = (real *)malloc( (n_eng + 1) * sizeof(real) );
+    if(eng_list == NULL)
     {
-#ifdef CONTROL_FLOW
-      fprintf(STDCTR, "(CLEED_NSYM): overlayer %d/%d\n", i_layer, over->nlayers - 1);
-#endif
-   /***********************************************************
-     Calculate scattering matrices for a single overlayer layer
-      - only single Bravais layer 
-   ************************************************************/
-      
-      if( (over->layers + i_layer)->natoms == 1)
-      {
-        leed_ms_nd( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                     v_par, (over->layers + i_layer), beams_now);
-      }
-      else
-      {
-        leed_ms_compl_nd( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                     v_par, (over->layers + i_layer), beams_now);
-      }
-
-#ifdef CONTROL_X
- fprintf(STDCTR, "\n(CLEED_NSYM):overlayer %d  ...\n",i_layer);
- fprintf(STDCTR, "\n(CLEED_NSYM): Tpp:\n");
- matshowabs(Tpp_s);
- fprintf(STDCTR, "\n(CLEED_NSYM): Tmm:\n");
- matshowabs(Tmm_s);
- fprintf(STDCTR, "\n(CLEED_NSYM): Rpm:\n");
- matshowabs(Rpm_s);
- fprintf(STDCTR, "\n(CLEED_NSYM): Rmp:\n");
- matshowabs(Rmp_s);
+#ifdef ERROR
+      fprintf(STDERR, "*** error (CLEED_NSYM): allocation error\n");
 #endif
+      exit(1);
+    }
 
-  /****************************************************************
-     Add the single layer matrices to the rest by layer doubling:
-     - if the current layer is the bottom-most (i_layer == 0),
-       the inter layer vector is calculated from the vectors between
-       top-most bulk layer and origin 
-       ( (bulk->layers + nlayers)->vec_to_next )
-       and origin and bottom-most overlayer
-       (over->layers + 0)->vec_from_last.
-
-     - inter layer vector is the vector between layers
-       (i_layer - 1) and (i_layer): (over->layers + i_layer)->vec_from_last
-  **********************************************************************/
-
-      if (i_layer == 0)
-      {
-        for(i_c = 1; i_c <= 3; i_c ++)
-        {
-          vec[i_c] = (bulk->layers + bulk->nlayers - 1)->vec_to_next[i_c]
-                     + (over->layers + 0)->vec_from_last[i_c];
-        }
+    for(i_eng = 0, n_list = 0; i_eng < n_eng; i_eng ++)
+    {
+      energy = eng->ini + i_eng * eng->stp;
+      if( (n_done <= 0) || ! leed_chk_done(energy, eng_done, n_done) )
+        eng_list[n_list ++] = energy;
+    }
 
-#ifdef CONTROL_FLOW
-        fprintf(STDCTR, 
-                "(LEED):over0 before leed_ld_2lay_rpm vec..(%.2f %.2f %.2f)\n",
-                vec[1] * BOHR,vec[2] * BOHR, vec[3] * BOHR);
+    if(n_proc > 1)
+    {
+      if( (n_list > 0) &&
+          (leed_calc_int_farm_nd(NULL, eng_list, n_list, beams_all, n_set,
+                                 beams_out, bulk, over, phs_shifts, v_par,
+                                 prune, n_proc, res_stream) < 0) )
+        exit(1);
+    }
+    else
+    {
+#ifdef _USE_OPENMP
+      n_blk = omp_get_max_threads();
+#else
+      n_blk = 1;
 #endif
-
-        R_tot = leed_ld_2lay_rpm(R_tot, R_bulk, Tpp_s, Tmm_s, Rpm_s, Rmp_s,
-                            beams_now, vec);
-      }
-      else
+      if(prune != NULL) n_blk *= PRUNE_N_VAL;  /* one validation per thread */
+      int_blk = (real *)malloc( (n_blk * n_out + 1) * sizeof(real) );
+      if(int_blk == NULL)
       {
-#ifdef CONTROL_FLOW
-        fprintf(STDCTR, 
-                "(LEED):over%d  before leed_ld_2lay_rpm vec..(%.2f %.2f %.2f)\n",
-                i_layer,(over->layers + i_layer)->vec_from_last[1] * BOHR,
-                        (over->layers + i_layer)->vec_from_last[2] * BOHR,
-                        (over->layers + i_layer)->vec_from_last[3] * BOHR); 
+#ifdef ERROR
+        fprintf(STDERR, "*** error (CLEED_NSYM): allocation error\n");
 #endif
-
-        R_tot = leed_ld_2lay_rpm(R_tot, R_tot, Tpp_s, Tmm_s, Rpm_s, Rmp_s,
-                          beams_now, (over->layers + i_layer)->vec_from_last);
+        exit(1);
       }
 
-   /**************************
-     Write cpu time to output
-   **************************/
-
-      sprintf(linebuffer,"(LEED): overlayer %d, E = %.1f", 
-              i_layer, energy * HART);
-      leed_cpu_time(STDCPU,linebuffer);
-
-    }  /* for i_layer (overlayer) */
-
-/*********************************************
-   Add propagation towards the potential step.
-**********************************************/
-
-    vec[1] = vec[2] = 0.;
-    vec[3] = 1.25 / BOHR;
-
-/********************************************
-    No scattering at pot. step 
-********************************************/
+      for(i_eng = 0; i_eng < n_list; i_eng += n_blk)
+      {
+        n_eng = MIN(n_blk, n_list - i_eng);
+        if(leed_calc_int_list_nd(int_blk, eng_list + i_eng, n_eng, 
+                                 beams_all, n_set, beams_out, bulk, over,
+                                 phs_shifts, v_par, prune) < 0)
+          exit(1);
 
-    Amp = leed_ld_potstep0(Amp, R_tot, beams_now, v_par->eng_v, vec);
-    leed_output_int(Amp, beams_now, beams_out, v_par, res_stream);
+        for(i_blk = 0; i_blk < n_eng; i_blk ++)
+        {
+          v_par->eng_v = eng_list[i_eng + i_blk];
+          leed_output_int_list(int_blk + i_blk*n_out, n_out, v_par, 
+                               res_stream);
+        }
+        fflush(res_stream);     /* output file is the checkpoint */
 
 /********************************************
     Write cpu time to output 
 ********************************************/
 
-    sprintf(linebuffer,"  %.1f   %d  ",energy * HART,n_beams_now);
-    leed_cpu_time(STDWAR,linebuffer);
+        sprintf(linebuffer,"  %.1f   %d  ",
+                eng_list[i_eng + n_eng - 1] * HART, n_eng);
+        leed_cpu_time(STDWAR,linebuffer);
+      } /* end of energy loop */
 
+      free(int_blk);
+    }
 
-  } /* end of energy loop */
+    free(eng_list);
+  }  /* adapt_tol */
 
 
 #ifdef CONTROL_IO
@@ -594,6 +655,8 @@ FILE *res_stream;
 #endif
 
   fclose(res_stream);
+  free(eng_done);
+  leed_beam_prune_free(prune);
 
 #ifdef CONTROL
   fprintf(STDCTR, "\n\n(LEED):\tCORRECT TERMINATION");
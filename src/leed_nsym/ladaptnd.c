@@ -0,0 +1,353 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  leed_calc_iv_adapt_nd
+    Calculate the intensities of the output beams on an adaptive
+    (non-uniform) energy grid.
+
+  I(V) curves are smooth over most of the energy range; dense sampling
+  is only needed near peaks and where new beams emerge. Starting from
+  a coarse grid with step es*2^n_ref, intervals are bisected where the
+  estimated interpolation error of any beam exceeds a tolerance, until
+  the step es of the input (ei, ef, es) is reached. All new energies of
+  a refinement level are independent and calculated concurrently
+  (leed_calc_int_list_nd).
+
+  The output grid is a sorted subset of the input grid; the R factor
+  program interpolates it back onto the smallest step before the
+  Lorentzian smoothing (cr_lorentz).
+
+Changes:
+  AG/17.10.26 - Creation
+  AG/17.10.26 - beam pruning context passed to leed_calc_int_list_nd.
+  AG/17.10.26 - start from a coarse grid (es*2^n_ref) and refine towards
+                es instead of bisecting the input grid.
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "leed.h"
+
+#ifndef E_TOLERANCE           /* should be defined in "leed_def.h" */
+#define E_TOLERANCE 0.0001
+#endif
+
+/*======================================================================*/
+
+static real leed_adapt_quad(real *x, real *y, real x_m)
+
+/*********************************************************************
+  Value of the parabola through (x[0],y[0]), (x[1],y[1]), (x[2],y[2])
+  at x_m (Lagrange form).
+*********************************************************************/
+{
+ return( y[0] * (x_m - x[1])*(x_m - x[2]) / ((x[0] - x[1])*(x[0] - x[2])) +
+         y[1] * (x_m - x[0])*(x_m - x[2]) / ((x[1] - x[0])*(x[1] - x[2])) +
+         y[2] * (x_m - x[0])*(x_m - x[1]) / ((x[2] - x[0])*(x[2] - x[1])) );
+} /* end of function leed_adapt_quad */
+
+/*======================================================================*/
+
+static real leed_adapt_err(real *energies, real *int_buf, int n_eng,
+                           int n_out, real *int_max, int i_eng)
+
+/*********************************************************************
+  Estimate the interpolation error in the interval
+  (energies[i_eng], energies[i_eng+1]).
+
+ DESIGN:
+
+  For each beam, the parabolas through the points (i_eng-1, i_eng,
+  i_eng+1) and (i_eng, i_eng+1, i_eng+2) are evaluated at the centre of
+  the interval; their difference is an estimate of the error of a
+  (spline) interpolation. If only one of the parabolas exists (ends of
+  the energy range, or the beam emerges in the neighbouring interval),
+  it is compared with the linear interpolation (over-estimate).
+  The error is relative to the max. intensity of the beam.
+
+  If a beam emerges (or vanishes) within the interval (zero intensity
+  at one end only), the threshold is not resolved: the return value is
+  larger than any tolerance.
+
+ RETURN VALUE:
+
+  max. relative error of all beams.
+
+*********************************************************************/
+{
+int i_out, i_c;
+int left, right;
+
+real e_m, y_m, err, err_max;
+real x[3], y[3];
+real *int_0, *int_1;
+
+ e_m = 0.5 * (energies[i_eng] + energies[i_eng + 1]);
+ int_0 = int_buf + i_eng*n_out;
+ int_1 = int_0 + n_out;
+
+ err_max = 0.;
+ for(i_out = 0; i_out < n_out; i_out ++)
+ {
+   if(int_max[i_out] <= 0.) continue;
+
+   /* threshold: beam emerges or vanishes */
+   if( (int_0[i_out] > 0.) != (int_1[i_out] > 0.) ) return(2.);
+   if(int_0[i_out] <= 0.) continue;
+
+   left  = (i_eng > 0) && (int_0[i_out - n_out] > 0.);
+   right = (i_eng + 2 < n_eng) && (int_1[i_out + n_out] > 0.);
+
+   if(left)
+   {
+     for(i_c = 0; i_c < 3; i_c ++)
+     {
+       x[i_c] = energies[i_eng - 1 + i_c];
+       y[i_c] = int_0[i_out + (i_c - 1)*n_out];
+     }
+     y_m = leed_adapt_quad(x, y, e_m);
+   }
+   else
+     y_m = 0.5 * (int_0[i_out] + int_1[i_out]);
+
+   if(right)
+   {
+     for(i_c = 0; i_c < 3; i_c ++)
+     {
+       x[i_c] = energies[i_eng + i_c];
+       y[i_c] = int_0[i_out + i_c*n_out];
+     }
+     y_m -= leed_adapt_quad(x, y, e_m);
+   }
+   else if(left)
+     y_m -= 0.5 * (int_0[i_out] + int_1[i_out]);
+   else
+     y_m = 0.;
+
+   err = R_fabs(y_m) / int_max[i_out];
+   if(err > err_max) err_max = err;
+ }
+
+ return(err_max);
+} /* end of function leed_adapt_err */
+
+/*======================================================================*/
+
+int leed_calc_iv_adapt_nd(real **p_int_buf, real **p_energies,
+                    leed_beam_t *beams_all, int n_set, leed_beam_t *beams_out,
+                    leed_cryst_t *bulk, leed_cryst_t *over,
+                    leed_phs_t *phs_shifts, leed_var_t *v_par,
+                    leed_energy_t *eng, real tol, int n_ref,
+                    leed_prune_t *prune)
+
+/*********************************************************************
+  Calculate the intensities of the output beams on an adaptive energy
+  grid.
+
+ INPUT:
+
+  real **p_int_buf - (output) intensities: (*p_int_buf)[i_eng*n_out +
+         i_beam] is the intensity of beam i_beam of beams_out at energy
+         (*p_energies)[i_eng]. Allocated by the function.
+  real **p_energies - (output) energies in ascending order. Allocated by
+         the function.
+  leed_beam_t *beams_all, int n_set, leed_beam_t *beams_out,
+  leed_cryst_t *bulk, *over, leed_phs_t *phs_shifts,
+  leed_var_t *v_par - see leed_calc_int_list_nd.
+  leed_energy_t *eng - energy grid of the input (eng->stp > 0); it is
+         the finest grid of the refinement.
+  real tol - max. interpolation error relative to the max. intensity of
+         each beam (e.g. 0.01).
+  int n_ref - number of refinement levels; the coarse grid has the step
+         eng->stp * 2^n_ref.
+  leed_prune_t *prune - beam pruning context of the input grid (see
+         leed_calc_int_list_nd); NULL: no pruning.
+
+ DESIGN:
+
+  The energies are kept as indices i of the input grid
+  eng->ini + i*eng->stp (as in the normal energy loop), so that every
+  calculated energy is also an energy of the uniform grid.
+
+  1. Calculate the coarse grid i = 0, 2^n_ref, 2*2^n_ref, ... and the
+     last energy of the input grid.
+  2. For each interval longer than eng->stp, estimate the interpolation
+     error (leed_adapt_err). Bisect all intervals with error > tol;
+     calculate the new energies together.
+  3. Repeat 2. until no interval is bisected.
+
+ RETURN VALUE:
+
+  number of energies.
+  -1 if failed (and EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+int n_out, n_eng, n_new, n_fine, n_crs;
+int i_eng, i_new, i_out, i_lev;
+
+int *idx, *idx_new, *idx_aux, *iswap;
+real *energies, *int_buf, *int_max;
+real *e_new, *i_new_buf, *e_aux, *i_aux, *swap;
+
+ for(n_out = 0;
+     ! IS_EQUAL_REAL((beams_out + n_out)->k_par, F_END_OF_LIST); n_out ++)
+   ;
+ n_fine = leed_calc_n_eng(eng);
+ if(n_ref < 0) n_ref = 0;
+ n_crs = 1 << n_ref;
+
+/* at most all energies of the input grid are calculated */
+ energies  = (real *)malloc(n_fine * sizeof(real));
+ int_buf   = (real *)malloc(n_fine * n_out * sizeof(real));
+ e_new     = (real *)malloc(n_fine * sizeof(real));
+ i_new_buf = (real *)malloc(n_fine * n_out * sizeof(real));
+ e_aux     = (real *)malloc(n_fine * sizeof(real));
+ i_aux     = (real *)malloc(n_fine * n_out * sizeof(real));
+ int_max   = (real *)malloc((n_out + 1) * sizeof(real));
+ idx       = (int *)malloc(n_fine * sizeof(int));
+ idx_new   = (int *)malloc(n_fine * sizeof(int));
+ idx_aux   = (int *)malloc(n_fine * sizeof(int));
+
+ if( (n_fine < 1) ||
+     (energies == NULL) || (int_buf == NULL) || (e_new == NULL) ||
+     (i_new_buf == NULL) || (e_aux == NULL) || (i_aux == NULL) ||
+     (int_max == NULL) || (idx == NULL) || (idx_new == NULL) ||
+     (idx_aux == NULL) )
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_calc_iv_adapt_nd): allocation error\n");
+#endif
+   free(energies); free(int_buf); free(e_new); free(i_new_buf);
+   free(e_aux); free(i_aux); free(int_max);
+   free(idx); free(idx_new); free(idx_aux);
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+/*********************************************************************
+  Coarse grid
+*********************************************************************/
+
+ for(i_eng = 0, n_eng = 0; i_eng < n_fine; i_eng += n_crs, n_eng ++)
+   idx[n_eng] = i_eng;
+ if(idx[n_eng - 1] != n_fine - 1)
+ {
+   idx[n_eng] = n_fine - 1;
+   n_eng ++;
+ }
+ for(i_eng = 0; i_eng < n_eng; i_eng ++)
+   energies[i_eng] = eng->ini + idx[i_eng] * eng->stp;
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(leed_calc_iv_adapt_nd): coarse grid: %d energies "
+         "(step %.2f eV)\n", n_eng, n_crs * eng->stp * HART);
+#endif
+
+ if(leed_calc_int_list_nd(int_buf, energies, n_eng, beams_all, n_set,
+                   beams_out, bulk, over, phs_shifts, v_par, prune) < 0)
+   n_crs = -1;
+
+/*********************************************************************
+  Refinement
+*********************************************************************/
+
+ for(i_lev = 1; n_crs > 0; i_lev ++)
+ {
+   for(i_out = 0; i_out < n_out; i_out ++)
+   {
+     int_max[i_out] = 0.;
+     for(i_eng = 0; i_eng < n_eng; i_eng ++)
+       if(int_buf[i_eng*n_out + i_out] > int_max[i_out])
+         int_max[i_out] = int_buf[i_eng*n_out + i_out];
+   }
+
+   n_new = 0;
+   for(i_eng = 0; i_eng < n_eng - 1; i_eng ++)
+   {
+     if( (idx[i_eng + 1] - idx[i_eng] > 1) &&
+         (leed_adapt_err(energies, int_buf, n_eng, n_out, int_max, i_eng)
+          > tol) )
+     {
+       idx_new[n_new] = (idx[i_eng] + idx[i_eng + 1]) / 2;
+       e_new[n_new] = eng->ini + idx_new[n_new] * eng->stp;
+       n_new ++;
+     }
+   }
+
+#ifdef CONTROL
+   fprintf(STDCTR, "(leed_calc_iv_adapt_nd): level %d: %d energies, "
+           "%d new\n", i_lev, n_eng, n_new);
+#endif
+
+   if(n_new == 0) break;
+
+   if(leed_calc_int_list_nd(i_new_buf, e_new, n_new, beams_all, n_set,
+                     beams_out, bulk, over, phs_shifts, v_par, prune) < 0)
+   {
+     n_crs = -1;
+     break;
+   }
+
+   /* merge (both lists are sorted) */
+   for(i_eng = 0, i_new = 0, i_out = 0;
+       (i_eng < n_eng) || (i_new < n_new); i_out ++)
+   {
+     if( (i_new < n_new) &&
+         ( (i_eng == n_eng) || (idx_new[i_new] < idx[i_eng]) ) )
+     {
+       idx_aux[i_out] = idx_new[i_new];
+       e_aux[i_out] = e_new[i_new];
+       memcpy(i_aux + i_out*n_out, i_new_buf + i_new*n_out,
+              n_out * sizeof(real));
+       i_new ++;
+     }
+     else
+     {
+       idx_aux[i_out] = idx[i_eng];
+       e_aux[i_out] = energies[i_eng];
+       memcpy(i_aux + i_out*n_out, int_buf + i_eng*n_out,
+              n_out * sizeof(real));
+       i_eng ++;
+     }
+   }
+   n_eng = i_out;
+
+   iswap = idx;     idx = idx_aux;     idx_aux = iswap;
+   swap = energies; energies = e_aux; e_aux = swap;
+   swap = int_buf;  int_buf = i_aux;  i_aux = swap;
+ }  /* for i_lev */
+
+ free(e_new);
+ free(i_new_buf);
+ free(e_aux);
+ free(i_aux);
+ free(int_max);
+ free(idx);
+ free(idx_new);
+ free(idx_aux);
+
+ if(n_crs < 0)
+ {
+   free(energies);
+   free(int_buf);
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+ *p_energies = energies;
+ *p_int_buf = int_buf;
+
+ return(n_eng);
+} /* end of function leed_calc_iv_adapt_nd */
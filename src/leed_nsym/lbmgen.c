@@ -12,6 +12,7 @@ GH/01.03.95 - introduce g1, g2;
 GH/20.04.95 - include fractional order beams
 GH/02.09.97 - return value = number of beam sets
 WB/27.02.98 - change eng_max to eng_max - vr when calculating k_max
+AG/17.10.26 - sort beams with qsort; store end of beam set (set_end).
 
 *********************************************************************/
 
@@ -28,6 +29,32 @@ WB/27.02.98 - change eng_max to eng_max - vr when calculating k_max
 #define K_TOLERANCE 0.0001                        /* tolerance of k_par */
 #endif
 
+/*======================================================================*/
+
+static int leed_beam_cmp(const void *p1, const void *p2)
+
+/************************************************************************
+ Compare two beams for qsort: k_par first, then 1st and 2nd index.
+ Values of k_par within K_TOLERANCE are treated as equal.
+*************************************************************************/
+{
+const leed_beam_t *b1 = (const leed_beam_t *) p1;
+const leed_beam_t *b2 = (const leed_beam_t *) p2;
+
+ if( R_fabs(b1->k_par - b2->k_par) >= K_TOLERANCE )
+   return( (b1->k_par < b2->k_par)? -1: 1 );
+
+ if( ! IS_EQUAL_REAL(b1->ind_1, b2->ind_1) )
+   return( (b1->ind_1 < b2->ind_1)? -1: 1 );
+
+ if( ! IS_EQUAL_REAL(b1->ind_2, b2->ind_2) )
+   return( (b1->ind_2 < b2->ind_2)? -1: 1 );
+
+ return(0);
+}
+
+/*======================================================================*/
+
 int leed_beam_gen(leed_beam_t ** p_beams, leed_cryst_t *c_par, 
            leed_var_t *v_par, real eng_max)
 
@@ -85,7 +112,7 @@ real g1_x, g1_y, g2_x, g2_y;
 real k_x, k_y;
 real m11, m12, m21, m22;
 
-leed_beam_t *beams, beam_aux;
+leed_beam_t *beams;
 leed_beam_t *bm_off;
 
 /**********************************************************************
@@ -284,50 +311,30 @@ leed_beam_t *bm_off;
      } /* if inside k_max */
    } /* for n1/n2 */
   /*********************************************************
-    1st pass: Sort the beams according to the parallel component
-    (i.e. smallest k_par first)
+    Sort the beams of this set according to the parallel component
+    (i.e. smallest k_par first) and, for equal k_par, according to
+    the 1st and 2nd index (i.e. smallest indices first).
   *********************************************************/ 
+
 #ifdef CONTROL
  fprintf(STDCTR,"(leed_beam_gen): SORTING %2d beams in set %d:\n", 
                 i_beams - offset, i_set);
 #endif
-   for(n1 = offset; n1 < i_beams; n1 ++)
-   {
-     for(n2 = n1+1; n2 < i_beams; n2 ++)
-     {
-       if((beams + n2)->k_par < (beams + n1)->k_par )
-       {
-         memcpy( & beam_aux, beams + n2, sizeof(leed_beam_t) );
-         memcpy( beams + n2, beams + n1, sizeof(leed_beam_t) );
-         memcpy( beams + n1, & beam_aux, sizeof(leed_beam_t) );
-       }
-     } /* n2 */
-   }  /* n1 */
+
+   qsort(beams + offset, i_beams - offset, sizeof(leed_beam_t), 
+         leed_beam_cmp);
 
   /*********************************************************
-    2nd pass: Sort the beams according to the 1st and 2nd index
-    (i.e. smallest indices first)
+    Mark the end of the set in each beam. This allows
+    leed_beam_get_selection to skip the rest of a set once k_par 
+    exceeds the cutoff radius.
   *********************************************************/ 
+
    for(n1 = offset; n1 < i_beams; n1 ++)
    {
-     for(n2 = n1+1; 
-         fabs( (beams + n2)->k_par - (beams + n1)->k_par ) < K_TOLERANCE; 
-         n2++)
-     {
-       if((beams + n2)->ind_1 < (beams + n1)->ind_1 )
-       {
-         memcpy( & beam_aux, beams + n2, sizeof(leed_beam_t) );
-         memcpy( beams + n2, beams + n1, sizeof(leed_beam_t) );
-         memcpy( beams + n1, & beam_aux, sizeof(leed_beam_t) );
-       }
-       if( (IS_EQUAL_REAL((beams + n2)->ind_1, (beams + n1)->ind_1 )) &&
-           ((beams + n2)->ind_2 < (beams + n1)->ind_2 )  )
-       {
-         memcpy( & beam_aux, beams + n2, sizeof(leed_beam_t) );
-         memcpy( beams + n2, beams + n1, sizeof(leed_beam_t) );
-         memcpy( beams + n1, & beam_aux, sizeof(leed_beam_t) );
-       }
-     } /* n2 */
+     (beams + n1)->set_end = i_beams;
+     (beams + n1)->i_out = -1;
+
 #ifdef CONTROL
  fprintf(STDCTR,"%2d: (%6.2f, %6.2f):\t",
                 n1, (beams + n1)->ind_1, (beams + n1)->ind_2);
@@ -336,6 +343,7 @@ leed_beam_t *bm_off;
                 (beams + n1)->k_r[2], (beams + n1)->k_r[3]);
 #endif
    }  /* n1 */
+
  } /* for i_set */
 
 /*
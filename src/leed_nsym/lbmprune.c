@@ -0,0 +1,604 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  leed_beam_prune_alloc
+    Allocate the beam pruning context of an energy grid.
+  leed_beam_prune_free
+    Free the beam pruning context.
+  leed_beam_prune_int
+    Validation interval of an energy.
+  leed_beam_prune_plan
+    Order a list of energies: validation energies first.
+  leed_beam_prune
+    Remove the pruned beams from the beam list of the current energy.
+  leed_beam_prune_amp
+    Record the amplitudes of the beams in a reflection matrix.
+  leed_beam_prune_amp_bulk
+    Same for the block diagonal bulk reflection matrix.
+  leed_beam_prune_update
+    Determine the beams to be pruned from the recorded amplitudes.
+
+  leed_beam_get_selection includes all beams with k_par below a cutoff
+  which is derived from epsilon and dmin. In large cells many of the
+  evanescent beams within this radius have negligible amplitudes in
+  the reflection matrices, but they determine the matrix dimensions
+  (and the cost grows with the third power of the number of beams).
+
+  At a validation energy the full selection is used and the largest
+  relative amplitude of each beam in R_bulk and in the reflection
+  matrices of the overlayer stack (R_tot) is recorded, after the
+  propagation to the next layer (or to the potential step). Evanescent beams
+  below the threshold are removed from the selection at the other
+  energies of the same validation interval. Beams emerging at higher
+  energies are not in the list and therefore always included;
+  propagating beams and the first beam of each beam set are never
+  removed.
+
+  The validation energies are fixed points of the energy grid
+  (e_ini + i*n_val*e_stp, i.e. the energies with i_eng % n_val == 0)
+  and the pruned beams of each interval are kept in a context
+  (leed_prune_t) which is passed explicitly with the energies. The
+  beams used at an energy therefore depend only on the energy, not on
+  the order of the energies, the thread or the process which
+  calculates it: serial, OpenMP and worker processes give the same
+  intensities.
+
+Changes:
+  AG/17.10.26 - Creation
+  AG/17.10.26 - explicit context (leed_prune_t) instead of thread private
+                state; validation at fixed energies of the grid.
+  AG/17.10.26 - amplitudes propagated to the next layer (evanescent 
+                beams are largest at the reference plane of a layer and
+                were never pruned).
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "leed.h"
+
+#ifndef K_TOLERANCE
+#define K_TOLERANCE 0.0001                        /* tolerance of k_par */
+#endif
+
+#ifndef E_TOLERANCE           /* should be defined in "leed_def.h" */
+#define E_TOLERANCE 0.0001
+#endif
+
+/*======================================================================*/
+
+leed_prune_t *leed_beam_prune_alloc(real eps, int n_val, leed_energy_t *eng)
+
+/*********************************************************************
+  Allocate the beam pruning context of an energy grid.
+
+ INPUT:
+
+  real eps - threshold for the amplitude of a beam relative to the
+         largest element of the same reflection matrix (e.g. 1.e-4).
+         eps <= 0 switches off pruning.
+  int n_val - number of energies in a validation interval (including
+         the validation energy; n_val >= 1).
+  leed_energy_t *eng - energy grid. The validation energies are
+         eng->ini + i*n_val*eng->stp; all calculations which should 
+         give the same intensities (e.g. shards of an energy range) 
+         must use the same grid.
+
+ RETURN VALUE:
+
+  pointer to the context (no interval validated yet).
+  NULL if pruning is switched off (eps <= 0 or eng->stp <= 0).
+
+*********************************************************************/
+{
+leed_prune_t *prune;
+
+ if( (eps <= 0.) || (eng->stp <= 0.) ) return(NULL);
+
+ prune = (leed_prune_t *)calloc(1, sizeof(leed_prune_t));
+ if(prune == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_beam_prune_alloc): allocation error\n");
+#endif
+   exit(1);
+ }
+
+ prune->eps = eps;
+ prune->n_val = MAX(n_val, 1);
+ prune->e_ini = eng->ini;
+ prune->e_stp = eng->stp;
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(leed_beam_prune_alloc): eps = %.2e, "
+         "validation every %d energies\n", prune->eps, prune->n_val);
+#endif
+
+ return(prune);
+} /* end of function leed_beam_prune_alloc */
+
+/*======================================================================*/
+
+void leed_beam_prune_free(leed_prune_t *prune)
+
+/*********************************************************************
+  Free the beam pruning context (NULL is allowed).
+*********************************************************************/
+{
+int i_int;
+
+ if(prune == NULL) return;
+
+ for(i_int = 0; i_int < prune->n_int; i_int ++) free(prune->pruned[i_int]);
+ free(prune->pruned);
+ free(prune->n_pruned);
+ free(prune);
+} /* end of function leed_beam_prune_free */
+
+/*======================================================================*/
+
+int leed_beam_prune_int(leed_prune_t *prune, real energy)
+
+/*********************************************************************
+  Validation interval of an energy.
+
+ RETURN VALUE:
+
+  index i of the validation interval [e_ini + i*n_val*e_stp, 
+  e_ini + (i+1)*n_val*e_stp) which contains energy (>= 0).
+
+*********************************************************************/
+{
+int i_int;
+
+ i_int = (int)floor( (energy - prune->e_ini + E_TOLERANCE) /
+                     (prune->n_val * prune->e_stp) );
+ return( MAX(i_int, 0) );
+} /* end of function leed_beam_prune_int */
+
+/*======================================================================*/
+
+static int leed_beam_prune_is_val(leed_prune_t *prune, real energy, 
+                                  int i_int)
+
+/*********************************************************************
+  1 if energy is the validation energy of interval i_int.
+*********************************************************************/
+{
+ return( R_fabs(energy - prune->e_ini - i_int * prune->n_val * prune->e_stp)
+         < E_TOLERANCE );
+} /* end of function leed_beam_prune_is_val */
+
+/*======================================================================*/
+
+int leed_beam_prune_plan(leed_prune_t *prune, real *energies, int n_eng,
+                         int *stage, real **p_e_val)
+
+/*********************************************************************
+  Order a list of energies: the validation energies which are needed
+  by the list are calculated first.
+
+ INPUT:
+
+  leed_prune_t *prune - pruning context.
+  real *energies - list of (distinct) energies.
+  int n_eng - number of energies.
+  int *stage - (output) stage of each energy: 0 if the energy can be
+         calculated in the first stage (validation energies and energies
+         of validated intervals), 1 if it must wait for a validation
+         energy of the first stage.
+  real **p_e_val - (output) validation energies which are not in the
+         list but are needed by it (to be calculated in the first 
+         stage, the intensities are not used). Allocated by the
+         function (NULL if there are none).
+
+ DESIGN:
+
+  The context is extended to all intervals of the list, so that it is
+  not reallocated while the energies are calculated. The intervals
+  validated in the first stage are written only once (by their
+  validation energy) and read only in the second stage.
+
+ RETURN VALUE:
+
+  number of energies in *p_e_val.
+
+*********************************************************************/
+{
+int i_eng, i_int, n_int, n_new;
+int *todo;
+real *e_val;
+
+ *p_e_val = NULL;
+
+/* extend the context to all intervals of the list */
+ for(i_eng = 0, n_int = prune->n_int; i_eng < n_eng; i_eng ++)
+   n_int = MAX(n_int, leed_beam_prune_int(prune, energies[i_eng]) + 1);
+
+ if(n_int > prune->n_int)
+ {
+   prune->n_pruned = (int *)realloc(prune->n_pruned, n_int * sizeof(int));
+   prune->pruned = (real **)realloc(prune->pruned, n_int * sizeof(real *));
+   if( (prune->n_pruned == NULL) || (prune->pruned == NULL) )
+   {
+#ifdef ERROR
+     fprintf(STDERR, "*** error (leed_beam_prune_plan): allocation error\n");
+#endif
+     exit(1);
+   }
+   for(i_int = prune->n_int; i_int < n_int; i_int ++)
+   {
+     prune->n_pruned[i_int] = -1;
+     prune->pruned[i_int] = NULL;
+   }
+   prune->n_int = n_int;
+ }
+
+/*
+  todo: 0 = validated; 1 = validation energy needed; 2 = validation
+  energy is in the list.
+*/
+ todo = (int *)calloc(n_int + 1, sizeof(int));
+ e_val = (real *)malloc((n_int + 1) * sizeof(real));
+ if( (todo == NULL) || (e_val == NULL) )
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_beam_prune_plan): allocation error\n");
+#endif
+   exit(1);
+ }
+
+ for(i_eng = 0; i_eng < n_eng; i_eng ++)
+ {
+   i_int = leed_beam_prune_int(prune, energies[i_eng]);
+   if(prune->n_pruned[i_int] >= 0) continue;
+   if(leed_beam_prune_is_val(prune, energies[i_eng], i_int)) todo[i_int] = 2;
+   else if(todo[i_int] == 0) todo[i_int] = 1;
+ }
+
+ for(i_eng = 0; i_eng < n_eng; i_eng ++)
+ {
+   i_int = leed_beam_prune_int(prune, energies[i_eng]);
+   stage[i_eng] = (todo[i_int] != 0) &&
+                  ! leed_beam_prune_is_val(prune, energies[i_eng], i_int);
+ }
+
+ for(i_int = 0, n_new = 0; i_int < n_int; i_int ++)
+   if(todo[i_int] == 1)
+     e_val[n_new ++] = prune->e_ini + i_int * prune->n_val * prune->e_stp;
+
+ free(todo);
+ if(n_new > 0) *p_e_val = e_val;
+ else          free(e_val);
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(leed_beam_prune_plan): %d energies, %d additional "
+         "validation energies\n", n_eng, n_new);
+#endif
+
+ return(n_new);
+} /* end of function leed_beam_prune_plan */
+
+/*======================================================================*/
+
+int leed_beam_prune(leed_prune_t *prune, leed_prune_amp_t *rec, real energy,
+                    leed_beam_t *beams_now, int n_beams_now)
+
+/*********************************************************************
+  Remove the pruned beams from the beam list of the current energy.
+
+ INPUT:
+
+  leed_prune_t *prune - pruning context (NULL: no pruning).
+  leed_prune_amp_t *rec - (output) recording of the amplitudes; 
+         switched on at the validation energy of an interval which is
+         not validated yet (see leed_beam_prune_amp). Must be passed to
+         leed_beam_prune_update.
+  real energy - current energy.
+  leed_beam_t *beams_now - (input/output) beams included at the current
+         energy (leed_beam_get_selection). The pruned beams are removed
+         from the list; the order of the other beams is kept.
+  int n_beams_now - number of beams in beams_now.
+
+ DESIGN:
+
+  At a validation energy the list is not changed. The same holds for
+  an energy whose interval has not been validated (see 
+  leed_beam_prune_plan).
+
+ RETURN VALUE:
+
+  number of beams in beams_now.
+
+*********************************************************************/
+{
+int i_beams, i_out, i_pr, i_int, n_pruned;
+int first;
+real faux;
+real *pruned;
+
+ rec->i_int = -1;
+ rec->n_amp = 0;
+ rec->amp = NULL;
+ rec->prop = NULL;
+ rec->kz_i = NULL;
+
+ if(prune == NULL) return(n_beams_now);
+
+ i_int = leed_beam_prune_int(prune, energy);
+ n_pruned = (i_int < prune->n_int)? prune->n_pruned[i_int]: -1;
+
+/*********************************************************************
+  Validation energy: record amplitudes of the full selection
+*********************************************************************/
+
+ if(leed_beam_prune_is_val(prune, energy, i_int))
+ {
+   if( (n_pruned >= 0) || (i_int >= prune->n_int) ) return(n_beams_now);
+
+   rec->amp = (real *)malloc((n_beams_now + 1) * sizeof(real));
+   rec->prop = (int *)malloc((n_beams_now + 1) * sizeof(int));
+   rec->kz_i = (real *)malloc((n_beams_now + 1) * sizeof(real));
+   if( (rec->amp == NULL) || (rec->prop == NULL) || (rec->kz_i == NULL) )
+   {
+#ifdef ERROR
+     fprintf(STDERR, "*** error (leed_beam_prune): allocation error\n");
+#endif
+     exit(1);
+   }
+   for(i_beams = 0; i_beams < n_beams_now; i_beams ++)
+   {
+     rec->amp[i_beams] = 0.;
+     rec->prop[i_beams] = 
+       ((beams_now + i_beams)->k_par <= (beams_now + i_beams)->k_r[0]);
+/* 
+  decay constant of an evanescent wave at the upper end of the interval
+  (k^2 = 2E): it decreases with the energy and vanishes at emergence.
+*/
+     faux = SQUARE((beams_now + i_beams)->k_par) - 
+            SQUARE((beams_now + i_beams)->k_r[0]) - 
+            2. * prune->n_val * prune->e_stp;
+     rec->kz_i[i_beams] = (faux > 0.)? R_sqrt(faux): 0.;
+   }
+
+   rec->i_int = i_int;
+   rec->n_amp = n_beams_now;
+   return(n_beams_now);
+ }
+
+ if(n_pruned <= 0) return(n_beams_now);
+ pruned = prune->pruned[i_int];
+
+/*********************************************************************
+  Remove evanescent beams of the list, except the first beam of a set.
+*********************************************************************/
+
+ for(i_beams = 0, i_out = 0; i_beams < n_beams_now; i_beams ++)
+ {
+   first = (i_beams == 0) ||
+           ((beams_now + i_beams)->set != (beams_now + i_beams - 1)->set);
+
+   i_pr = n_pruned;
+   if( (! first) &&
+       ((beams_now + i_beams)->k_par > (beams_now + i_beams)->k_r[0]) )
+   {
+     for(i_pr = 0; i_pr < n_pruned; i_pr ++)
+       if( (R_fabs((beams_now + i_beams)->ind_1 - pruned[2*i_pr])
+                                                       < K_TOLERANCE) &&
+           (R_fabs((beams_now + i_beams)->ind_2 - pruned[2*i_pr + 1])
+                                                       < K_TOLERANCE) )
+         break;
+   }
+
+   if(i_pr == n_pruned)        /* not pruned */
+   {
+     if(i_out < i_beams)
+       memcpy(beams_now + i_out, beams_now + i_beams, sizeof(leed_beam_t));
+     i_out ++;
+   }
+ }
+
+ (beams_now + i_out)->k_par = F_END_OF_LIST;
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(leed_beam_prune): %d of %d beams used\n",
+         i_out, n_beams_now);
+#endif
+
+ return(i_out);
+} /* end of function leed_beam_prune */
+
+/*======================================================================*/
+
+void leed_beam_prune_amp(leed_prune_amp_t *rec, mat R, int off, real dz)
+
+/*********************************************************************
+  Record the amplitudes of the beams in a reflection matrix.
+
+ INPUT:
+
+  leed_prune_amp_t *rec - (input/output) recording (leed_beam_prune);
+         NULL is allowed.
+  mat R - reflection matrix. Row and column i belong to beam 
+         off + i - 1 of the beam list passed to leed_beam_prune (R may
+         have fewer columns than rows, e.g. the first column only).
+  int off - offset of the first row (0 unless R is a block of R_bulk).
+  real dz - distance (z) to the next layer or to the potential step,
+         i.e. over which the waves are propagated before R is used.
+
+ DESIGN:
+
+  Only the columns of propagating beams are used, i.e. the amplitudes
+  which are excited by waves coming from the vacuum side. The elements
+  are propagated over dz in both directions, 
+
+    |P(i) R(i,j) P(j)|^2 with |P(i)| = exp(-Im(k_z(i)) * dz),
+
+  since an evanescent wave is largest at the reference plane of the 
+  layer and has decayed when it reaches the next one. Im(k_z) is taken
+  at the end of the validation interval (smallest decay, 0 for beams
+  which are propagating there, see leed_beam_prune). The amplitude of
+  a beam is the largest propagated element in its row relative to the
+  largest propagated element of these columns. Evanescent beams couple
+  strongly among each other within a layer; their mutual elements are
+  not a measure of the importance of a beam.
+  Only done at validation energies; does nothing otherwise.
+
+*********************************************************************/
+{
+int i_r, i_c;
+real faux, f_max;
+real *prop_2;
+
+ if( (rec == NULL) || (rec->n_amp <= 0) ) return;
+ if( (R == NULL) || (R->rel == NULL) ) return;
+ if( (off + R->rows > rec->n_amp) || (R->cols > R->rows) ) return;
+
+/* |P(i)|^2 of the rows (the first R->cols are also the columns) */
+ prop_2 = (real *)malloc((R->rows + 1) * sizeof(real));
+ if(prop_2 == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_beam_prune_amp): allocation error\n");
+#endif
+   exit(1);
+ }
+ for(i_r = 1; i_r <= R->rows; i_r ++)
+   prop_2[i_r] = exp(-2. * rec->kz_i[off + i_r - 1] * R_fabs(dz));
+
+ f_max = 0.;
+ for(i_r = 1; i_r <= R->rows; i_r ++)
+   for(i_c = 1; i_c <= R->cols; i_c ++)
+   {
+     if(! rec->prop[off + i_c - 1]) continue;
+     faux = ( SQUARE(RMATEL(i_r, i_c, R)) + SQUARE(IMATEL(i_r, i_c, R)) )
+            * prop_2[i_r] * prop_2[i_c];
+     if(faux > f_max) f_max = faux;
+   }
+
+ if(f_max > 0.)
+ {
+   f_max = 1./f_max;
+   for(i_r = 1; i_r <= R->rows; i_r ++)
+     for(i_c = 1; i_c <= R->cols; i_c ++)
+     {
+       if(! rec->prop[off + i_c - 1]) continue;
+       faux = ( SQUARE(RMATEL(i_r, i_c, R)) + SQUARE(IMATEL(i_r, i_c, R)) )
+              * prop_2[i_r] * prop_2[i_c] * f_max;
+       if(faux > rec->amp[off + i_r - 1]) rec->amp[off + i_r - 1] = faux;
+     }
+ }
+
+ free(prop_2);
+} /* end of function leed_beam_prune_amp */
+
+/*======================================================================*/
+
+void leed_beam_prune_amp_bulk(leed_prune_amp_t *rec, mat R_bulk, 
+                              leed_beam_t *beams_now, int n_set, real dz)
+
+/*********************************************************************
+  Record the amplitudes of the beams in the bulk reflection matrix
+  (matrix array with one diagonal block per beam set, see
+  leed_calc_bulk_nd); dz as in leed_beam_prune_amp.
+*********************************************************************/
+{
+int i_set;
+int *set_off;
+
+ if( (rec == NULL) || (rec->n_amp <= 0) || (R_bulk == NULL) ) return;
+
+ set_off = NULL;
+ if(leed_beam_set_offsets(&set_off, beams_now, n_set) == rec->n_amp)
+ {
+   for(i_set = 0; i_set < n_set; i_set ++)
+     if(set_off[i_set + 1] > set_off[i_set])
+       leed_beam_prune_amp(rec, R_bulk + i_set, set_off[i_set], dz);
+ }
+ free(set_off);
+} /* end of function leed_beam_prune_amp_bulk */
+
+/*======================================================================*/
+
+int leed_beam_prune_update(leed_prune_t *prune, leed_prune_amp_t *rec,
+                           leed_beam_t *beams_now, int n_beams_now)
+
+/*********************************************************************
+  Determine the beams to be pruned in a validation interval from the
+  amplitudes recorded at its validation energy.
+
+ INPUT:
+
+  leed_prune_t *prune - (input/output) pruning context; the list of
+         the interval rec->i_int is set. If NULL (e.g. the calculation
+         has failed) the recorded amplitudes are discarded.
+  leed_prune_amp_t *rec - recording (leed_beam_prune); the memory is
+         freed.
+  leed_beam_t *beams_now - beams of the validation energy (as passed to
+         leed_beam_prune).
+  int n_beams_now - number of beams in beams_now.
+
+ RETURN VALUE:
+
+  number of pruned beams of the interval (-1 if nothing was recorded).
+
+*********************************************************************/
+{
+int i_beams, n_pruned;
+real eps_2;
+real *pruned;
+
+ n_pruned = -1;
+ if( (prune != NULL) && (rec->n_amp > 0) && (rec->n_amp == n_beams_now) &&
+     (rec->i_int >= 0) && (rec->i_int < prune->n_int) )
+ {
+   pruned = (real *)malloc((2*n_beams_now + 1) * sizeof(real));
+   if(pruned == NULL)
+   {
+#ifdef ERROR
+     fprintf(STDERR, 
+             "*** error (leed_beam_prune_update): allocation error\n");
+#endif
+     exit(1);
+   }
+
+   eps_2 = SQUARE(prune->eps);
+   n_pruned = 0;
+   for(i_beams = 1; i_beams < n_beams_now; i_beams ++)
+   {
+     if( ((beams_now + i_beams)->set == (beams_now + i_beams - 1)->set) &&
+         ((beams_now + i_beams)->k_par > (beams_now + i_beams)->k_r[0]) &&
+         (rec->amp[i_beams] < eps_2) )
+     {
+       pruned[2*n_pruned]     = (beams_now + i_beams)->ind_1;
+       pruned[2*n_pruned + 1] = (beams_now + i_beams)->ind_2;
+       n_pruned ++;
+     }
+   }
+
+/* the list is complete before the number is set */
+   free(prune->pruned[rec->i_int]);
+   prune->pruned[rec->i_int] = pruned;
+   prune->n_pruned[rec->i_int] = n_pruned;
+
+#ifdef CONTROL
+   fprintf(STDCTR, "(leed_beam_prune_update): interval %d: %d of %d beams "
+           "below %.2e\n", rec->i_int, n_pruned, n_beams_now, prune->eps);
+#endif
+ }
+
+ free(rec->amp);
+ free(rec->prop);
+ free(rec->kz_i);
+ rec->amp = NULL;
+ rec->prop = NULL;
+ rec->kz_i = NULL;
+ rec->n_amp = 0;
+ rec->i_int = -1;
+
+ return(n_pruned);
+} /* end of function leed_beam_prune_update */
@@ -7,6 +7,8 @@ GH/04.09.97
 Changes:
 GH/26.08.94 - Creation
 GH/04.09.97 - use memcpy for copying beams.
+AG/17.10.26 - skip the rest of a beam set once k_par exceeds the cutoff
+              radius (lists sorted by leed_beam_gen, see set_end).
 
 *********************************************************************/
 
@@ -19,6 +21,9 @@ GH/04.09.97 - use memcpy for copying beams.
 
 #include "leed.h"
 
+#ifndef K_TOLERANCE
+#define K_TOLERANCE 0.0001                        /* tolerance of k_par */
+#endif
 
 int leed_beam_get_selection(leed_beam_t ** p_beams_out, 
               leed_beam_t * beams_in,
@@ -54,6 +59,14 @@ int leed_beam_get_selection(leed_beam_t ** p_beams_out,
 
    real dmin    (input) min. distance between two successive layers.
 
+ DESIGN:
+
+  If beams_in was created by leed_beam_gen, the beams of each set are 
+  sorted by k_par (= |g|^2) and set_end points to the next set. Since
+  |g + k_in| >= |g| - |k_in|, all beams of a set following the first 
+  beam with |g| > k_max + |k_in| are outside the cutoff radius; the 
+  selection within a set is therefore a prefix of the set.
+
  RETURN VALUE:
 
   int i_beams_out - number of beams in the list pointed to by p_beams.
@@ -66,6 +79,7 @@ int i_beams_in, i_beams_out;
 
 real faux_r;
 real k_max, k_max_2;
+real k_lim_2;
 real k_r, k_i;
 real k_x, k_y;
 
@@ -77,8 +91,11 @@ leed_beam_t *beams_out;
 *************************************************************************/
 
  for(iaux = 0; 
-     ! IS_EQUAL_REAL((beams_in + iaux)->k_par, F_END_OF_LIST); 
-     iaux++);
+     ! IS_EQUAL_REAL((beams_in + iaux)->k_par, F_END_OF_LIST); )
+ {
+   if( (beams_in + iaux)->set_end > iaux ) iaux = (beams_in + iaux)->set_end;
+   else                                    iaux ++;
+ }
  iaux++;
 
  if (*p_beams_out == NULL)
@@ -107,6 +124,9 @@ leed_beam_t *beams_out;
  faux_r = R_log(v_par->epsilon) / dmin;
  k_max_2 = faux_r*faux_r + 2*v_par->eng_r;
  k_max = R_sqrt(k_max_2);
+
+/* no beam with k_par (= |g|^2) > k_lim_2 can be within the radius */
+ k_lim_2 = SQUARE(k_max + v_par->k_in[0] + K_TOLERANCE);
  
 #ifdef CONTROL_X
  fprintf(STDCTR,"(leed_beam_get_selection): dmin  = %.2f, epsilon = %.2e\n", 
@@ -135,6 +155,14 @@ leed_beam_t *beams_out;
      ! IS_EQUAL_REAL((beams_in + i_beams_in)->k_par, F_END_OF_LIST); 
      i_beams_in ++)
  {
+/* skip the rest of a sorted beam set */
+   if( ((beams_in + i_beams_in)->set_end > i_beams_in) &&
+       ((beams_in + i_beams_in)->k_par > k_lim_2) )
+   {
+     i_beams_in = (beams_in + i_beams_in)->set_end - 1;
+     continue;
+   }
+
    k_x = (beams_in + i_beams_in)->k_r[1] + v_par->k_in[1];
    k_y = (beams_in + i_beams_in)->k_r[2] + v_par->k_in[2];
    faux_r = SQUARE(k_x) + SQUARE(k_y);
@@ -145,6 +173,9 @@ leed_beam_t *beams_out;
              beams_in + i_beams_in, 
              sizeof(leed_beam_t) );
 
+/* the selection is not sorted by k_par (see set_end) */
+     (beams_out + i_beams_out)->set_end = 0;
+
 /* replace, k_par, k_r/i, k_r/ix/y */
      (beams_out + i_beams_out)->k_par = R_sqrt(faux_r);
 
@@ -1,8 +1,16 @@
 /*********************************************************************
   GH/26.08.94 
-  file contains function:
+  file contains functions:
 
   leed_beam_set
+  leed_beam_set_offsets
+  leed_beam_set_copy
+
+Changes:
+GH/26.08.94 - Creation (leed_beam_set)
+AG/17.10.26 - leed_beam_set_offsets: offsets of the beam sets in a beam
+              list (block structure of R_bulk).
+AG/17.10.26 - leed_beam_set_copy: copy a beam set using the offsets.
 
 *********************************************************************/
 
@@ -116,3 +124,158 @@ leed_beam_t *beams_out;
 }  /* end of function leed_beam_set */
 
 /*======================================================================*/
+
+int leed_beam_set_offsets(int ** p_offsets, leed_beam_t * beams_in, int n_set)
+
+/************************************************************************
+
+ Find the positions of all beam sets within a beam list.
+ 
+ INPUT:
+
+  int ** p_offsets - (output) 
+                Pointer to an array of n_set + 1 integers. (*p_offsets)[i]
+                is the position (starting from 0) of the first beam of set
+                i in beams_in, (*p_offsets)[n_set] is the total number of 
+                beams. The beams of set i are therefore found between
+                (*p_offsets)[i] and (*p_offsets)[i+1] - 1.
+
+  leed_beam_t * beams_in - (input)
+                List of beams. The list must be terminated by 
+                "F_END_OF_LIST" in the structure element "k_par".
+
+  int n_set     (input) number of beam sets.
+
+ DESIGN:
+
+  The beams of one set must be stored contiguously in beams_in and the 
+  sets must appear in increasing order, as created by leed_beam_gen
+  and preserved by leed_beam_get_selection. The offsets then define the 
+  diagonal blocks of any matrix that couples only beams of the same set
+  (e.g. the bulk reflection matrix).
+
+ RETURN VALUE:
+
+  int n_beams - total number of beams in list beams_in.
+  -1            if failed (beam sets are not contiguous).
+
+*************************************************************************/
+{
+int i_beams, i_set;
+int *offsets;
+
+ if (*p_offsets == NULL)
+   offsets = *p_offsets = (int *)calloc(n_set + 1, sizeof(int));
+ else
+   offsets = *p_offsets = (int *)realloc(*p_offsets, (n_set + 1)*sizeof(int));
+
+ if(offsets == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR," *** error (leed_beam_set_offsets): allocation error.\n");
+#endif
+   exit(1);
+ }
+
+/*********************************************************
+  Loop over beams: a new block starts whenever the set changes.
+  Sets without any beam have zero length.
+*********************************************************/ 
+
+ for(i_beams = 0, i_set = 0; 
+     ! IS_EQUAL_REAL((beams_in + i_beams)->k_par, F_END_OF_LIST); 
+     i_beams ++)
+ {
+   if( (beams_in + i_beams)->set < i_set - 1 )
+   {
+#ifdef ERROR
+     fprintf(STDERR," *** error (leed_beam_set_offsets): "
+             "beam sets are not stored contiguously.\n");
+#endif
+     return(-1);
+   }
+   while( (i_set <= (beams_in + i_beams)->set) && (i_set < n_set) )
+   {
+     offsets[i_set] = i_beams;
+     i_set ++;
+   }
+ }
+
+ for( ; i_set <= n_set; i_set ++) offsets[i_set] = i_beams;
+
+#ifdef CONTROL
+ for(i_set = 0; i_set < n_set; i_set ++)
+   fprintf(STDCTR,"(leed_beam_set_offsets): set %d: beams %d - %d\n", 
+           i_set, offsets[i_set], offsets[i_set+1] - 1);
+#endif
+
+ return(i_beams);
+}  /* end of function leed_beam_set_offsets */
+
+/*======================================================================*/
+
+int leed_beam_set_copy(leed_beam_t ** p_beams_out, leed_beam_t * beams_in, 
+                       int * offsets, int set)
+
+/************************************************************************
+
+ Copy the beams of a certain beam set ("set") into a list.
+ 
+ INPUT:
+
+  leed_beam_t ** p_beams_out - (output) 
+                Pointer to the list of beams included in the beam set.
+                The list will be terminated by "F_END_OF_LIST" in the 
+                structure element "k_par".
+
+  leed_beam_t * beams_in - (input) list of beams.
+
+  int * offsets (input) positions of the beam sets in beams_in as 
+                created by leed_beam_set_offsets.
+
+  int set       (input) set for which the beams are extracted.
+
+ DESIGN:
+
+  Same result as leed_beam_set, but the beams are copied in one block
+  instead of scanning the whole list.
+
+ RETURN VALUE:
+
+  int n_beams_out - number of beams in the list pointed to by p_beams.
+
+*************************************************************************/
+{
+int n_beams_out;
+
+leed_beam_t *beams_out;
+
+ n_beams_out = offsets[set+1] - offsets[set];
+
+ if (*p_beams_out == NULL)
+   beams_out = *p_beams_out = (leed_beam_t *)
+                 calloc(n_beams_out + 1, sizeof(leed_beam_t));
+ else
+   beams_out = *p_beams_out = (leed_beam_t *)
+                 realloc(*p_beams_out, (n_beams_out + 1)*sizeof(leed_beam_t));
+
+ if(beams_out == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR," *** error (leed_beam_set_copy): allocation error.\n");
+#endif
+   exit(1);
+ }
+
+ memcpy(beams_out, beams_in + offsets[set], 
+        n_beams_out * sizeof(leed_beam_t) );
+
+/*
+  Set k_par of the last element of the list to the terminating value.
+*/
+ (beams_out + n_beams_out)->k_par = F_END_OF_LIST;
+
+ return(n_beams_out);
+}  /* end of function leed_beam_set_copy */
+
+/*======================================================================*/
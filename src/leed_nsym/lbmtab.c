@@ -0,0 +1,254 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  leed_beam_tab
+    Pack the k vectors of a beam list into a table of arrays.
+  leed_beam_tab_free
+    Free the arrays of a beam table.
+  leed_beam_tab_phase
+    Phase factors exp(i k*r) for a range of beams of the table.
+  leed_beam_tab_mul_cols
+    Multiply the columns of a complex matrix with a vector of factors.
+  leed_beam_tab_mul_rows
+    Multiply the rows of a complex matrix with a vector of factors.
+
+  The beam list (leed_beam_t) is an array of large structures (symmetry
+  arrays and pointers to the phase factors of each layer); in loops
+  over all beams only a few elements of each structure are used. The
+  beam table contains these elements (k_x, k_y, k_z, 1/Akz) in separate
+  contiguous arrays. A range (off, n) of the table is used for a beam
+  set (see leed_beam_set_offsets).
+
+  The phase factors are calculated in two plain loops over the arrays
+  (arguments, then exponential functions) which the compiler can
+  vectorise; they replace the loops calling cri_expi for each beam.
+  The matrices are multiplied with the phase factors row by row, i.e.
+  in the order of the matrix elements in memory.
+
+Changes:
+  AG/17.10.26 - Creation
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "leed.h"
+
+#define N_TAB_ARRAYS 8                 /* number of arrays in the table */
+
+/*======================================================================*/
+
+int leed_beam_tab(leed_beam_tab_t *tab, leed_beam_t *beams, int n_beams)
+
+/*********************************************************************
+  Pack the k vectors of a beam list into a table of arrays.
+
+ INPUT:
+
+  leed_beam_tab_t *tab - (input/output) beam table. The arrays are
+         (re)allocated if the table is too small; a new table must be
+         initialised with zeros.
+  leed_beam_t *beams - beam list.
+  int n_beams - number of beams in the list; if negative, the list is
+         terminated by k_par = F_END_OF_LIST.
+
+ RETURN VALUE:
+
+  number of beams in the table.
+  -1 if failed (and EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+int i_beams;
+real *buf;
+
+ if(n_beams < 0)
+   for(n_beams = 0;
+       ! IS_EQUAL_REAL((beams + n_beams)->k_par, F_END_OF_LIST); n_beams ++)
+     ;
+
+/* allocate (all arrays in one block) */
+ if( (n_beams > tab->n_max) || (tab->k_x == NULL) )
+ {
+   buf = (real *)realloc(tab->k_x,
+                         N_TAB_ARRAYS * (n_beams + 1) * sizeof(real));
+   if(buf == NULL)
+   {
+#ifdef ERROR
+     fprintf(STDERR, "*** error (leed_beam_tab): allocation error\n");
+#endif
+#ifdef EXIT_ON_ERROR
+     exit(1);
+#else
+     return(-1);
+#endif
+   }
+
+   tab->n_max = n_beams + 1;
+   tab->k_x   = buf;
+   tab->k_y   = buf + 1*tab->n_max;
+   tab->kz_r  = buf + 2*tab->n_max;
+   tab->kz_i  = buf + 3*tab->n_max;
+   tab->Akz_r = buf + 4*tab->n_max;
+   tab->Akz_i = buf + 5*tab->n_max;
+   tab->ph_r  = buf + 6*tab->n_max;
+   tab->ph_i  = buf + 7*tab->n_max;
+ }
+
+ for(i_beams = 0; i_beams < n_beams; i_beams ++)
+ {
+   tab->k_x[i_beams]   = (beams + i_beams)->k_r[1];
+   tab->k_y[i_beams]   = (beams + i_beams)->k_r[2];
+   tab->kz_r[i_beams]  = (beams + i_beams)->k_r[3];
+   tab->kz_i[i_beams]  = (beams + i_beams)->k_i[3];
+   tab->Akz_r[i_beams] = (beams + i_beams)->Akz_r;
+   tab->Akz_i[i_beams] = (beams + i_beams)->Akz_i;
+ }
+ tab->n_beams = n_beams;
+
+ return(n_beams);
+} /* end of function leed_beam_tab */
+
+/*======================================================================*/
+
+void leed_beam_tab_free(leed_beam_tab_t *tab)
+
+/*********************************************************************
+  Free the arrays of a beam table (the structure itself is not freed).
+*********************************************************************/
+{
+ free(tab->k_x);
+ tab->k_x = tab->k_y = tab->kz_r = tab->kz_i = NULL;
+ tab->Akz_r = tab->Akz_i = tab->ph_r = tab->ph_i = NULL;
+ tab->n_beams = tab->n_max = 0;
+} /* end of function leed_beam_tab_free */
+
+/*======================================================================*/
+
+void leed_beam_tab_phase(real *ph_r, real *ph_i, leed_beam_tab_t *tab,
+                         int off, int n, real *vec, real s_par, real s_z)
+
+/*********************************************************************
+  Phase factors exp(i k*r) for the beams off ... off+n-1 of a table.
+
+ INPUT:
+
+  real *ph_r, *ph_i - (output) real and imaginary parts of the phase
+         factors of beam off+i in ph_r[i], ph_i[i]. If NULL, the
+         arrays tab->ph_r/ph_i are used (from index 0).
+  leed_beam_tab_t *tab - beam table (leed_beam_tab).
+  int off, int n - range of beams.
+  real *vec - vector r (vec[1..3] = x, y, z).
+  real s_par, s_z - signs (+1./-1.) of the parallel and the z
+         component of k:
+
+         ph = exp[ i (s_par*(k_x*x + k_y*y) + s_z*k_z*z) ]
+
+         where k_z is complex.
+
+*********************************************************************/
+{
+int i;
+real *k_x, *k_y, *kz_r, *kz_i;
+real arg;
+
+ if(ph_r == NULL)
+ {
+   ph_r = tab->ph_r;
+   ph_i = tab->ph_i;
+ }
+
+ k_x  = tab->k_x  + off;
+ k_y  = tab->k_y  + off;
+ kz_r = tab->kz_r + off;
+ kz_i = tab->kz_i + off;
+
+/* arguments: ph_r = Re(k*r), ph_i = Im(k*r) */
+ for(i = 0; i < n; i ++)
+ {
+   ph_r[i] = s_par * (k_x[i] * vec[1] + k_y[i] * vec[2]) +
+             s_z * kz_r[i] * vec[3];
+   ph_i[i] = s_z * kz_i[i] * vec[3];
+ }
+
+/* exp(i*arg) = exp(-Im(arg)) * (cos(Re(arg)) + i sin(Re(arg))) */
+ for(i = 0; i < n; i ++)
+ {
+   arg = ph_r[i];
+   ph_r[i] = R_exp(-ph_i[i]);
+   ph_i[i] = ph_r[i] * R_sin(arg);
+   ph_r[i] = ph_r[i] * R_cos(arg);
+ }
+} /* end of function leed_beam_tab_phase */
+
+/*======================================================================*/
+
+void leed_beam_tab_mul_cols(mat M, real *f_r, real *f_i)
+
+/*********************************************************************
+  Multiply the columns of a complex matrix with a vector of factors:
+
+  M(i,k) = M(i,k) * f[k-1]
+
+ INPUT:
+
+  mat M - (input/output) complex matrix.
+  real *f_r, *f_i - real and imaginary parts of the factors (M->cols
+         elements, starting from index 0).
+
+*********************************************************************/
+{
+int k;
+real faux;
+real *ptr_r, *ptr_i, *ptr_end;
+
+ for(ptr_r = M->rel + 1, ptr_i = M->iel + 1,
+     ptr_end = ptr_r + M->rows * M->cols;
+     ptr_r < ptr_end; ptr_r += M->cols, ptr_i += M->cols)
+ {
+   for(k = 0; k < M->cols; k ++)
+   {
+     faux = ptr_r[k];
+     ptr_r[k] = faux * f_r[k] - ptr_i[k] * f_i[k];
+     ptr_i[k] = faux * f_i[k] + ptr_i[k] * f_r[k];
+   }
+ }
+} /* end of function leed_beam_tab_mul_cols */
+
+/*======================================================================*/
+
+void leed_beam_tab_mul_rows(mat M, real *f_r, real *f_i)
+
+/*********************************************************************
+  Multiply the rows of a complex matrix with a vector of factors:
+
+  M(i,k) = M(i,k) * f[i-1]
+
+ INPUT:
+
+  mat M - (input/output) complex matrix.
+  real *f_r, *f_i - real and imaginary parts of the factors (M->rows
+         elements, starting from index 0).
+
+*********************************************************************/
+{
+int i, k;
+real faux, g_r, g_i;
+real *ptr_r, *ptr_i;
+
+ for(i = 0, ptr_r = M->rel + 1, ptr_i = M->iel + 1; i < M->rows;
+     i ++, ptr_r += M->cols, ptr_i += M->cols)
+ {
+   g_r = f_r[i];
+   g_i = f_i[i];
+   for(k = 0; k < M->cols; k ++)
+   {
+     faux = ptr_r[k];
+     ptr_r[k] = faux * g_r - ptr_i[k] * g_i;
+     ptr_i[k] = faux * g_i + ptr_i[k] * g_r;
+   }
+ }
+} /* end of function leed_beam_tab_mul_rows */
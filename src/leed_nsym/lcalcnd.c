@@ -0,0 +1,1958 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  leed_calc_amp_nd
+    Calculate the amplitudes of all beams at a single energy.
+  leed_calc_beams_nd
+    Create the lists of beams for an energy range.
+  leed_calc_n_eng
+    Number of energies in an energy range.
+  leed_calc_iv_nd
+    Calculate the intensities of the output beams for an energy range.
+  leed_calc_iv_delta_nd
+    Same as leed_calc_iv_nd but reuse the layer matrices of the 
+    previous call for layers which have not changed.
+  leed_calc_cache_alloc
+    Allocate the storage for leed_calc_iv_delta_nd.
+  leed_calc_cache_free
+    Free the layer matrices stored by leed_calc_iv_delta_nd.
+  leed_calc_int_dom_nd
+    Calculate the domain averaged intensities at a single energy.
+  leed_calc_top_mode
+    Select full or first column layer doubling for the top-most layer.
+  leed_calc_int_list_nd
+    Calculate the intensities for a list of energies (in parallel).
+
+  All functions work on parameters which have been read from input
+  files (leed_inp_read_bul_nd etc.) or created in memory
+  (leed_inp_bul_mem_nd etc.). No files are written.
+
+Changes:
+  AG/17.10.26 - Creation (energy loop body of cleed_nsym.c)
+  AG/17.10.26 - leed_calc_bulk_nd, leed_calc_iv_delta_nd: store layer 
+                matrices between calls (delta mode).
+  AG/17.10.26 - delta mode: optionally keep the layer matrices in scratch
+                files (leed_calc_cache_alloc).
+  AG/17.10.26 - domain averaging (leed_calc_int_dom_nd): overlayer part
+                in leed_calc_over_nd, bulk calculated once for all domains.
+  AG/17.10.26 - top-most overlayer layer: only the first column of R+-
+                (leed_ld_2lay_rpm1, leed_calc_top_mode).
+  AG/17.10.26 - leed_calc_int_list_nd: arbitrary energies, concurrently
+                with thread-local parameters (adaptive energy grid).
+  AG/17.10.26 - leed_calc_int_list_nd: worker processes if set by
+                leed_farm_mode (lfarmnd.c).
+  AG/17.10.26 - bulk and overlayer: matrices of a layer are reused for
+                equal layers (which may differ in their registry).
+  AG/17.10.26 - leed_calc_amp_core: dynamic beam pruning (lbmprune.c).
+  AG/17.10.26 - leed_calc_bulk_nd: empty block of R_bulk for a beam set
+                without beams.
+  AG/17.10.26 - delta mode: the phase shifts of all atoms are part of 
+                the comparison of stored and current layers; atom->dwf
+                (not set by the input) is not compared.
+  AG/17.10.26 - leed_calc_over_nd, leed_calc_amp_core: return NULL if
+                the layer doubling (leed_ld_2lay_rpm1) fails.
+  AG/17.10.26 - free the Ylm cache (leed_ms_ymat_cache_free) at the end
+                of the energy loops.
+  AG/17.10.26 - delta mode: the blocks of R_bulk are written to the 
+                scratch files, too; leed_calc_eng_reset skips the
+                matrices of spilled energies.
+  AG/17.10.26 - beam pruning with an explicit context (leed_prune_t):
+                leed_calc_int_list_nd calculates the validation energies
+                first (leed_beam_prune_plan).
+  AG/17.10.26 - pruning amplitudes propagated to the next layer
+                (leed_beam_prune_amp).
+  AG/17.10.26 - leed_calc_layer_eq, leed_calc_vec_eq: geometry compared
+                within GEO_TOLERANCE; the other cache keys with
+                IS_EQUAL_REAL.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "leed.h"
+
+#ifdef _USE_OPENMP
+#include <omp.h>        /* compile with '-fopenmp' */
+#endif
+
+#define POT_STEP_Z  (1.25 / BOHR)   /* top-most layer to potential step */
+
+static int top_mode = LEED_TOP_COLUMN;
+
+/*======================================================================*/
+
+int leed_calc_top_mode(int mode)
+
+/*********************************************************************
+  Select the layer doubling for the top-most overlayer layer.
+
+ INPUT:
+
+  int mode - LEED_TOP_COLUMN (default): only the first column of R+- 
+         (the amplitudes for the incident beam) is calculated for the 
+         top-most layer (leed_ld_2lay_rpm1), which is all that 
+         leed_ld_potstep0 needs.
+         LEED_TOP_FULL: the full matrix R+- is calculated (as for all 
+         other layers).
+         Other values leave the mode unchanged.
+
+  The mode is global and should be set before any parallel region.
+
+ RETURN VALUE:
+
+  previous mode.
+
+*********************************************************************/
+{
+int old_mode;
+
+ old_mode = top_mode;
+ if( (mode == LEED_TOP_FULL) || (mode == LEED_TOP_COLUMN) ) top_mode = mode;
+ return(old_mode);
+} /* end of function leed_calc_top_mode */
+
+/*======================================================================*/
+
+static int leed_calc_layer_eq(leed_layer_t *lay1, leed_layer_t *lay2)
+
+/*********************************************************************
+  Compare the properties of two layers which enter the layer matrices 
+  (not the vectors to the adjacent layers). Lengths are equal within
+  GEO_TOLERANCE.
+  Thermal vibrations enter through the phase shifts (displacements,
+  see leed_calc_phs_key); atom->dwf is not set by the input functions
+  and is therefore not compared.
+
+ RETURN VALUE:
+
+  1 if the layer matrices of lay1 and lay2 are the same, 0 otherwise.
+
+*********************************************************************/
+{
+int i_c, i_atoms;
+leed_atom_t *at1, *at2;
+
+ if( (lay1->atoms == NULL) || (lay2->atoms == NULL) ) return(0);
+ if( (lay1->natoms != lay2->natoms) || 
+     (lay1->periodic != lay2->periodic) ||
+     ! IS_EQUAL_REAL(lay1->rel_area, lay2->rel_area) ) return(0);
+
+ for(i_c = 1; i_c <= 4; i_c ++)
+   if(R_fabs(lay1->a_lat[i_c] - lay2->a_lat[i_c]) > GEO_TOLERANCE) return(0);
+
+ for(i_atoms = 0; i_atoms < lay1->natoms; i_atoms ++)
+ {
+   at1 = lay1->atoms + i_atoms;
+   at2 = lay2->atoms + i_atoms;
+   if( (at1->type != at2->type) || (at1->t_type != at2->t_type) ) 
+     return(0);
+   for(i_c = 1; i_c <= 3; i_c ++)
+     if(R_fabs(at1->pos[i_c] - at2->pos[i_c]) > GEO_TOLERANCE) return(0);
+ }
+
+ return(1);
+} /* end of function leed_calc_layer_eq */
+
+/*======================================================================*/
+
+static int leed_calc_vec_eq(real *vec1, real *vec2)
+
+/*********************************************************************
+  Compare two 3-dim. vectors (1=x, 2=y, 3=z) within GEO_TOLERANCE.
+*********************************************************************/
+{
+ return( (R_fabs(vec1[1] - vec2[1]) <= GEO_TOLERANCE) && 
+         (R_fabs(vec1[2] - vec2[2]) <= GEO_TOLERANCE) && 
+         (R_fabs(vec1[3] - vec2[3]) <= GEO_TOLERANCE) );
+} /* end of function leed_calc_vec_eq */
+
+/*======================================================================*/
+
+static void leed_calc_phs_free(leed_calc_cache_t *cache)
+
+/*********************************************************************
+  Free the copies of the phase shifts stored in cache.
+*********************************************************************/
+{
+int i_phs;
+
+ for(i_phs = 0; i_phs < cache->n_phs; i_phs ++)
+ {
+   free(cache->phs[i_phs].input_file);
+   free(cache->phs[i_phs].energy);
+   free(cache->phs[i_phs].pshift);
+   free(cache->phs[i_phs].mix_type);
+   free(cache->phs[i_phs].mix_wgt);
+ }
+ free(cache->phs);
+ free(cache->phs_ok);
+ cache->n_phs = 0;
+ cache->phs = NULL;
+ cache->phs_ok = NULL;
+} /* end of function leed_calc_phs_free */
+
+/*======================================================================*/
+
+static int leed_calc_phs_eq(leed_phs_t *phs1, leed_phs_t *phs2)
+
+/*********************************************************************
+  Compare two sets of phase shifts: all input of the atomic t matrix 
+  (name, phase shifts, displacements, type of t matrix and, for the 
+  average t matrix, components and concentrations).
+
+ RETURN VALUE:
+
+  1 if the sets are equal, 0 otherwise.
+
+*********************************************************************/
+{
+int i_c, nl;
+
+ if( (phs1->lmax != phs2->lmax) || (phs1->neng != phs2->neng) ||
+     (phs1->t_type != phs2->t_type) || (phs1->n_mix != phs2->n_mix) ||
+     ! IS_EQUAL_REAL(phs1->eng_min, phs2->eng_min) || 
+     ! IS_EQUAL_REAL(phs1->eng_max, phs2->eng_max) )
+   return(0);
+
+ for(i_c = 0; i_c <= 3; i_c ++)
+   if(! IS_EQUAL_REAL(phs1->dr[i_c], phs2->dr[i_c])) return(0);
+
+ if( (phs1->input_file == NULL) || (phs2->input_file == NULL) ||
+     strcmp(phs1->input_file, phs2->input_file) ) return(0);
+
+ nl = phs1->lmax + 1;
+ if( (phs1->neng > 0) &&
+     ( memcmp(phs1->energy, phs2->energy, phs1->neng * sizeof(real)) ||
+       memcmp(phs1->pshift, phs2->pshift, phs1->neng * nl * sizeof(real)) ) )
+   return(0);
+
+ for(i_c = 0; i_c < phs1->n_mix; i_c ++)
+   if( (phs1->mix_type[i_c] != phs2->mix_type[i_c]) ||
+       ! IS_EQUAL_REAL(phs1->mix_wgt[i_c], phs2->mix_wgt[i_c]) ) return(0);
+
+ return(1);
+} /* end of function leed_calc_phs_eq */
+
+/*======================================================================*/
+
+static void leed_calc_phs_key(leed_calc_cache_t *cache, 
+                              leed_phs_t *phs_shifts)
+
+/*********************************************************************
+  Compare the phase shifts with the copies stored in cache (previous 
+  call), set cache->phs_ok and store copies of the current phase 
+  shifts.
+
+  A mixture (average t matrix) is only unchanged if all its components
+  are unchanged; the components precede the mixture in the list.
+*********************************************************************/
+{
+int i_phs, i_c, n_phs, nl;
+int *phs_ok;
+
+leed_phs_t *phs, *old;
+
+ for(n_phs = 0; (phs_shifts + n_phs)->lmax != I_END_OF_LIST; n_phs ++)
+   ;
+
+ phs_ok = (int *)calloc(n_phs + 1, sizeof(int));
+ phs = (leed_phs_t *)calloc(n_phs + 1, sizeof(leed_phs_t));
+
+ for(i_phs = 0; i_phs < n_phs; i_phs ++)
+ {
+   old = (i_phs < cache->n_phs)? cache->phs + i_phs: NULL;
+   phs_ok[i_phs] = (old != NULL) && 
+                   leed_calc_phs_eq(old, phs_shifts + i_phs);
+   for(i_c = 0; i_c < (phs_shifts + i_phs)->n_mix; i_c ++)
+     phs_ok[i_phs] = phs_ok[i_phs] && 
+                     phs_ok[(phs_shifts + i_phs)->mix_type[i_c]];
+
+   /* copy */
+   memcpy(phs + i_phs, phs_shifts + i_phs, sizeof(leed_phs_t));
+   nl = (phs + i_phs)->lmax + 1;
+   if((phs + i_phs)->input_file != NULL)
+   {
+     (phs + i_phs)->input_file = 
+       (char *)malloc(strlen((phs_shifts + i_phs)->input_file) + 1);
+     strcpy((phs + i_phs)->input_file, (phs_shifts + i_phs)->input_file);
+   }
+   if((phs + i_phs)->neng > 0)
+   {
+     (phs + i_phs)->energy = (real *)malloc((phs + i_phs)->neng * sizeof(real));
+     (phs + i_phs)->pshift = 
+                     (real *)malloc((phs + i_phs)->neng * nl * sizeof(real));
+     memcpy((phs + i_phs)->energy, (phs_shifts + i_phs)->energy, 
+            (phs + i_phs)->neng * sizeof(real));
+     memcpy((phs + i_phs)->pshift, (phs_shifts + i_phs)->pshift, 
+            (phs + i_phs)->neng * nl * sizeof(real));
+   }
+   if((phs + i_phs)->n_mix > 0)
+   {
+     (phs + i_phs)->mix_type = (int *)malloc((phs + i_phs)->n_mix * sizeof(int));
+     (phs + i_phs)->mix_wgt = (real *)malloc((phs + i_phs)->n_mix * sizeof(real));
+     memcpy((phs + i_phs)->mix_type, (phs_shifts + i_phs)->mix_type, 
+            (phs + i_phs)->n_mix * sizeof(int));
+     memcpy((phs + i_phs)->mix_wgt, (phs_shifts + i_phs)->mix_wgt, 
+            (phs + i_phs)->n_mix * sizeof(real));
+   }
+ }
+
+ leed_calc_phs_free(cache);
+ cache->n_phs = n_phs;
+ cache->phs = phs;
+ cache->phs_ok = phs_ok;
+} /* end of function leed_calc_phs_key */
+
+/*======================================================================*/
+
+static int leed_calc_layer_key(leed_calc_cache_t *cache, 
+                               leed_layer_t *lay_c, leed_layer_t *lay)
+
+/*********************************************************************
+  Check if the matrices of the stored layer lay_c can be used for lay: 
+  same geometry (leed_calc_layer_eq) and unchanged phase shifts of all 
+  atoms (leed_calc_phs_key).
+*********************************************************************/
+{
+int i_atoms, type;
+
+ if(! leed_calc_layer_eq(lay_c, lay)) return(0);
+
+ for(i_atoms = 0; i_atoms < lay->natoms; i_atoms ++)
+ {
+   type = (lay->atoms + i_atoms)->type;
+   if( (type < 0) || (type >= cache->n_phs) || ! cache->phs_ok[type] ) 
+     return(0);
+ }
+ return(1);
+} /* end of function leed_calc_layer_key */
+
+/*======================================================================*/
+
+static void leed_calc_layer_copy(leed_layer_t *dst, leed_layer_t *src)
+
+/*********************************************************************
+  Copy layer src (including atoms) into dst. The atoms of dst are 
+  reallocated.
+*********************************************************************/
+{
+leed_atom_t *atoms;
+
+ atoms = (leed_atom_t *)realloc(dst->atoms, 
+                                src->natoms * sizeof(leed_atom_t));
+ memcpy(dst, src, sizeof(leed_layer_t));
+ memcpy(atoms, src->atoms, src->natoms * sizeof(leed_atom_t));
+ dst->atoms = atoms;
+} /* end of function leed_calc_layer_copy */
+
+/*======================================================================*/
+
+static void leed_calc_eng_reset(leed_calc_eng_t *c_eng, int n_over)
+
+/*********************************************************************
+  Free the matrices and layers stored in c_eng and prepare storage for
+  n_over overlayer layers. The matrices of spilled energies are NULL.
+*********************************************************************/
+{
+int i_layer;
+
+ for(i_layer = 0; i_layer < c_eng->n_over; i_layer ++)
+ {
+   if(c_eng->Tpp[i_layer] != NULL) matfree(c_eng->Tpp[i_layer]);
+   if(c_eng->Tmm[i_layer] != NULL) matfree(c_eng->Tmm[i_layer]);
+   if(c_eng->Rpm[i_layer] != NULL) matfree(c_eng->Rpm[i_layer]);
+   if(c_eng->Rmp[i_layer] != NULL) matfree(c_eng->Rmp[i_layer]);
+   if(c_eng->R_tot[i_layer] != NULL) matfree(c_eng->R_tot[i_layer]);
+   free(c_eng->over[i_layer].atoms);
+ }
+ for(i_layer = 0; i_layer < c_eng->n_bulk; i_layer ++)
+   free(c_eng->bulk[i_layer].atoms);
+
+ free(c_eng->Tpp); free(c_eng->Tmm); free(c_eng->Rpm); free(c_eng->Rmp);
+ free(c_eng->R_tot);
+ free(c_eng->over); free(c_eng->bulk);
+ free(c_eng->ind);
+ if(c_eng->R_bulk != NULL) matarrfree(c_eng->R_bulk);
+
+ memset(c_eng, 0, sizeof(leed_calc_eng_t));
+
+ if(n_over > 0)
+ {
+   c_eng->n_over = n_over;
+   c_eng->Tpp   = (mat *)calloc(n_over, sizeof(mat));
+   c_eng->Tmm   = (mat *)calloc(n_over, sizeof(mat));
+   c_eng->Rpm   = (mat *)calloc(n_over, sizeof(mat));
+   c_eng->Rmp   = (mat *)calloc(n_over, sizeof(mat));
+   c_eng->R_tot = (mat *)calloc(n_over, sizeof(mat));
+   c_eng->over  = (leed_layer_t *)calloc(n_over, sizeof(leed_layer_t));
+ }
+} /* end of function leed_calc_eng_reset */
+
+/*======================================================================*/
+
+static int leed_calc_eng_match(leed_calc_eng_t *c_eng, real energy,
+                               leed_var_t *v_par, leed_beam_t *beams_now,
+                               int n_beams_now, int n_over)
+
+/*********************************************************************
+  Check if the matrices stored in c_eng were calculated for the same
+  energy, parameters, beams and number of overlayer layers.
+
+ RETURN VALUE:
+
+  1 if the matrices can be reused, 0 otherwise.
+
+*********************************************************************/
+{
+int i_beams;
+
+ if( (c_eng->ind == NULL) || ! IS_EQUAL_REAL(c_eng->energy, energy) ||
+     (c_eng->n_beams != n_beams_now) || (c_eng->n_over != n_over) )
+   return(0);
+
+ if( ! IS_EQUAL_REAL(c_eng->par.vr, v_par->vr) || 
+     ! IS_EQUAL_REAL(c_eng->par.vi_pre, v_par->vi_pre) ||
+     ! IS_EQUAL_REAL(c_eng->par.vi_exp, v_par->vi_exp) ||
+     ! IS_EQUAL_REAL(c_eng->par.theta, v_par->theta) ||
+     ! IS_EQUAL_REAL(c_eng->par.phi, v_par->phi) ||
+     ! IS_EQUAL_REAL(c_eng->par.epsilon, v_par->epsilon) ||
+     (c_eng->par.l_max != v_par->l_max) ) return(0);
+
+ for(i_beams = 0; i_beams < n_beams_now; i_beams ++)
+   if( ! IS_EQUAL_REAL(c_eng->ind[2*i_beams], 
+                       (beams_now + i_beams)->ind_1) ||
+       ! IS_EQUAL_REAL(c_eng->ind[2*i_beams + 1], 
+                       (beams_now + i_beams)->ind_2) )
+     return(0);
+
+ return(1);
+} /* end of function leed_calc_eng_match */
+
+/*======================================================================*/
+
+static int leed_calc_eng_spill(leed_calc_eng_t *c_eng, char *scratch, 
+                               int i_eng, int load)
+
+/*********************************************************************
+  Write the matrices of c_eng (the beam set blocks of R_bulk and the 
+  overlayer matrices) to the scratch file <scratch>.<i_eng> and free 
+  them (load = 0) or read them back (load = 1).
+
+ DESIGN:
+
+  The file contains the number of blocks of R_bulk and for each block
+  the number of rows followed by the block (matwrite; empty blocks of
+  beam sets without beams at this energy are not written), then the
+  five matrices of each overlayer layer.
+
+ RETURN VALUE:
+
+  1 if ok, 0 if failed.
+
+*********************************************************************/
+{
+int i_layer;
+int i_mat;
+int i_blk, n_blk, rows;
+int ok;
+
+mat p_blk, M_read;
+mat *p_mat[5];
+
+FILE *scr_stream;
+char scr_file[STRSZ];
+
+ sprintf(scr_file, "%s.%d", scratch, i_eng);
+ if( (scr_stream = fopen(scr_file, (load)? "rb": "wb")) == NULL)
+ {
+#ifdef WARNING
+   fprintf(STDWAR, 
+   "* warning (leed_calc_eng_spill): could not open scratch file \"%s\"\n",
+   scr_file);
+#endif
+   return(0);
+ }
+
+/* beam set blocks of R_bulk */
+ ok = 1;
+ if(load)
+ {
+   ok = (fread(&n_blk, sizeof(int), 1, scr_stream) == 1);
+   if(ok && (n_blk > 0))
+     ok = ( (c_eng->R_bulk = matarralloc(NULL, n_blk)) != NULL);
+ }
+ else
+ {
+   n_blk = 0;
+   if(c_eng->R_bulk != NULL)
+     for(n_blk = 0; (c_eng->R_bulk + n_blk)->blk_type == BLK_ARRAY; n_blk ++)
+       ;
+   ok = (fwrite(&n_blk, sizeof(int), 1, scr_stream) == 1);
+ }
+
+ for(i_blk = 0; (i_blk < n_blk) && ok; i_blk ++)
+ {
+   p_blk = c_eng->R_bulk + i_blk;
+   if(load)
+   {
+     ok = (fread(&rows, sizeof(int), 1, scr_stream) == 1);
+     if(ok && (rows > 0))
+     {
+       /* move the elements of the matrix read into the array */
+       ok = ( (M_read = matread(NULL, scr_stream)) != NULL);
+       if(ok)
+       {
+         p_blk->rows = M_read->rows;
+         p_blk->cols = M_read->cols;
+         p_blk->mat_type = M_read->mat_type;
+         p_blk->num_type = M_read->num_type;
+         p_blk->rel = M_read->rel;
+         p_blk->iel = M_read->iel;
+         free(M_read);
+       }
+     }
+     else if(ok)
+     {
+       p_blk->rel = p_blk->iel = NULL;
+       p_blk->rows = p_blk->cols = 0;
+       p_blk->num_type = NUM_COMPLEX;
+       p_blk->mat_type = MAT_SQUARE;
+     }
+   }
+   else
+   {
+     rows = (p_blk->rel != NULL)? p_blk->rows: 0;
+     ok = (fwrite(&rows, sizeof(int), 1, scr_stream) == 1);
+     if(ok && (rows > 0)) ok = (matwrite(p_blk, scr_stream) > 0);
+   }
+ }
+
+/* overlayer matrices */
+ for(i_layer = 0; (i_layer < c_eng->n_over) && ok; i_layer ++)
+ {
+   p_mat[0] = c_eng->Tpp + i_layer; p_mat[1] = c_eng->Tmm + i_layer;
+   p_mat[2] = c_eng->Rpm + i_layer; p_mat[3] = c_eng->Rmp + i_layer;
+   p_mat[4] = c_eng->R_tot + i_layer;
+   for(i_mat = 0; (i_mat < 5) && ok; i_mat ++)
+   {
+     if(load)
+       ok = ( (*p_mat[i_mat] = matread(NULL, scr_stream)) != NULL);
+     else
+       ok = (matwrite(*p_mat[i_mat], scr_stream) > 0);
+   }
+ }
+ fclose(scr_stream);
+
+/* free the matrices only after all have been written */
+ if(ok && ! load)
+ {
+   if(c_eng->R_bulk != NULL) matarrfree(c_eng->R_bulk);
+   c_eng->R_bulk = NULL;
+   for(i_layer = 0; i_layer < c_eng->n_over; i_layer ++)
+   {
+     matfree(c_eng->Tpp[i_layer]); c_eng->Tpp[i_layer] = NULL;
+     matfree(c_eng->Tmm[i_layer]); c_eng->Tmm[i_layer] = NULL;
+     matfree(c_eng->Rpm[i_layer]); c_eng->Rpm[i_layer] = NULL;
+     matfree(c_eng->Rmp[i_layer]); c_eng->Rmp[i_layer] = NULL;
+     matfree(c_eng->R_tot[i_layer]); c_eng->R_tot[i_layer] = NULL;
+   }
+ }
+
+ c_eng->spilled = (ok && ! load);
+ return(ok);
+} /* end of function leed_calc_eng_spill */
+
+/*======================================================================*/
+
+static mat leed_calc_bulk_nd(mat R_bulk, leed_beam_t *beams_now, 
+                             int n_beams_now, leed_cryst_t *bulk, 
+                             leed_var_t *v_par, int n_set, real energy)
+
+/*********************************************************************
+  Calculate the bulk reflection matrix at a single energy.
+
+ INPUT:
+
+  mat R_bulk - (output) bulk reflection matrix (matrix array with one
+         diagonal block per beam set). If NULL, the array is allocated.
+  leed_beam_t *beams_now, int n_beams_now - beams included at this
+         energy (leed_beam_get_selection).
+  leed_cryst_t *bulk - bulk parameters.
+  leed_var_t *v_par - parameters (already updated for energy).
+  int n_set - number of beam sets.
+  real energy - vacuum energy (only used for the cpu time output).
+
+ RETURN VALUE:
+
+  R_bulk (NULL if failed and EXIT_ON_ERROR is not defined; R_bulk has
+  been freed in this case).
+
+*********************************************************************/
+{
+int i_set;
+int *set_off;
+int i_layer;
+
+  set_off = NULL;
+
+/*********************************************************************
+BULK:
+Loop over beam sets
+
+Create matrix R_bulk that will eventually contain the bulk 
+reflection matrix.
+
+The beam sets do not couple in the bulk, i.e. R_bulk is block 
+diagonal and only the diagonal blocks are stored (matrix array with
+one block per beam set). This requires the beam sets to be contiguous
+in beams_now (checked by leed_beam_set_offsets). The beam sets are
+computed independently (and concurrently if compiled with OpenMP),
+each with its own layer matrices, and each set writes only its own
+block of R_bulk.
+*********************************************************************/
+
+  R_bulk = matarralloc(R_bulk, n_set);
+  if(leed_beam_set_offsets(&set_off, beams_now, n_set) != n_beams_now)
+  {
+#ifdef ERROR
+    fprintf(STDERR, "*** error (leed_calc_bulk_nd): beam sets are not ordered\n");
+#endif
+#ifdef EXIT_ON_ERROR
+    exit(1);
+#else
+    free(set_off);
+    matarrfree(R_bulk);
+    return(NULL);
+#endif
+  }
+
+#ifdef _USE_OPENMP
+  #pragma omp parallel private(i_set, i_layer)
+#endif
+  {
+  int n_beams_set;
+  char set_buffer[STRSZ];
+
+  leed_beam_t *beams_set;
+
+  mat Tpp,   Tmm,   Rpm,   Rmp;       /* stack of bulk layers */
+  mat Tpp_b, Tmm_b, Rpm_b, Rmp_b;     /* single bulk layer */
+  int i_b;                            /* layer stored in Tpp_b ... */
+
+  Tpp   = Tmm   = Rpm   = Rmp   = NULL;
+  Tpp_b = Tmm_b = Rpm_b = Rmp_b = NULL;
+  beams_set = NULL;
+
+#ifdef _USE_OPENMP
+  #pragma omp for schedule(dynamic, 1)
+#endif
+  for(i_set = 0; i_set < n_set; i_set ++)
+  {
+    n_beams_set = leed_beam_set_copy(&beams_set, beams_now, set_off, i_set);
+    if(n_beams_set < 1)
+    {
+  /*********************************************************************
+    No beams of this set at this energy: the block of R_bulk is set to 
+    an empty (0 x 0) matrix without elements, also if it holds the 
+    block of a previous energy.
+  *********************************************************************/
+      if((R_bulk+i_set)->rel != NULL) free((R_bulk+i_set)->rel);
+      if((R_bulk+i_set)->iel != NULL) free((R_bulk+i_set)->iel);
+      (R_bulk+i_set)->rel = (R_bulk+i_set)->iel = NULL;
+      (R_bulk+i_set)->rows = (R_bulk+i_set)->cols = 0;
+      (R_bulk+i_set)->num_type = NUM_COMPLEX;
+      (R_bulk+i_set)->mat_type = MAT_SQUARE;
+      continue;
+    }
+
+/*********************************************************************
+  Loop over periodic bulk layers
+*********************************************************************/
+
+  /**********************************************************
+   Compute scattering matrices for bottom-most bulk layer:
+   - single Bravais layer or composite layer
+   The matrices of a single layer are kept in Tpp_b ... (layer i_b)
+   and reused for the following layers as long as these are equal 
+   (leed_calc_layer_eq). The lateral registry of a layer is not part
+   of its matrices but of vec_from_last, i.e. the layers of an fcc
+   or hcp stack (ABC...) differ only in the phases applied by the
+   layer doubling.
+  **********************************************************/
+
+#ifdef CONTROL_FLOW
+    fprintf(STDCTR, "(leed_calc_bulk_nd periodic): bulk layer %d/%d, set %d/%d\n", 
+                      0, bulk->nlayers - 1, i_set, n_set - 1);
+#endif
+      
+    if( (bulk->layers + 0)->natoms == 1)
+    {
+      leed_ms_nd( &Tpp_b, &Tmm_b, &Rpm_b, &Rmp_b,
+                   v_par, (bulk->layers + 0), beams_set);
+    }
+    else
+    {
+      leed_ms_compl_nd( &Tpp_b, &Tmm_b, &Rpm_b, &Rmp_b,
+                   v_par, (bulk->layers + 0), beams_set);
+    }
+    i_b = 0;
+
+    Tpp = matcop(Tpp, Tpp_b);
+    Tmm = matcop(Tmm, Tmm_b);
+    Rpm = matcop(Rpm, Rpm_b);
+    Rmp = matcop(Rmp, Rmp_b);
+
+#ifdef CONTROL_X
+    fprintf(STDCTR, "(leed_calc_bulk_nd): after leed_ms_nd: Tpp:");
+    matshow(Tpp);
+    fprintf(STDCTR, "(leed_calc_bulk_nd): after leed_ms_nd: Tmm:");
+    matshow(Tmm);
+    fprintf(STDCTR, "(leed_calc_bulk_nd): after leed_ms_nd: Rpm:");
+    matshow(Rpm);
+    fprintf(STDCTR, "(leed_calc_bulk_nd): after leed_ms_nd: Rmp:");
+    matshow(Rmp);
+#endif
+     
+  /**********************************************************
+    Loop over the other bulk layers 
+  **********************************************************/
+
+    for(i_layer = 1; 
+        ( (bulk->layers+i_layer)->periodic == 1) && 
+        (i_layer < bulk->nlayers); 
+        i_layer ++)
+    {
+#ifdef CONTROL_FLOW
+      fprintf(STDCTR, "(leed_calc_bulk_nd periodic): bulk layer %d/%d, set %d/%d\n", 
+                      i_layer, bulk->nlayers - 1, i_set, n_set - 1);
+#endif
+
+  /************************************************************** 
+    Compute scattering matrices R/T_b for a single bulk layer 
+    (unless equal to layer i_b)
+     - single Bravais layer or composite layer
+  ***************************************************************/
+
+      if( ! leed_calc_layer_eq(bulk->layers + i_b, bulk->layers + i_layer) )
+      {
+        if( (bulk->layers + i_layer)->natoms == 1)
+        {
+          leed_ms_nd ( &Tpp_b, &Tmm_b, &Rpm_b, &Rmp_b,
+                        v_par, (bulk->layers + i_layer), beams_set);
+        }
+        else
+        {
+          leed_ms_compl_nd( &Tpp_b, &Tmm_b, &Rpm_b, &Rmp_b,
+                       v_par, (bulk->layers + i_layer), beams_set);
+        }
+        i_b = i_layer;
+      }
+
+  /*************************************************************************** 
+     Add the single layer matrices to the rest by layer doubling 
+     - inter layer vector is the vector between layers
+       (i_layer - 1) and (i_layer): 
+       (bulk->layers + i_layer)->vec_from_last
+  ****************************************************************************/ 
+#ifdef CONTROL_FLOW
+      fprintf(STDCTR, 
+              "(leed_calc_bulk_nd): before leed_ld_2lay vec_from...(%.2f %.2f %.2f)\n",
+                     (bulk->layers + i_layer)->vec_from_last[1] * BOHR,
+                     (bulk->layers + i_layer)->vec_from_last[2] * BOHR,
+                     (bulk->layers + i_layer)->vec_from_last[3] * BOHR); 
+#endif
+
+      leed_ld_2lay( &Tpp,  &Tmm,  &Rpm,  &Rmp,
+               Tpp,   Tmm,   Rpm,   Rmp,
+               Tpp_b, Tmm_b, Rpm_b, Rmp_b,
+               beams_set, (bulk->layers + i_layer)->vec_from_last);
+
+    } /* for i_layer (bulk) */
+
+ /********************************************************************* 
+    Layer doubling for all periodic bulk layers until convergence is 
+    reached:
+     - inter layer vector is (bulk->layers + 0)->vec_from_last
+ **********************************************************************/
+#ifdef CONTROL_FLOW
+    fprintf(STDCTR, "(leed_calc_bulk_nd): before leed_ld_2n vec_from...(%.2f %.2f %.2f)\n",
+                    (bulk->layers + 0)->vec_from_last[1] * BOHR,
+                    (bulk->layers + 0)->vec_from_last[2] * BOHR,
+                    (bulk->layers + 0)->vec_from_last[3] * BOHR);
+#endif
+
+    Rpm = leed_ld_2n( Rpm, Tpp, Tmm, Rpm, Rmp, 
+                 beams_set, (bulk->layers + 0)->vec_from_last);
+
+ /*******************************************************************
+   Compute scattering matrices for top-most bulk layer if it is
+   not periodic.
+    - single Bravais layer or composite layer
+ **********************************************************************/
+
+    if( i_layer == bulk->nlayers - 1 )
+    {
+#ifdef CONTROL_FLOW
+      fprintf(STDCTR, 
+              "(leed_calc_bulk_nd not periodic): bulk layer %d/%d, set %d/%d\n", 
+              i_layer, bulk->nlayers - 1, i_set, n_set - 1);
+#endif
+  
+      if( ! leed_calc_layer_eq(bulk->layers + i_b, bulk->layers + i_layer) )
+      {
+        if( (bulk->layers + i_layer)->natoms == 1)
+        {
+          leed_ms_nd( &Tpp_b, &Tmm_b, &Rpm_b, &Rmp_b,
+                    v_par, (bulk->layers + i_layer), beams_set);
+        }
+        else
+        {
+          leed_ms_compl_nd( &Tpp_b, &Tmm_b, &Rpm_b, &Rmp_b,
+                       v_par, (bulk->layers + i_layer), beams_set);
+        }
+        i_b = i_layer;
+      }
+ 
+  /**************************************************************************
+     Add the single layer matrices of the top-most layer to the rest 
+     by layer doubling:
+     - inter layer vector is the vector between layers
+       (i_layer - 1) and (i_layer): 
+       (bulk->layers + i_layer)->vec_from_last
+  ***************************************************************************/
+
+      Rpm = leed_ld_2lay_rpm(Rpm, Rpm, Tpp_b, Tmm_b, Rpm_b, Rmp_b,
+                        beams_set, (bulk->layers + i_layer)->vec_from_last);
+
+    }  /* if( i_layer == bulk->nlayers - 1 ) */
+
+ /*******************************************************
+   Copy reflection matrix for this beam set into its block
+   of R_bulk.
+ ********************************************************/
+
+    matcop(R_bulk + i_set, Rpm);
+
+ /*************************
+   Write cpu time to output
+ **************************/
+
+    sprintf(set_buffer,"(leed_calc_bulk_nd): bulk layers set %d, E = %.1f", 
+            i_set, energy*HART);
+    leed_cpu_time(STDCPU,set_buffer);
+  }  /* for i_set */
+
+ /*************************
+   Free thread-local storage
+ **************************/
+
+  matfree(Tpp);   matfree(Tmm);   matfree(Rpm);   matfree(Rmp);
+  matfree(Tpp_b); matfree(Tmm_b); matfree(Rpm_b); matfree(Rmp_b);
+  free(beams_set);
+  }  /* parallel region (beam sets) */
+
+  free(set_off);
+
+  return(R_bulk);
+} /* end of function leed_calc_bulk_nd */
+
+/*======================================================================*/
+
+static mat leed_calc_over_nd(mat Amp, mat R_bulk, leed_beam_t *beams_now,
+                     leed_cryst_t *bulk, leed_cryst_t *over, 
+                     leed_var_t *v_par, real energy,
+                     leed_calc_cache_t *cache, leed_calc_eng_t *c_eng,
+                     int stack_ok, leed_prune_amp_t *rec)
+
+/*********************************************************************
+  Add the overlayer layers on top of the bulk reflection matrix R_bulk
+  and calculate the amplitudes at the potential step
+  (see leed_calc_amp_core).
+
+  If c_eng is not NULL, the layer matrices stored in c_eng are reused
+  for unchanged layers as long as stack_ok is set (i.e. all layers
+  below are unchanged). Otherwise all matrices are local to the call;
+  R_bulk is not modified.
+  If rec is not NULL, the amplitudes in the reflection matrices of the
+  stack are recorded (leed_beam_prune_amp).
+
+  Returns NULL if the layer doubling fails (Amp is freed); the 
+  matrices stored in c_eng are then incomplete.
+
+*********************************************************************/
+{
+mat Tpp_s, Tmm_s, Rpm_s, Rmp_s;
+mat R_tot, R_prev;
+mat *p_Tpp, *p_Tmm, *p_Rpm, *p_Rmp, *p_R;
+
+int i_c;
+int i_layer, i_eq, i_s;
+int lay_ok;
+
+real vec[4];
+
+char linebuffer[STRSZ];
+
+  Tpp_s =  Tmm_s =  Rpm_s =  Rmp_s = NULL;
+  R_tot = NULL;
+  i_s = -1;                             /* layer stored in Tpp_s ... */
+
+/*********************************************************************
+Loop over all overlayer layers
+
+  With cache, the layer matrices are recalculated only if the layer 
+  has changed, layer doubling is repeated from the lowest changed layer
+  or inter layer vector upwards (stack_ok = 0).
+
+  Only the first column of R+- is needed at the potential step; for the
+  top-most layer it is calculated without the full matrix 
+  (LEED_TOP_COLUMN, see leed_calc_top_mode).
+*********************************************************************/
+
+  R_prev = R_bulk;
+  for(i_layer = 0; i_layer < over->nlayers; i_layer ++)
+  {
+#ifdef CONTROL_FLOW
+    fprintf(STDCTR, "(leed_calc_amp_nd): overlayer %d/%d\n", i_layer, over->nlayers - 1);
+#endif
+
+    if(c_eng == NULL)
+    {
+      p_Tpp = &Tpp_s; p_Tmm = &Tmm_s; p_Rpm = &Rpm_s; p_Rmp = &Rmp_s;
+      p_R = &R_tot;
+      lay_ok = 0;
+    }
+    else
+    {
+      p_Tpp = c_eng->Tpp + i_layer; p_Tmm = c_eng->Tmm + i_layer; 
+      p_Rpm = c_eng->Rpm + i_layer; p_Rmp = c_eng->Rmp + i_layer;
+      p_R = c_eng->R_tot + i_layer;
+      lay_ok = (*p_Rpm != NULL) && 
+        leed_calc_layer_key(cache, c_eng->over + i_layer, 
+                            over->layers + i_layer);
+    }
+
+ /***********************************************************
+   Calculate scattering matrices for a single overlayer layer
+    - only single Bravais layer 
+   If a layer below is equal (leed_calc_layer_eq; the registry is
+   in vec_from_last), its matrices are used: copied from the cache,
+   or still in Tpp_s ... without cache.
+ ************************************************************/
+    
+    if(lay_ok)
+    {
+      cache->n_reuse ++;
+      stack_ok = stack_ok &&
+        leed_calc_vec_eq(c_eng->over[i_layer].vec_from_last, 
+                         (over->layers + i_layer)->vec_from_last);
+    }
+    else
+    {
+      for(i_eq = i_layer - 1; i_eq >= 0; i_eq --)
+        if( ( ( (c_eng != NULL) && (c_eng->Rpm[i_eq] != NULL) ) ||
+              (i_eq == i_s) ) &&
+            leed_calc_layer_eq(over->layers + i_eq, over->layers + i_layer) )
+          break;
+
+      if( (i_eq >= 0) && (c_eng != NULL) )
+      {
+        *p_Tpp = matcop(*p_Tpp, c_eng->Tpp[i_eq]);
+        *p_Tmm = matcop(*p_Tmm, c_eng->Tmm[i_eq]);
+        *p_Rpm = matcop(*p_Rpm, c_eng->Rpm[i_eq]);
+        *p_Rmp = matcop(*p_Rmp, c_eng->Rmp[i_eq]);
+      }
+      else if(i_eq < 0)
+      {
+        if( (over->layers + i_layer)->natoms == 1)
+        {
+          leed_ms_nd( p_Tpp, p_Tmm, p_Rpm, p_Rmp,
+                       v_par, (over->layers + i_layer), beams_now);
+        }
+        else
+        {
+          leed_ms_compl_nd( p_Tpp, p_Tmm, p_Rpm, p_Rmp,
+                       v_par, (over->layers + i_layer), beams_now);
+        }
+        i_s = i_layer;
+      }
+      stack_ok = 0;
+    }
+
+    if(c_eng != NULL)
+    {
+      if(! lay_ok) cache->n_calc ++;
+      leed_calc_layer_copy(c_eng->over + i_layer, over->layers + i_layer);
+    }
+
+#ifdef CONTROL_X
+ fprintf(STDCTR, "\n(leed_calc_amp_nd):overlayer %d  ...\n",i_layer);
+ fprintf(STDCTR, "\n(leed_calc_amp_nd): Tpp:\n");
+ matshowabs(*p_Tpp);
+ fprintf(STDCTR, "\n(leed_calc_amp_nd): Tmm:\n");
+ matshowabs(*p_Tmm);
+ fprintf(STDCTR, "\n(leed_calc_amp_nd): Rpm:\n");
+ matshowabs(*p_Rpm);
+ fprintf(STDCTR, "\n(leed_calc_amp_nd): Rmp:\n");
+ matshowabs(*p_Rmp);
+#endif
+
+/****************************************************************
+   Add the single layer matrices to the rest by layer doubling:
+   - if the current layer is the bottom-most (i_layer == 0),
+     the inter layer vector is calculated from the vectors between
+     top-most bulk layer and origin 
+     ( (bulk->layers + nlayers)->vec_to_next )
+     and origin and bottom-most overlayer
+     (over->layers + 0)->vec_from_last.
+
+   - inter layer vector is the vector between layers
+     (i_layer - 1) and (i_layer): (over->layers + i_layer)->vec_from_last
+**********************************************************************/
+
+    if(! stack_ok)
+    {
+      if (i_layer == 0)
+      {
+        for(i_c = 1; i_c <= 3; i_c ++)
+        {
+          vec[i_c] = (bulk->layers + bulk->nlayers - 1)->vec_to_next[i_c]
+                     + (over->layers + 0)->vec_from_last[i_c];
+        }
+
+#ifdef CONTROL_FLOW
+        fprintf(STDCTR, 
+                "(leed_calc_amp_nd):over0 before leed_ld_2lay_rpm vec..(%.2f %.2f %.2f)\n",
+                vec[1] * BOHR,vec[2] * BOHR, vec[3] * BOHR);
+#endif
+      }
+      else
+      {
+        for(i_c = 1; i_c <= 3; i_c ++)
+          vec[i_c] = (over->layers + i_layer)->vec_from_last[i_c];
+
+#ifdef CONTROL_FLOW
+        fprintf(STDCTR, 
+                "(leed_calc_amp_nd):over%d  before leed_ld_2lay_rpm vec..(%.2f %.2f %.2f)\n",
+                i_layer, vec[1] * BOHR, vec[2] * BOHR, vec[3] * BOHR); 
+#endif
+      }
+
+      if( (top_mode == LEED_TOP_COLUMN) && (i_layer == over->nlayers - 1) )
+        *p_R = leed_ld_2lay_rpm1(*p_R, R_prev, *p_Tpp, *p_Tmm, *p_Rpm, 
+                                 *p_Rmp, beams_now, vec);
+      else
+        *p_R = leed_ld_2lay_rpm(*p_R, R_prev, *p_Tpp, *p_Tmm, *p_Rpm, 
+                                *p_Rmp, beams_now, vec);
+      if(*p_R == NULL)
+      {
+        if(c_eng == NULL)
+        {
+          matfree(Tpp_s); matfree(Tmm_s); matfree(Rpm_s); matfree(Rmp_s);
+        }
+        if(Amp != NULL) matfree(Amp);
+        return(NULL);
+      }
+      leed_beam_prune_amp(rec, *p_R, 0, (i_layer < over->nlayers - 1)?
+                          (over->layers + i_layer + 1)->vec_from_last[3]:
+                          POT_STEP_Z);
+    }
+    R_prev = *p_R;
+
+ /**************************
+   Write cpu time to output
+ **************************/
+
+    sprintf(linebuffer,"(leed_calc_amp_nd): overlayer %d, E = %.1f", 
+            i_layer, energy * HART);
+    leed_cpu_time(STDCPU,linebuffer);
+
+  }  /* for i_layer (overlayer) */
+
+/*********************************************
+ Add propagation towards the potential step.
+**********************************************/
+
+  vec[1] = vec[2] = 0.;
+  vec[3] = POT_STEP_Z;
+
+/********************************************
+  No scattering at pot. step 
+  (R_prev is R_bulk if there is no overlayer)
+********************************************/
+
+  Amp = leed_ld_potstep0(Amp, R_prev, beams_now, v_par->eng_v, vec);
+
+  if(c_eng == NULL)
+  {
+    matfree(Tpp_s); matfree(Tmm_s); matfree(Rpm_s); matfree(Rmp_s);
+    matfree(R_tot);
+  }
+
+  return(Amp);
+} /* end of function leed_calc_over_nd */
+
+/*======================================================================*/
+
+static mat leed_calc_amp_core(mat Amp, 
+                     leed_beam_t **p_beams_now, int *p_n_beams_now,
+                     leed_cryst_t *bulk, leed_cryst_t *over,
+                     leed_phs_t *phs_shifts, leed_var_t *v_par,
+                     leed_beam_t *beams_all, int n_set, real energy,
+                     leed_calc_cache_t *cache, int i_eng,
+                     leed_prune_t *prune)
+
+/*********************************************************************
+  Calculate the amplitudes of all beams at a single energy 
+  (see leed_calc_amp_nd).
+
+  If cache is not NULL, the layer matrices of the previous call with
+  the same i_eng are taken from cache->eng[i_eng] as long as the 
+  geometry of the respective layers has not changed; the stack is
+  recalculated from the lowest changed layer upwards. The matrices of
+  this call are stored in cache->eng[i_eng].
+
+  If prune is not NULL, the beams with small amplitudes at the 
+  validation energy of the interval are removed from the selection; at
+  validation energies the amplitudes in R_bulk and R_tot are recorded
+  and the pruned beams of the interval are stored in prune 
+  (leed_beam_prune_amp, leed_beam_prune_update).
+
+*********************************************************************/
+{
+leed_beam_t *beams_now;
+leed_calc_eng_t *c_eng;
+leed_prune_amp_t rec;
+
+mat R_bulk;
+
+int i_c;
+int n_beams_now;
+int i_layer;
+int stack_ok;
+
+  R_bulk = NULL;
+  c_eng = NULL;
+
+  leed_par_update_nd(v_par, phs_shifts, energy);
+  n_beams_now = leed_beam_get_selection(p_beams_now, beams_all, v_par, bulk->dmin);
+  beams_now = *p_beams_now;
+  n_beams_now = leed_beam_prune(prune, &rec, energy, beams_now, n_beams_now);
+  if(p_n_beams_now != NULL) *p_n_beams_now = n_beams_now;
+
+#ifdef CONTROL
+  fprintf(STDCTR, "(leed_calc_amp_nd):\n\t => E = %.1f eV (%d beams used) <=\n\n",
+            v_par->eng_v*HART, n_beams_now);
+#endif
+
+/*********************************************************************
+  Find the stored matrices for this energy. They are discarded if 
+  energy, parameters or beams have changed.
+*********************************************************************/
+
+  if(cache != NULL)
+  {
+    if(i_eng >= cache->n_eng)
+    {
+      cache->eng = (leed_calc_eng_t *)realloc(cache->eng, 
+                              (i_eng + 1) * sizeof(leed_calc_eng_t));
+      memset(cache->eng + cache->n_eng, 0, 
+                     (i_eng + 1 - cache->n_eng) * sizeof(leed_calc_eng_t));
+      cache->n_eng = i_eng + 1;
+    }
+    c_eng = cache->eng + i_eng;
+
+    if( c_eng->spilled && 
+        ! leed_calc_eng_spill(c_eng, cache->scratch, i_eng, 1) )
+      leed_calc_eng_reset(c_eng, 0);
+
+    if(! leed_calc_eng_match(c_eng, energy, v_par, beams_now, n_beams_now,
+                             over->nlayers) )
+    {
+      leed_calc_eng_reset(c_eng, over->nlayers);
+
+      c_eng->energy = energy;
+      memcpy(&(c_eng->par), v_par, sizeof(leed_var_t));
+      c_eng->n_beams = n_beams_now;
+      c_eng->ind = (real *)malloc(2 * n_beams_now * sizeof(real));
+      for(i_c = 0; i_c < n_beams_now; i_c ++)
+      {
+        c_eng->ind[2*i_c]     = (beams_now + i_c)->ind_1;
+        c_eng->ind[2*i_c + 1] = (beams_now + i_c)->ind_2;
+      }
+    }
+  }
+
+/*********************************************************************
+BULK:
+  Reuse R_bulk if all bulk layers are unchanged.
+*********************************************************************/
+
+  stack_ok = 0;
+  if( (c_eng != NULL) && (c_eng->R_bulk != NULL) && 
+      (c_eng->n_bulk == bulk->nlayers) )
+  {
+    for(i_layer = 0, stack_ok = 1; 
+        (i_layer < bulk->nlayers) && stack_ok; i_layer ++)
+    {
+      stack_ok = 
+        leed_calc_layer_key(cache, c_eng->bulk + i_layer, 
+                            bulk->layers + i_layer) &&
+        leed_calc_vec_eq(c_eng->bulk[i_layer].vec_from_last,
+                         (bulk->layers + i_layer)->vec_from_last) &&
+        leed_calc_vec_eq(c_eng->bulk[i_layer].vec_to_next,
+                         (bulk->layers + i_layer)->vec_to_next);
+    }
+  }
+
+  if(c_eng == NULL)
+  {
+    R_bulk = leed_calc_bulk_nd(NULL, beams_now, n_beams_now, 
+                               bulk, v_par, n_set, energy);
+    if(R_bulk == NULL) 
+    {
+      leed_beam_prune_update(NULL, &rec, beams_now, n_beams_now);
+      return(NULL);
+    }
+  }
+  else if(stack_ok)
+  {
+    R_bulk = c_eng->R_bulk;
+    cache->n_reuse += bulk->nlayers;
+  }
+  else
+  {
+    R_bulk = c_eng->R_bulk = leed_calc_bulk_nd(c_eng->R_bulk, 
+                    beams_now, n_beams_now, bulk, v_par, n_set, energy);
+    if(R_bulk == NULL) 
+    {
+      leed_calc_eng_reset(c_eng, 0);
+      leed_beam_prune_update(NULL, &rec, beams_now, n_beams_now);
+      return(NULL);
+    }
+
+    c_eng->bulk = (leed_layer_t *)realloc(c_eng->bulk, 
+                               bulk->nlayers * sizeof(leed_layer_t));
+    for(i_layer = c_eng->n_bulk; i_layer < bulk->nlayers; i_layer ++)
+      c_eng->bulk[i_layer].atoms = NULL;
+    c_eng->n_bulk = bulk->nlayers;
+    for(i_layer = 0; i_layer < bulk->nlayers; i_layer ++)
+      leed_calc_layer_copy(c_eng->bulk + i_layer, bulk->layers + i_layer);
+    cache->n_calc += bulk->nlayers;
+  }
+
+/*********************************************************************
+OVERLAYER and propagation towards the potential step
+*********************************************************************/
+
+  leed_beam_prune_amp_bulk(&rec, R_bulk, beams_now, n_set,
+      (over->nlayers > 0)?
+      (bulk->layers + bulk->nlayers - 1)->vec_to_next[3] +
+      (over->layers + 0)->vec_from_last[3]: POT_STEP_Z);
+  Amp = leed_calc_over_nd(Amp, R_bulk, beams_now, bulk, over, v_par,
+                          energy, cache, c_eng, stack_ok, &rec);
+  if(Amp == NULL)
+  {
+    if(c_eng == NULL) matarrfree(R_bulk);
+    else              leed_calc_eng_reset(c_eng, 0);
+    leed_beam_prune_update(NULL, &rec, beams_now, n_beams_now);
+    return(NULL);
+  }
+  leed_beam_prune_update(prune, &rec, beams_now, n_beams_now);
+
+/*********************************************
+   Free local storage
+**********************************************/
+
+  if(c_eng == NULL)
+  {
+    matarrfree(R_bulk);
+  }
+  else if(cache->scratch != NULL)
+  {
+/* if writing fails, the matrices simply stay in memory */
+    leed_calc_eng_spill(c_eng, cache->scratch, i_eng, 0);
+  }
+
+  return(Amp);
+} /* end of function leed_calc_amp_core */
+
+/*======================================================================*/
+
+mat leed_calc_amp_nd(mat Amp, leed_beam_t **p_beams_now, int *p_n_beams_now,
+                     leed_cryst_t *bulk, leed_cryst_t *over,
+                     leed_phs_t *phs_shifts, leed_var_t *v_par,
+                     leed_beam_t *beams_all, int n_set, real energy)
+
+/*********************************************************************
+  Calculate the amplitudes of all beams at a single energy.
+
+ INPUT:
+
+  mat Amp - (output) amplitudes of the beams in *p_beams_now. If NULL,
+         the matrix is allocated.
+  leed_beam_t **p_beams_now - (output) beams included at this energy
+         (see leed_beam_get_selection).
+  int *p_n_beams_now - (output) number of beams in *p_beams_now 
+         (can be NULL).
+  leed_cryst_t *bulk, *over - bulk and overlayer parameters.
+  leed_phs_t *phs_shifts - phase shifts.
+  leed_var_t *v_par - (input/output) parameters; updated for the
+         current energy (leed_par_update_nd).
+  leed_beam_t *beams_all - all beams at the highest energy
+         (leed_beam_gen).
+  int n_set - number of beam sets (return value of leed_beam_gen).
+  real energy - vacuum energy (Hartree).
+
+ DESIGN:
+
+  mk_cg_coef and mk_ylm_coef must have been called for 2*v_par->l_max.
+
+  Bulk: the beam sets do not couple; the reflection matrix of each set
+  is calculated by layer doubling (concurrently if compiled with
+  OpenMP) and stored as one block of the block-diagonal matrix R_bulk.
+  Overlayer: the layers are added on top of the bulk by layer doubling.
+  Finally the amplitudes are propagated towards the potential step.
+
+  All matrices except Amp are local to the function call (see 
+  leed_calc_iv_delta_nd for keeping them). No beam pruning (see 
+  leed_calc_int_list_nd).
+
+ RETURN VALUE:
+
+  Amp (NULL if failed and EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+  return(leed_calc_amp_core(Amp, p_beams_now, p_n_beams_now, bulk, over,
+                            phs_shifts, v_par, beams_all, n_set, energy,
+                            NULL, 0, NULL));
+} /* end of function leed_calc_amp_nd */
+
+
+/*======================================================================*/
+
+int leed_calc_beams_nd(leed_beam_t **p_beams_all, leed_beam_t **p_beams_out,
+                       int *p_n_set, leed_cryst_t *bulk, leed_var_t *v_par,
+                       leed_energy_t *eng)
+
+/*********************************************************************
+  Create the lists of beams for an energy range.
+
+ INPUT:
+
+  leed_beam_t **p_beams_all - (output) all beams at eng->fin 
+         (leed_beam_gen).
+  leed_beam_t **p_beams_out - (output) non-evanescent beams at eng->fin,
+         i.e. the beams for which intensities are calculated
+         (leed_output_beam_list).
+  int *p_n_set - (output) number of beam sets.
+  leed_cryst_t *bulk - bulk parameters.
+  leed_var_t *v_par - parameters.
+  leed_energy_t *eng - energy range.
+
+ DESIGN:
+
+  Also prepares the Clebsh-Gordan and Ylm coefficients for 
+  2*v_par->l_max (mk_cg_coef, mk_ylm_coef).
+
+ RETURN VALUE:
+
+  number of output beams.
+
+*********************************************************************/
+{
+ *p_n_set = leed_beam_gen(p_beams_all, bulk, v_par, eng->fin);
+
+ mk_cg_coef (2*v_par->l_max);
+ mk_ylm_coef(2*v_par->l_max);
+
+ return(leed_output_beam_list(p_beams_out, *p_beams_all, eng, NULL));
+} /* end of function leed_calc_beams_nd */
+
+/*======================================================================*/
+
+int leed_calc_n_eng(leed_energy_t *eng)
+
+/*********************************************************************
+  Number of energies in the energy range eng.
+
+  The energies are eng->ini + i*eng->stp up to eng->fin (+ E_TOLERANCE),
+  as in leed_calc_iv_delta_nd; cleed_nsym builds its list of energies
+  with this number.
+
+*********************************************************************/
+{
+int n_eng;
+real energy;
+
+ for( energy = eng->ini, n_eng = 0; 
+      energy < eng->fin + E_TOLERANCE; 
+      energy += eng->stp, n_eng ++)
+   ;
+
+ return(n_eng);
+} /* end of function leed_calc_n_eng */
+
+/*======================================================================*/
+
+int leed_calc_iv_nd(real *int_buf, int buf_size,
+                    leed_beam_t *beams_all, int n_set, leed_beam_t *beams_out,
+                    leed_cryst_t *bulk, leed_cryst_t *over,
+                    leed_phs_t *phs_shifts, leed_var_t *v_par,
+                    leed_energy_t *eng)
+
+/*********************************************************************
+  Calculate the intensities of the output beams for an energy range.
+
+ INPUT:
+
+  real *int_buf - (output) intensities: int_buf[i_eng*n_out + i_beam]
+         is the intensity of beam i_beam of beams_out at energy
+         eng->ini + i_eng*eng->stp (n_out = number of beams in
+         beams_out).
+  int buf_size - number of elements available in int_buf; must be at
+         least leed_calc_n_eng(eng) * n_out.
+  leed_beam_t *beams_all, int n_set, leed_beam_t *beams_out -
+         beams as created by leed_calc_beams_nd.
+  leed_cryst_t *bulk, *over, leed_phs_t *phs_shifts, leed_var_t *v_par -
+         parameters (see leed_calc_amp_nd).
+  leed_energy_t *eng - energy range.
+
+ RETURN VALUE:
+
+  number of energies.
+  -1 if failed (and EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+ return(leed_calc_iv_delta_nd(int_buf, buf_size, beams_all, n_set, 
+                              beams_out, bulk, over, phs_shifts, v_par, 
+                              eng, NULL));
+} /* end of function leed_calc_iv_nd */
+
+/*======================================================================*/
+
+int leed_calc_iv_delta_nd(real *int_buf, int buf_size,
+                    leed_beam_t *beams_all, int n_set, leed_beam_t *beams_out,
+                    leed_cryst_t *bulk, leed_cryst_t *over,
+                    leed_phs_t *phs_shifts, leed_var_t *v_par,
+                    leed_energy_t *eng, leed_calc_cache_t **p_cache)
+
+/*********************************************************************
+  Calculate the intensities of the output beams for an energy range
+  reusing the layer matrices of the previous call (delta mode).
+
+ INPUT:
+
+  real *int_buf, int buf_size, ... leed_energy_t *eng - 
+         see leed_calc_iv_nd.
+  leed_calc_cache_t **p_cache - (input/output) layer matrices of the 
+         previous call. If *p_cache is NULL, memory is allocated
+         (leed_calc_cache_alloc(NULL)). 
+         If p_cache is NULL, nothing is stored (same as 
+         leed_calc_iv_nd).
+
+ DESIGN:
+
+  For each energy, R_bulk, the matrices Tpp, Tmm, Rpm, Rmp of each 
+  overlayer layer and the reflection matrix of the stack up to each
+  overlayer layer are stored in (*p_cache)->eng[i_eng] together with 
+  the geometry they were calculated for. In the next call, only the 
+  matrices of layers whose atoms (positions, Debye-Waller factors, 
+  types of t matrix or phase shifts) have changed are recalculated, and 
+  layer doubling is repeated only from the lowest changed layer or 
+  inter layer vector upwards. This is the typical situation in a 
+  structure search where only a few coordinates of the top-most 
+  layers change between successive evaluations.
+
+  The stored matrices are discarded automatically if energy, beams, 
+  the number of overlayer layers or the parameters in v_par change.
+  With domain averaging (over->n_dom > 0) nothing is stored
+  (leed_calc_int_dom_nd).
+  The phase shifts of the previous call are kept in the cache and 
+  compared set by set (phase shifts, displacements, i.e. temperature,
+  and, for the average t matrix, concentrations); a layer containing 
+  an atom with changed phase shifts is recalculated.
+
+ RETURN VALUE:
+
+  number of energies.
+  -1 if failed (and EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+int n_out, n_eng, i_eng;
+
+real energy;
+
+mat Amp;
+leed_beam_t *beams_now;
+leed_calc_cache_t *cache;
+
+ for(n_out = 0; 
+     ! IS_EQUAL_REAL((beams_out + n_out)->k_par, F_END_OF_LIST); n_out ++)
+   ;
+ n_eng = leed_calc_n_eng(eng);
+
+ if(n_eng * n_out > buf_size)
+ {
+#ifdef ERROR
+   fprintf(STDERR, 
+   "*** error (leed_calc_iv_nd): buffer too small (%d < %d * %d)\n",
+   buf_size, n_eng, n_out);
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+ cache = NULL;
+ if(p_cache != NULL)
+ {
+   if(*p_cache == NULL) *p_cache = leed_calc_cache_alloc(NULL);
+   cache = *p_cache;
+   leed_calc_phs_key(cache, phs_shifts);
+ }
+
+ Amp = NULL;
+ beams_now = NULL;
+
+ for( energy = eng->ini, i_eng = 0; 
+      energy < eng->fin + E_TOLERANCE; 
+      energy += eng->stp, i_eng ++)
+ {
+   if(over->n_dom > 0)
+   {
+     if(leed_calc_int_dom_nd(int_buf + i_eng*n_out, &beams_now, NULL, 
+                             beams_out, bulk, over, phs_shifts, v_par, 
+                             beams_all, n_set, energy) < 0)
+     {
+       free(beams_now);
+       return(-1);
+     }
+     continue;
+   }
+
+   Amp = leed_calc_amp_core(Amp, &beams_now, NULL, bulk, over, phs_shifts, 
+                            v_par, beams_all, n_set, energy, cache, i_eng,
+                            NULL);
+   if(Amp == NULL) 
+   {
+     free(beams_now);
+     return(-1);
+   }
+   leed_output_int_buf(int_buf + i_eng*n_out, Amp, beams_now, beams_out, 
+                       v_par);
+ }
+
+#ifdef CONTROL
+ if(cache != NULL)
+   fprintf(STDCTR, "(leed_calc_iv_delta_nd): %d layers calculated, "
+                   "%d layers reused\n", cache->n_calc, cache->n_reuse);
+#endif
+
+ if(Amp != NULL) matfree(Amp);
+ free(beams_now);
+ leed_ms_ymat_cache_free();
+
+ return(n_eng);
+} /* end of function leed_calc_iv_delta_nd */
+
+/*======================================================================*/
+
+leed_calc_cache_t *leed_calc_cache_alloc(const char *scratch)
+
+/*********************************************************************
+  Allocate the storage for leed_calc_iv_delta_nd.
+
+ INPUT:
+
+  const char *scratch - name prefix of scratch files. If not NULL, the 
+         matrices of each energy (R_bulk and the overlayer matrices) are
+         written to the file <scratch>.<i_eng> after use and read back 
+         in the next call (see leed_mem_plan_nd). Only the layer 
+         geometry stays in memory. If NULL, all matrices stay in memory.
+
+ RETURN VALUE:
+
+  pointer to the new structure.
+
+*********************************************************************/
+{
+leed_calc_cache_t *cache;
+
+ cache = (leed_calc_cache_t *)calloc(1, sizeof(leed_calc_cache_t));
+ if(scratch != NULL)
+ {
+   cache->scratch = (char *)malloc(strlen(scratch) + 1);
+   strcpy(cache->scratch, scratch);
+ }
+ return(cache);
+} /* end of function leed_calc_cache_alloc */
+
+/*======================================================================*/
+
+void leed_calc_cache_free(leed_calc_cache_t *cache)
+
+/*********************************************************************
+  Free the layer matrices stored by leed_calc_iv_delta_nd and the 
+  structure cache itself; remove the scratch files.
+*********************************************************************/
+{
+int i_eng;
+char scr_file[STRSZ];
+
+ if(cache == NULL) return;
+
+ for(i_eng = 0; i_eng < cache->n_eng; i_eng ++)
+ {
+   if(cache->scratch != NULL)
+   {
+     sprintf(scr_file, "%s.%d", cache->scratch, i_eng);
+     remove(scr_file);
+   }
+   leed_calc_eng_reset(cache->eng + i_eng, 0);
+ }
+
+ leed_calc_phs_free(cache);
+ free(cache->eng);
+ free(cache->scratch);
+ free(cache);
+} /* end of function leed_calc_cache_free */
+
+/*======================================================================*/
+
+int leed_calc_int_dom_nd(real *int_buf, 
+                     leed_beam_t **p_beams_now, int *p_n_beams_now,
+                     leed_beam_t *beams_out,
+                     leed_cryst_t *bulk, leed_cryst_t *over,
+                     leed_phs_t *phs_shifts, leed_var_t *v_par,
+                     leed_beam_t *beams_all, int n_set, real energy)
+
+/*********************************************************************
+  Calculate the domain averaged intensities of the output beams at a 
+  single energy.
+
+ INPUT:
+
+  real *int_buf - (output) intensities of the beams in beams_out (see
+         leed_output_int_buf).
+  leed_beam_t **p_beams_now, int *p_n_beams_now - (output) beams 
+         included at this energy (see leed_calc_amp_nd).
+  leed_beam_t *beams_out - output beams.
+  leed_cryst_t *bulk, *over, leed_phs_t *phs_shifts, leed_var_t *v_par,
+  leed_beam_t *beams_all, int n_set, real energy - see 
+         leed_calc_amp_nd. over->n_dom and over->dom contain the domain
+         operations and weights.
+
+ DESIGN:
+
+  R_bulk is calculated once (leed_calc_bulk_nd). The overlayer of each
+  domain (leed_dom_over_nd) is added by leed_calc_over_nd; the domains
+  are independent and calculated concurrently if compiled with OpenMP.
+  The intensities are averaged incoherently:
+
+    I(g) = S[ w_d * I_d(g) ] / S[ w_d ]
+
+ RETURN VALUE:
+
+  number of output beams.
+  -1 if failed (and EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+int i_dom, i_out, n_out;
+int n_beams_now;
+int err;
+
+real w_tot;
+real *int_dom;
+
+mat R_bulk;
+leed_beam_t *beams_now;
+
+  leed_par_update_nd(v_par, phs_shifts, energy);
+  n_beams_now = leed_beam_get_selection(p_beams_now, beams_all, v_par, bulk->dmin);
+  beams_now = *p_beams_now;
+  if(p_n_beams_now != NULL) *p_n_beams_now = n_beams_now;
+
+  for(n_out = 0; 
+      ! IS_EQUAL_REAL((beams_out + n_out)->k_par, F_END_OF_LIST); n_out ++)
+    ;
+
+  R_bulk = leed_calc_bulk_nd(NULL, beams_now, n_beams_now, 
+                             bulk, v_par, n_set, energy);
+  int_dom = (real *)calloc(over->n_dom * n_out + 1, sizeof(real));
+  if( (R_bulk == NULL) || (int_dom == NULL) )
+  {
+#ifdef ERROR
+    fprintf(STDERR, "*** error (leed_calc_int_dom_nd): "
+            "bulk calculation or allocation failed\n");
+#endif
+    matarrfree(R_bulk);
+    free(int_dom);
+#ifdef EXIT_ON_ERROR
+    exit(1);
+#else
+    return(-1);
+#endif
+  }
+
+/*********************************************************************
+  Overlayer of all domains
+*********************************************************************/
+
+  err = 0;
+#ifdef _USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for(i_dom = 0; i_dom < over->n_dom; i_dom ++)
+  {
+  leed_cryst_t over_dom;
+  mat Amp;
+
+    if(leed_dom_over_nd(&over_dom, over, over->dom + i_dom) < 0)
+    {
+#ifdef _USE_OPENMP
+#pragma omp atomic write
+#endif
+      err = 1;
+      continue;
+    }
+
+    Amp = leed_calc_over_nd(NULL, R_bulk, beams_now, bulk, &over_dom, v_par,
+                            energy, NULL, NULL, 0, NULL);
+    if(Amp == NULL)
+    {
+#ifdef _USE_OPENMP
+#pragma omp atomic write
+#endif
+      err = 1;
+    }
+    else
+      leed_output_int_buf(int_dom + i_dom * n_out, Amp, beams_now, beams_out,
+                          v_par);
+
+    matfree(Amp);
+    leed_dom_over_free_nd(&over_dom);
+  }
+
+  matarrfree(R_bulk);
+
+  if(err)
+  {
+    free(int_dom);
+#ifdef EXIT_ON_ERROR
+    exit(1);
+#else
+    return(-1);
+#endif
+  }
+
+/*********************************************************************
+  Average of the intensities
+*********************************************************************/
+
+  w_tot = 0.;
+  for(i_dom = 0; i_dom < over->n_dom; i_dom ++)
+    w_tot += over->dom[i_dom].weight;
+
+  for(i_out = 0; i_out < n_out; i_out ++)
+  {
+    int_buf[i_out] = 0.;
+    for(i_dom = 0; i_dom < over->n_dom; i_dom ++)
+      int_buf[i_out] += over->dom[i_dom].weight * int_dom[i_dom*n_out + i_out];
+    int_buf[i_out] /= w_tot;
+  }
+
+  free(int_dom);
+  return(n_out);
+} /* end of function leed_calc_int_dom_nd */
+
+/*======================================================================*/
+
+int leed_calc_int_list_nd(real *int_buf, real *energies, int n_eng,
+                     leed_beam_t *beams_all, int n_set, leed_beam_t *beams_out,
+                     leed_cryst_t *bulk, leed_cryst_t *over,
+                     leed_phs_t *phs_shifts, leed_var_t *v_par,
+                     leed_prune_t *prune)
+
+/*********************************************************************
+  Calculate the intensities of the output beams for a list of energies.
+
+ INPUT:
+
+  real *int_buf - (output) intensities: int_buf[i_eng*n_out + i_beam]
+         is the intensity of beam i_beam of beams_out at energy
+         energies[i_eng] (n_out = number of beams in beams_out).
+  real *energies - vacuum energies (Hartree), distinct, in any order.
+  int n_eng - number of energies.
+  leed_beam_t *beams_all, int n_set, leed_beam_t *beams_out, 
+  leed_cryst_t *bulk, *over, leed_phs_t *phs_shifts - see 
+         leed_calc_iv_nd.
+  leed_var_t *v_par - parameters; only used as template, each energy
+         (thread) works on its own copy with its own t matrices.
+  leed_prune_t *prune - (input/output) beam pruning context of the
+         energy grid (leed_beam_prune_alloc); NULL: no pruning.
+
+ DESIGN:
+
+  The energies are independent and calculated concurrently if compiled
+  with OpenMP (dynamic schedule, the cost grows with the number of 
+  beams). If worker processes are set (leed_farm_mode), the energies
+  are distributed to these (leed_calc_int_farm_nd) instead. With 
+  domains (over->n_dom > 0) the domain averaged intensities are 
+  calculated (leed_calc_int_dom_nd), without pruning.
+
+  With beam pruning the energies are calculated in two stages 
+  (leed_beam_prune_plan): first the validation energies of the 
+  intervals which are not validated yet in prune (also those which are
+  not in the list; their intensities are not used) together with the
+  energies of validated intervals, then the remaining energies.
+
+ RETURN VALUE:
+
+  number of energies.
+  -1 if failed (and EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+int i_eng, n_out, n_phs, n_proc, n_extra;
+int err;
+int *stage;
+real *e_extra;
+
+ if( (n_eng > 1) && ((n_proc = leed_farm_mode(-1)) > 1) )
+   return(leed_calc_int_farm_nd(int_buf, energies, n_eng, beams_all, n_set,
+                          beams_out, bulk, over, phs_shifts, v_par, prune,
+                          n_proc, NULL));
+
+ for(n_out = 0; 
+     ! IS_EQUAL_REAL((beams_out + n_out)->k_par, F_END_OF_LIST); n_out ++)
+   ;
+ for(n_phs = 0; (phs_shifts + n_phs)->lmax != I_END_OF_LIST; n_phs ++)
+   ;
+
+ if(over->n_dom > 0) prune = NULL;
+
+ n_extra = 0;
+ e_extra = NULL;
+ stage = NULL;
+ if(prune != NULL)
+ {
+   stage = (int *)malloc((n_eng + 1) * sizeof(int));
+   if(stage == NULL)
+   {
+#ifdef ERROR
+     fprintf(STDERR, "*** error (leed_calc_int_list_nd): allocation error\n");
+#endif
+#ifdef EXIT_ON_ERROR
+     exit(1);
+#else
+     return(-1);
+#endif
+   }
+   n_extra = leed_beam_prune_plan(prune, energies, n_eng, stage, &e_extra);
+ }
+
+ err = 0;
+
+#ifdef _USE_OPENMP
+#pragma omp parallel
+#endif
+ {
+ leed_var_t v_loc;
+ leed_beam_t *beams_now;
+ mat Amp;
+ int i_phs, i_stage;
+ real energy;
+
+   memcpy(&v_loc, v_par, sizeof(leed_var_t));
+   v_loc.p_tl = NULL;
+   beams_now = NULL;
+   Amp = NULL;
+
+   for(i_stage = 0; i_stage < ((stage != NULL)? 2: 1); i_stage ++)
+   {
+/* energies of the list, then the additional validation energies */
+#ifdef _USE_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+     for(i_eng = 0; i_eng < n_eng + n_extra; i_eng ++)
+     {
+       if(i_eng < n_eng)
+       {
+         if( (stage != NULL) && (stage[i_eng] != i_stage) ) continue;
+         energy = energies[i_eng];
+       }
+       else
+       {
+         if(i_stage > 0) continue;
+         energy = e_extra[i_eng - n_eng];
+       }
+
+       if(over->n_dom > 0)
+       {
+         if(leed_calc_int_dom_nd(int_buf + i_eng*n_out, &beams_now, NULL,
+                                 beams_out, bulk, over, phs_shifts, &v_loc,
+                                 beams_all, n_set, energy) < 0)
+         {
+#ifdef _USE_OPENMP
+#pragma omp atomic write
+#endif
+           err = 1;
+         }
+         continue;
+       }
+
+       Amp = leed_calc_amp_core(Amp, &beams_now, NULL, bulk, over, 
+                                phs_shifts, &v_loc, beams_all, n_set, 
+                                energy, NULL, 0, prune);
+       if(Amp == NULL)
+       {
+#ifdef _USE_OPENMP
+#pragma omp atomic write
+#endif
+         err = 1;
+         continue;
+       }
+       if(i_eng < n_eng)
+         leed_output_int_buf(int_buf + i_eng*n_out, Amp, beams_now, 
+                             beams_out, &v_loc);
+     }  /* for i_eng */
+   }  /* for i_stage */
+
+   if(Amp != NULL) matfree(Amp);
+   free(beams_now);
+   leed_ms_ymat_cache_free();           /* Ylm of this thread */
+   if(v_loc.p_tl != NULL)
+   {
+     for(i_phs = 0; i_phs < n_phs; i_phs ++) matfree(v_loc.p_tl[i_phs]);
+     free(v_loc.p_tl);
+   }
+ }  /* parallel */
+
+ free(stage);
+ free(e_extra);
+
+ if(err)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_calc_int_list_nd): "
+           "calculation failed\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+ return(n_eng);
+} /* end of function leed_calc_int_list_nd */
@@ -0,0 +1,310 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  leed_dom_check_nd
+    Check if the domain operations are compatible with the overlayer.
+  leed_dom_over_nd
+    Create the overlayer of a domain (transformed copy).
+  leed_dom_over_free_nd
+    Free the layers of an overlayer created by leed_dom_over_nd.
+
+  Domains of the overlayer which are related by a rotation or mirror
+  operation (input 'do', see leed_read_overlayer_nd) are treated as
+  incoherent: the intensities of all domains are averaged with the
+  weights of the domains. Only the overlayer is transformed; the bulk
+  is the same for all domains and its reflection matrix is calculated
+  only once per energy (leed_calc_int_dom_nd).
+
+  The operations must map the 2-dim. lattices of all overlayer layers
+  onto themselves, so that the list of beams is the same for all
+  domains. For domains with different superstructure cells (e.g.
+  rotated (2x1) domains) a common superstructure (e.g. (2x2)) must be
+  specified in the bulk input.
+
+Changes:
+  AG/17.10.26 - Creation
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "leed.h"
+
+#ifndef GEO_TOLERANCE           /* should be defined in "leed_def.h" */
+#define GEO_TOLERANCE 0.0001
+#endif
+
+/*======================================================================*/
+
+static void leed_dom_vec(real *vec, real *m)
+
+/*********************************************************************
+  Apply the 2x2 matrix m to the (x,y) components of vec (1=x, 2=y).
+*********************************************************************/
+{
+real x, y;
+
+ x = vec[1]; y = vec[2];
+ vec[1] = m[1]*x + m[2]*y;
+ vec[2] = m[3]*x + m[4]*y;
+} /* end of function leed_dom_vec */
+
+/*======================================================================*/
+
+static void leed_dom_cell(real *vec, real *a)
+
+/*********************************************************************
+  Move the (x,y) components of vec into the unit cell spanned by the
+  lattice vectors in a (as for the input positions in
+  leed_inp_over_setup_nd).
+*********************************************************************/
+{
+real det, n1, n2;
+
+ det = a[1]*a[4] - a[2]*a[3];
+ n1 = (real) floor( ( a[4]*vec[1] - a[2]*vec[2]) / det);
+ n2 = (real) floor( (-a[3]*vec[1] + a[1]*vec[2]) / det);
+
+ vec[1] -= n1*a[1] + n2*a[2];
+ vec[2] -= n1*a[3] + n2*a[4];
+} /* end of function leed_dom_cell */
+
+/*======================================================================*/
+
+static void leed_dom_short(real *vec, real *a)
+
+/*********************************************************************
+  Replace the (x,y) components of vec by the shortest equivalent vector
+  (adding -1, 0, 1 times the lattice vectors in a), in the same way as
+  for the inter layer vectors of the input (leed_inp_overlayer).
+*********************************************************************/
+{
+int i_c, i_d;
+real x, y, faux;
+
+ x = vec[1]; y = vec[2];
+ faux = SQUARE(x) + SQUARE(y);
+
+ for(i_c = -1; i_c <= 1; i_c ++)
+ for(i_d = -1; i_d <= 1; i_d ++)
+ {
+   if( ( SQUARE(x + i_c*a[1] + i_d*a[2]) +
+         SQUARE(y + i_c*a[3] + i_d*a[4]) ) < faux )
+   {
+     vec[1] = x + i_c*a[1] + i_d*a[2];
+     vec[2] = y + i_c*a[3] + i_d*a[4];
+     faux = SQUARE(vec[1]) + SQUARE(vec[2]);
+   }
+ }
+} /* end of function leed_dom_short */
+
+/*======================================================================*/
+
+int leed_dom_check_nd(leed_cryst_t *over)
+
+/*********************************************************************
+  Check if the domain operations are compatible with the overlayer.
+
+ INPUT:
+
+  leed_cryst_t *over - overlayer parameters including the domains
+         (over->n_dom, over->dom).
+
+ DESIGN:
+
+  For each layer with lattice A = (a1,a2) and operation M, the matrix
+  A^-1 M A must be integer, i.e. the transformed lattice vectors are
+  lattice vectors. Non-diagonal t matrices (anisotropic vibrations)
+  would have to be transformed as well and are not accepted.
+
+ RETURN VALUE:
+
+  1 if ok.
+ -1 if not (error message is printed).
+
+*********************************************************************/
+{
+int i_dom, i_layer, i_atoms, i_c;
+
+real det, faux, w_tot;
+real *a, *m;
+real ma[5], n[5];
+
+ w_tot = 0.;
+ for(i_dom = 0; i_dom < over->n_dom; i_dom ++)
+ {
+   m = over->dom[i_dom].m;
+   w_tot += over->dom[i_dom].weight;
+
+   for(i_layer = 0; i_layer < over->nlayers; i_layer ++)
+   {
+     a = (over->layers + i_layer)->a_lat;
+     det = a[1]*a[4] - a[2]*a[3];
+
+     /* ma = M * A */
+     ma[1] = m[1]*a[1] + m[2]*a[3]; ma[2] = m[1]*a[2] + m[2]*a[4];
+     ma[3] = m[3]*a[1] + m[4]*a[3]; ma[4] = m[3]*a[2] + m[4]*a[4];
+
+     /* n = A^-1 * ma */
+     n[1] = ( a[4]*ma[1] - a[2]*ma[3]) / det;
+     n[2] = ( a[4]*ma[2] - a[2]*ma[4]) / det;
+     n[3] = (-a[3]*ma[1] + a[1]*ma[3]) / det;
+     n[4] = (-a[3]*ma[2] + a[1]*ma[4]) / det;
+
+     for(i_c = 1; i_c <= 4; i_c ++)
+     {
+       faux = n[i_c] - R_nint(n[i_c]);
+       if(R_fabs(faux) > GEO_TOLERANCE)
+       {
+#ifdef ERROR
+         fprintf(STDERR, "*** error (leed_dom_check_nd): domain %d does not "
+                 "map the lattice of overlayer %d onto itself\n",
+                 i_dom + 1, i_layer);
+#endif
+         return(-1);
+       }
+     }
+
+     for(i_atoms = 0; i_atoms < (over->layers + i_layer)->natoms; i_atoms ++)
+     {
+       if( ((over->layers + i_layer)->atoms + i_atoms)->t_type == T_NOND)
+       {
+#ifdef ERROR
+         fprintf(STDERR, "*** error (leed_dom_check_nd): domains are not "
+                 "implemented for non-diagonal t matrices\n");
+#endif
+         return(-1);
+       }
+     }
+   } /* i_layer */
+ } /* i_dom */
+
+ if(w_tot <= 0.)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_dom_check_nd): sum of domain weights "
+           "is zero\n");
+#endif
+   return(-1);
+ }
+
+ return(1);
+} /* end of function leed_dom_check_nd */
+
+/*======================================================================*/
+
+int leed_dom_over_nd(leed_cryst_t *over_dom, leed_cryst_t *over,
+                     leed_domain_t *dom)
+
+/*********************************************************************
+  Create the overlayer of a domain.
+
+ INPUT:
+
+  leed_cryst_t *over_dom - (output) overlayer of the domain. The layers
+         and atoms are allocated (free with leed_dom_over_free_nd), all
+         other pointers are shared with over.
+  leed_cryst_t *over - overlayer parameters.
+  leed_domain_t *dom - domain operation.
+
+ DESIGN:
+
+  The (x,y) components of the atom positions and of the inter layer
+  vectors (including the vector from the origin to the bottom-most
+  overlayer) are transformed; the lattices of the layers are unchanged
+  (see leed_dom_check_nd). As in the input, the atoms of composite
+  layers are moved back into the unit cell and the inter layer vectors
+  are replaced by the shortest equivalent vectors afterwards (the
+  convergence of the lattice sums depends on this choice).
+
+ RETURN VALUE:
+
+  1 if ok.
+ -1 if failed (and EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+int i_layer, i_atoms;
+leed_layer_t *layer;
+
+ memcpy(over_dom, over, sizeof(leed_cryst_t));
+ over_dom->n_dom = 0;
+ over_dom->dom = NULL;
+
+ over_dom->layers = (leed_layer_t *)calloc(over->nlayers + 1,
+                                           sizeof(leed_layer_t));
+ if(over_dom->layers == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_dom_over_nd): allocation error\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+ for(i_layer = 0; i_layer < over->nlayers; i_layer ++)
+ {
+   layer = over_dom->layers + i_layer;
+   memcpy(layer, over->layers + i_layer, sizeof(leed_layer_t));
+
+   layer->atoms = (leed_atom_t *)malloc(layer->natoms * sizeof(leed_atom_t));
+   if(layer->atoms == NULL)
+   {
+     over_dom->nlayers = i_layer;
+     leed_dom_over_free_nd(over_dom);
+#ifdef ERROR
+     fprintf(STDERR, "*** error (leed_dom_over_nd): allocation error\n");
+#endif
+#ifdef EXIT_ON_ERROR
+     exit(1);
+#else
+     return(-1);
+#endif
+   }
+   memcpy(layer->atoms, (over->layers + i_layer)->atoms,
+          layer->natoms * sizeof(leed_atom_t));
+
+   for(i_atoms = 0; i_atoms < layer->natoms; i_atoms ++)
+   {
+     leed_dom_vec((layer->atoms + i_atoms)->pos, dom->m);
+     if(layer->natoms > 1)
+       leed_dom_cell((layer->atoms + i_atoms)->pos, layer->a_lat);
+   }
+
+   leed_dom_vec(layer->vec_to_next, dom->m);
+   leed_dom_short(layer->vec_to_next, layer->a_lat);
+
+   if(i_layer == 0)
+     leed_dom_vec(layer->vec_from_last, dom->m);
+   else
+     memcpy(layer->vec_from_last, (layer-1)->vec_to_next, 4*sizeof(real));
+ }
+
+ return(1);
+} /* end of function leed_dom_over_nd */
+
+/*======================================================================*/
+
+void leed_dom_over_free_nd(leed_cryst_t *over_dom)
+
+/*********************************************************************
+  Free the layers and atoms of an overlayer created by
+  leed_dom_over_nd (not the structure itself).
+*********************************************************************/
+{
+int i_layer;
+
+ if(over_dom->layers == NULL) return;
+
+ for(i_layer = 0; i_layer < over_dom->nlayers; i_layer ++)
+   free((over_dom->layers + i_layer)->atoms);
+ free(over_dom->layers);
+ over_dom->layers = NULL;
+} /* end of function leed_dom_over_free_nd */
@@ -0,0 +1,355 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  leed_farm_mode
+    Set the number of worker processes for lists of energies.
+  leed_calc_int_farm_nd
+    Calculate the intensities for a list of energies in worker
+    processes.
+
+  Alternative to the OpenMP parallelisation of the energies: several
+  routines keep global state (C.G. coefficients, lattice sums, CPU time
+  etc.) which is not thread safe. The coordinator process reads the
+  input and sets up all tables, then forks n_proc worker processes.
+  The workers share the tables copy-on-write, take energies one at a
+  time from a shared counter (dynamic distribution) and store the
+  intensities in a shared memory array. With beam pruning a worker
+  takes all energies of a validation interval at a time. The coordinator writes the
+  lines of intensities in the order of the energy list as soon as they
+  are available.
+
+  Only on POSIX systems (fork, mmap); otherwise the energies are
+  calculated by leed_calc_int_list_nd.
+
+Changes:
+  AG/17.10.26 - Creation
+  AG/17.10.26 - beam pruning: energies distributed in validation
+                intervals, each worker with its copy of the context.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+
+#include "leed.h"
+
+#ifdef _USE_OPENMP
+#include <omp.h>        /* compile with '-fopenmp' */
+#endif
+
+#define FARM_POLL_NS 10000000L      /* 10 ms between checks for results */
+
+/* state of an energy in the shared memory */
+#define FARM_OPEN    0
+#define FARM_DONE    1
+#define FARM_FAILED -1
+
+static int farm_n_proc = 0;
+
+/*======================================================================*/
+
+int leed_farm_mode(int n_proc)
+
+/*********************************************************************
+  Set the number of worker processes for lists of energies.
+
+ INPUT:
+
+  int n_proc - number of worker processes used by leed_calc_int_list_nd
+         (and therefore the adaptive energy grid). n_proc <= 1 switches
+         the worker processes off (default). Negative values leave the
+         setting unchanged. Always off without fork (_WIN32).
+
+  The setting is global and should be made before any parallel region.
+
+ RETURN VALUE:
+
+  previous number of worker processes.
+
+*********************************************************************/
+{
+int old_n_proc;
+
+ old_n_proc = farm_n_proc;
+#ifndef _WIN32
+ if(n_proc >= 0) farm_n_proc = (n_proc > 1)? n_proc: 0;
+#endif
+ return(old_n_proc);
+} /* end of function leed_farm_mode */
+
+/*======================================================================*/
+
+int leed_calc_int_farm_nd(real *int_buf, real *energies, int n_eng,
+                    leed_beam_t *beams_all, int n_set, leed_beam_t *beams_out,
+                    leed_cryst_t *bulk, leed_cryst_t *over,
+                    leed_phs_t *phs_shifts, leed_var_t *v_par,
+                    leed_prune_t *prune, int n_proc, FILE *res_stream)
+
+/*********************************************************************
+  Calculate the intensities of the output beams for a list of energies
+  in worker processes.
+
+ INPUT:
+
+  real *int_buf - (output) intensities: int_buf[i_eng*n_out + i_beam]
+         (see leed_calc_int_list_nd). May be NULL if only res_stream
+         is needed.
+  real *energies - vacuum energies (Hartree), in output order.
+  int n_eng - number of energies.
+  leed_beam_t *beams_all, int n_set, leed_beam_t *beams_out,
+  leed_cryst_t *bulk, *over, leed_phs_t *phs_shifts,
+  leed_var_t *v_par - see leed_calc_int_list_nd. v_par->eng_v is
+         changed if res_stream is not NULL.
+  leed_prune_t *prune - beam pruning context (see 
+         leed_calc_int_list_nd); NULL: no pruning.
+  int n_proc - number of worker processes.
+  FILE *res_stream - if not NULL, a line of intensities is written
+         (leed_output_int_list) and flushed for each energy, in the
+         order of energies.
+
+ DESIGN:
+
+  One shared memory block (anonymous mmap) holds the counter of the
+  next open block of energies, the state of each energy and the 
+  intensities. Each worker calculates blocks of energies 
+  (leed_calc_int_list_nd) until the counter reaches the number of
+  blocks, then exits. A worker writes the state of an energy after its
+  intensities.
+  A block is a single energy or, with beam pruning, the consecutive
+  energies of the list in the same validation interval. The pruned
+  beams of an interval depend only on its validation energy, which the
+  worker calculates if needed (the contexts of the workers are copies
+  and are not returned to the coordinator).
+
+  The coordinator writes the completed energies in order while the
+  workers run. Energies which are still open when all workers have
+  terminated (e.g. a worker was killed) or for which no worker could be
+  started are calculated by the coordinator.
+
+ RETURN VALUE:
+
+  number of energies.
+  -1 if failed (and EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+int i_next, n_out, err;
+
+#ifdef _WIN32
+real *buf;
+#else
+int i_eng, i_blk, i_proc, n_alive, n_blk;
+int *next, *blk;
+volatile int *state;
+real *shm_int;
+size_t shm_size;
+char *shm;
+
+pid_t pid;
+struct timespec t_poll;
+#endif
+
+ for(n_out = 0;
+     ! IS_EQUAL_REAL((beams_out + n_out)->k_par, F_END_OF_LIST); n_out ++)
+   ;
+
+#ifdef _WIN32
+
+/*********************************************************************
+  No fork: all energies in this process
+*********************************************************************/
+
+ buf = (int_buf != NULL)? int_buf:
+       (real *)malloc((size_t)(n_eng * n_out + 1) * sizeof(real));
+ err = (buf == NULL) ||
+       (leed_calc_int_list_nd(buf, energies, n_eng, beams_all, n_set,
+                        beams_out, bulk, over, phs_shifts, v_par, prune) < 0);
+
+ for(i_next = 0; (! err) && (res_stream != NULL) && (i_next < n_eng);
+     i_next ++)
+ {
+   v_par->eng_v = energies[i_next];
+   leed_output_int_list(buf + i_next*n_out, n_out, v_par, res_stream);
+ }
+ if(res_stream != NULL) fflush(res_stream);
+ if(buf != int_buf) free(buf);
+ i_next = n_eng;
+
+#else
+
+/*********************************************************************
+  Blocks of energies: blk[i_blk] is the first energy of block i_blk
+*********************************************************************/
+
+ blk = (int *)malloc((n_eng + 1) * sizeof(int));
+ if(blk == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_calc_int_farm_nd): allocation error\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+ for(i_eng = 0, n_blk = 0; i_eng < n_eng; i_eng ++)
+   if( (i_eng == 0) || (prune == NULL) ||
+       (leed_beam_prune_int(prune, energies[i_eng]) != 
+        leed_beam_prune_int(prune, energies[i_eng - 1])) )
+     blk[n_blk ++] = i_eng;
+ blk[n_blk] = n_eng;
+
+/*********************************************************************
+  Shared memory: counter, state of each energy, intensities
+*********************************************************************/
+
+ shm_size = sizeof(real) * (size_t)(n_eng * n_out + 1) +
+            sizeof(int) * (size_t)(n_eng + 2);
+ shm = (char *)mmap(NULL, shm_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+ if(shm == (char *)MAP_FAILED)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_calc_int_farm_nd): "
+           "could not allocate shared memory\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   free(blk);
+   return(-1);
+#endif
+ }
+
+ /* mmap memory is zero: counter 0, all energies FARM_OPEN */
+ shm_int = (real *)shm;
+ next  = (int *)(shm + sizeof(real) * (size_t)(n_eng * n_out + 1));
+ state = next + 1;
+
+/*********************************************************************
+  Start workers
+  (flush all streams first, otherwise the buffers are written twice)
+*********************************************************************/
+
+ fflush(NULL);
+
+ n_alive = 0;
+ for(i_proc = 0; i_proc < n_proc; i_proc ++)
+ {
+   pid = fork();
+   if(pid < 0)
+   {
+#ifdef WARNING
+     fprintf(STDWAR, "* warning (leed_calc_int_farm_nd): "
+             "only %d of %d worker processes started\n", n_alive, n_proc);
+#endif
+     break;
+   }
+
+   if(pid == 0)
+   {
+     /* worker */
+     leed_farm_mode(0);
+#ifdef _USE_OPENMP
+     omp_set_num_threads(1);
+#endif
+     while( (i_blk = __sync_fetch_and_add(next, 1)) < n_blk )
+     {
+       i_eng = blk[i_blk];
+       err = leed_calc_int_list_nd(shm_int + i_eng*n_out, energies + i_eng, 
+                        blk[i_blk + 1] - i_eng, beams_all, n_set, beams_out,
+                        bulk, over, phs_shifts, v_par, prune);
+       __sync_synchronize();
+       for( ; i_eng < blk[i_blk + 1]; i_eng ++)
+         state[i_eng] = (err < 0)? FARM_FAILED: FARM_DONE;
+     }
+     fflush(NULL);
+     _exit(0);
+   }
+
+   n_alive ++;
+ }
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(leed_calc_int_farm_nd): %d energies, %d workers\n",
+         n_eng, n_alive);
+#endif
+
+/*********************************************************************
+  Coordinator: write the energies in order as they are completed.
+*********************************************************************/
+
+ t_poll.tv_sec = 0;
+ t_poll.tv_nsec = FARM_POLL_NS;
+
+ err = 0;
+ for(i_next = 0; i_next < n_eng; )
+ {
+   if(state[i_next] != FARM_OPEN)
+   {
+     __sync_synchronize();
+     if(state[i_next] == FARM_FAILED) err = 1;
+     else if(res_stream != NULL)
+     {
+       v_par->eng_v = energies[i_next];
+       leed_output_int_list(shm_int + i_next*n_out, n_out, v_par, res_stream);
+       fflush(res_stream);     /* output file is the checkpoint */
+     }
+     i_next ++;
+   }
+   else if(n_alive > 0)
+   {
+     pid = waitpid(-1, NULL, WNOHANG);
+     if(pid > 0) n_alive --;
+     else if(pid == 0) nanosleep(&t_poll, NULL);
+     else n_alive = 0;              /* no more children */
+   }
+   else
+   {
+     /* no workers left: calculate the energy here */
+#ifdef WARNING
+     fprintf(STDWAR, "* warning (leed_calc_int_farm_nd): E = %.2f eV "
+             "not calculated by a worker\n", energies[i_next]*HART);
+#endif
+     state[i_next] = (leed_calc_int_list_nd(shm_int + i_next*n_out,
+                        energies + i_next, 1, beams_all, n_set, beams_out,
+                        bulk, over, phs_shifts, v_par, prune) < 0)?
+                     FARM_FAILED: FARM_DONE;
+   }
+ }
+
+ while( (n_alive > 0) && (waitpid(-1, NULL, 0) > 0) ) n_alive --;
+
+ if(int_buf != NULL)
+   memcpy(int_buf, shm_int, (size_t)(n_eng * n_out) * sizeof(real));
+ munmap(shm, shm_size);
+ free(blk);
+
+#endif /* _WIN32 */
+
+ if(err)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_calc_int_farm_nd): "
+           "calculation failed\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+ return(i_next);
+} /* end of function leed_calc_int_farm_nd */
@@ -9,6 +9,13 @@ LD/24.04.14
      Provides version information then exits
   
 Changes:
+AG/17.10.26 - option -m (memory budget).
+AG/17.10.26 - restart and energy shard options.
+AG/17.10.26 - option -p (beam pruning).
+AG/17.10.26 - option -c (output beams from R factor control file).
+AG/17.10.26 - option -j (worker processes).
+AG/17.10.26 - option -a (adaptive energy grid); all options in the
+              usage line.
 
 *********************************************************************/
 
@@ -17,12 +24,27 @@ Changes:
 
 void usage(FILE *output) {
     fprintf(output,"\tusage: \t%s -i <par_file> -o <res_file>", PROG);
-    fprintf(output," [-b <bul_file> -e]\n"); 
+    fprintf(output," [-b <bul_file> -c <ctr_file> -m <budget> -a <tol>");
+    fprintf(output," -p <eps> -j <n_proc> -e]\n"); 
     fprintf(output, "Options:\n");
     fprintf(output, "  -i <par_file>        : filepath to parameter input file\n");
     fprintf(output, "  -o <res_file>        : filepath to output file\n");
     fprintf(output, "  -b <bul_file>        : filepath to bulk parameter file\n");
+    fprintf(output, "  -c <ctr_file>        : write only the beams used in R factor control file\n");
+    fprintf(output, "  -m <budget>          : memory budget in MB (in-place matrix inversion and\n");
+    fprintf(output, "                         fewer threads; nothing is spilled to scratch files)\n");
+    fprintf(output, "  -a <tol>             : adaptive energy grid: start with 8 x the energy step\n");
+    fprintf(output, "                         and refine towards it where the interpolation error\n");
+    fprintf(output, "                         is above tol (relative to the max. intensity of\n");
+    fprintf(output, "                         the beam)\n");
+    fprintf(output, "  -p <eps>             : remove evanescent beams with relative amplitudes\n");
+    fprintf(output, "                         below eps (re-validated every few energies)\n");
+    fprintf(output, "  -j <n_proc>          : calculate the energies in n_proc worker processes\n");
     fprintf(output, "  -e                   : early return option\n");
+    fprintf(output, "  --restart            : continue an interrupted run (append to res_file)\n");
+    fprintf(output, "  --energy-range e1:e2 : calculate only energies e1 <= E <= e2 (eV)\n");
+    fprintf(output, "  --energy-shard i/N   : calculate only the i-th of N energy blocks\n");
+    fprintf(output, "                         (merge the output files with cleed_merge)\n");
     fprintf(output, "  -h --help            : print help and exit\n");
     fprintf(output, "  -V --version         : print version and information about this program\n");
     fprintf(output, "\n");
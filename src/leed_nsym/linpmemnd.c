@@ -0,0 +1,349 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  leed_inp_bul_mem_nd
+    Set up the bulk parameters from data in memory.
+  leed_inp_over_mem_nd
+    Set up the overlayer parameters from data in memory.
+  leed_inp_par_mem
+    Set up the parameters controlling the program from data in memory.
+  leed_inp_free_nd
+    Free the memory attached to bulk or overlayer parameters.
+
+  These functions are the counterparts of leed_inp_read_bul_nd,
+  leed_read_overlayer_nd and leed_inp_leed_read_par for programs which
+  create the input in memory rather than writing and parsing input files.
+  All values are expected in atomic units (Bohr, Hartree, radians);
+  phase shifts are stored through leed_inp_phase_mem_nd or
+  leed_inp_phase_nd before. The structures can be reused for a new
+  set of parameters (e.g. in a structure search); the memory attached 
+  to them is freed (leed_inp_free_nd).
+
+Changes:
+  AG/17.10.26 - Creation
+  AG/17.10.26 - free the memory attached to reused structures.
+
+*********************************************************************/
+
+#include <math.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "leed.h"
+#include "leed_def.h"
+
+
+#ifndef WAVE_TOLERANCE         /* should be defined in "leed_def.h" */
+#define WAVE_TOLERANCE 1.e-4
+#endif
+
+/********************************************************************/
+
+int leed_inp_bul_mem_nd(leed_cryst_t **p_bulk_par,
+                        real *a1, real *a2, real *a3, real *m_super,
+                        leed_atom_t *atoms, int n_atoms,
+                        real vr, real vi, real temp)
+/*********************************************************************
+  Set up the bulk parameters from data in memory.
+
+  INPUT:
+
+  leed_cryst_t **p_bulk_par - (output) bulk parameters. If *p_bulk_par
+            is NULL, memory is allocated; otherwise it must have been
+            set up by leed_inp_bul_mem_nd or leed_inp_read_bul_nd and 
+            the memory attached to it is freed (leed_inp_free_nd).
+  real *a1, *a2, *a3 - bulk unit cell vectors (1=x, 2=y, 3=z) in Bohr.
+  real *m_super - superstructure matrix (m_super[1..4], b = m_super * a).
+            If NULL, a (1x1) structure is assumed.
+  leed_atom_t *atoms - bulk atoms: pos (Bohr), type (number of the set
+            of phase shifts) and t_type. The array is copied.
+  int n_atoms - number of atoms.
+  real vr, vi - real and imaginary part of the optical potential
+            (Hartree). The signs are corrected like in the file input.
+  real temp - crystal temperature (K). If <= 0., DEF_TEMP is used.
+
+  DESIGN:
+
+  Same presets as in leed_inp_read_bul_nd; the processing is done by
+  leed_inp_bul_setup_nd. No symmetry is used.
+
+  RETURN VALUE:
+
+    1 if ok.
+   -1 if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+int i_c, i_atoms;
+int iaux;
+
+real a1_loc[4], a2_loc[4], a3_loc[4];
+
+leed_cryst_t *bulk_par;
+leed_atom_t *atoms_rd;
+
+ if( (atoms == NULL) || (n_atoms < 1) )
+ {
+#ifdef ERROR
+   fprintf(STDERR,
+   "*** error (leed_inp_bul_mem_nd): no bulk atoms (n_atoms = %d)\n", n_atoms);
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+ if (*p_bulk_par == NULL)
+   *p_bulk_par = (leed_cryst_t *)malloc( sizeof(leed_cryst_t) );
+ else
+   leed_inp_free_nd(*p_bulk_par, 1);
+ bulk_par = *p_bulk_par;
+
+/********************************************************************
+  Preset parameters (see leed_inp_read_bul_nd)
+********************************************************************/
+
+ bulk_par->m_plane = (real *)malloc( sizeof(real));
+ bulk_par->comments = (char * *)malloc( sizeof(char *));
+ *(bulk_par->comments) = NULL;
+
+ bulk_par->m_trans[1] = bulk_par->m_trans[4] = 1.;
+ bulk_par->m_trans[2] = bulk_par->m_trans[3] = 0.;
+
+ bulk_par->m_super[1] = bulk_par->m_super[4] = 1.;
+ bulk_par->m_super[2] = bulk_par->m_super[3] = 0.;
+
+/* the superstructure matrix is passed to leed_inp_bul_setup_nd in m_recip */
+ if(m_super != NULL)
+   for(i_c = 1; i_c < 5; i_c ++) bulk_par->m_recip[i_c] = m_super[i_c];
+ else
+ {
+   bulk_par->m_recip[1] = bulk_par->m_recip[4] = 1.;
+   bulk_par->m_recip[2] = bulk_par->m_recip[3] = 0.;
+ }
+
+ for(i_c = 0; i_c < 5; i_c ++) bulk_par->b[i_c] = 0.;
+
+ bulk_par->temp = (temp > 0.)? temp: DEF_TEMP;
+
+ bulk_par->vr = -R_fabs(vr);
+ bulk_par->vi =  R_fabs(vi);
+
+ bulk_par->n_rot = 1;
+ bulk_par->rot_axis[1] = bulk_par->rot_axis[2] = 0.;
+ bulk_par->n_mir = 0;
+
+ bulk_par->n_dom = 0;
+ bulk_par->dom = NULL;
+
+/* a1, a2, a3 may be reordered by leed_inp_bul_setup_nd */
+ for(i_c = 0; i_c < 4; i_c ++)
+ {
+   a1_loc[i_c] = a1[i_c];
+   a2_loc[i_c] = a2[i_c];
+   a3_loc[i_c] = a3[i_c];
+ }
+
+/********************************************************************
+  Copy atoms (one extra element is needed for sorting)
+********************************************************************/
+
+ atoms_rd = (leed_atom_t *)malloc( (n_atoms + 1) * sizeof(leed_atom_t) );
+ memcpy(atoms_rd, atoms, n_atoms * sizeof(leed_atom_t) );
+
+ bulk_par->ntypes = 0;
+ for(i_atoms = 0; i_atoms < n_atoms; i_atoms ++)
+   bulk_par->ntypes = MAX(atoms_rd[i_atoms].type+1, bulk_par->ntypes);
+
+ iaux = leed_inp_bul_setup_nd(bulk_par, atoms_rd, n_atoms,
+                              a1_loc, a2_loc, a3_loc);
+ free(atoms_rd);
+
+ if(iaux < 0) return(-1);
+ return(1);
+} /* end of function leed_inp_bul_mem_nd */
+
+/********************************************************************/
+
+int leed_inp_over_mem_nd(leed_cryst_t **p_over_par, leed_cryst_t *bulk_par,
+                         leed_atom_t *atoms, int n_atoms)
+/*********************************************************************
+  Set up the overlayer parameters from data in memory.
+
+  INPUT:
+
+  leed_cryst_t **p_over_par - (output) overlayer parameters. If
+            *p_over_par is NULL, memory is allocated; otherwise it must
+            have been set up by leed_inp_over_mem_nd or 
+            leed_read_overlayer_nd and the memory attached to it is 
+            freed (leed_inp_free_nd).
+  leed_cryst_t *bulk_par - (input/output) bulk parameters as set up by
+            leed_inp_bul_mem_nd or leed_inp_read_bul_nd.
+  leed_atom_t *atoms - overlayer atoms: pos (Bohr), type and t_type.
+            The array is copied.
+  int n_atoms - number of atoms (can be zero).
+
+  DESIGN:
+
+  Same presets as in leed_read_overlayer_nd; the processing is done by
+  leed_inp_over_setup_nd.
+
+  RETURN VALUE:
+
+    1 if ok.
+
+*********************************************************************/
+{
+int i_atoms;
+
+leed_cryst_t *over_par;
+leed_atom_t *atoms_rd;
+
+ if (*p_over_par == NULL)
+   *p_over_par = (leed_cryst_t *)malloc( sizeof(leed_cryst_t) );
+ else
+   leed_inp_free_nd(*p_over_par, 0);
+ over_par = *p_over_par;
+ memcpy(over_par, bulk_par, sizeof(leed_cryst_t) );
+
+ over_par->layers = NULL;
+
+ over_par->comments = (char * *)malloc( sizeof(char *) );
+ *(over_par->comments) = NULL;
+
+ over_par->temp = DEF_TEMP;
+
+ if(n_atoms < 0) n_atoms = 0;
+ atoms_rd = (leed_atom_t *)malloc( (n_atoms + 1) * sizeof(leed_atom_t) );
+ if(n_atoms > 0)
+   memcpy(atoms_rd, atoms, n_atoms * sizeof(leed_atom_t) );
+
+ for(i_atoms = 0; i_atoms < n_atoms; i_atoms ++)
+   over_par->ntypes = MAX(atoms_rd[i_atoms].type+1, over_par->ntypes);
+
+ leed_inp_over_setup_nd(over_par, bulk_par, atoms_rd, n_atoms);
+ free(atoms_rd);
+
+ return(1);
+} /* end of function leed_inp_over_mem_nd */
+
+/********************************************************************/
+
+int leed_inp_par_mem(leed_var_t ** p_var_par, leed_energy_t ** p_eng_par,
+                     leed_cryst_t * bulk_par,
+                     real e_ini, real e_fin, real e_stp,
+                     real theta, real phi, int l_max,
+                     real epsilon, real vi_exp)
+/*********************************************************************
+  Set up the parameters controlling the program from data in memory.
+
+  INPUT:
+
+  leed_var_t ** p_var_par, leed_energy_t ** p_eng_par - (output)
+            parameters. Memory is allocated if the pointers are NULL.
+  leed_cryst_t * bulk_par - bulk parameters (vr, vi).
+  real e_ini, e_fin, e_stp - energy range (Hartree).
+  real theta, phi - angles of incidence (radians).
+  int l_max - max. l quantum number (calculated from e_fin if <= 0).
+  real epsilon - convergence criterion (WAVE_TOLERANCE if <= 0.).
+  real vi_exp - exponent for the imag. part of the optical potential.
+
+  DESIGN:
+
+  Same presets as in leed_inp_leed_read_par; the checks are done by
+  leed_inp_par_setup.
+
+  RETURN VALUE:
+
+    1 if ok.
+   -1 if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+int i_c;
+
+leed_var_t *var_par;
+leed_energy_t *eng_par;
+
+ if (*p_var_par == NULL)
+   *p_var_par = (leed_var_t *)malloc( sizeof(leed_var_t) );
+ var_par = *p_var_par;
+
+ if (*p_eng_par == NULL)
+   *p_eng_par = (leed_energy_t *)malloc( sizeof(leed_energy_t) );
+ eng_par = *p_eng_par;
+
+ var_par->eng_r = 0.;
+ var_par->eng_i = 0.;
+ var_par->eng_v = 0.;
+
+ var_par->vi_pre = bulk_par->vi;
+ var_par->vi_exp = vi_exp;
+ var_par->vr     = bulk_par->vr;
+
+ for( i_c = 0; i_c <=3; i_c ++)
+   var_par->k_in[i_c] = 0.;
+
+ var_par->p_tl = NULL;
+
+ var_par->theta = theta;
+ var_par->phi = phi;
+ var_par->epsilon = (epsilon > 0.)? epsilon: WAVE_TOLERANCE;
+ var_par->l_max = l_max;
+
+ eng_par->ini = e_ini;
+ eng_par->fin = e_fin;
+ eng_par->stp = e_stp;
+
+ return(leed_inp_par_setup(var_par, eng_par));
+} /* end of function leed_inp_par_mem */
+
+/********************************************************************/
+
+void leed_inp_free_nd(leed_cryst_t *par, int bulk)
+/*********************************************************************
+  Free the memory attached to bulk or overlayer parameters (not the 
+  structure itself).
+
+  INPUT:
+
+  leed_cryst_t *par - bulk or overlayer parameters.
+  int bulk - 1: par are bulk parameters. 
+             0: par are overlayer parameters; the mirror planes are
+             shared with the bulk parameters (copied by the input
+             functions) and are not freed.
+
+  DESIGN:
+
+  Layers (and their atoms), comments and domains are freed and the 
+  pointers are set to NULL.
+
+*********************************************************************/
+{
+int i_com;
+
+ leed_dom_over_free_nd(par);
+
+ if(par->comments != NULL)
+ {
+   for(i_com = 0; *(par->comments + i_com) != NULL; i_com ++)
+     free(*(par->comments + i_com));
+   free(par->comments);
+   par->comments = NULL;
+ }
+
+ if(bulk)
+ {
+   free(par->m_plane);
+   par->m_plane = NULL;
+ }
+
+ free(par->dom);
+ par->dom = NULL;
+ par->n_dom = 0;
+} /* end of function leed_inp_free_nd */
@@ -4,8 +4,12 @@
 
   leed_update_phase
    Update the number of phase shifts.
-  leed_leed_leed_leed_inp_phase_nd
+  leed_inp_phase_nd
    Read phase shifts from an input file and store them.
+  leed_inp_phase_mem_nd
+   Store phase shifts supplied in memory.
+  leed_inp_phase_mix_nd
+   Create a mixture of phase shift sets (average t matrix).
 
 Changes:
 
@@ -17,6 +21,12 @@ Changes:
   WB/26.02.98 - Correct control output
   GH/03.05.00 - extend list of parameters for leed_leed_inp_phase: t_type
   GH/15.07.03 - fix bug in energy scaleing factor for Ry (was 2./HART, now 2.).
+  AG/17.10.26 - add leed_inp_phase_mem_nd; finding/appending a set is
+                shared with file input (leed_phase_slot_nd).
+  AG/17.10.26 - mixtures of phase shifts for the average t matrix 
+                (leed_inp_phase_mix_nd).
+  AG/17.10.26 - rename leed_leed_leed_leed_inp_phase_nd to 
+                leed_inp_phase_nd (as declared in leed_func.h).
 
 *********************************************************************/
 
@@ -35,6 +45,8 @@ Changes:
 #define GEO_TOLERANCE 0.0001                /* ca. 0.00005 A */
 #endif
 
+#define MIX_TOLERANCE 0.0001          /* tolerance of the sum of weights */
+
 #ifdef __STRICT_ANSI__
 char *strdup(const char *str) /* strdup is not standard C (its POSIX) */
 {
@@ -68,7 +80,73 @@ RETURN VALUE:
 
 /********************************************************************/
 
-int leed_leed_leed_leed_inp_phase_nd( char * phaseinp, real * dr, int t_type, 
+static int leed_phase_slot_nd(const char * filename, real * dr, int t_type,
+                 leed_phs_t **p_phs_shifts )
+/*********************************************************************
+  Find a set of phase shifts or append a new (empty) one.
+
+ INPUT:
+  const char * filename (input) name of the phase shift set.
+  real * dr (input) displacement vector for thermic vibrations.
+  int t_type (input) type of t matrix.
+  leed_phs_t **p_phs_shifts (input/output) phase shifts.
+
+ DESIGN:
+  If the combination of filename, dr, and t_type has already been 
+  stored, the number of this set is returned. Otherwise the list is 
+  extended by one set (dr and t_type are set, the list is terminated)
+  and the number of the new set (i_phase - 1) is returned.
+
+*********************************************************************/
+{
+int i;
+
+ if(i_phase > 0)
+ {
+/* 
+  Compare filename, dr, and t_type with previous phaseshifts. Return the 
+  corresponding phase shift number if the same combination has already 
+  been read.
+*/
+   for(i=0; i< i_phase; i++)
+     if( (!strcmp( (*p_phs_shifts + i)->input_file, filename) )         &&
+         ( R_fabs(dr[1] - (*p_phs_shifts + i)->dr[1]) < GEO_TOLERANCE ) &&
+         ( R_fabs(dr[2] - (*p_phs_shifts + i)->dr[2]) < GEO_TOLERANCE ) &&
+         ( R_fabs(dr[3] - (*p_phs_shifts + i)->dr[3]) < GEO_TOLERANCE ) &&
+         ( t_type == (*p_phs_shifts + i)->t_type ) 
+       )
+     {
+       return(i); 
+     }
+   i_phase ++;
+   *p_phs_shifts = (leed_phs_t *)realloc( 
+                    *p_phs_shifts, (i_phase + 1) * sizeof(leed_phs_t) );
+ }
+ else
+ {
+   i_phase ++;
+   *p_phs_shifts = (leed_phs_t *) malloc( 2 * sizeof(leed_phs_t) );
+ }
+
+/* Terminate list of phase shifts */
+  
+ (*(p_phs_shifts) + i_phase)->lmax = I_END_OF_LIST;
+
+/* write dr and t_type to the new set */
+ for(i=0; i<=3; i++) (*(p_phs_shifts) + i_phase-1)->dr[i] = dr[i];
+ (*(p_phs_shifts) + i_phase-1)->t_type = t_type;
+
+/* no mixture */
+ (*(p_phs_shifts) + i_phase-1)->n_mix = 0;
+ (*(p_phs_shifts) + i_phase-1)->mix_type = NULL;
+ (*(p_phs_shifts) + i_phase-1)->mix_wgt = NULL;
+
+ return(i_phase - 1);
+} /* end of function leed_phase_slot_nd */
+
+/********************************************************************/
+
+int leed_inp_phase_nd( char * phaseinp, real * dr, int t_type, 
                  leed_phs_t **p_phs_shifts )
 
 /*********************************************************************
@@ -87,6 +165,9 @@ int leed_leed_leed_leed_inp_phase_nd( char * phaseinp, real * dr, int t_type,
 
  DESIGN:
 
+  If phaseinp contains '*' or '+', it is a mixture of phase shift sets
+  (see leed_inp_phase_mix_nd).
+
   The phase shifts in the input file must be for increasing energies.
   The storage scheme is:
   
@@ -112,6 +193,9 @@ int neng, lmax, nl;          /* neng = No. of energies to be read
 
 real eng_scale;
 
+ if( strpbrk(phaseinp, "*+") != NULL)
+   return(leed_inp_phase_mix_nd(phaseinp, dr, t_type, p_phs_shifts));
+
 /***********************************************************************
   Create name of input file:
   - If phaseinp is a full path (starting with '/'), this is used as 
@@ -127,7 +211,7 @@ real eng_scale;
    {
 #ifdef ERROR
      fprintf(STDERR,
-     " *** error (leed_leed_inp_phase): environment variable CLEED_PHASE not defined\n");
+     " *** error (leed_inp_phase_nd): environment variable CLEED_PHASE not defined\n");
 #endif
      exit(1);
    }
@@ -136,51 +220,17 @@ real eng_scale;
  else
    sprintf(filename, "%s", phaseinp);
 
- if(i_phase > 0)
- {
-/* 
-  Compare filename, dr, and t_type with previous phaseshifts. Return the 
-  corresponding phase shift number if the same combination has already 
-  been read.
-*/
-   for(i=0; i< i_phase; i++)
-     if( (!strcmp( (*p_phs_shifts + i)->input_file, filename) )         &&
-         ( R_fabs(dr[1] - (*p_phs_shifts + i)->dr[1]) < GEO_TOLERANCE ) &&
-         ( R_fabs(dr[2] - (*p_phs_shifts + i)->dr[2]) < GEO_TOLERANCE ) &&
-         ( R_fabs(dr[3] - (*p_phs_shifts + i)->dr[3]) < GEO_TOLERANCE ) &&
-         ( t_type == (*p_phs_shifts + i)->t_type ) 
-       )
-     {
-       return(i); 
-       break;
-     }
-   i_phase ++;
-   *p_phs_shifts = (leed_phs_t *)realloc( 
-                    *p_phs_shifts, (i_phase + 1) * sizeof(leed_phs_t) );
- }
- else
- {
-   i_phase ++;
-   *p_phs_shifts = (leed_phs_t *) malloc( 2 * sizeof(leed_phs_t) );
- }
-
-/* Terminate list of phase shifts */
-  
- (*(p_phs_shifts) + i_phase)->lmax = I_END_OF_LIST;
-
+ if( (i = leed_phase_slot_nd(filename, dr, t_type, p_phs_shifts)) < i_phase - 1)
+   return(i);
 
  phs_shifts = *(p_phs_shifts) + i_phase-1;
 
-/* write dr and t_type to phs_shifts */
- for(i=0; i<=3; i++) phs_shifts->dr[i] = dr[i];
- phs_shifts->t_type = t_type;
-
 /********************************************************************
   Open and Read input file for a new set of phase shifts
 ********************************************************************/
 
 #ifdef CONTROL
- fprintf(STDCTR,"(leed_leed_inp_phase): Reading file \"%s\", i_phase = %d\n", 
+ fprintf(STDCTR,"(leed_inp_phase_nd): Reading file \"%s\", i_phase = %d\n", 
          filename, i_phase-1);
 #endif
 
@@ -193,7 +243,7 @@ real eng_scale;
  {
 #ifdef ERROR
    fprintf(STDERR,
-  " *** error (leed_leed_inp_phase): could not open file \"%s\"\n",filename);
+  " *** error (leed_inp_phase_nd): could not open file \"%s\"\n",filename);
 #endif
    exit(1);
  }
@@ -213,7 +263,7 @@ real eng_scale;
  {
 #ifdef ERROR
    fprintf(STDERR,
-   " *** error (leed_leed_inp_phase): unexpected EOF found while reading file \"%s\"\n",
+   " *** error (leed_inp_phase_nd): unexpected EOF found while reading file \"%s\"\n",
    filename);
 #endif
    exit(1);
@@ -222,7 +272,7 @@ real eng_scale;
  {
 #ifdef ERROR
    fprintf(STDERR,
-   " *** error (leed_leed_inp_phase): improper input line in file \"%s\":\n%s",
+   " *** error (leed_inp_phase_nd): improper input line in file \"%s\":\n%s",
    filename, linebuffer);
 #endif
    exit(1);
@@ -236,21 +286,21 @@ real eng_scale;
  {
    eng_scale = 1./HART;
 #ifdef CONTROL
-   fprintf(STDCTR,"(leed_leed_inp_phase): Energy input in eV\n");
+   fprintf(STDCTR,"(leed_inp_phase_nd): Energy input in eV\n");
 #endif
  }
  else if( !strncmp(eng_type,"Ry",2) || !strncmp(eng_type,"RY",2) )
  {
    eng_scale = 2.;
 #ifdef CONTROL
-   fprintf(STDCTR,"(leed_leed_inp_phase): Energy input in Rydberg (13.59 eV)\n");
+   fprintf(STDCTR,"(leed_inp_phase_nd): Energy input in Rydberg (13.59 eV)\n");
 #endif
  }
  else 
  {
    eng_scale = 1.;
 #ifdef CONTROL
-   fprintf(STDCTR,"(leed_leed_inp_phase): Energy input in Hartree (27.18 eV)\n");
+   fprintf(STDCTR,"(leed_inp_phase_nd): Energy input in Hartree (27.18 eV)\n");
 #endif
  }
   
@@ -312,7 +362,7 @@ real eng_scale;
  phs_shifts->neng = i_eng;
 
 #ifdef CONTROL
- fprintf(STDCTR,"(leed_leed_inp_phase): Number of energies = %d, lmax = %d\n",
+ fprintf(STDCTR,"(leed_inp_phase_nd): Number of energies = %d, lmax = %d\n",
          phs_shifts->neng, phs_shifts->lmax);
  fprintf(STDCTR,"\n\t  E(H)");
  for(i=0; i<nl; i++) fprintf(STDCTR,"\t  l=%2d",i); 
@@ -337,7 +387,7 @@ real eng_scale;
  if(phs_shifts->neng != neng)
  {
    fprintf(STDWAR,
-   " *** warning (leed_leed_inp_phase): EOF found before reading all phase shifts:\n");
+   " *** warning (leed_inp_phase_nd): EOF found before reading all phase shifts:\n");
    fprintf(STDWAR,
    "     expected energies: %3d, found: %3d, file: %s\n", 
    neng, i_eng+1, filename);
@@ -346,3 +396,212 @@ real eng_scale;
 
  return(i_phase - 1);
 } /* end of function leed_leed_inp_phase */
+
+/********************************************************************/
+
+int leed_inp_phase_mem_nd( const char * name, real * dr, int t_type,
+                 int lmax, int neng, real * energy, real * pshift,
+                 leed_phs_t **p_phs_shifts )
+/*********************************************************************
+  Store a set of phase shifts supplied in memory.
+
+ INPUT:
+  const char * name (input) name of the set (stored as input_file and
+         used to identify the set, like the file name for file input).
+  real * dr (input) displacement vector for thermic vibrations 
+         (dr[0] = <dr^2>, dr[1..3] = rms displacements, atomic units).
+  int t_type (input) type of t matrix (T_DIAG or T_NOND).
+  int lmax (input) max. angular momentum quantum number.
+  int neng (input) number of energies.
+  real * energy (input) neng energies in Hartree (increasing).
+  real * pshift (input) phase shifts: pshift[i_eng*(lmax+1) + l].
+  leed_phs_t **p_phs_shifts (output) phase shifts.
+
+ DESIGN:
+  Same storage scheme as leed_inp_phase_nd; energy and
+  pshift are copied.
+
+ RETURN VALUE:
+  number of the set of phase shifts (i.e. atom type).
+  -1 if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+int i;
+int nl;
+
+leed_phs_t *phs_shifts;
+
+ if( (neng < 1) || (lmax < 0) || (energy == NULL) || (pshift == NULL) )
+ {
+#ifdef ERROR
+   fprintf(STDERR,
+   " *** error (leed_inp_phase_mem_nd): improper phase shifts \"%s\"\n", name);
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+ if( (i = leed_phase_slot_nd(name, dr, t_type, p_phs_shifts)) < i_phase - 1)
+   return(i);
+
+ phs_shifts = *(p_phs_shifts) + i;
+ nl = lmax + 1;
+
+ phs_shifts->input_file = strdup(name);
+ phs_shifts->lmax = lmax;
+ phs_shifts->neng = neng;
+
+ phs_shifts->energy = (real *)malloc( neng * sizeof(real) ); 
+ phs_shifts->pshift = (real *)malloc( neng * nl * sizeof(real) ); 
+ memcpy(phs_shifts->energy, energy, neng * sizeof(real));
+ memcpy(phs_shifts->pshift, pshift, neng * nl * sizeof(real));
+
+ phs_shifts->eng_min = energy[0];
+ phs_shifts->eng_max = energy[neng-1];
+
+ return(i);
+} /* end of function leed_inp_phase_mem_nd */
+
+/********************************************************************/
+
+int leed_inp_phase_mix_nd( const char * mixinp, real * dr, int t_type, 
+                 leed_phs_t **p_phs_shifts )
+/*********************************************************************
+  Create a mixture of phase shift sets for the average t matrix 
+  approximation (ATA).
+
+ INPUT:
+  const char * mixinp (input) components and concentrations:
+         "<phaseinp>*<c>+<phaseinp>*<c>+..." (e.g. "Ni*0.7+Al*0.3"; 
+         c = 1 if "*<c>" is omitted). The concentrations must be 
+         decimal numbers >= 0 with a sum <= 1; the remainder to 1 is
+         vacancy (partial occupancy, e.g. "O*0.25").
+  real * dr (input) displacement vector for thermic vibrations (used 
+         for all components).
+  int t_type (input) type of t matrix (T_DIAG or T_NOND).
+  leed_phs_t **p_phs_shifts (output) phase shifts.
+
+ DESIGN:
+  The phase shifts of each component are read (or found) as a set of
+  their own (leed_inp_phase_nd). The mixture is stored
+  as an additional set without phase shifts (neng = 0) which refers to
+  the components (n_mix, mix_type, mix_wgt); its t matrix is the 
+  concentration weighted average of the t matrices of the components
+  (leed_par_mktl_nd). The components always precede the mixture in 
+  the list of phase shifts.
+
+ RETURN VALUE:
+  number of the set of phase shifts (i.e. atom type).
+  -1 if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+int i_mix, n_mix, i_set;
+int *mix_type;
+
+real sum;
+real *mix_wgt;
+
+char buffer[STRSZ];
+char *comp, *sep, *end;
+
+leed_phs_t *phs_shifts;
+
+ strncpy(buffer, mixinp, STRSZ - 1);
+ buffer[STRSZ - 1] = '\0';
+
+ for(n_mix = 1, sep = buffer; (sep = strchr(sep, '+')) != NULL; sep ++)
+   n_mix ++;
+
+ mix_type = (int *)malloc(n_mix * sizeof(int));
+ mix_wgt = (real *)malloc(n_mix * sizeof(real));
+
+/*********************************************************************
+  Read the components
+*********************************************************************/
+
+ sum = 0.;
+ for(i_mix = 0, comp = buffer; i_mix < n_mix; i_mix ++, comp = end + 1)
+ {
+   if((end = strchr(comp, '+')) == NULL) end = comp + strlen(comp);
+   *end = '\0';
+
+   mix_wgt[i_mix] = 1.;
+   if((sep = strchr(comp, '*')) != NULL)
+   {
+     *sep = '\0';
+     mix_wgt[i_mix] = (real)atof(sep + 1);
+   }
+   sum += mix_wgt[i_mix];
+
+   if( (*comp == '\0') || (mix_wgt[i_mix] < 0.) || 
+       (sum > 1. + MIX_TOLERANCE) )
+   {
+#ifdef ERROR
+     fprintf(STDERR, " *** error (leed_inp_phase_mix_nd): improper "
+             "component or sum of concentrations > 1 in \"%s\"\n", mixinp);
+#endif
+     free(mix_type);
+     free(mix_wgt);
+#ifdef EXIT_ON_ERROR
+     exit(1);
+#else
+     return(-1);
+#endif
+   }
+
+   mix_type[i_mix] = 
+     leed_inp_phase_nd(comp, dr, t_type, p_phs_shifts);
+ }
+
+/*********************************************************************
+  Find the mixture or create a new set
+*********************************************************************/
+
+ if( (i_set = leed_phase_slot_nd(mixinp, dr, t_type, p_phs_shifts)) 
+     < i_phase - 1)
+ {
+   free(mix_type);
+   free(mix_wgt);
+   return(i_set);
+ }
+
+ phs_shifts = *(p_phs_shifts) + i_set;
+ phs_shifts->input_file = strdup(mixinp);
+
+ phs_shifts->neng = 0;
+ phs_shifts->energy = NULL;
+ phs_shifts->pshift = NULL;
+ phs_shifts->lmax = 0;
+ phs_shifts->eng_min = 0.;
+ phs_shifts->eng_max = 0.;
+ for(i_mix = 0; i_mix < n_mix; i_mix ++)
+ {
+   leed_phs_t *ptr = *(p_phs_shifts) + mix_type[i_mix];
+
+   phs_shifts->lmax = MAX(phs_shifts->lmax, ptr->lmax);
+   if( (i_mix == 0) || (ptr->eng_min > phs_shifts->eng_min) )
+     phs_shifts->eng_min = ptr->eng_min;
+   if( (i_mix == 0) || (ptr->eng_max < phs_shifts->eng_max) )
+     phs_shifts->eng_max = ptr->eng_max;
+ }
+
+ phs_shifts->n_mix = n_mix;
+ phs_shifts->mix_type = mix_type;
+ phs_shifts->mix_wgt = mix_wgt;
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(leed_inp_phase_mix_nd): i_phase = %d:", i_set);
+ for(i_mix = 0; i_mix < n_mix; i_mix ++)
+   fprintf(STDCTR, " %.3f x (%d)", mix_wgt[i_mix], mix_type[i_mix]);
+ if(sum < 1. - MIX_TOLERANCE)
+   fprintf(STDCTR, " %.3f x vacancy", 1. - sum);
+ fprintf(STDCTR, "\n");
+#endif
+
+ return(i_set);
+} /* end of function leed_inp_phase_mix_nd */
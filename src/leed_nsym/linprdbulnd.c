@@ -1,8 +1,11 @@
 /*********************************************************************
 GH/29.09.00 
-  file contains function:
+  file contains functions:
 
-  leed_inp_read_bul
+  leed_inp_read_bul_nd
+    Read the bulk parameters from file.
+  leed_inp_bul_setup_nd
+    Process the bulk parameters (also used for input from memory).
  
 Changes:
 
@@ -14,6 +17,9 @@ GH/25.07.95 - introduce structure element "layers" in bulk_par
 GH/04.09.97 - include symmetry flags.
 GH/03.05.00 - read parameters for non-diagonal t matrix
 GH/29.09.00 - calculate dr2 for dmt input in function leed_inp_debye_temp
+AG/17.10.26 - move processing of the input data into leed_inp_bul_setup_nd
+AG/17.10.26 - ignore domain input ('do', see leed_read_overlayer_nd).
+AG/17.10.26 - declare the atom counter of the CONTROL_X output.
 
 *********************************************************************/
 
@@ -63,7 +69,7 @@ int leed_inp_read_bul_nd (leed_cryst_t **p_bulk_par,
 
   FUNCTION CALLS
 
-   - leed_leed_leed_leed_inp_phase_nd
+   - leed_inp_phase_nd
    - leed_inp_bul_layer
 
   RETURN VALUES
@@ -80,20 +86,20 @@ char linebuffer[STRSZ];
 char phaseinp[STRSZ];
 char whatnext[STRSZ];
 
-int i,j, iaux;                /* counter, dummy  variables */
+int i, iaux;                  /* counter, dummy  variables */
 int i_c, i_str;
 int i_com;
 int i_atoms;
-int i_layer;
+#ifdef CONTROL_X
+int j;                        /* atom counter (control output) */
+#endif
 
-real faux;                    /* dummy variable */
 real a1[4], a2[4], a3[4];     /* vectors: 1=x, 2=y, 3=z, 0 is not used */
 real vaux[4];                 /* dummy vector */
 
 leed_cryst_t *bulk_par;   /* use *bulk_par instead of the pointer 
                                  p_bulk_par */
 
-leed_atom_t atom_aux;     /* used for sorting atoms */
 leed_atom_t * atoms_rd;   /* this vector of structure atom_str is
                                  used to read and treat the input atomic
                                  properties and will be copied into bulk_par
@@ -146,6 +152,9 @@ leed_atom_t * atoms_rd;   /* this vector of structure atom_str is
  bulk_par->rot_axis[1] = bulk_par->rot_axis[2] = 0.;
  bulk_par->n_mir = 0;
 
+ bulk_par->n_dom = 0;
+ bulk_par->dom = NULL;
+
 /********************************************************************
   Open and Read input file
 ********************************************************************/
@@ -491,7 +500,7 @@ leed_atom_t * atoms_rd;   /* this vector of structure atom_str is
        }
 
      /* input of atomic phase shifts */
-       atoms_rd[i_atoms].type = leed_leed_leed_leed_inp_phase_nd(phaseinp, vaux, 
+       atoms_rd[i_atoms].type = leed_inp_phase_nd(phaseinp, vaux, 
                                             atoms_rd[i_atoms].t_type, 
                                             p_phs_shifts);
        bulk_par->ntypes = MAX(atoms_rd[i_atoms].type+1, bulk_par->ntypes);
@@ -557,6 +566,10 @@ leed_atom_t * atoms_rd;   /* this vector of structure atom_str is
      new line characters
    ***********************************/
      case ('#'): case ('\n'): case('\r'): 
+   /***********************************
+     identifiers used in leed_read_overlayer_nd
+   ***********************************/
+     case ('d'): case ('D'): 
    /***********************************
      identifiers used in leed_inp_leed_read_par
    ***********************************/
@@ -586,13 +599,162 @@ leed_atom_t * atoms_rd;   /* this vector of structure atom_str is
   
 /************************************************************************
  END OF INPUT
+ Process the input data.
+*************************************************************************/
+
+ if(leed_inp_bul_setup_nd(bulk_par, atoms_rd, i_atoms, a1, a2, a3) < 0)
+ {
+   free(atoms_rd);
+   return(-1);
+ }
+ free(atoms_rd);
+
+#ifdef CONTROL_X
+ printf("***********************(leed_inp_read_bul)***********************\n");
+ printf("potentials:\n");
+ printf("\tvr: %7.4f eV  vi: %7.4f eV\n", 
+        (bulk_par->vr)*HART, (bulk_par->vi)*HART);
+
+ printf("\nbulk unit cell:\n");
+ printf("\ta1:  (%7.4f  %7.4f  %7.4f) A\n", a1[1]*BOHR, a1[2]*BOHR, a1[3]*BOHR);
+ printf("\ta2:  (%7.4f  %7.4f  %7.4f) A\n", a2[1]*BOHR, a2[2]*BOHR, a2[3]*BOHR);
+ printf("\ta3:  (%7.4f  %7.4f  %7.4f) A\n", a3[1]*BOHR, a3[2]*BOHR, a3[3]*BOHR);
+ printf("\n     reciprocal lattice: \n");
+ printf("\ta1*: (%7.4f  %7.4f) A^-1\n", 
+         bulk_par->a_1[1]/BOHR, bulk_par->a_1[2]/BOHR);
+ printf("\ta2*: (%7.4f  %7.4f) A^-1\n", 
+         bulk_par->a_1[3]/BOHR, bulk_par->a_1[4]/BOHR);
+ printf("\nsuperstructure unit cell:\n");
+ printf("\t(%5.2f %5.2f)\tb1:  (%7.4f  %7.4f) A\n", 
+         bulk_par->m_super[1], bulk_par->m_super[2],
+         bulk_par->b[1]*BOHR, bulk_par->b[3]*BOHR);
+ printf("\t(%5.2f %5.2f)\tb2:  (%7.4f  %7.4f) A\n", 
+         bulk_par->m_super[3], bulk_par->m_super[4],
+         bulk_par->b[2]*BOHR, bulk_par->b[4]*BOHR);
+
+ printf("\n     reciprocal lattice: \n");
+ printf("\t(%5.2f %5.2f)\tb1*: (%7.4f  %7.4f) A^-1\n",
+         bulk_par->m_recip[1], bulk_par->m_recip[2],
+         bulk_par->b_1[1]/BOHR, bulk_par->b_1[2]/BOHR);
+ printf("\t(%5.2f %5.2f)\tb2*: (%7.4f  %7.4f) A^-1\n",
+         bulk_par->m_recip[3], bulk_par->m_recip[4],
+         bulk_par->b_1[3]/BOHR, bulk_par->b_1[4]/BOHR);
+
+ printf("\npositions(bulk):\n");
+ 
+ for(i=0; i < bulk_par->nlayers; i++)
+ {
+   printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n", 
+           bulk_par->layers[i].vec_from_last[1]*BOHR,
+           bulk_par->layers[i].vec_from_last[2]*BOHR, 
+           bulk_par->layers[i].vec_from_last[3]*BOHR );
+
+   if( bulk_par->layers[i].periodic == 0 ) printf("np:");
+   else         printf("p: ");
+
+   for( j = 0; j < bulk_par->layers[i].natoms; j ++)
+   {
+     printf("\tpos: (%7.4f  %7.4f  %7.4f) A\tlayer: %d type: %d atom: %d\n", 
+             bulk_par->layers[i].atoms[j].pos[1]*BOHR, 
+             bulk_par->layers[i].atoms[j].pos[2]*BOHR, 
+             bulk_par->layers[i].atoms[j].pos[3]*BOHR,
+             bulk_par->layers[i].atoms[j].layer, 
+             bulk_par->layers[i].atoms[j].type, j);
+   }
+ }
+
+ printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n", 
+          bulk_par->layers[bulk_par->nlayers-1].vec_to_next[1]*BOHR,
+          bulk_par->layers[bulk_par->nlayers-1].vec_to_next[2]*BOHR, 
+          bulk_par->layers[bulk_par->nlayers-1].vec_to_next[3]*BOHR );
+
+ printf("M_trans:\n");
+ printf("\t%7.4f  %7.4f\n", bulk_par->m_trans[1], bulk_par->m_trans[2]);
+ printf("\t%7.4f  %7.4f\n", bulk_par->m_trans[3], bulk_par->m_trans[4]);
+ printf("comments:\n");
+
+ for( i=0; i<i_com; i++)
+ {
+   printf("\t%s", *(bulk_par->comments + i));
+ }
+
+ fprintf(STDCTR,"phase shifts:\n");
+ fprintf(STDCTR,"\t%d different sets of phase shifts used:\n", 
+         bulk_par->ntypes);
+ for(i_c = 0; i_c < bulk_par->ntypes; i_c ++)
+   fprintf(STDCTR,"\t(%d) %s (%d energies, lmax = %d)\tV<dr^2>_T = %.3f A^2\n",
+           i_c,
+           (*(p_phs_shifts)+i_c)->input_file, 
+           (*(p_phs_shifts)+i_c)->neng, 
+           (*(p_phs_shifts)+i_c)->lmax,
+           R_sqrt( (*(p_phs_shifts)+i_c)->dr[0] ) *BOHR);
+
+ printf("***********************(leed_inp_read_bul)***********************\n");
+#endif
+
+
+/************************************************************************
+ write the structures phs_shifts and bulk_par back.
+*************************************************************************/
+
+ *p_bulk_par = bulk_par;
+
+ return(1);
+}
+/********************************************************************/
+
+int leed_inp_bul_setup_nd(leed_cryst_t *bulk_par,
+                  leed_atom_t *atoms_rd, int n_atoms,
+                  real *a1, real *a2, real *a3)
+/*********************************************************************
+  Process the bulk parameters after input (from file or from memory).
+
+  INPUT:
+
+  leed_cryst_t *bulk_par - (input/output) bulk parameters. The following 
+            elements must be set before: vr, vi, temp, ntypes, comments,
+            m_trans (identity), symmetry parameters, and either the super-
+            structure lattice vectors b or (if b is zero) the super-
+            structure matrix which is stored temporarily in m_recip.
+  leed_atom_t *atoms_rd - (input) bulk atoms (positions in atomic units,
+            type, t_type). The array must have space for n_atoms + 1
+            elements; the atoms are sorted and moved into the unit cell.
+  int n_atoms - number of atoms in atoms_rd.
+  real *a1, *a2, *a3 - bulk unit cell vectors (1=x, 2=y, 3=z) in atomic
+            units. They will be reordered if necessary.
+
+  DESIGN
+
+  - Set up a, a_1, b, b_1, m_super and m_recip.
+  - Move the atoms into the unit cell and sort them by z.
+  - Distribute the atoms to layers (leed_inp_bul_layer) and find dmin.
+
+  RETURN VALUES
+
+    1 if ok.
+   -1 if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+int i,j, iaux;                /* counter, dummy  variables */
+int i_atoms;
+int i_layer;
+
+real faux;                    /* dummy variable */
+real vaux[4];                 /* dummy vector */
+
+leed_atom_t atom_aux;     /* used for sorting atoms */
+
+ i_atoms = n_atoms;
+
+/************************************************************************
  Check the number of bulk atoms. Exit if zero
 *************************************************************************/
  if(i_atoms < 1)
  {
 #ifdef ERROR
    fprintf(STDERR,
-   "*** error (leed_inp_read_bul): could not find any bulk atoms (i_atoms = %d)\n", 
+   "*** error (leed_inp_bul_setup_nd): could not find any bulk atoms (i_atoms = %d)\n", 
    i_atoms);
 #endif
 #ifdef EXIT_ON_ERROR
@@ -618,7 +780,7 @@ leed_atom_t * atoms_rd;   /* this vector of structure atom_str is
      ! IS_EQUAL_REAL(a2[3], 0.0) )
  {
 #ifdef ERROR
-   fprintf(STDERR, " *** error (leed_inp_read_bul):\n");
+   fprintf(STDERR, " *** error (leed_inp_bul_setup_nd):\n");
    fprintf(STDERR,
            " Vectors a1 and a2 are not parallel to the surface (xy plane)\n");
 #endif
@@ -746,7 +908,7 @@ leed_atom_t * atoms_rd;   /* this vector of structure atom_str is
  {
 #ifdef ERROR
   fprintf(STDERR, 
-          "*** error (leed_inp_read_bul): superstructure is not commensurate \n");
+          "*** error (leed_inp_bul_setup_nd): superstructure is not commensurate \n");
 #endif
 #ifdef EXIT_ON_ERROR
   exit(1);
@@ -875,11 +1037,11 @@ leed_atom_t * atoms_rd;   /* this vector of structure atom_str is
    {
 #ifdef WARNING
       fprintf(STDWAR,
-      "* warning (leed_inp_read_bul): Some coordinates of bulk atoms exceede the\n");
+      "* warning (leed_inp_bul_setup_nd): Some coordinates of bulk atoms exceede the\n");
       fprintf(STDWAR,
       "                       bulk unit cell and will not be considered:\n");
       for(j = i; j < i_atoms; j ++)
-        fprintf(STDWAR," %s \t %7.4f  %7.4f  %7.4f\n", phaseinp, 
+        fprintf(STDWAR," type %d \t %7.4f  %7.4f  %7.4f\n", atoms_rd[j].type, 
                         atoms_rd[j].pos[1]*BOHR, 
                         atoms_rd[j].pos[2]*BOHR, 
                         atoms_rd[j].pos[3]*BOHR);
@@ -898,7 +1060,6 @@ leed_atom_t * atoms_rd;   /* this vector of structure atom_str is
 
    i_layer = leed_inp_bul_layer(bulk_par, atoms_rd, a3);
 
- free(atoms_rd);
 
  bulk_par->dmin = R_fabs(bulk_par->layers[0].vec_from_last[3]);
  for(i=0; i < bulk_par->nlayers - 1 /* origin is not relevant */; i++)
@@ -907,96 +1068,6 @@ leed_atom_t * atoms_rd;   /* this vector of structure atom_str is
             MIN(bulk_par->dmin, R_fabs(bulk_par->layers[i].vec_to_next[3]) );
  }
 
-#ifdef CONTROL_X
- printf("***********************(leed_inp_read_bul)***********************\n");
- printf("potentials:\n");
- printf("\tvr: %7.4f eV  vi: %7.4f eV\n", 
-        (bulk_par->vr)*HART, (bulk_par->vi)*HART);
-
- printf("\nbulk unit cell:\n");
- printf("\ta1:  (%7.4f  %7.4f  %7.4f) A\n", a1[1]*BOHR, a1[2]*BOHR, a1[3]*BOHR);
- printf("\ta2:  (%7.4f  %7.4f  %7.4f) A\n", a2[1]*BOHR, a2[2]*BOHR, a2[3]*BOHR);
- printf("\ta3:  (%7.4f  %7.4f  %7.4f) A\n", a3[1]*BOHR, a3[2]*BOHR, a3[3]*BOHR);
- printf("\n     reciprocal lattice: \n");
- printf("\ta1*: (%7.4f  %7.4f) A^-1\n", 
-         bulk_par->a_1[1]/BOHR, bulk_par->a_1[2]/BOHR);
- printf("\ta2*: (%7.4f  %7.4f) A^-1\n", 
-         bulk_par->a_1[3]/BOHR, bulk_par->a_1[4]/BOHR);
- printf("\nsuperstructure unit cell:\n");
- printf("\t(%5.2f %5.2f)\tb1:  (%7.4f  %7.4f) A\n", 
-         bulk_par->m_super[1], bulk_par->m_super[2],
-         bulk_par->b[1]*BOHR, bulk_par->b[3]*BOHR);
- printf("\t(%5.2f %5.2f)\tb2:  (%7.4f  %7.4f) A\n", 
-         bulk_par->m_super[3], bulk_par->m_super[4],
-         bulk_par->b[2]*BOHR, bulk_par->b[4]*BOHR);
-
- printf("\n     reciprocal lattice: \n");
- printf("\t(%5.2f %5.2f)\tb1*: (%7.4f  %7.4f) A^-1\n",
-         bulk_par->m_recip[1], bulk_par->m_recip[2],
-         bulk_par->b_1[1]/BOHR, bulk_par->b_1[2]/BOHR);
- printf("\t(%5.2f %5.2f)\tb2*: (%7.4f  %7.4f) A^-1\n",
-         bulk_par->m_recip[3], bulk_par->m_recip[4],
-         bulk_par->b_1[3]/BOHR, bulk_par->b_1[4]/BOHR);
-
- printf("\npositions(bulk):\n");
- 
- for(i=0; i < bulk_par->nlayers; i++)
- {
-   printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n", 
-           bulk_par->layers[i].vec_from_last[1]*BOHR,
-           bulk_par->layers[i].vec_from_last[2]*BOHR, 
-           bulk_par->layers[i].vec_from_last[3]*BOHR );
-
-   if( bulk_par->layers[i].periodic == 0 ) printf("np:");
-   else         printf("p: ");
-
-   for( j = 0; j < bulk_par->layers[i].natoms; j ++)
-   {
-     printf("\tpos: (%7.4f  %7.4f  %7.4f) A\tlayer: %d type: %d atom: %d\n", 
-             bulk_par->layers[i].atoms[j].pos[1]*BOHR, 
-             bulk_par->layers[i].atoms[j].pos[2]*BOHR, 
-             bulk_par->layers[i].atoms[j].pos[3]*BOHR,
-             bulk_par->layers[i].atoms[j].layer, 
-             bulk_par->layers[i].atoms[j].type, j);
-   }
- }
-
- printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n", 
-          bulk_par->layers[bulk_par->nlayers-1].vec_to_next[1]*BOHR,
-          bulk_par->layers[bulk_par->nlayers-1].vec_to_next[2]*BOHR, 
-          bulk_par->layers[bulk_par->nlayers-1].vec_to_next[3]*BOHR );
-
- printf("M_trans:\n");
- printf("\t%7.4f  %7.4f\n", bulk_par->m_trans[1], bulk_par->m_trans[2]);
- printf("\t%7.4f  %7.4f\n", bulk_par->m_trans[3], bulk_par->m_trans[4]);
- printf("comments:\n");
-
- for( i=0; i<i_com; i++)
- {
-   printf("\t%s", *(bulk_par->comments + i));
- }
-
- fprintf(STDCTR,"phase shifts:\n");
- fprintf(STDCTR,"\t%d different sets of phase shifts used:\n", 
-         bulk_par->ntypes);
- for(i_c = 0; i_c < bulk_par->ntypes; i_c ++)
-   fprintf(STDCTR,"\t(%d) %s (%d energies, lmax = %d)\tV<dr^2>_T = %.3f A^2\n",
-           i_c,
-           (*(p_phs_shifts)+i_c)->input_file, 
-           (*(p_phs_shifts)+i_c)->neng, 
-           (*(p_phs_shifts)+i_c)->lmax,
-           R_sqrt( (*(p_phs_shifts)+i_c)->dr[0] ) *BOHR);
-
- printf("***********************(leed_inp_read_bul)***********************\n");
-#endif
-
-
-/************************************************************************
- write the structures phs_shifts and bulk_par back.
-*************************************************************************/
-
- *p_bulk_par = bulk_par;
-
  return(1);
  i_layer = i_layer * 1;
 }
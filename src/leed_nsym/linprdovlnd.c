@@ -1,8 +1,11 @@
 /*********************************************************************
 GH/29.09.00 
-  file contains function:
+  file contains functions:
 
-  leed_read_overlayer
+  leed_read_overlayer_nd
+    Read the overlayer parameters from file.
+  leed_inp_over_setup_nd
+    Process the overlayer parameters (also used for input from memory).
  
 Changes:
 
@@ -14,6 +17,10 @@ WB/19.08.98 - atoms_rd realloc i_atoms+2
 GH/03.05.00 - read parameters for non-diagonal t matrix
             - fix bug in Debye waller factor (dmt): 0.0625
 GH/29.09.00 - calculate dr2 for dmt input in function leed_inp_debye_temp
+AG/17.10.26 - move processing of the input data into leed_inp_over_setup_nd
+AG/17.10.26 - read domain operations ('do').
+AG/17.10.26 - check the reallocation of the domain operations.
+AG/17.10.26 - declare the atom counter of the CONTROL output.
 
 *********************************************************************/
 
@@ -52,13 +59,20 @@ int leed_read_overlayer_nd (leed_cryst_t **p_over_par,
   currently recognized identifier:
   
   'c': comment
+  'do': domain operation and weight: 
+        "do: r <angle> [<weight>]" rotation by angle (deg.) about the 
+                                   z axis through the origin.
+        "do: m <angle> [<weight>]" mirror plane through the origin
+                                   containing z and the direction angle 
+                                   (deg.) with respect to x.
+        The intensities of all domains are averaged (see ldomnd.c).
   'po': postion and type of overlayer atoms.
 
   The atoms are in order of increasing z before they enter leed_inp_overlayer.
 
   FUNCTION CALLS
 
-   - leed_leed_leed_leed_inp_phase_nd
+   - leed_inp_phase_nd
    - leed_inp_overlayer
 
   RETURN VALUES
@@ -75,19 +89,22 @@ char linebuffer[STRSZ];
 char phaseinp[STRSZ];
 char whatnext[STRSZ];
 
-int i,j, iaux;                /* counter, dummy  variables */
+int i, iaux;                  /* counter, dummy  variables */
 int i_c, i_str;
 int i_com;
 int i_atoms;
-int i_layer;
+#ifdef CONTROL
+int j;                        /* atom counter (control output) */
+#endif
 
-real faux;                    /* dummy variable */
 real vaux[4];                 /* dummy vector */
+real faux;                    /* dummy variable */
+
+leed_domain_t *dom;           /* current domain */
 
 leed_cryst_t *over_par;   /* use *over_par instead of the pointer 
                                  p_over_par */
 
-leed_atom_t atom_aux;     /* used for sorting atoms */
 leed_atom_t *atoms_rd;    /* this vector of structure atom_str is
                                  used to read and treat the input atomic
                                  properties and will be copied into over_par
@@ -176,6 +193,72 @@ leed_atom_t *atoms_rd;    /* this vector of structure atom_str is
        break;
      } /* case 'c' */
 
+     case ('d'): case ('D'):
+   /*********************************** 
+     input of domain operations 'do':
+   ***********************************/
+     {
+     /* go on if 2nd letter is different from 'o' */
+       if( (*(linebuffer+i_str+1) != 'o') && (*(linebuffer+i_str+1) != 'O') )
+         break;
+
+       dom = (leed_domain_t *)realloc(over_par->dom,
+                       (over_par->n_dom + 1) * sizeof(leed_domain_t) );
+       if(dom == NULL)
+       {
+#ifdef ERROR
+         fprintf(STDERR, "*** error (leed_read_overlayer): "
+                 "allocation error (domain operations)\n");
+#endif
+#ifdef EXIT_ON_ERROR
+         exit(1);
+#else
+         fclose(inp_stream);
+         free(atoms_rd);
+         return(-1);
+#endif
+       }
+       over_par->dom = dom;
+       dom = over_par->dom + over_par->n_dom;
+       dom->weight = 1.;
+
+#ifdef REAL_IS_DOUBLE
+       iaux = sscanf(linebuffer+i_str+3 ," %s %lf %lf",
+#endif
+#ifdef REAL_IS_FLOAT
+       iaux = sscanf(linebuffer+i_str+3 ," %s %f %f",
+#endif
+              whatnext, &faux, &(dom->weight));
+
+       faux *= DEG_TO_RAD;
+       if( (iaux >= 2) && ( (whatnext[0] == 'r') || (whatnext[0] == 'R') ) )
+       {
+         dom->m[1] =  R_cos(faux); dom->m[2] = -R_sin(faux);
+         dom->m[3] =  R_sin(faux); dom->m[4] =  R_cos(faux);
+       }
+       else if( (iaux >= 2) && ( (whatnext[0] == 'm') || (whatnext[0] == 'M') ) )
+       {
+         dom->m[1] =  R_cos(2.*faux); dom->m[2] =  R_sin(2.*faux);
+         dom->m[3] =  R_sin(2.*faux); dom->m[4] = -R_cos(2.*faux);
+       }
+       else
+       {
+#ifdef ERROR
+         fprintf(STDERR, "*** error (leed_read_overlayer): "
+                 "could not interpret domain input:\n\t%s\n", linebuffer);
+#endif
+#ifdef EXIT_ON_ERROR
+         exit(1);
+#else
+         break;
+#endif
+       }
+
+       if(dom->weight < 0.) dom->weight = 0.;
+       over_par->n_dom ++;
+       break;
+     } /* case 'd' */
+
      case ('p'): case ('P'):
    /*********************************** 
      input of atom positions and types
@@ -296,7 +379,7 @@ leed_atom_t *atoms_rd;    /* this vector of structure atom_str is
        }
 
      /* input of atomic phase shifts */
-       atoms_rd[i_atoms].type = leed_leed_leed_leed_inp_phase_nd(phaseinp, vaux, 
+       atoms_rd[i_atoms].type = leed_inp_phase_nd(phaseinp, vaux, 
                                             atoms_rd[i_atoms].t_type, 
                                             p_phs_shifts);
        over_par->ntypes = MAX(atoms_rd[i_atoms].type+1, over_par->ntypes);
@@ -375,12 +458,133 @@ leed_atom_t *atoms_rd;    /* this vector of structure atom_str is
 
 /************************************************************************
   END OF INPUT
+  Process the input data.
+*************************************************************************/
+
+ leed_inp_over_setup_nd(over_par, bulk_par, atoms_rd, i_atoms);
+ free(atoms_rd);
+
+ if( (over_par->n_dom > 0) && (leed_dom_check_nd(over_par) < 0) )
+ {
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+#ifdef CONTROL
+ printf("***********************(leed_read_overlayer)***********************\n");
+ printf("\npositions (overlayer):\n");
+
+ printf("\n\tdmin (bulk and overlayer): %.4f\n", over_par->dmin*BOHR);
+ 
+ for(i=0; i < over_par->nlayers; i++)
+ {
+   printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n", 
+            over_par->layers[i].vec_from_last[1]*BOHR,
+            over_par->layers[i].vec_from_last[2]*BOHR, 
+            over_par->layers[i].vec_from_last[3]*BOHR );
+
+   if( over_par->layers[i].periodic == 0 ) printf("np:");
+   else         printf("p: ");
+
+   for( j = 0; j < over_par->layers[i].natoms; j ++)
+   {
+     printf("\tpos: (%7.4f  %7.4f  %7.4f) A\tlayer: %d type: %d atom: %d\n", 
+             over_par->layers[i].atoms[j].pos[1]*BOHR, 
+             over_par->layers[i].atoms[j].pos[2]*BOHR, 
+             over_par->layers[i].atoms[j].pos[3]*BOHR,
+             over_par->layers[i].atoms[j].layer, 
+             over_par->layers[i].atoms[j].type, j);
+   }
+ }
+
+ printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n", 
+          over_par->layers[over_par->nlayers-1].vec_to_next[1]*BOHR,
+          over_par->layers[over_par->nlayers-1].vec_to_next[2]*BOHR, 
+          over_par->layers[over_par->nlayers-1].vec_to_next[3]*BOHR );
+
+ printf("comments:\n");
+
+ for( i=0; i<i_com; i++)
+ {
+   printf("\t%s", *(over_par->comments + i));
+ }
+
+ fprintf(STDCTR,"phase shifts:\n");
+ fprintf(STDCTR,"\t%d different sets of phase shifts used:\n", 
+         over_par->ntypes);
+ for(i_c = 0; i_c < over_par->ntypes; i_c ++)
+   fprintf(STDCTR,"\t(%d) %s (%d energies, lmax = %d)\tV<dr^2>_T = %.3f A^2\n",
+           i_c,
+           (*(p_phs_shifts)+i_c)->input_file, 
+           (*(p_phs_shifts)+i_c)->neng, 
+           (*(p_phs_shifts)+i_c)->lmax,
+           R_sqrt( (*(p_phs_shifts)+i_c)->dr[0] ) *BOHR);
+
+ printf("***********************(leed_read_overlayer)***********************\n");
+#endif
+
+
+/************************************************************************
+ write the structures phs_shifts and over_par back.
+*************************************************************************/
+
+ *p_over_par = over_par;
+
+ return(1);
+}
+/********************************************************************/
+
+int leed_inp_over_setup_nd(leed_cryst_t *over_par,
+                  leed_cryst_t *bulk_par,
+                  leed_atom_t *atoms_rd, int n_atoms)
+/*********************************************************************
+  Process the overlayer parameters after input (from file or memory).
+
+  INPUT:
+
+  leed_cryst_t *over_par - (input/output) overlayer parameters. Must be
+            a copy of bulk_par with vr, temp and ntypes updated for the
+            overlayer atoms.
+  leed_cryst_t *bulk_par - (input/output) bulk parameters (as set up by
+            leed_inp_bul_setup_nd). dmin, vr, ntypes and n_rot are 
+            updated from the overlayer.
+  leed_atom_t *atoms_rd - (input) overlayer atoms (positions in atomic
+            units, type, t_type). The array must have space for 
+            n_atoms + 1 elements; the atoms are sorted and moved into 
+            the superstructure unit cell.
+  int n_atoms - number of atoms in atoms_rd.
+
+  DESIGN
+
+  - Move the atoms into the unit cell and sort them by z.
+  - Distribute the atoms to layers (leed_inp_overlayer) and find dmin.
+
+  RETURN VALUES
 
+    1 if ok.
+
+*********************************************************************/
+{
+int i,j, iaux;                /* counter, dummy  variables */
+int i_atoms;
+int i_layer;
+
+real faux;                    /* dummy variable */
+real vaux[4];                 /* dummy vector */
+
+leed_atom_t atom_aux;     /* used for sorting atoms */
+
+ i_atoms = n_atoms;
+
+/************************************************************************
   Start processing input data if there were any (i_atoms > 0)
 *************************************************************************/
 
 #ifdef CONTROL_X
- fprintf(STDCTR, "(leed_read_overlayer): start processing: i_atoms = %d\n", i_atoms);
+ fprintf(STDCTR, "(leed_inp_over_setup_nd): start processing: i_atoms = %d\n", i_atoms);
 #endif
  atoms_rd[i_atoms].type = I_END_OF_LIST;
  over_par->natoms = i_atoms;
@@ -423,7 +627,7 @@ leed_atom_t *atoms_rd;    /* this vector of structure atom_str is
 *************************************************************************/
 
 #ifdef CONTROL_X
- fprintf(STDCTR, "(leed_read_overlayer): sorting \n");
+ fprintf(STDCTR, "(leed_inp_over_setup_nd): sorting \n");
 #endif
    for(i=0; i<i_atoms; i++)
      for(j=i+1; j<i_atoms; j++)
@@ -443,7 +647,6 @@ leed_atom_t *atoms_rd;    /* this vector of structure atom_str is
 
     i_layer = leed_inp_overlayer(over_par, atoms_rd);
 
-  free(atoms_rd);
   
 /* 
    Find the minimum interlayer distance in bulk and overlayer.
@@ -458,14 +661,14 @@ leed_atom_t *atoms_rd;    /* this vector of structure atom_str is
    over_par->dmin = MIN(over_par->dmin, faux);
 
 #ifdef CONTROL
-   fprintf(STDCTR, "(leed_read_overlayer): bulk - overlayer distance = %5.2f\n", 
+   fprintf(STDCTR, "(leed_inp_over_setup_nd): bulk - overlayer distance = %5.2f\n", 
                    faux*BOHR);
 #endif
 
    for(i=1; i < over_par->nlayers; i++)
    {
 #ifdef CONTROL
-     fprintf(STDCTR, "(leed_read_overlayer): interlayer distance [%d] = %5.2f\n",
+     fprintf(STDCTR, "(leed_inp_over_setup_nd): interlayer distance [%d] = %5.2f\n",
              i, over_par->layers[i].vec_from_last[3]*BOHR);
 #endif
      over_par->dmin = 
@@ -488,65 +691,6 @@ leed_atom_t *atoms_rd;    /* this vector of structure atom_str is
  bulk_par->ntypes = over_par->ntypes;
  bulk_par->n_rot = over_par->n_rot;
 
-#ifdef CONTROL
- printf("***********************(leed_read_overlayer)***********************\n");
- printf("\npositions (overlayer):\n");
-
- printf("\n\tdmin (bulk and overlayer): %.4f\n", over_par->dmin*BOHR);
- 
- for(i=0; i < over_par->nlayers; i++)
- {
-   printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n", 
-            over_par->layers[i].vec_from_last[1]*BOHR,
-            over_par->layers[i].vec_from_last[2]*BOHR, 
-            over_par->layers[i].vec_from_last[3]*BOHR );
-
-   if( over_par->layers[i].periodic == 0 ) printf("np:");
-   else         printf("p: ");
-
-   for( j = 0; j < over_par->layers[i].natoms; j ++)
-   {
-     printf("\tpos: (%7.4f  %7.4f  %7.4f) A\tlayer: %d type: %d atom: %d\n", 
-             over_par->layers[i].atoms[j].pos[1]*BOHR, 
-             over_par->layers[i].atoms[j].pos[2]*BOHR, 
-             over_par->layers[i].atoms[j].pos[3]*BOHR,
-             over_par->layers[i].atoms[j].layer, 
-             over_par->layers[i].atoms[j].type, j);
-   }
- }
-
- printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n", 
-          over_par->layers[over_par->nlayers-1].vec_to_next[1]*BOHR,
-          over_par->layers[over_par->nlayers-1].vec_to_next[2]*BOHR, 
-          over_par->layers[over_par->nlayers-1].vec_to_next[3]*BOHR );
-
- printf("comments:\n");
-
- for( i=0; i<i_com; i++)
- {
-   printf("\t%s", *(over_par->comments + i));
- }
-
- fprintf(STDCTR,"phase shifts:\n");
- fprintf(STDCTR,"\t%d different sets of phase shifts used:\n", 
-         over_par->ntypes);
- for(i_c = 0; i_c < over_par->ntypes; i_c ++)
-   fprintf(STDCTR,"\t(%d) %s (%d energies, lmax = %d)\tV<dr^2>_T = %.3f A^2\n",
-           i_c,
-           (*(p_phs_shifts)+i_c)->input_file, 
-           (*(p_phs_shifts)+i_c)->neng, 
-           (*(p_phs_shifts)+i_c)->lmax,
-           R_sqrt( (*(p_phs_shifts)+i_c)->dr[0] ) *BOHR);
-
- printf("***********************(leed_read_overlayer)***********************\n");
-#endif
-
-
-/************************************************************************
- write the structures phs_shifts and over_par back.
-*************************************************************************/
-
- *p_over_par = over_par;
 
  return(1);
  i_layer = i_layer * 1;
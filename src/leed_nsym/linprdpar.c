@@ -3,6 +3,7 @@
   file contains function:
 
   leed_inp_leed_read_par
+  leed_inp_par_setup
  
 CHANGES:
 
@@ -10,6 +11,8 @@ CHANGES:
   GH/07.03.95 - Add angles of incidence.
   GH/07.07.95 - Read output file.
   GH/28.07.95 - complete redesign.
+  AG/17.10.26 - move checks of input data into leed_inp_par_setup.
+  AG/17.10.26 - missing break after case 'l' (fell through to 'v').
 
 *********************************************************************/
 
@@ -276,7 +279,7 @@ char linebuffer[STRSZ];         /* input buffer */
            sscanf(linebuffer+i_str+3 ,"%d", &(var_par->l_max) );
            break; }
        }
-
+       break;
      } /* case 'l' */
 
      case ('v'): case ('V'):
@@ -341,8 +344,43 @@ char linebuffer[STRSZ];         /* input buffer */
 
  fclose(inp_stream);
 
+ if(leed_inp_par_setup(var_par, eng_par) < 0) return(-1);
+
+/************************************************************************
+  Write eng_par and var_par back to their pointers and return.
+*************************************************************************/
+
+  *p_eng_par = eng_par;
+  *p_var_par = var_par;
+  return(1);
+}  /* end of function (leed_inp_leed_read_par) */
+
+/********************************************************************/
+
+int leed_inp_par_setup(leed_var_t * var_par, leed_energy_t * eng_par)
+/*********************************************************************
+  Check and complete the parameters in var_par and eng_par.
+
+  INPUT:
+
+  leed_var_t * var_par - (input/output) parameters. l_max is calculated
+            from the final energy if var_par->l_max <= 0.
+  leed_energy_t * eng_par - (input/output) energy parameters (Hartree).
+
+  DESIGN:
+
+  Called by leed_inp_leed_read_par after reading the input file and by
+  leed_inp_par_mem for parameters supplied in memory.
+
+  RETURN VALUE:
+   1 if successful.
+  -1 if failed (and EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+real faux;
+
 /************************************************************************
-  END OF INPUT
   Start controlling and processing input data.
 *************************************************************************/
 
@@ -357,7 +395,7 @@ char linebuffer[STRSZ];         /* input buffer */
  {
 #ifdef ERROR
    fprintf(STDERR,
-     "*** error (leed_inp_leed_read_par): no initial energy available (Eini = %.1f)\n", 
+     "*** error (leed_inp_par_setup): no initial energy available (Eini = %.1f)\n", 
      eng_par->ini * HART);
 #endif
 #ifdef EXIT_ON_ERROR
@@ -371,7 +409,7 @@ char linebuffer[STRSZ];         /* input buffer */
  {
 #ifdef WARNING
    fprintf(STDWAR, 
-     "* warning (leed_inp_leed_read_par): final energy (%.1f) <= initial energy (%.1f)\n",
+     "* warning (leed_inp_par_setup): final energy (%.1f) <= initial energy (%.1f)\n",
      eng_par->fin * HART, eng_par->ini * HART);
    fprintf(STDWAR, 
      "*         only one energy step will be performed.\n");
@@ -383,7 +421,7 @@ char linebuffer[STRSZ];         /* input buffer */
  {
 #ifdef WARNING
    fprintf(STDWAR, 
-     "* warning (leed_inp_leed_read_par): energy <= 0. (%.1f)\n", eng_par->stp * HART);
+     "* warning (leed_inp_par_setup): energy <= 0. (%.1f)\n", eng_par->stp * HART);
    fprintf(STDWAR, 
      "*         only one energy step will be performed.\n");
 #endif
@@ -392,7 +430,7 @@ char linebuffer[STRSZ];         /* input buffer */
 
 #ifdef CONTROL
 fprintf(STDCTR,
- "******************************(leed_inp_leed_read_par)*****************************\n");
+ "******************************(leed_inp_par_setup)*****************************\n");
    fprintf(STDCTR,"energy loop:\n");
    fprintf(STDCTR,"\tstart:\t%.1f eV\n",eng_par->ini * HART);
    fprintf(STDCTR,"\tend:\t%.1f eV\n",eng_par->fin * HART);
@@ -408,7 +446,7 @@ fprintf(STDCTR,
  {
 #ifdef WARNING
    fprintf(STDWAR,
-"* warning (leed_inp_leed_read_par): l_max = %d <= 0\n", var_par->l_max);
+"* warning (leed_inp_par_setup): l_max = %d <= 0\n", var_par->l_max);
 #endif
    faux = R_sqrt(2. * eng_par->fin) * R_FOR_LMAX;
    var_par->l_max = (int)R_nint(faux);
@@ -419,10 +457,6 @@ fprintf(STDCTR,
 #endif
  }
 
-/************************************************************************
-  Write eng_par and var_par back to their pointers and return.
-*************************************************************************/
-
 #ifdef CONTROL
    fprintf(STDCTR,"\nparameter structure:\n");
    fprintf(STDCTR,"\tvr:\t%.2f eV,\tvi:\t%.2f eV (pref), (expt: %.2f)\n", 
@@ -432,10 +466,8 @@ fprintf(STDCTR,
    fprintf(STDCTR,"\teps:\t%.1e,\tl_max:\t%d\n",
            var_par->epsilon, var_par->l_max);
 fprintf(STDCTR,
- "******************************(leed_inp_leed_read_par)*****************************\n");
+ "******************************(leed_inp_par_setup)*****************************\n");
 #endif
 
-  *p_eng_par = eng_par;
-  *p_var_par = var_par;
   return(1);
-}  /* end of function (leed_inp_leed_read_par) */
+}  /* end of function (leed_inp_par_setup) */
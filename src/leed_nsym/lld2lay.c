@@ -9,6 +9,8 @@
 Changes:
  GH/06.09.94 - Creation
  GH/30.01.95 - 
+ AG/17.10.26 - static storage is thread private (beam sets in parallel).
+ AG/17.10.26 - propagators from the packed beam table (leed_beam_tab_phase).
 
 *********************************************************************/
 
@@ -75,11 +77,15 @@ int leed_ld_2lay ( mat *p_Tpp_ab, mat *p_Tmm_ab, mat *p_Rpm_ab, mat *p_Rmp_ab,
 int k;
 int n_beams, nn_beams;                   /* total number of beams */
 
-real faux_r, faux_i;
 real *ptr_r, *ptr_i, *ptr_end;
 
 static mat Pp = NULL, Pm = NULL, Maux_a = NULL, Maux_b = NULL;
 static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
+static leed_beam_tab_t tab = {0, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+#ifdef _USE_OPENMP
+#pragma omp threadprivate(Pp, Pm, Maux_a, Maux_b)
+#pragma omp threadprivate(Tpp_ab, Tmm_ab, Rpm_ab, Rmp_ab, tab)
+#endif
 
 
 /*
@@ -109,34 +115,19 @@ static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
          vec_ab[1] * BOHR, vec_ab[2] * BOHR , vec_ab[3] * BOHR);
 #endif
 
+ leed_beam_tab(&tab, beams, n_beams);
+ leed_beam_tab_phase(Pp->rel+1, Pp->iel+1, &tab, 0, n_beams, vec_ab, 1.,  1.);
+ leed_beam_tab_phase(Pm->rel+1, Pm->iel+1, &tab, 0, n_beams, vec_ab, -1., 1.);
+
+#ifdef CONTROL
  for( k = 0; k < n_beams; k++)
  {
-#ifdef CONTROL
    fprintf(STDCTR, "(leed_ld_2lay): %2d: k_r = %6.3f %6.3f %6.3f, k_i = %6.3f;",
-           k, (beams+k)->k_r[1], (beams+k)->k_r[2], (beams+k)->k_r[3],
-           (beams+k)->k_i[3]);
-#endif
-
-   faux_r = (beams+k)->k_r[1] * vec_ab[1] +
-            (beams+k)->k_r[2] * vec_ab[2] + 
-            (beams+k)->k_r[3] * vec_ab[3];
-   faux_i = (beams+k)->k_i[3] * vec_ab[3];
-
-   cri_expi(Pp->rel+k+1, Pp->iel+k+1, faux_r, faux_i);
-
-   faux_r -= 2. * (beams+k)->k_r[3] * vec_ab[3];
-
-   cri_expi(Pm->rel+k+1, Pm->iel+k+1, -faux_r, faux_i);
-
-#ifdef CONTROL
-   fprintf(STDCTR," Pp = (%6.3f,%6.3f), Pm = (%6.3f,%6.3f)",
+           k, tab.k_x[k], tab.k_y[k], tab.kz_r[k], tab.kz_i[k]);
+   fprintf(STDCTR," Pp = (%6.3f,%6.3f), Pm = (%6.3f,%6.3f)\n",
            Pp->rel[k+1], Pp->iel[k+1], Pm->rel[k+1], Pm->iel[k+1]);
-
-   cri_mul(&faux_r,&faux_i,
-           Pp->rel[k+1],Pp->iel[k+1],Pm->rel[k+1],Pm->iel[k+1]);
-   fprintf(STDCTR,": (%6.3f,%6.3f)\n", faux_r, faux_i);
-#endif
  }
+#endif
  
 /*************************************************************************
   Prepare the quantities (Ra+- P-) and  -(Rb-+ P+):
@@ -146,26 +137,14 @@ static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
  Maux_a = matcop(Maux_a, Rpm_a);
  Maux_b = matcop(Maux_b, Rmp_b);
 
- for(k = 1; k <= n_beams; k ++)
- {
-
-   faux_r = *(Pm->rel+k);
-   faux_i = *(Pm->iel+k);
-
-   ptr_end = Maux_a->rel+nn_beams;
-   for (ptr_r = Maux_a->rel+k, ptr_i = Maux_a->iel+k;
-        ptr_r <= ptr_end; ptr_r += n_beams,  ptr_i += n_beams)
-     cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
-
-   faux_r = - *(Pp->rel+k);
-   faux_i = - *(Pp->iel+k);
-
-   ptr_end = Maux_b->rel+nn_beams;
-   for (ptr_r = Maux_b->rel+k, ptr_i = Maux_b->iel+k;
-        ptr_r <= ptr_end; ptr_r += n_beams,  ptr_i += n_beams)
-     cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
+ leed_beam_tab_mul_cols(Maux_a, Pm->rel+1, Pm->iel+1);
 
+ for(k = 0; k < n_beams; k ++)
+ {
+   tab.ph_r[k] = - Pp->rel[k+1];
+   tab.ph_i[k] = - Pp->iel[k+1];
  }
+ leed_beam_tab_mul_cols(Maux_b, tab.ph_r, tab.ph_i);
 
 /*************************************************************************
   (i) Calculate the quantities  
@@ -231,24 +210,8 @@ static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
  Maux_a = matcop(Maux_a, Tmm_a);
  Maux_b = matcop(Maux_b, Tpp_b);
 
- for(k = 1; k <= n_beams; k ++)
- {
-   faux_r = *(Pm->rel+k);
-   faux_i = *(Pm->iel+k);
-
-   ptr_end=Maux_a->rel+nn_beams;
-   for (ptr_r = Maux_a->rel+k, ptr_i = Maux_a->iel+k;
-        ptr_r <= ptr_end; ptr_r += n_beams, ptr_i += n_beams)
-     cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
-
-   faux_r = *(Pp->rel+k);
-   faux_i = *(Pp->iel+k);
-
-   ptr_end=Maux_b->rel+nn_beams;
-   for (ptr_r = Maux_b->rel+k, ptr_i = Maux_b->iel+k;
-        ptr_r <= ptr_end;  ptr_r += n_beams, ptr_i += n_beams)
-     cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
- }
+ leed_beam_tab_mul_cols(Maux_a, Pm->rel+1, Pm->iel+1);
+ leed_beam_tab_mul_cols(Maux_b, Pp->rel+1, Pp->iel+1);
 
 /*************************************************************************
   (i) Finish the computation of Tab++ and Tab--:
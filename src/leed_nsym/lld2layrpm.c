@@ -5,19 +5,35 @@
   leed_ld_2lay_rpm        (26.01.95)
      Calculate the reflection matrix R+- for a stack of two (super)layers
      by layer doubling
+  leed_ld_2lay_rpm1       (17.10.26)
+     Calculate only the first column of R+- for a stack of two
+     (super)layers (incident beam)
 
 Changes:
  GH/26.01.95 - Creation: copied from leed_ld_2lay and modified
+ AG/17.10.26 - Rpm_a can be block diagonal (e.g. bulk: one block per
+               beam set); its structure is used in the multiplications.
+ AG/17.10.26 - add leed_ld_2lay_rpm1 (first column only, linear solve
+               instead of inversion).
+ AG/17.10.26 - propagators from the packed beam table (leed_beam_tab_phase).
+ AG/17.10.26 - block diagonal Rpm_a: empty blocks (empty beam sets).
+ AG/17.10.26 - leed_ld_2lay_rpm1: return NULL if matsolve fails.
 
 *********************************************************************/
 
 #include <math.h>
 #include <malloc.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "leed.h"
 
+static leed_beam_tab_t tab = {0, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+#ifdef _USE_OPENMP
+#pragma omp threadprivate(tab)
+#endif
+
 /*======================================================================*/
 /*======================================================================*/
 
@@ -36,6 +52,8 @@ mat leed_ld_2lay_rpm ( mat Rpm_ab,
    mat Rpm_ab - (output) reflection matrix (+-) of the stack "ab".
 
    mat Rpm_a - (input) reflection matrix (+-) of the "lower" layer "a".
+               Either a full matrix or a block-diagonal matrix (matrix
+               array of diagonal blocks, see matbdmul).
 
    mat Tpp_b - (input) transmission matrix (++) of the "upper" layer "b".
    mat Tmm_b - (input) transmission matrix (--) of the "upper" layer "b".
@@ -54,6 +72,10 @@ mat leed_ld_2lay_rpm ( mat Rpm_ab,
 
    Rab+- = Rb+- + (Tb++ P+ Ra+- P-) * (I - Rb-+ P+ Ra+- P-)^(-1) * Tb--
 
+   If Ra+- is block diagonal, so is (Ra+- P-). The two products which
+   contain (Ra+- P-) are then computed block by block (matmulbd,
+   matbdmul); the inversion remains a full one, since Rb-+ couples
+   all beams.
    
 
  RETURN VALUES:
@@ -64,12 +86,14 @@ mat leed_ld_2lay_rpm ( mat Rpm_ab,
 *************************************************************************/
 {
 int k;
+int i_blk, off;
 int n_beams, nn_beams;             /* total number of beams */
+int bd_a;                          /* Rpm_a is block diagonal */
 
-real faux_r, faux_i;
 real *ptr_r, *ptr_i, *ptr_end;
 
 mat Pp, Pm, Maux_a, Maux_b;        /* temp. storage space */
+mat Mblk;
 mat Res;                           /* result will be copied to Rpm_ab */
 
 
@@ -79,6 +103,8 @@ mat Res;                           /* result will be copied to Rpm_ab */
   Check arguments:
 *************************************************************************/
 
+ bd_a = (Rpm_a->blk_type == BLK_ARRAY) || (Rpm_a->blk_type == BLK_END);
+
 /*************************************************************************
   Allocate memory and set up propagators Pp and Pm. 
 
@@ -86,7 +112,8 @@ mat Res;                           /* result will be copied to Rpm_ab */
   Pm = exp[-i *( k_x*v_ab_x + k_y*v_ab_y - k_z*v_ab_z) ]
      = exp[ i *(-k_x*v_ab_x - k_y*v_ab_y + k_z*v_ab_z) ]
 *************************************************************************/
- n_beams = Rpm_a->cols;
+ if(bd_a) n_beams = matbddim(Rpm_a);
+ else     n_beams = Rpm_a->cols;
  nn_beams = n_beams * n_beams;
 
  Pp = matalloc(NULL, n_beams, 1, NUM_COMPLEX );
@@ -97,57 +124,51 @@ mat Res;                           /* result will be copied to Rpm_ab */
                               ,vec_ab[1],vec_ab[2],vec_ab[3]);
 #endif
 
- for( k = 0; k < n_beams; k++)
- {
-#ifdef CONTROL
- fprintf(STDCTR,"ld: %2d: k_r = %5.2f %5.2f %5.2f\tk_i = %5.2f;",
-        k, (beams+k)->k_r[1], (beams+k)->k_r[2], (beams+k)->k_r[3],
-        (beams+k)->k_i[3]);
-#endif
-
-   faux_r = (beams+k)->k_r[1] * vec_ab[1] +
-            (beams+k)->k_r[2] * vec_ab[2] + 
-            (beams+k)->k_r[3] * vec_ab[3];
-   faux_i = (beams+k)->k_i[3] * vec_ab[3];
-   
-   cri_expi(Pp->rel+k+1, Pp->iel+k+1, faux_r, faux_i);
-
-   faux_r -= 2 * (beams+k)->k_r[3] * vec_ab[3];
-
-   cri_expi(Pm->rel+k+1, Pm->iel+k+1, -faux_r, faux_i);
-
-/*
-   printf("\tPp = (%6.3f,%6.3f), Pm = (%6.3f,%6.3f)\n",
-           Pp->rel[k+1], Pp->iel[k+1], Pm->rel[k+1], Pm->iel[k+1]);
-*/
- }
+ leed_beam_tab(&tab, beams, n_beams);
+ leed_beam_tab_phase(Pp->rel+1, Pp->iel+1, &tab, 0, n_beams, vec_ab, 1.,  1.);
+ leed_beam_tab_phase(Pm->rel+1, Pm->iel+1, &tab, 0, n_beams, vec_ab, -1., 1.);
  
 /*************************************************************************
   Prepare the quantities (Ra+- P-) and  -(Rb-+ P+):
   Multiply the k-th column of Ra+- / Rb-+ with the k-th element of P-/+.
 *************************************************************************/
 
- Maux_a = matcop(Maux_a, Rpm_a);
  Maux_b = matcop(Maux_b, Rmp_b);
 
- for(k = 1; k <= n_beams; k ++)
+ if(bd_a)
  {
-   faux_r = *(Pm->rel+k);
-   faux_i = *(Pm->iel+k);
-
-   ptr_end = Maux_a->rel+nn_beams;
-   for (ptr_r = Maux_a->rel+k, ptr_i = Maux_a->iel+k;
-        ptr_r <= ptr_end; ptr_r += n_beams,  ptr_i += n_beams)
-     cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
+   for(i_blk = 0; (Rpm_a+i_blk)->blk_type == BLK_ARRAY; i_blk ++)
+     ;
+   Maux_a = matarralloc(Maux_a, i_blk);
+
+   for(i_blk = 0, off = 0; 
+       (Rpm_a+i_blk)->blk_type == BLK_ARRAY; 
+       off += (Rpm_a+i_blk)->cols, i_blk ++)
+   {
+     /* empty beam set (0 x 0 block without elements) */
+     if((Rpm_a+i_blk)->cols < 1)
+     {
+       *(Maux_a+i_blk) = *(Rpm_a+i_blk);
+       continue;
+     }
+     Mblk = matcop(Maux_a+i_blk, Rpm_a+i_blk);
+
+     leed_beam_tab_mul_cols(Mblk, Pm->rel+off+1, Pm->iel+off+1);
+   }
+ }
+ else
+ {
+   Maux_a = matcop(Maux_a, Rpm_a);
 
-   faux_r = - *(Pp->rel+k);
-   faux_i = - *(Pp->iel+k);
+   leed_beam_tab_mul_cols(Maux_a, Pm->rel+1, Pm->iel+1);
+ }
 
-   ptr_end = Maux_b->rel+nn_beams;
-   for (ptr_r = Maux_b->rel+k, ptr_i = Maux_b->iel+k;
-        ptr_r <= ptr_end; ptr_r += n_beams,  ptr_i += n_beams)
-     cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
+ for(k = 0; k < n_beams; k ++)
+ {
+   tab.ph_r[k] = - Pp->rel[k+1];
+   tab.ph_i[k] = - Pp->iel[k+1];
  }
+ leed_beam_tab_mul_cols(Maux_b, tab.ph_r, tab.ph_i);
 
 /*************************************************************************
   (i) Calculate
@@ -166,7 +187,8 @@ mat Res;                           /* result will be copied to Rpm_ab */
 *************************************************************************/
 
 /* (i) */
- Maux_b = matmul(Maux_b, Maux_b, Maux_a);
+ if(bd_a) Maux_b = matmulbd(Maux_b, Maux_b, Maux_a);
+ else     Maux_b = matmul(Maux_b, Maux_b, Maux_a);
 
  for(k = 1; k <= nn_beams; k+= Maux_b->cols + 1)
  {
@@ -180,7 +202,8 @@ mat Res;                           /* result will be copied to Rpm_ab */
  Maux_b = matmul(Maux_b, Maux_b, Tmm_b);
 
 /* (iv) */
- Res = matmul(Res, Maux_a, Maux_b);
+ if(bd_a) Res = matbdmul(Res, Maux_a, Maux_b);
+ else     Res = matmul(Res, Maux_a, Maux_b);
 
 /*************************************************************************
   Prepare Maux_b = (Tb++ P+):
@@ -190,16 +213,7 @@ mat Res;                           /* result will be copied to Rpm_ab */
  Maux_b = matcop(Maux_b, Tpp_b);
 
 
- for(k = 1; k <= n_beams; k ++)
- {
-   faux_r = *(Pp->rel+k);
-   faux_i = *(Pp->iel+k);
-
-   ptr_end=Maux_b->rel+nn_beams;
-   for (ptr_r = Maux_b->rel+k, ptr_i = Maux_b->iel+k;
-        ptr_r <= ptr_end;  ptr_r += n_beams, ptr_i += n_beams)
-     cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
- }
+ leed_beam_tab_mul_cols(Maux_b, Pp->rel+1, Pp->iel+1);
 
 /*************************************************************************
  (i) Complete the computation of the matrix product in Rab+- and Rab-+:
@@ -232,7 +246,8 @@ mat Res;                           /* result will be copied to Rpm_ab */
 
  matfree(Pp);
  matfree(Pm);
- matfree(Maux_a);
+ if(bd_a) matarrfree(Maux_a);
+ else     matfree(Maux_a);
  matfree(Maux_b);
 
  Rpm_ab = matcop(Rpm_ab, Res);
@@ -243,3 +258,201 @@ mat Res;                           /* result will be copied to Rpm_ab */
  
 /*======================================================================*/
 /*======================================================================*/
+
+mat leed_ld_2lay_rpm1 ( mat Rpm1_ab,
+                mat Rpm_a,
+                mat Tpp_b,  mat Tmm_b,  mat Rpm_b,  mat Rmp_b,
+                leed_beam_t *beams, real *vec_ab )
+
+/************************************************************************
+
+   Calculate only the first column of the reflection matrix R+- (i.e. the
+   amplitudes for the incident (00) beam) for a stack of two (super) 
+   layers "a" and "b" (z(a) < z(b)) by layer doubling.
+
+ INPUT:
+
+   mat Rpm1_ab - (output) first column of the reflection matrix (+-) of 
+               the stack "ab" (n_beams x 1).
+
+   mat Rpm_a, Tpp_b, Tmm_b, Rpm_b, Rmp_b, beams, vec_ab - 
+               see leed_ld_2lay_rpm. Rpm_a must be the complete matrix
+               (full or block diagonal).
+
+ DESIGN:
+
+   Same formula as in leed_ld_2lay_rpm, applied to the first column of 
+   Tb-- only:
+
+   Rab+-(:,1) = Rb+-(:,1) + Tb++ P+ Ra+- P- * X,
+   
+   where X is the solution of the linear equations
+
+   (I - Rb-+ P+ Ra+- P-) * X = Tb--(:,1).
+
+   Instead of the inversion and three n_beams^2 matrix products, only one
+   matrix product, the LU decomposition (matsolve) and matrix-vector 
+   products are needed. Since the full R+- of the stack is not known 
+   afterwards, this can only be used for the top-most layer 
+   (see leed_ld_potstep0).
+
+ RETURN VALUES:
+
+   mat Rpm1_ab - first column of the reflection matrix (+-) of the stack
+                "ab" (not necessarily equal to the first argument).
+
+*************************************************************************/
+{
+int k;
+int i_blk, off;
+int n_beams, nn_beams;             /* total number of beams */
+int bd_a;                          /* Rpm_a is block diagonal */
+
+mat Pp, Pm, Maux_a, Maux_b;        /* temp. storage space */
+mat Mblk;
+mat Col;                           /* result will be copied to Rpm1_ab */
+
+
+ Col = Pp = Pm = Maux_a = Maux_b = NULL;
+
+ bd_a = (Rpm_a->blk_type == BLK_ARRAY) || (Rpm_a->blk_type == BLK_END);
+
+/*************************************************************************
+  Allocate memory and set up propagators Pp and Pm (see leed_ld_2lay_rpm).
+*************************************************************************/
+ if(bd_a) n_beams = matbddim(Rpm_a);
+ else     n_beams = Rpm_a->cols;
+ nn_beams = n_beams * n_beams;
+
+ Pp = matalloc(NULL, n_beams, 1, NUM_COMPLEX );
+ Pm = matalloc(NULL, n_beams, 1, NUM_COMPLEX );
+
+ leed_beam_tab(&tab, beams, n_beams);
+ leed_beam_tab_phase(Pp->rel+1, Pp->iel+1, &tab, 0, n_beams, vec_ab, 1.,  1.);
+ leed_beam_tab_phase(Pm->rel+1, Pm->iel+1, &tab, 0, n_beams, vec_ab, -1., 1.);
+ 
+/*************************************************************************
+  Prepare the quantities (Ra+- P-) and  -(Rb-+ P+).
+*************************************************************************/
+
+ Maux_b = matcop(Maux_b, Rmp_b);
+
+ if(bd_a)
+ {
+   for(i_blk = 0; (Rpm_a+i_blk)->blk_type == BLK_ARRAY; i_blk ++)
+     ;
+   Maux_a = matarralloc(Maux_a, i_blk);
+
+   for(i_blk = 0, off = 0; 
+       (Rpm_a+i_blk)->blk_type == BLK_ARRAY; 
+       off += (Rpm_a+i_blk)->cols, i_blk ++)
+   {
+     /* empty beam set (0 x 0 block without elements) */
+     if((Rpm_a+i_blk)->cols < 1)
+     {
+       *(Maux_a+i_blk) = *(Rpm_a+i_blk);
+       continue;
+     }
+     Mblk = matcop(Maux_a+i_blk, Rpm_a+i_blk);
+
+     leed_beam_tab_mul_cols(Mblk, Pm->rel+off+1, Pm->iel+off+1);
+   }
+ }
+ else
+ {
+   Maux_a = matcop(Maux_a, Rpm_a);
+
+   leed_beam_tab_mul_cols(Maux_a, Pm->rel+1, Pm->iel+1);
+ }
+
+ for(k = 0; k < n_beams; k ++)
+ {
+   tab.ph_r[k] = - Pp->rel[k+1];
+   tab.ph_i[k] = - Pp->iel[k+1];
+ }
+ leed_beam_tab_mul_cols(Maux_b, tab.ph_r, tab.ph_i);
+
+/*************************************************************************
+  (i) Maux_b = I - (Rb-+ P+ Ra+- P-)
+
+ (ii) Solve Maux_b * X = Tb--(:,1) (-> Col)
+
+(iii) Col = Ra+- P- * X
+*************************************************************************/
+
+/* (i) */
+ if(bd_a) Maux_b = matmulbd(Maux_b, Maux_b, Maux_a);
+ else     Maux_b = matmul(Maux_b, Maux_b, Maux_a);
+
+ for(k = 1; k <= nn_beams; k+= Maux_b->cols + 1)
+ {
+   Maux_b->rel[k] += 1.;
+ }
+
+/* (ii) */
+ Col = matcol(Col, Tmm_b, 1);
+ if(matsolve(Col, Maux_b, Col) == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_ld_2lay_rpm1): "
+           "linear equations could not be solved (matsolve)\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   matfree(Pp);
+   matfree(Pm);
+   if(bd_a) matarrfree(Maux_a);
+   else     matfree(Maux_a);
+   matfree(Maux_b);
+   matfree(Col);
+   if(Rpm1_ab != NULL) matfree(Rpm1_ab);
+   return(NULL);
+#endif
+ }
+
+/* (iii) */
+ if(bd_a) Col = matbdmul(Col, Maux_a, Col);
+ else     Col = matmul(Col, Maux_a, Col);
+
+/*************************************************************************
+ (i) Multiply with P+ and Tb++: Col = Tb++ * (P+ Col)
+     (Tb++ P+ is Tb++ with the k-th column multiplied by P+(k))
+
+(ii) Add the first column of Rb+-.
+*************************************************************************/
+
+/* (i) */
+ for(k = 1; k <= n_beams; k ++)
+   cri_mul(Col->rel+k, Col->iel+k, Col->rel[k], Col->iel[k],
+           Pp->rel[k], Pp->iel[k]);
+
+ Col = matmul(Col, Tpp_b, Col);
+
+/* (ii) */
+ for(k = 1; k <= n_beams; k ++)
+ {
+   Col->rel[k] += Rpm_b->rel[(k-1)*n_beams + 1];
+   Col->iel[k] += Rpm_b->iel[(k-1)*n_beams + 1];
+ }
+
+/*************************************************************************
+ - Free temporary storage space, 
+ - Write results to output pointers
+ - Return.
+*************************************************************************/
+
+ matfree(Pp);
+ matfree(Pm);
+ if(bd_a) matarrfree(Maux_a);
+ else     matfree(Maux_a);
+ matfree(Maux_b);
+
+ Rpm1_ab = matcop(Rpm1_ab, Col);
+ matfree(Col);
+
+ return(Rpm1_ab);
+}
+ 
+/*======================================================================*/
+/*======================================================================*/
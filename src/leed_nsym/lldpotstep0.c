@@ -11,6 +11,8 @@
 
 Changes:
  GH/15.03.95 - Creation
+ AG/17.10.26 - Rpm_a can be block diagonal.
+ AG/17.10.26 - Rpm_a can be the first column only (leed_ld_2lay_rpm1).
 
 *********************************************************************/
 
@@ -43,6 +45,9 @@ mat leed_ld_potstep0 ( mat Rpm1_ab, mat Rpm_a,
    mat Rpm1 - (output) fist column of the reflection matrix (+-)
 
    mat Rpm_a - (input) reflection matrix (+-) of the "lower" layer "a".
+               Either a full matrix, a block-diagonal matrix (matrix
+               array of diagonal blocks, see matbdmul) or only the first
+               column (n_beams x 1, see leed_ld_2lay_rpm1).
 
    beam_str *beams - (input) information about beams.
                   used: k_r, k_i, k_par.
@@ -68,6 +73,8 @@ mat leed_ld_potstep0 ( mat Rpm1_ab, mat Rpm_a,
 {
 int k,l;
 int n_beams;                       /* total number of beams */
+int n_col;                         /* non-zero elements in 1st column */
+int inc;                           /* distance of the elements in memory */
 
 real faux_r, faux_i;
 
@@ -90,14 +97,26 @@ mat Maux;                          /* temp. storage space */
       = exp[ i *( (k_x-k_x0)*v_ab_x + (k_y-k_y0)*v_ab_y + (k_z0+k_z)*v_ab_z)]
 
  - Multiply the first column of Rpm_a with the propagators to the potential
-   step.
+   step. If Rpm_a is block diagonal, only the first block (which
+   contains the (00) beam) has non-zero elements in the first column.
  - Multiply with the factor sqrt(cos(out)/cos(in))
 
 *************************************************************************/
- n_beams = Rpm_a->cols;
+ if( (Rpm_a->blk_type == BLK_ARRAY) || (Rpm_a->blk_type == BLK_END) )
+ {
+   n_beams = matbddim(Rpm_a);
+   n_col = Rpm_a->rows;
+   inc = n_col;
+ }
+ else
+ {
+   n_beams = Rpm_a->rows;
+   n_col = n_beams;
+   inc = Rpm_a->cols;
+ }
  Maux = matalloc(NULL, n_beams, 1, NUM_COMPLEX );
 
- for(k = 1, l = 1; k <= n_beams; k ++, l+= n_beams)
+ for(k = 1, l = 1; k <= n_beams; k ++, l+= inc)
  {
 
    faux_r = ((beams+k-1)->k_r[1] - beams->k_r[1]) * vec_ab[1] +
@@ -115,8 +134,11 @@ mat Maux;                          /* temp. storage space */
    faux_r = R_sqrt(faux_r);
    cri_mul(Maux->rel+k, Maux->iel+k, faux_r, 0., Maux->rel[k], Maux->iel[k]);
 
-   cri_mul(Maux->rel+k, Maux->iel+k,
-           Rpm_a->rel[l], Rpm_a->iel[l], Maux->rel[k], Maux->iel[k]);
+   if(k <= n_col)
+     cri_mul(Maux->rel+k, Maux->iel+k,
+             Rpm_a->rel[l], Rpm_a->iel[l], Maux->rel[k], Maux->iel[k]);
+   else
+     Maux->rel[k] = Maux->iel[k] = 0.;
 
  }
  
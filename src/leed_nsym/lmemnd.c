@@ -0,0 +1,291 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  leed_mem_estimate_nd
+    Estimate the memory needed for the calculation.
+  leed_mem_peak_nd
+    Peak memory for the settings in a memory estimate.
+  leed_mem_plan_nd
+    Choose memory saving settings to fit into a memory budget.
+
+  The dominant memory consumers are the dense complex n_beams x n_beams
+  matrices (layer matrices, R_tot, layer doubling temporaries and the
+  copy made by matinv) and the giant matrix of composite layers with
+  dimension natoms*(l_max+1)^2. The estimates are upper bounds (beams
+  at the final energy) and do not include the phase shifts and the
+  Clebsh-Gordan coefficients.
+
+Changes:
+  AG/17.10.26 - Creation
+  AG/17.10.26 - energies calculated concurrently (n_eng = 0); spilled
+                delta mode keeps R_bulk in the scratch files, too;
+                bracket the uses of MAX in leed_mem_peak_nd.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "leed.h"
+
+#ifdef _USE_OPENMP
+#include <omp.h>        /* compile with '-fopenmp' */
+#endif
+
+/*======================================================================*/
+
+static double leed_mem_mat(int rows, int cols)
+
+/*********************************************************************
+  Memory of a complex rows x cols matrix (see matalloc).
+*********************************************************************/
+{
+ return( (double)sizeof(struct mat_str) +
+         2. * ((double)rows * (double)cols + 1.) * sizeof(real) );
+} /* end of function leed_mem_mat */
+
+/*======================================================================*/
+
+int leed_mem_estimate_nd(leed_mem_t *mem, leed_beam_t *beams_all, int n_set,
+                         leed_cryst_t *bulk, leed_cryst_t *over,
+                         leed_var_t *v_par, int n_eng)
+
+/*********************************************************************
+  Estimate the memory needed for the calculation.
+
+ INPUT:
+
+  leed_mem_t *mem - (output) memory estimate. The settings are preset
+         to the default (no memory saving, all threads).
+  leed_beam_t *beams_all - all beams at the final energy (leed_beam_gen).
+  int n_set - number of beam sets.
+  leed_cryst_t *bulk, *over - bulk and overlayer parameters.
+  leed_var_t *v_par - parameters (l_max).
+  int n_eng - number of energies for which the layer matrices are kept
+         (leed_calc_iv_delta_nd, energies one after the other); 0 if
+         the delta mode is not used, i.e. the energies are calculated
+         concurrently, one per thread (leed_calc_int_list_nd).
+
+ RETURN VALUE:
+
+  1 if ok.
+ -1 if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+int i_beams, i_set, i_layer;
+int n_lm;
+int *n_set_beams;
+
+leed_layer_t *layer;
+
+ n_set_beams = (int *)calloc(n_set, sizeof(int));
+ if(n_set_beams == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_mem_estimate_nd): allocation error\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+/*********************************************************************
+  Beams and beam sets
+*********************************************************************/
+
+ for(i_beams = 0;
+     ! IS_EQUAL_REAL((beams_all + i_beams)->k_par, F_END_OF_LIST);
+     i_beams ++)
+ {
+   i_set = (beams_all + i_beams)->set;
+   if( (i_set >= 0) && (i_set < n_set) ) n_set_beams[i_set] ++;
+ }
+ mem->n_beams = i_beams;
+
+ mem->n_max_set = 0;
+ mem->r_bulk = 0.;
+ for(i_set = 0; i_set < n_set; i_set ++)
+ {
+   mem->n_max_set = MAX(mem->n_max_set, n_set_beams[i_set]);
+   mem->r_bulk += leed_mem_mat(n_set_beams[i_set], n_set_beams[i_set]);
+ }
+ free(n_set_beams);
+
+/*********************************************************************
+  Combined space of composite layers
+*********************************************************************/
+
+ n_lm = (v_par->l_max + 1) * (v_par->l_max + 1);
+ mem->n_comp = 0;
+ for(i_layer = 0; i_layer < bulk->nlayers + over->nlayers; i_layer ++)
+ {
+   if(i_layer < bulk->nlayers) layer = bulk->layers + i_layer;
+   else                        layer = over->layers + i_layer - bulk->nlayers;
+
+   if(layer->natoms > 1)
+     mem->n_comp = MAX(mem->n_comp, layer->natoms * n_lm);
+ }
+
+ mem->n_over = over->nlayers;
+ mem->n_eng = n_eng;
+
+/*********************************************************************
+  Default settings
+*********************************************************************/
+
+#ifdef _USE_OPENMP
+ mem->n_threads = omp_get_max_threads();
+#else
+ mem->n_threads = 1;
+#endif
+ mem->inv_inplace = 0;
+ mem->spill = 0;
+
+ leed_mem_peak_nd(mem);
+
+ return(1);
+} /* end of function leed_mem_estimate_nd */
+
+/*======================================================================*/
+
+double leed_mem_peak_nd(leed_mem_t *mem)
+
+/*********************************************************************
+  Peak memory for the settings in a memory estimate.
+
+ INPUT:
+
+  leed_mem_t *mem - (input/output) memory estimate
+         (leed_mem_estimate_nd); mem->peak and mem->cache are updated
+         for the current settings.
+
+ DESIGN:
+
+  The calculation for one energy passes through three stages:
+  - bulk: each thread holds 8 set matrices and the layer doubling
+    temporaries for one beam set (+ a composite bulk layer);
+  - overlayer: R_bulk, R_tot, the four matrices of the current layer
+    and either the composite layer matrices (giant matrix, its copy
+    in matinv and the n_beams x n_comp matrices) or the layer doubling
+    temporaries (3 matrices + copy in matinv).
+  In the delta mode (n_eng > 0) the energies are calculated one after
+  the other and the threads share the beam sets of the bulk; R_bulk
+  and 5 matrices per overlayer layer are kept for each energy unless
+  they are spilled to scratch files (then only those of the current
+  energy are in memory). Otherwise each thread calculates one energy
+  with all its stages (leed_calc_int_list_nd).
+
+ RETURN VALUE:
+
+  estimated total memory (peak + cache) in bytes.
+
+*********************************************************************/
+{
+int n_inv, n_threads;
+double m_beams, m_set;
+double bulk_thread, comp, doubling, over, stage;
+
+ n_inv = (mem->inv_inplace)? 0: 1;
+ m_beams = leed_mem_mat(mem->n_beams, mem->n_beams);
+ m_set = leed_mem_mat(mem->n_max_set, mem->n_max_set);
+
+/* composite layer for nb beams */
+#define COMP_MEM(nb)   ( (1 + n_inv) * leed_mem_mat(mem->n_comp, mem->n_comp) \
+                      + 5. * leed_mem_mat((nb), mem->n_comp) )
+
+ bulk_thread = (8. + 5. + n_inv) * m_set;
+ if(mem->n_comp > 0) bulk_thread += COMP_MEM(mem->n_max_set);
+
+ comp = (mem->n_comp > 0)? COMP_MEM(mem->n_beams): 0.;
+ doubling = (3. + n_inv) * m_beams + mem->r_bulk;
+ over = MAX((comp), (doubling));
+ over += 5. * m_beams;
+
+#undef COMP_MEM
+
+ n_threads = (mem->n_threads > 1)? mem->n_threads: 1;
+
+ mem->cache = 0.;
+ if(mem->n_eng > 0)
+ {
+   stage = MAX((n_threads * bulk_thread), (over));
+   mem->peak = mem->r_bulk + stage;
+
+   if(mem->spill)
+     mem->cache = mem->r_bulk + 5. * mem->n_over * m_beams;
+   else
+     mem->cache = mem->n_eng * (mem->r_bulk + 5. * mem->n_over * m_beams);
+ }
+ else
+ {
+   stage = MAX((bulk_thread), (over));
+   mem->peak = n_threads * (mem->r_bulk + stage);
+ }
+
+ return(mem->peak + mem->cache);
+} /* end of function leed_mem_peak_nd */
+
+/*======================================================================*/
+
+int leed_mem_plan_nd(leed_mem_t *mem, double budget)
+
+/*********************************************************************
+  Choose memory saving settings to fit into a memory budget.
+
+ INPUT:
+
+  leed_mem_t *mem - (input/output) memory estimate
+         (leed_mem_estimate_nd); the settings are modified.
+  double budget - memory budget (bytes). If <= 0., the settings are
+         not changed.
+
+ DESIGN:
+
+  The settings are changed one after the other until the estimate
+  fits into the budget (in the order of their cost in cpu time):
+  1. invert matrices in place (no copy in matinv);
+  2. spill the layer matrices of the delta mode to scratch files;
+  3. reduce the number of threads (bulk beam sets in the delta mode,
+     energies otherwise).
+
+  The caller applies the settings: matinvmode(MAT_INV_INPLACE),
+  omp_set_num_threads(mem->n_threads) and a scratch file prefix for
+  the delta mode cache (leed_calc_cache_alloc).
+
+ RETURN VALUE:
+
+  1 if the estimate fits into the budget.
+  0 if not (all settings exhausted).
+
+*********************************************************************/
+{
+ if(budget <= 0.) return(1);
+
+ if(leed_mem_peak_nd(mem) <= budget) return(1);
+
+ mem->inv_inplace = 1;
+ if(leed_mem_peak_nd(mem) <= budget) return(1);
+
+ if(mem->n_eng > 0)
+ {
+   mem->spill = 1;
+   if(leed_mem_peak_nd(mem) <= budget) return(1);
+ }
+
+ while(mem->n_threads > 1)
+ {
+   mem->n_threads --;
+   if(leed_mem_peak_nd(mem) <= budget) return(1);
+ }
+
+#ifdef WARNING
+ fprintf(STDWAR, "* warning (leed_mem_plan_nd): estimated memory "
+                 "%.1f MB exceeds budget %.1f MB\n",
+                 (mem->peak + mem->cache) / 1048576., budget / 1048576.);
+#endif
+ return(0);
+} /* end of function leed_mem_plan_nd */
@@ -13,6 +13,11 @@ GH/05.07.03
  GH/03.09.97 - set return value to 1
  GH/23.09.00 - extension for non-diagonal atomic scattering matrix.
  GH/05.07.03 - bug fix: update all "old" values at the end of function.
+ AG/17.10.26 - static storage is thread private, i.e. the reuse of lattice 
+               sums etc. works per thread if beam sets are computed in 
+               parallel.
+ AG/17.10.26 - Ylm and Y*lm from the cache of the beam set 
+               (leed_ms_ymat_cache).
 
 *********************************************************************/
 
@@ -82,10 +87,7 @@ int leed_ms_nd ( mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp,
   leed_ms_tmat_ii
   leed_ms_tmat_nd_ii
 
-  leed_ms_ymat
-  leed_ms_yp_ym
-  leed_ms_yp_yxp
-  leed_ms_yp_yxm
+  leed_ms_ymat_cache
 
   matmul
 
@@ -104,7 +106,11 @@ static int old_l_max = I_END_OF_LIST;
 static real old_eng = F_END_OF_LIST;
 
 static mat Llm = NULL, Tii = NULL;
-static mat Yin_p = NULL, Yin_m = NULL, Yout_p = NULL, Yout_m = NULL;
+static mat Yout_p = NULL, Yout_m = NULL;
+#ifdef _USE_OPENMP
+#pragma omp threadprivate(old_set, old_n_beams, old_type, old_l_max, old_eng)
+#pragma omp threadprivate(Llm, Tii, Yout_p, Yout_m)
+#endif
 
 int n_beams, i_beams;
 int l_max;
@@ -116,6 +122,8 @@ real *ptr_r, *ptr_i;
 
 mat Maux;
 
+leed_ylm_t *ylm;
+
 
 /*************************************************************************
  Preset often used values: i_type, l_max, n_beams
@@ -185,16 +193,10 @@ mat Maux;
      Tii = leed_ms_tmat_nd_ii( Tii, Llm, v_par->p_tl[i_type], l_max);
    }
 
-/* Yout_p = Y(k+) */
-   Yout_p = leed_ms_ymat(Yout_p, l_max, beams, n_beams);
-/* Yout_m = Y(k-) */
-   Yout_m = leed_ms_yp_ym(Yout_m, Yout_p);
-
-
-/* Yin_p: Y*(k+) for transmission matrix. */
-   Yin_p = leed_ms_yp_yxp(Yin_p, Yout_p);
-/* Yin_m: Y*(k-) for reflection matrix. */
-   Yin_m = leed_ms_yp_yxm(Yin_m, Yout_p);
+/* Yout_p = Y(k+), Yout_m = Y(k-): copies of the cached matrices */
+   ylm = leed_ms_ymat_cache(l_max, beams, n_beams);
+   Yout_p = matcop(Yout_p, ylm->Yp);
+   Yout_m = matcop(Yout_m, ylm->Ym);
 
   /********************************************************************** 
    Loop over k' (exit beams: rows of Yout_p): 
@@ -262,16 +264,21 @@ mat Maux;
 
 /**********************************************************************
  Matrix product Yout (exit beams) * Tii * Yin (inc. beams)
+  Yin_p = Y*(k+) for transmission matrix (ylm->Yxp), 
+  Yin_m = Y*(k-) for reflection matrix (ylm->Yxm)
+  are used directly from the Ylm cache (shared by all layers).
 **********************************************************************/
+ ylm = leed_ms_ymat_cache(l_max, beams, n_beams);
+
  Maux = matmul(Maux, Yout_p, Tii);
 
- *p_Rpm = matmul(*p_Rpm, Maux, Yin_m);
- *p_Tpp = matmul(*p_Tpp, Maux, Yin_p);
+ *p_Rpm = matmul(*p_Rpm, Maux, ylm->Yxm);
+ *p_Tpp = matmul(*p_Tpp, Maux, ylm->Yxp);
 
  Maux = matmul(Maux, Yout_m, Tii);
 
- *p_Tmm = matmul(*p_Tmm, Maux, Yin_m);
- *p_Rmp = matmul(*p_Rmp, Maux, Yin_p);
+ *p_Tmm = matmul(*p_Tmm, Maux, ylm->Yxm);
+ *p_Rmp = matmul(*p_Rmp, Maux, ylm->Yxp);
 
 
 /**********************************************************************
@@ -24,6 +24,9 @@
  GH/17.07.02 - bug fixes for non-diagonal T matrix:
                = Copy atom information by memcpy.
                = Set l_max equal to v_par->l_max for T_NOND.
+ AG/17.10.26 - Ylm and derived matrices from the cache of the beam set
+               (leed_ms_ymat_cache) instead of recalculation per atom.
+ AG/17.10.26 - phase factors from the packed beam table (leed_beam_tab).
 
 *********************************************************************/
 
@@ -51,6 +54,11 @@
 #define K_TOLERANCE 0.0001                  /* tolerance in k_par */
 #endif
 
+static leed_beam_tab_t tab = {0, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+#ifdef _USE_OPENMP
+#pragma omp threadprivate(tab)
+#endif
+
 /*======================================================================*/
 /*======================================================================*/
 
@@ -162,7 +170,7 @@ real *ptr_r, *ptr_i, *ptr_end;
 
 leed_atom_t * atoms;        /* atomic positions and scattering properties */
 
-mat Ylm;                        /* spherical harmonics (for exit beams) */
+leed_ylm_t *ylm;                /* spherical harmonics (cache of beam set) */
 mat Llm_ij, Llm_ji;             /* interlayer lattice sums */
 mat Maux, Mbg, Mark;            /* dummy matrices */
 mat L_p, L_m, R_p, R_m;         /* dummy matrices */
@@ -171,8 +179,6 @@ mat Tpp, Tmm, Rpm, Rmp;         /* Layer diffraction matrices in k-space
                                    will be copied to output */
 mat * p_Tii;                    /* Array of Bravais layer scattering matrices */
 
- Ylm = NULL;
-
  Llm_ij = NULL;
  Llm_ji = NULL;
 
@@ -629,11 +635,15 @@ fprintf(STDERR," *** error (leed_ms_compl_nd): invalid input matrix (4th argumen
 #endif
 
 
-/* calculate spherical harmonics Ylm */
+/* spherical harmonics Ylm and derived matrices (shared by all layers) */
 
- Ylm = leed_ms_ymat(Ylm, l_max, beams, n_beams);
+ ylm = leed_ms_ymat_cache(l_max, beams, n_beams);
 
-/* allocate storage space (Ylm->rows = number of beams) */
+/* k vectors of all beams as separate arrays (phase factors) */
+
+ leed_beam_tab(&tab, beams, n_beams);
+
+/* allocate storage space (ylm->Yp->rows = number of beams) */
  iaux = l_max_2 * n_atoms;
  L_p = matalloc(L_p, n_beams, iaux, NUM_COMPLEX);
  L_m = matalloc(L_m, n_beams, iaux, NUM_COMPLEX);
@@ -654,23 +664,12 @@ fprintf(STDERR," *** error (leed_ms_compl_nd): invalid input matrix (4th argumen
 /*
   R_p(ilm',g)  = exp(+ ikg(+) * ri) *Tii * Ylm'*(g+)
 */
-   Maux = leed_ms_yp_yxm(Maux, Ylm);
-   Maux = matmul(Maux, p_Tii[(atoms+i_atoms)->type], Maux);
+   Maux = matmul(Maux, p_Tii[(atoms+i_atoms)->type], ylm->Yxm);
 
  /* Multiply the cols of Maux with exp(- ikg(+) * ri) */
-   for(k = 0; k < Maux->cols; k ++)
-   {
-     faux_r = +(beams+k)->k_r[1] * (atoms+i_atoms)->pos[1]
-              +(beams+k)->k_r[2] * (atoms+i_atoms)->pos[2]
-              +(beams+k)->k_r[3] * (atoms+i_atoms)->pos[3];
-     faux_i = +(beams+k)->k_i[3] * (atoms+i_atoms)->pos[3];
-     cri_expi(&faux_r, &faux_i, faux_r, faux_i);
-     for(ptr_r = Maux->rel + k + 1,
-         ptr_i = Maux->iel + k + 1,
-         ptr_end = Maux->rel + Maux->cols*Maux->rows;
-         ptr_r <= ptr_end; ptr_r += Maux->cols, ptr_i += Maux->cols)
-     { cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i); }
-   } /* k */
+   leed_beam_tab_phase(NULL, NULL, &tab, 0, Maux->cols,
+                       (atoms+i_atoms)->pos, 1., 1.);
+   leed_beam_tab_mul_cols(Maux, tab.ph_r, tab.ph_i);
 
 #ifdef CONTROL_XXX
  if(i_atoms == 0)
@@ -685,51 +684,31 @@ fprintf(STDERR," *** error (leed_ms_compl_nd): invalid input matrix (4th argumen
 /*
   R_m(ilm',g)  = exp(+ ikg(-) * ri) *Tii * Ylm'*(g-)
 */
-   Maux = leed_ms_yp_yxp(Maux, Ylm);
-   Maux = matmul(Maux, p_Tii[(atoms+i_atoms)->type], Maux);
+   Maux = matmul(Maux, p_Tii[(atoms+i_atoms)->type], ylm->Yxp);
 
  /* Multiply the cols of Maux with exp(- ikg(-) * ri) */
-   for(k = 0; k < Maux->cols; k ++)
-   {
-     faux_r = +(beams+k)->k_r[1] * (atoms+i_atoms)->pos[1]
-              +(beams+k)->k_r[2] * (atoms+i_atoms)->pos[2]
-              -(beams+k)->k_r[3] * (atoms+i_atoms)->pos[3];
-     faux_i = -(beams+k)->k_i[3] * (atoms+i_atoms)->pos[3];
-     cri_expi(&faux_r, &faux_i, faux_r, faux_i);
-     for(ptr_r = Maux->rel + k + 1,
-         ptr_i = Maux->iel + k + 1,
-         ptr_end = Maux->rel + Maux->cols*Maux->rows;
-         ptr_r <= ptr_end; ptr_r += Maux->cols, ptr_i += Maux->cols)
-     { cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i); }
-   } /* k */
+   leed_beam_tab_phase(NULL, NULL, &tab, 0, Maux->cols,
+                       (atoms+i_atoms)->pos, 1., -1.);
+   leed_beam_tab_mul_cols(Maux, tab.ph_r, tab.ph_i);
 
    R_m  = matins(R_m, Maux, off_row, 1);
 
 /*
   L_p(g',jlm) = Ylm(g'+) * exp(- ikg'(+) * rj)
 */
-   Maux = leed_ms_yp_ym(Maux, Ylm);
+   Maux = matcop(Maux, ylm->Ym);
    
 
  /* Multiply the rows of Maux with exp(- ikg(+) * ri) */
+   leed_beam_tab_phase(NULL, NULL, &tab, 0, Maux->rows,
+                       (atoms+i_atoms)->pos, -1., -1.);
    for(k = 0; k < Maux->rows; k ++)
    {
-     faux_r = -(beams+k)->k_r[1] * (atoms+i_atoms)->pos[1]
-              -(beams+k)->k_r[2] * (atoms+i_atoms)->pos[2]
-              -(beams+k)->k_r[3] * (atoms+i_atoms)->pos[3];
-     faux_i = -(beams+k)->k_i[3] * (atoms+i_atoms)->pos[3];
-
-     cri_expi(&faux_r, &faux_i, faux_r, faux_i);
-     cri_mul (&faux_r, &faux_i, faux_r, faux_i,
-             (beams+k)->Akz_r, (beams+k)->Akz_i);
-     cri_mul (&faux_r, &faux_i, faux_r, faux_i, 0., pref_i);
-
-     for(ptr_r = Maux->rel + k*Maux->cols + 1,
-         ptr_i = Maux->iel + k*Maux->cols + 1,
-         ptr_end = ptr_r + Maux->cols;
-         ptr_r < ptr_end; ptr_r ++,  ptr_i ++)
-     { cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i); }
-   } /* k */
+     cri_mul (tab.ph_r+k, tab.ph_i+k, tab.ph_r[k], tab.ph_i[k],
+              tab.Akz_r[k], tab.Akz_i[k]);
+     cri_mul (tab.ph_r+k, tab.ph_i+k, tab.ph_r[k], tab.ph_i[k], 0., pref_i);
+   }
+   leed_beam_tab_mul_rows(Maux, tab.ph_r, tab.ph_i);
 
 #ifdef CONTROL_XXX
  if(i_atoms == 0)
@@ -745,33 +724,24 @@ fprintf(STDERR," *** error (leed_ms_compl_nd): invalid input matrix (4th argumen
 /*
   L_m(g',jlm) = Ylm(g'-) * exp(- ikg'(-) * rj)
 */
-   Maux = matcop(Maux, Ylm);
+   Maux = matcop(Maux, ylm->Yp);
 
  /* Multiply the rows of Maux with exp(- ikg'(-) * ri) */
+   leed_beam_tab_phase(NULL, NULL, &tab, 0, Maux->rows,
+                       (atoms+i_atoms)->pos, -1., 1.);
    for(k = 0; k < Maux->rows; k ++)
    {
-     faux_r = -(beams+k)->k_r[1] * (atoms+i_atoms)->pos[1]
-              -(beams+k)->k_r[2] * (atoms+i_atoms)->pos[2]
-              +(beams+k)->k_r[3] * (atoms+i_atoms)->pos[3];
-     faux_i = +(beams+k)->k_i[3] * (atoms+i_atoms)->pos[3];
-     cri_expi(&faux_r, &faux_i, faux_r, faux_i);
-     cri_mul (&faux_r, &faux_i, faux_r, faux_i,
-             (beams+k)->Akz_r, (beams+k)->Akz_i);
-     cri_mul (&faux_r, &faux_i, faux_r, faux_i, 0., pref_i);
-
-     for(ptr_r = Maux->rel + k*Maux->cols + 1,
-         ptr_i = Maux->iel + k*Maux->cols + 1,
-         ptr_end = ptr_r + Maux->cols;
-         ptr_r < ptr_end; ptr_r ++,  ptr_i ++)
-     { cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i); }
-   } /* k */
+     cri_mul (tab.ph_r+k, tab.ph_i+k, tab.ph_r[k], tab.ph_i[k],
+              tab.Akz_r[k], tab.Akz_i[k]);
+     cri_mul (tab.ph_r+k, tab.ph_i+k, tab.ph_r[k], tab.ph_i[k], 0., pref_i);
+   }
+   leed_beam_tab_mul_rows(Maux, tab.ph_r, tab.ph_i);
 
    L_m  = matins(L_m, Maux, 1, off_row);
 
  }
 
  CTIME("(leed_ms_compl_nd): after preparation of R_p ... ");
- matfree(Ylm);
 
 /**********************************************************************
  Multiply matrices: L*Mbg*R
@@ -840,26 +810,21 @@ fprintf(STDERR," *** error (leed_ms_compl_nd): invalid input matrix (4th argumen
 
 /* Set up vectors L_p/m and R_p/m */
 
- for(k = 0; k < n_beams; k ++)
- {
+ d_ij[1] = d_ij[2] = 0.;
 
 /* R_m (exp[- ikz(-)zmax) = L_p (exp[+ ikz(+)zmax) */ 
 
-   faux_r = +(beams+k)->k_r[3] * z_max;
-   faux_i = +(beams+k)->k_i[3] * z_max;
-   cri_expi(R_m->rel+k+1, R_m->iel+k+1, faux_r, faux_i);
-   L_p->rel[k+1] = R_m->rel[k+1];
-   L_p->iel[k+1] = R_m->iel[k+1];
+ d_ij[3] = z_max;
+ leed_beam_tab_phase(R_m->rel+1, R_m->iel+1, &tab, 0, n_beams, d_ij, 1., 1.);
+ memcpy(L_p->rel+1, R_m->rel+1, n_beams*sizeof(real));
+ memcpy(L_p->iel+1, R_m->iel+1, n_beams*sizeof(real));
 
 /* R_p (exp[- ik(+)zmin) = L_m (exp[+ ik(-)zmin) */ 
 
-   faux_r = -(beams+k)->k_r[3] * z_min;
-   faux_i = -(beams+k)->k_i[3] * z_min;
-   cri_expi(R_p->rel+k+1, R_p->iel+k+1, faux_r, faux_i);
-   L_m->rel[k+1] = R_p->rel[k+1];
-   L_m->iel[k+1] = R_p->iel[k+1];
-
- } /* k */
+ d_ij[3] = z_min;
+ leed_beam_tab_phase(R_p->rel+1, R_p->iel+1, &tab, 0, n_beams, d_ij, 1., -1.);
+ memcpy(L_m->rel+1, R_p->rel+1, n_beams*sizeof(real));
+ memcpy(L_m->iel+1, R_p->iel+1, n_beams*sizeof(real));
 
 /*
   Final multiplications of matrix elements:
@@ -869,58 +834,26 @@ fprintf(STDERR," *** error (leed_ms_compl_nd): invalid input matrix (4th argumen
 /*
   Tpp
 */
- for(k = 1; k <= Tpp->rows; k++)         /* loop over row No's (1st index) */
-   for(ptr_r = Tpp->rel + (k-1)*Tpp->cols + 1,
-       ptr_i = Tpp->iel + (k-1)*Tpp->cols + 1,
-       ptr_end = ptr_r + Tpp->cols, l = 1;
-       ptr_r < ptr_end;
-       ptr_r ++, ptr_i ++, l ++)         /* loop over col No's (2nd index) */
-   {
-     cri_mul(ptr_r, ptr_i, *(L_p->rel+k), *(L_p->iel+k), *ptr_r, *ptr_i);
-     cri_mul(ptr_r, ptr_i, *(R_p->rel+l), *(R_p->iel+l), *ptr_r, *ptr_i);
-   }
+ leed_beam_tab_mul_rows(Tpp, L_p->rel+1, L_p->iel+1);
+ leed_beam_tab_mul_cols(Tpp, R_p->rel+1, R_p->iel+1);
 
 /*
   Tmm
 */
- for(k = 1; k <= Tmm->rows; k++)         /* loop over row No's (1st index) */
-   for(ptr_r = Tmm->rel + (k-1)*Tmm->cols + 1,
-       ptr_i = Tmm->iel + (k-1)*Tmm->cols + 1,
-       ptr_end = ptr_r + Tmm->cols, l = 1;
-       ptr_r < ptr_end;
-       ptr_r ++, ptr_i ++, l ++)         /* loop over col No's (2nd index) */
-   {
-     cri_mul(ptr_r, ptr_i, *(L_m->rel+k), *(L_m->iel+k), *ptr_r, *ptr_i);
-     cri_mul(ptr_r, ptr_i, *(R_m->rel+l), *(R_m->iel+l), *ptr_r, *ptr_i);
-   }
+ leed_beam_tab_mul_rows(Tmm, L_m->rel+1, L_m->iel+1);
+ leed_beam_tab_mul_cols(Tmm, R_m->rel+1, R_m->iel+1);
 
 /*
   Rpm
 */
- for(k = 1; k <= Rpm->rows; k++)         /* loop over row No's (1st index) */
-   for(ptr_r = Rpm->rel + (k-1)*Rpm->cols + 1,
-       ptr_i = Rpm->iel + (k-1)*Rpm->cols + 1,
-       ptr_end = ptr_r + Rpm->cols, l = 1;
-       ptr_r < ptr_end;
-       ptr_r ++, ptr_i ++, l ++)         /* loop over col No's (2nd index) */
-   {
-     cri_mul(ptr_r, ptr_i, *(L_p->rel+k), *(L_p->iel+k), *ptr_r, *ptr_i);
-     cri_mul(ptr_r, ptr_i, *(R_m->rel+l), *(R_m->iel+l), *ptr_r, *ptr_i);
-   }
+ leed_beam_tab_mul_rows(Rpm, L_p->rel+1, L_p->iel+1);
+ leed_beam_tab_mul_cols(Rpm, R_m->rel+1, R_m->iel+1);
 
 /*
   Rmp
 */
- for(k = 1; k <= Rmp->rows; k++)         /* loop over row No's (1st index) */
-   for(ptr_r = Rmp->rel + (k-1)*Rmp->cols + 1,
-       ptr_i = Rmp->iel + (k-1)*Rmp->cols + 1,
-       ptr_end = ptr_r + Rmp->cols, l = 1;
-       ptr_r < ptr_end;
-       ptr_r ++, ptr_i ++, l ++)         /* loop over col No's (2nd index) */
-   {
-     cri_mul(ptr_r, ptr_i, *(L_m->rel+k), *(L_m->iel+k), *ptr_r, *ptr_i);
-     cri_mul(ptr_r, ptr_i, *(R_p->rel+l), *(R_p->iel+l), *ptr_r, *ptr_i);
-   }
+ leed_beam_tab_mul_rows(Rmp, L_m->rel+1, L_m->iel+1);
+ leed_beam_tab_mul_cols(Rmp, R_p->rel+1, R_p->iel+1);
 
 /*
   Add propagator of the unscattered wave to Tpp/Tmm: 
@@ -0,0 +1,266 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  leed_ms_gaunt
+    Return the precompiled C.G. coupling tensor used to set up the
+    Green's function matrices (leed_ms_tmat_ii/nd_ii/ij).
+  leed_ms_gaunt_free
+    Free the coupling tensors.
+
+  The matrix elements of the Green's functions are sums over l3 of
+  lattice sums L(l3,m3) times C.G. coefficients with a sign that
+  depends only on the quantum numbers. The coefficients (including
+  the signs) and the positions of L(l3,m3) in Llm are computed once per
+  l_max and stored for each (l1,m1; l2,m2) pair in compressed sparse
+  row format. Setting up a G matrix is then a sparse contraction of
+  this tensor with Llm. For Gii the pairs with odd (l1+m1+l2+m2)
+  (different parity blocks) are empty.
+
+Changes:
+  AG/17.10.26 - Creation
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "leed.h"
+
+static leed_gaunt_t *gaunt_tensor[LEED_GAUNT_NTYPES] = { NULL, NULL };
+
+/*======================================================================*/
+
+static leed_gaunt_t *leed_ms_gaunt_mk(int type, int l_max)
+
+/*********************************************************************
+  Compute the coupling tensor of type "type" for l_max.
+  Returns NULL if the allocation failed.
+*********************************************************************/
+{
+int l1,m1, l2,m2;
+int l3,m3;
+int l3_min, l3_max;
+int i3, i_pair, i_ent, n_ent;
+real sign;
+
+leed_gaunt_t *gnt;
+
+ gnt = (leed_gaunt_t *)malloc(sizeof(leed_gaunt_t));
+ if(gnt == NULL) return(NULL);
+
+ gnt->l_max = l_max;
+ gnt->n_lm = (l_max + 1)*(l_max + 1);
+
+/*
+  Count the entries: (l1 + l2 - l3_min)/2 + 1 values of l3 per pair
+*/
+ n_ent = 0;
+ for(l1 = 0; l1 <= l_max; l1 ++)
+  for(m1 = -l1; m1 <= l1; m1 ++)
+   for(l2 = 0; l2 <= l_max; l2 ++)
+    for(m2 = -l2; m2 <= l2; m2 ++)
+    {
+      if( (type != LEED_GAUNT_IJ) && ODD(l1 + m1 + l2 + m2) ) continue;
+
+      l3_min = MAX(abs(m1 - m2), abs(l2 - l1));
+      l3_min += (l1 + l2 + l3_min)%2;
+      if(l3_min <= l1 + l2) n_ent += (l1 + l2 - l3_min)/2 + 1;
+    }
+
+ gnt->row  = (int *)malloc((gnt->n_lm * gnt->n_lm + 1) * sizeof(int));
+ gnt->i3   = (int *)malloc((n_ent + 1) * sizeof(int));
+ gnt->coef = (real *)malloc((n_ent + 1) * sizeof(real));
+ if( (gnt->row == NULL) || (gnt->i3 == NULL) || (gnt->coef == NULL) )
+ {
+   free(gnt->row);
+   free(gnt->i3);
+   free(gnt->coef);
+   free(gnt);
+   return(NULL);
+ }
+
+/*
+  Fill the tensor. The pairs are in the loop order of the G matrix
+  set-up: i_pair = (l1*(l1+1) + m1) * n_lm + l2*(l2+1) + m2.
+*/
+ i_pair = 0;
+ i_ent = 0;
+ for(l1 = 0; l1 <= l_max; l1 ++)
+  for(m1 = -l1; m1 <= l1; m1 ++)
+   for(l2 = 0; l2 <= l_max; l2 ++)
+    for(m2 = -l2; m2 <= l2; m2 ++, i_pair ++)
+    {
+      gnt->row[i_pair] = i_ent;
+
+      if(type == LEED_GAUNT_IJ)
+      {
+        /*
+          Gij: m3 = m2 - m1, constant sign (-1)^(m2+1),
+          C(l3,m3, l2,m2, l1,-m1)
+        */
+        m3 = m2 - m1;
+        l3_min = MAX(abs(m3), abs(l2-l1));
+        l3_min += (l1 + l2 + l3_min)%2;
+        l3_max = l2+l1;
+
+        sign = M1P(m2+1);
+        i3 = l3_min*(l3_min + 1) - m3 + 1;
+
+        for(l3 = l3_min; l3 <= l3_max; l3 += 2, i_ent ++)
+        {
+          gnt->i3[i_ent] = i3;
+          gnt->coef[i_ent] = sign*cg(l3, m3, l2,m2, l1,-m1);
+          i3 += 4*l3 + 6;
+        }
+      }
+      else if(! ODD(l1 + m1 + l2 + m2))
+      {
+        /*
+          Gii: m3 = m1 - m2, sign (-1)^((l1-l2-l3)/2 - m2),
+          C(l3,m3, l1,m1, l2,-m2)
+          Only pairs with even (l1+m1+l2+m2): for odd sums all L(l3,m3)
+          have odd (l3+m3) and vanish for a lattice sum in the plane
+          (Ylm(0,0) = 0, see leed_ms_lsum_ii); these rows stay empty.
+        */
+        m3 = m1 - m2;
+        l3_min = MAX(abs(m3), abs(l2-l1));
+        l3_min += (l1 + l2 + l3_min)%2;
+        l3_max = l2+l1;
+
+        sign = M1P( (l1 - l2 - l3_min)/2 - m2);
+        i3 = l3_min*(l3_min + 1) - m3 + 1;
+
+        for(l3 = l3_min; l3 <= l3_max; l3 += 2, i_ent ++)
+        {
+          gnt->i3[i_ent] = i3;
+          gnt->coef[i_ent] = sign*cg(l3, m3, l1,m1, l2,-m2);
+          sign = -sign;
+          i3 += 4*l3 + 6;
+        }
+      }
+    }  /* m2, l2, m1, l1 */
+
+ gnt->row[i_pair] = i_ent;
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(leed_ms_gaunt): type %d, l_max = %d: %d entries\n",
+         type, l_max, i_ent);
+#endif
+
+ return(gnt);
+} /* end of function leed_ms_gaunt_mk */
+
+/*======================================================================*/
+
+leed_gaunt_t *leed_ms_gaunt(int type, int l_max)
+
+/*********************************************************************
+  Return the precompiled C.G. coupling tensor.
+
+ INPUT:
+
+  int type - LEED_GAUNT_II: Gii (leed_ms_tmat_ii, leed_ms_tmat_nd_ii);
+             LEED_GAUNT_IJ: Gij (leed_ms_tmat_ij).
+  int l_max - max. angular momentum quantum number.
+
+ DESIGN:
+
+  The tensor is computed at the first call (or if l_max exceeds the
+  l_max of the stored tensor) and kept in a static variable. A tensor
+  computed for a larger l_max can be used for smaller l_max since the
+  entries of a pair do not depend on l_max; the pair index is
+
+    i_pair = (l1*(l1+1) + m1) * gnt->n_lm + l2*(l2+1) + m2.
+
+  The entries of pair i_pair are gnt->row[i_pair] ... gnt->row[i_pair+1]-1:
+
+    G(l1,m1; l2,m2) = S[ gnt->coef[i] * L(gnt->i3[i]) ]
+
+  As for the C.G. coefficients (mk_cg_coef), the function should be
+  called once before any parallel region (see main) since the tensor
+  is replaced if l_max increases.
+
+ RETURN VALUE:
+
+  pointer to the tensor.
+  NULL if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+leed_gaunt_t *gnt;
+
+ if( (type < 0) || (type >= LEED_GAUNT_NTYPES) )
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_ms_gaunt): invalid type %d\n", type);
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(NULL);
+#endif
+ }
+
+#ifdef _USE_OPENMP
+#pragma omp critical (leed_gaunt)
+#endif
+ {
+   gnt = gaunt_tensor[type];
+   if( (gnt == NULL) || (gnt->l_max < l_max) )
+   {
+     mk_cg_coef(2*l_max);
+
+     gnt = leed_ms_gaunt_mk(type, l_max);
+     if(gnt != NULL)
+     {
+       if(gaunt_tensor[type] != NULL)
+       {
+         free(gaunt_tensor[type]->row);
+         free(gaunt_tensor[type]->i3);
+         free(gaunt_tensor[type]->coef);
+         free(gaunt_tensor[type]);
+       }
+       gaunt_tensor[type] = gnt;
+     }
+   }
+ }  /* critical */
+
+ if(gnt == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_ms_gaunt): allocation error\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(NULL);
+#endif
+ }
+
+ return(gnt);
+} /* end of function leed_ms_gaunt */
+
+/*======================================================================*/
+
+void leed_ms_gaunt_free(void)
+
+/*********************************************************************
+  Free all coupling tensors.
+*********************************************************************/
+{
+int type;
+
+ for(type = 0; type < LEED_GAUNT_NTYPES; type ++)
+ {
+   if(gaunt_tensor[type] != NULL)
+   {
+     free(gaunt_tensor[type]->row);
+     free(gaunt_tensor[type]->i3);
+     free(gaunt_tensor[type]->coef);
+     free(gaunt_tensor[type]);
+     gaunt_tensor[type] = NULL;
+   }
+ }
+} /* end of function leed_ms_gaunt_free */
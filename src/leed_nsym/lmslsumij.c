@@ -11,6 +11,8 @@ GH/01.02.95 - Creation
 GH/17.07.95 - Change signs
 GH/18.09.02 - change summation boundaries for n1 and n2 so that they comply
               with the general case of dij != 0.
+AG/17.10.26 - sum over l,m for each lattice point in lsum_ij_add, with
+              copies for fixed l_max (qm_lfix.h).
 
 *********************************************************************/
 
@@ -20,6 +22,7 @@ GH/18.09.02 - change summation boundaries for n1 and n2 so that they comply
 #include <stdio.h>
 
 #include "leed.h"
+#include "qm_lfix.h"
 
 #ifdef WARNING
 #define WARN_LEVEL 1000
@@ -32,6 +35,73 @@ GH/18.09.02 - change summation boundaries for n1 and n2 so that they comply
 /*======================================================================*/
 /*======================================================================*/
 
+QM_L_CORE void lsum_ij_add(real *lp_r, real *lp_i, real *lm_r, real *lm_i,
+                           real *y_r, real *y_i, real *h_r, real *h_i,
+                           real *pre_r, real *pre_i, 
+                           real exp_ikp_r, real exp_ikp_i, int l_max)
+
+/************************************************************************
+ Add the contribution of one lattice point to Llm_p (lp) and Llm_m (lm):
+
+   Llm_p += (-1)^(l+m) * pref(l) * Hl * exp(-ikP) * Ylm
+   Llm_m += (-1)^m     * pref(l) * Hl * exp(+ikP) * Ylm
+
+ (all arrays in natural order, first element not occupied). 
+ The function is inlined into the copies for fixed l_max 
+ (LSUM_IJ_ADD_FIX).
+*************************************************************************/
+{
+int l, m, off;
+real sgn_p, sgn_m;
+real faux_r, faux_i;
+real fauxp_r, fauxp_i;
+real fauxm_r, fauxm_i;
+
+ for(l = 0; l <= l_max; l++ )
+ {
+   off = l*(l+1) + 1;
+
+   /* m-independent prefactors pref * Hl * exp(-/+ikP) */
+   faux_r = pre_r[l+1] * h_r[l+1] - pre_i[l+1] * h_i[l+1];
+   faux_i = pre_r[l+1] * h_i[l+1] + pre_i[l+1] * h_r[l+1];
+
+   fauxp_r = faux_r * exp_ikp_r - faux_i * exp_ikp_i;
+   fauxp_i = faux_r * exp_ikp_i + faux_i * exp_ikp_r;
+
+   fauxm_r = faux_r * exp_ikp_r + faux_i * exp_ikp_i;
+   fauxm_i = faux_i * exp_ikp_r - faux_r * exp_ikp_i;
+
+   /* m = -l: (-1)^(l+m) = 1, (-1)^m = (-1)^l */
+   sgn_p = 1.;
+   sgn_m = M1P(l);
+   for(m = off - l; m <= off + l; m ++, sgn_p = -sgn_p, sgn_m = -sgn_m)
+   {
+     lp_r[m] += sgn_p * (y_r[m] * fauxp_r - y_i[m] * fauxp_i);
+     lp_i[m] += sgn_p * (y_r[m] * fauxp_i + y_i[m] * fauxp_r);
+
+     lm_r[m] += sgn_m * (y_r[m] * fauxm_r - y_i[m] * fauxm_i);
+     lm_i[m] += sgn_m * (y_r[m] * fauxm_i + y_i[m] * fauxm_r);
+   }  /* m */
+ }    /* l */
+} /* end of function lsum_ij_add */
+
+#define LSUM_IJ_ADD_FIX(L)                                              \
+static void lsum_ij_add_##L(real *lp_r, real *lp_i, real *lm_r, real *lm_i, \
+                     real *y_r, real *y_i, real *h_r, real *h_i,        \
+                     real *pre_r, real *pre_i, real e_r, real e_i)      \
+{ lsum_ij_add(lp_r, lp_i, lm_r, lm_i, y_r, y_i, h_r, h_i,               \
+              pre_r, pre_i, e_r, e_i, L); }
+
+QM_L_FIX_ALL(LSUM_IJ_ADD_FIX)
+
+#define LSUM_IJ_ADD_PTR(L) lsum_ij_add_##L,
+static void (* const lsum_ij_add_fix[])(real *, real *, real *, real *,
+                     real *, real *, real *, real *, real *, real *, 
+                     real , real ) = { QM_L_FIX_ALL(LSUM_IJ_ADD_PTR) };
+
+/*======================================================================*/
+/*======================================================================*/
+
 int leed_ms_lsum_ij ( mat *p_Llm_p, mat *p_Llm_m, 
                  real k_r, real k_i, real *k_in, 
                  real *a, real *d_ij, 
@@ -149,8 +219,7 @@ int leed_ms_lsum_ij ( mat *p_Llm_p, mat *p_Llm_m,
 
 *************************************************************************/
 {
-int l,m;                       /* quantum numbers l,m */
-int off;                       /* offset in the arrays Ylm and Llm */
+int l;                         /* quantum number l */
 int iaux;
 
 int n1, n1_min, n1_max;        /* counters for lattice vectors */
@@ -166,8 +235,6 @@ real r_max, r_abs, r_phi;
 real a1_x, a1_y, a2_x, a2_y;        /* basic lattice vectors */
 
 real faux_r, faux_i;
-real fauxp_r, fauxp_i;
-real fauxm_r, fauxm_i;
 real exp_ikp_i, exp_ikp_r;
 
 mat Llm_p, Llm_m;              /* lattice sums */
@@ -358,45 +425,17 @@ Llm_m = *p_Llm_m;
          cri_expi(&exp_ikp_r, &exp_ikp_i, -faux_r, 0.); /* exp(-i*k_in*p) */
        
        /* 
-         loops over l and m:
-       */
-         for(l = 0; l <= l_max; l++ )
-         {
-           off = l*(l+1) + 1;
-  
-       /* 
-         calculate m-independent prefactors: 
-          (-1)^l * -8PI * (i)^(l+1) * Hl * exp(-ikP)  for Llm_p
-                   -8PI * (i)^(l+1) * Hl * exp(+ikP)  for Llm_m
+         loops over l and m (copy with fixed l_max for common values):
        */
-           cri_mul(&faux_r, &faux_i, pref->rel[l+1], pref->iel[l+1], 
-                   Hl->rel[l+1], Hl->iel[l+1]);
-
-           cri_mul(&fauxp_r, &fauxp_i, faux_r, faux_i, 
-                   exp_ikp_r, +exp_ikp_i);              /* for Llm_p */
-
-/*
-           faux_r *= M1P(l);
-           faux_i *= M1P(l);
-*/
-           cri_mul(&fauxm_r, &fauxm_i, faux_r, faux_i,
-                   exp_ikp_r, -exp_ikp_i);              /* for Llm_m */
-
-           
-           for(m = -l; m <= l; m ++)
-           {
-           /* Hl * exp(-ikp) * Ylm  */
-             cri_mul(&faux_r, &faux_i, Ylm->rel[off+m], Ylm->iel[off+m],
-                     fauxp_r, fauxp_i);
-             Llm_p->rel[off + m] += faux_r*M1P(l+m);
-             Llm_p->iel[off + m] += faux_i*M1P(l+m);
-
-             cri_mul(&faux_r, &faux_i, Ylm->rel[off+m], Ylm->iel[off+m],
-                     fauxm_r, fauxm_i);
-             Llm_m->rel[off + m] += faux_r*M1P(m);
-             Llm_m->iel[off + m] += faux_i*M1P(m);
-           }  /* m */
-         }    /* l */
+         if( QM_L_FIX(l_max) )
+           lsum_ij_add_fix[l_max - QM_L_FIX_MIN](
+                  Llm_p->rel, Llm_p->iel, Llm_m->rel, Llm_m->iel,
+                  Ylm->rel, Ylm->iel, Hl->rel, Hl->iel, 
+                  pref->rel, pref->iel, exp_ikp_r, exp_ikp_i);
+         else
+           lsum_ij_add(Llm_p->rel, Llm_p->iel, Llm_m->rel, Llm_m->iel,
+                  Ylm->rel, Ylm->iel, Hl->rel, Hl->iel, 
+                  pref->rel, pref->iel, exp_ikp_r, exp_ikp_i, l_max);
        }    /* if r < r_max */
      }  /* lattice vectors a2 */
    }    /* lattice vectors a1 */
@@ -7,11 +7,16 @@
     Create the multiple scattering Matrix for a periodic plane of
     scatterers.
 
+Changes:
+  AG/17.10.26 - Gev/God from the precompiled C.G. coupling tensor
+                (leed_ms_gaunt) instead of the loop over l3.
+
 *********************************************************************/
 
 #include <math.h>
 #include <malloc.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "leed.h"
 
@@ -60,10 +65,14 @@ mat leed_ms_tmat_ii ( mat Tii, mat Llm, mat Tl, int l_max /* arguments */ )
     L(l3,m3) = lattice sum
     C(l3,m3,l1,m1,l2,m2) = C.G. coefficients.
 
+  The signed C.G. coefficients and the positions of L(l3,m3) are taken
+  from the coupling tensor (leed_ms_gaunt) and contracted with Llm.
+
   - Gii separates in two blocks with even (l1+m1), (l2+m2) and odd
     (l1+m1), (l2+m2) which are stored in Gev and God, respectively.
-  - Gii(l1,m1; l2,m2)  is symmetric under exchange of (l1,m1) and (l2,m2),
-    therefore only (l2,m2) <= (l1,m1) is calculated.
+  - Gii(l1,m1; l2,m2)  is symmetric under exchange of (l1,m1) and (l2,m2)
+    only if L(l,-m) = (-1)^m L(l,m), which is not true for all lattices
+    and k_in; therefore all elements are calculated.
 
  Multiply Gev and God with Tl from the l.h.s. (in the same loop).
 
@@ -86,27 +95,32 @@ Tii = [(1 - Tl*Giilm)^-1]*Tl
 {
 int iaux;
 int l1,m1, l2,m2;
-int l3,m3;
-int l3_min, l3_max;
 
-int i3;
+int off_row, i_pair, i_ent;
 int iev1, iev2;
 int iod1, iod2;
 int odd1;
 
 real faux_r, faux_i;
 real sum_r, sum_i;
-real sign;
 
 real *ptr_r, *ptr_i;
 
 mat Gev, God;
 
- if(mk_cg_coef(2*l_max) != 0)
+leed_gaunt_t *gnt;
+
+ gnt = leed_ms_gaunt(LEED_GAUNT_II, l_max);
+ if(gnt == NULL)
  {
-#ifdef WARNING
-   fprintf(STDWAR,
-     "* warning (leed_ms_tmat_ii): C.G. coefficients had to be recalculated\n");
+#ifdef ERROR
+   fprintf(STDERR,
+     "*** error (leed_ms_tmat_ii): no C.G. coupling tensor\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(NULL);
 #endif
  }
 
@@ -136,8 +150,8 @@ mat Gev, God;
 
   - Gii separates into two blocks with even (l1+m1), (l2+m2) and odd
     (l1+m1), (l2+m2) which are stored in Gev and God, respectively.
-  - Gii(l1,m1; l2,m2)  is symmetric under exchange of (l1,m1) and (l2,m2), 
-    therefore only (l2,m2) <= (l1,m1) is calculated.
+  - The sum over l3 is the contraction of the coupling tensor gnt
+    (signs included) with Llm.
   - Multiply with Tl.
 *************************************************************************/
  for(l1 = 0, iev1 = 1, iod1 = 1; l1 <= l_max; l1 ++)
@@ -147,6 +161,7 @@ mat Gev, God;
 */
    for(m1 = -l1; m1 <= l1; m1 += 2, iev1 ++)  /* even l1 + m1 */
    {
+     off_row = (l1*(l1+1) + m1) * gnt->n_lm;
      for(l2 = 0, iev2 = 1; /*(iev2 <= iev1) &&*/ (l2 <= l_max); l2 ++)
      {
    /* 
@@ -154,37 +169,13 @@ mat Gev, God;
    */
        for(m2 = -l2; /*(iev2 <= iev1) &&*/ (m2 <= l2); m2 += 2, iev2 ++)
        {
-     /* 
-       Loop over l3 (inner--most loop): calculate the elements of Gev
-
-        - l3_min: l3 >= |m3|, |l2-l1|.
-        - Only even (l1 + l2 + l3) lead to nonzero C.G.-coefficients
-          => if (l1 + l2 + l3_min) is odd, increment l3_min by 1.
-     */
-         m3 = m1 - m2; 
-
-         l3_min = MAX(abs(m3), abs(l2-l1)); 
-         l3_min += (l1 + l2 + l3_min)%2;
-         l3_max = l2+l1;
+         i_pair = off_row + l2*(l2+1) + m2;
 
          sum_r = sum_i = 0.;
-         i3 = l3_min*(l3_min + 1) - m3 + 1;
-
-         sign = M1P( (l1 - l2 - l3_min)/2 - m2);
-
-         for(l3 = l3_min; l3 <= l3_max; l3 += 2 )
+         for(i_ent = gnt->row[i_pair]; i_ent < gnt->row[i_pair+1]; i_ent ++)
          {
-           faux_r = sign*cg(l3, m3, l1,m1,l2,-m2);
-           sum_r += Llm->rel[i3] * faux_r;
-           sum_i += Llm->iel[i3] * faux_r;
-
-         /*
-           l3 is incremented by 2 
-           => l3/2 is incremented by 1; the sign is inverted.
-           => i3 is incremented by 2*(l3+1) + 2*(l3+2) = 4*l3 + 6
-         */
-           sign = -sign;
-           i3 += 4*l3 + 6;
+           sum_r += Llm->rel[gnt->i3[i_ent]] * gnt->coef[i_ent];
+           sum_i += Llm->iel[gnt->i3[i_ent]] * gnt->coef[i_ent];
          }
 
        /*
@@ -204,8 +195,9 @@ mat Gev, God;
 /* 
   Now odd (l1 + m1)
 */
-   for(m1 = -l1+1; m1 < l1; m1 += 2, iod1 ++)  /* even l1 + m1 */
+   for(m1 = -l1+1; m1 < l1; m1 += 2, iod1 ++)  /* odd l1 + m1 */
    {
+     off_row = (l1*(l1+1) + m1) * gnt->n_lm;
      for(l2 = 0, iod2 = 1; /*(iod2 <= iod1) &&*/ (l2 <= l_max); l2 ++)
      {
    /* 
@@ -213,38 +205,13 @@ mat Gev, God;
    */
        for(m2 = -l2+1; /*(iod2 <= iod1) &&*/ (m2 < l2); m2 += 2, iod2 ++)
        {
-     /* 
-        Loop over l3 (inner--most loop): calculate the elements of God
-        - l3_min: l3 >= |m3|, |l2-l1|.
-        - Only even (l1 + l2 + l3) lead to nonzero C.G.-coefficients
-          => if (l1 + l2 + l3_min) is odd, increment l3_min by 1.
-     */
-
-         m3 = m1 - m2;
-
-         l3_min = MAX(abs(m3), abs(l2-l1));
-         l3_min += (l1 + l2 + l3_min)%2;
-         l3_max = l2+l1;
+         i_pair = off_row + l2*(l2+1) + m2;
 
          sum_r = sum_i = 0.;
-         i3 = l3_min*(l3_min + 1) - m3 + 1;
-
-         sign = M1P( (l1 - l2 - l3_min)/2 - m2);
-
-         for(l3 = l3_min; l3 <= l3_max; l3 += 2 )
+         for(i_ent = gnt->row[i_pair]; i_ent < gnt->row[i_pair+1]; i_ent ++)
          {
-           faux_r = sign*cg(l3, m3, l1,m1,l2,-m2);
-
-           sum_r += Llm->rel[i3] * faux_r;
-           sum_i += Llm->iel[i3] * faux_r;
-
-         /*
-           l3 is incremented by 2 
-           => l3/2 is incremented by 1; the sign is inverted.
-           => i3 is incremented by 2*(l3+1) + 2*(l3+2) = 4*l3 + 6
-         */
-           sign = -sign;
-           i3 += 4*l3 + 6;
+           sum_r += Llm->rel[gnt->i3[i_ent]] * gnt->coef[i_ent];
+           sum_i += Llm->iel[gnt->i3[i_ent]] * gnt->coef[i_ent];
          }
 
        /*
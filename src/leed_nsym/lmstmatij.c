@@ -10,6 +10,8 @@
    two (or more) periodic planes of scatterers.
 Changes:
 GH/01.02.95 - Creation
+AG/17.10.26 - Gij from the precompiled C.G. coupling tensor
+              (leed_ms_gaunt) instead of the loop over l3.
 
 *********************************************************************/
 
@@ -80,14 +82,11 @@ NULL if failed (and EXIT_ON_ERROR is not defined)
 int iaux;
 int l1,m1, l2,m2;
 int off_row, off_ij;
+int i_pair, i_ent;
 
-int l3,m3;
-int l3_min, l3_max;
+real sum_r, sum_i;
 
-int i3;
-
-real faux_r;
-real sign;
+leed_gaunt_t *gnt;
 
 /*************************************************************************
  Check the input matrices Llm and Tii
@@ -121,11 +120,17 @@ real sign;
 #endif
  }
 
- if(mk_cg_coef(l_max) != 0)
+ gnt = leed_ms_gaunt(LEED_GAUNT_IJ, l_max);
+ if(gnt == NULL)
  {
-#ifdef WARNING
-   fprintf(STDWAR,
-     " * warning (leed_ms_tmat_ij): C.G. coefficients had to be recalculated\n");
+#ifdef ERROR
+   fprintf(STDERR," *** error (leed_ms_tmat_ij): no C.G. coupling tensor\n");
+#endif
+#ifndef EXIT_ON_ERROR
+   return(NULL);
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
 #endif
  }
 
@@ -136,8 +141,8 @@ real sign;
 
 #ifdef CONTROL
  fprintf(STDCTR,"\n(leed_ms_tmat_ij): Llm:\n");
- for(i3 = 1; i3 <= Llm->rows; i3++)
-  printf("(%8.5f, %8.5f)", Llm->rel[i3], Llm->iel[i3]);
+ for(i_ent = 1; i_ent <= Llm->rows; i_ent++)
+  printf("(%8.5f, %8.5f)", Llm->rel[i_ent], Llm->iel[i_ent]);
  printf("\n");
 #endif
 
@@ -150,6 +155,9 @@ real sign;
              = -8 PI * i^(l+1) *
                sum(P) [ Ylm (rj-ri+P) * H(1)l(k*|rj-ri+P|) * exp( i(-kin*P)]
     C(l3,m3,l1,m1,l2,m2) = C.G. coefficients.
+
+  The sum over l3 is the contraction of the coupling tensor gnt (signs
+  included) with Llm.
 *************************************************************************/
  for(l1 = 0, off_row = 0; l1 <= l_max; l1 ++)
  {
@@ -163,50 +171,20 @@ real sign;
        for(m2 = -l2; m2 <= l2; m2 ++, off_ij ++ )
        {
      /* 
-       Loop over l3 (inner-most loop): calculate the elements of Gij
-
-        - l3_min: l3 >= |m3|, |l2-l1|.
-        - Only even (l1 + l2 + l3) lead to nonzero C.G.-coefficients
-          => if (l1 + l2 + l3_min) is odd, increment l3_min by 1.
-          => increment l3 by 2 in the inner loop.
-        - The sign (-1)^(m2+1) is due to different definitions of C.G.C's 
-          and the "-" in front of the summation.
+        The sign (-1)^(m2+1) in gnt is due to different definitions of 
+        C.G.C's and the "-" in front of the summation.
      */
-/*
-         off_ij = off_row * Gij->cols + l2*(l2+1) - m2 + 1;
-*/
-         m3 = m2 - m1;
-
-         l3_min = MAX(abs(-m3), abs(l2-l1)); 
-         l3_min += (l1 + l2 + l3_min)%2;
-         l3_max = l2+l1;
-
-         sign = M1P(m2+1);
-
-
          off_ij = (l1*(l1+1) - m1) * Gij->cols + l2*(l2+1) - m2 + 1;
-         Gij->rel[off_ij] = Gij->iel[off_ij] = 0.;
+         i_pair = (l1*(l1+1) + m1) * gnt->n_lm + l2*(l2+1) + m2;
 
-         i3 = l3_min*(l3_min + 1) - m3 + 1;
-
-         for(l3 = l3_min; l3 <= l3_max; l3 += 2 )
+         sum_r = sum_i = 0.;
+         for(i_ent = gnt->row[i_pair]; i_ent < gnt->row[i_pair+1]; i_ent ++)
          {
-
-           faux_r = sign*cg(l3,+m3, l2,+m2, l1,-m1);
-/*
-           printf("%2d %2d %2d %2d %2d %2d : %.5f\n", 
-                   l1,m1, l2,m2, l3,m3, faux_r);
-*/
-           Gij->rel[off_ij] += Llm->rel[i3] * faux_r;
-           Gij->iel[off_ij] += Llm->iel[i3] * faux_r;
-
-         /*
-           l3 is incremented by 2 
-           => i3 is incremented by 2*(l3+1) + 2*(l3+2) = 4*l3 + 6
-           sign = -sign;
-         */
-           i3 += 4*l3 + 6;
+           sum_r += Llm->rel[gnt->i3[i_ent]] * gnt->coef[i_ent];
+           sum_i += Llm->iel[gnt->i3[i_ent]] * gnt->coef[i_ent];
          }
+         Gij->rel[off_ij] = sum_r;
+         Gij->iel[off_ij] = sum_i;
        }  /* m2 */
      }  /* l2 */
    }  /* m1 */
@@ -12,12 +12,15 @@ GH/11.01.00 - copy from lmstmatii.c
 GH/02.05.00 - use transposed of X-matrix: ((1 - Tlm*Gii)^-1)^t
 GH/22.09.00
 GH/16.07.02 - fix bug cg/gaunt in summation over l3 (Gii)
+AG/17.10.26 - Gii from the precompiled C.G. coupling tensor
+              (leed_ms_gaunt) instead of the loop over l3.
 
 *********************************************************************/
 
 #include <math.h>
 #include <malloc.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "leed.h"
 
@@ -79,19 +82,18 @@ Tii = [Tlm (1 - Gii*Tlm)^-1] * i^(l-l')
 {
 int iaux;
 int l1,m1, l2,m2;
-int l3,m3;
-int l3_min, l3_max;
 
-int i3;
+int off_row, i_pair, i_ent;
 int ilm1, ilm2;
 
 real faux_r, faux_i;
 real sum_r, sum_i;
-real sign;
 
 mat Tlm;
 mat Gii;
 
+leed_gaunt_t *gnt;
+
 /*************************************************************************
 Check matrix dimensions of Tlm_in and compatibilities with l_max. 
  - allocate Tii and Tlm.
@@ -181,13 +183,18 @@ Check matrix dimensions of Tlm_in and compatibilities with l_max.
  
 *************************************************************************/
 
- if(mk_cg_coef(2*l_max) != 0)
+ gnt = leed_ms_gaunt(LEED_GAUNT_II, l_max);
+ if(gnt == NULL)
  {
-#ifdef WARNING
-   fprintf(STDWAR,
-     "* warning (leed_ms_tmat_nd_ii): C.G. coefficients had to be recalculated\n");
+#ifdef ERROR
+   fprintf(STDERR,
+     "*** error (leed_ms_tmat_nd_ii): no C.G. coupling tensor\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(NULL);
 #endif
-   ;
  }
 
 /*************************************************************************
@@ -202,6 +209,10 @@ Check matrix dimensions of Tlm_in and compatibilities with l_max.
     (under most conditions)
     therefore only (l2,m2) <= (l1,m1) could be calculated which is,
     however not implemented (see comments in m2 loops). 
+  - The sum over l3 is the contraction of the coupling tensor gnt
+    (signs included) with Llm. Pairs from different parity blocks
+    (odd l1+m1+l2+m2) have no entries since L(l3,m3) vanishes for
+    odd l3+m3.
 *************************************************************************/
 
  Gii = NULL;
@@ -212,47 +223,20 @@ Check matrix dimensions of Tlm_in and compatibilities with l_max.
  {
    for(m1 = -l1; m1 <= l1; m1 ++)
    {
+     off_row = (l1*(l1+1) + m1) * gnt->n_lm;
      for(l2 = 0; l2 <= l_max; l2 ++)
      {
        for(m2 = -l2; m2 <= l2; m2 ++, ilm1 ++)
        {
 
-     /*
-        Loop over l3 (inner--most loop): calculate the elements of Gii
-        - l3_min: l3 >= |m3|, |l2-l1|.
-        - Only even (l1 + l2 + l3) lead to nonzero C.G.-coefficients
-          => if (l1 + l2 + l3_min) is odd, increment l3_min by 1.
-     */
-
-/* m3 = m2 - m1; */
-         m3 = m1 - m2;
-
-         l3_min = MAX(abs(m3), abs(l2-l1));
-         l3_min += (l1 + l2 + l3_min)%2;
-         l3_max = l2+l1;
+         i_pair = off_row + l2*(l2+1) + m2;
 
          sum_r = sum_i = 0.;
-         i3 = l3_min*(l3_min + 1) - m3 + 1;
-
-/* sign = M1P( (l2 - l1 - l3_min)/2 - m2); */
-         sign = M1P( (l1 - l2 - l3_min)/2 - m2);
-
-         for(l3 = l3_min; l3 <= l3_max; l3 += 2 )
+         for(i_ent = gnt->row[i_pair]; i_ent < gnt->row[i_pair+1]; i_ent ++)
          {
-/* faux_r = sign*gaunt(l1, m1, l3, m3, l2,m2); */
-           faux_r = sign*cg(l3, m3, l1,m1,l2,-m2);
-
-           sum_r += Llm->rel[i3] * faux_r;
-           sum_i += Llm->iel[i3] * faux_r;
-
-         /*
-           l3 is incremented by 2
-           => l3/2 is incremented by 1; the sign is inverted.
-           => i3 is incremented by 2*(l3+1) + 2*(l3+2) = 4*l3 + 6
-         */
-           sign = -sign;
-           i3 += 4*l3 + 6;
-         }  /* l3 */
+           sum_r += Llm->rel[gnt->i3[i_ent]] * gnt->coef[i_ent];
+           sum_i += Llm->iel[gnt->i3[i_ent]] * gnt->coef[i_ent];
+         }
 
        /*
          Store -i * sum in Gii (to be multiplied with Tlm). The factor i 
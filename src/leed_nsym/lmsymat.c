@@ -6,11 +6,25 @@
      Create the transformation matrix from angular momentum space 
      into k-space: Ylm(k).
 
+  leed_ms_ymat_cache      (17.10.26)
+     Return Ylm(k) and the derived matrices Ylm(k-), Y*lm(k+/-) of a
+     beam set from a cache (one calculation per energy and beam set).
+
+  leed_ms_ymat_cache_free (17.10.26)
+     Free the cache.
+
+Changes:
+AG/17.10.26 - static Ylm is thread private.
+AG/17.10.26 - cache of Ylm per beam set (leed_ms_ymat_cache).
+AG/17.10.26 - leed_ms_ymat_cache: beam directions compared with 
+              IS_EQUAL_REAL.
+
 *********************************************************************/
 
 #include <math.h>
 #include <malloc.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "leed.h"
@@ -20,6 +34,12 @@
 
 static mat Ylm = NULL;
 
+static leed_ylm_t **ylm_cache = NULL;
+static int n_ylm_cache = 0;
+#ifdef _USE_OPENMP
+#pragma omp threadprivate(Ylm, ylm_cache, n_ylm_cache)
+#endif
+
 mat leed_ms_ymat ( mat Ymat, int l_max, leed_beam_t *beams, int n_beams)
 
 /************************************************************************
@@ -96,3 +116,158 @@ int i_beams;
  
 /*======================================================================*/
 /*======================================================================*/
+
+leed_ylm_t *leed_ms_ymat_cache(int l_max, leed_beam_t *beams, int n_beams)
+
+/************************************************************************
+
+ Return the spherical harmonics of a beam set and the matrices derived
+ from them.
+
+ INPUT:
+
+   int l_max - max l quantum number spanning up the (l,m)-space.
+   leed_beam_t *beams - beams spanning up the k-space.
+   n_beams - number of beams in list beams.
+
+ DESIGN:
+
+   Ylm(k) depends only on the directions of the beams, i.e. it is the
+   same for all layers which use the same beam set at the same energy.
+   The cache entries are identified by n_beams, l_max, and the angles
+   (cth, phi) of all beams; the beam lists themselves are often
+   temporary copies (e.g. leed_beam_set_copy) and cannot be used as key.
+   If no entry matches, an entry of a different energy (|k| of the
+   first beam) is recalculated or a new entry is added. The cache is
+   thread private.
+
+   The matrices in the returned entry belong to the cache and must not
+   be modified or freed by the calling function. They remain valid until
+   the next call for the same beam list at a different energy.
+
+ RETURN VALUES:
+
+   NULL if failed (and EXIT_ON_ERROR is not defined)
+
+   pointer to the cache entry:
+     ->Yp  = Ylm(k+)   (leed_ms_ymat)
+     ->Ym  = Ylm(k-)   (leed_ms_yp_ym)
+     ->Yxp = Y*lm(k+)  (leed_ms_yp_yxp)
+     ->Yxm = Y*lm(k-)  (leed_ms_yp_yxm)
+
+*************************************************************************/
+{
+int i_cache, i_beams;
+real *ang;
+leed_ylm_t *ylm, **p_aux;
+
+/*
+  Look for an entry with the same beam directions.
+*/
+ ylm = NULL;
+ for(i_cache = 0; i_cache < n_ylm_cache; i_cache ++)
+ {
+   if( (ylm_cache[i_cache]->n_beams != n_beams) ||
+       (ylm_cache[i_cache]->l_max != l_max)        ) continue;
+
+   for(i_beams = 0, ang = ylm_cache[i_cache]->ang; i_beams < n_beams; 
+       i_beams ++, ang += 3)
+   {
+     if( ! IS_EQUAL_REAL(ang[0], (beams+i_beams)->cth_r) ||
+         ! IS_EQUAL_REAL(ang[1], (beams+i_beams)->cth_i) ||
+         ! IS_EQUAL_REAL(ang[2], (beams+i_beams)->phi)      ) break;
+   }
+   if(i_beams == n_beams) return(ylm_cache[i_cache]);
+
+   if( (ylm == NULL) &&
+       ( ! IS_EQUAL_REAL(ylm_cache[i_cache]->k_r, beams->k_r[0]) ||
+         ! IS_EQUAL_REAL(ylm_cache[i_cache]->k_i, beams->k_i[0])    ) )
+     ylm = ylm_cache[i_cache];
+ }
+
+/*
+  No entry of a previous energy: add an entry.
+*/
+ if(ylm == NULL)
+ {
+   p_aux = (leed_ylm_t **)realloc(ylm_cache, 
+                                  (n_ylm_cache + 1)*sizeof(leed_ylm_t *));
+   ylm = (leed_ylm_t *)calloc(1, sizeof(leed_ylm_t));
+   if(p_aux != NULL) ylm_cache = p_aux;
+   if( (p_aux == NULL) || (ylm == NULL) ) 
+   {
+     free(ylm);
+     ylm = NULL;
+   }
+   else
+   {
+     ylm_cache[n_ylm_cache ++] = ylm;
+     ylm->n_beams = n_beams;
+     ylm->l_max = l_max;
+     ylm->ang = (real *)malloc(3*n_beams*sizeof(real));
+   }
+ }
+
+ if( (ylm == NULL) || (ylm->ang == NULL) )
+ {
+#ifdef ERROR
+   fprintf(STDERR,"*** error (leed_ms_ymat_cache): allocation error\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(NULL);
+#endif
+ }
+
+#ifdef CONTROL
+ fprintf(STDCTR,"(leed_ms_ymat_cache): recalculate Ylm (%d beams)\n", n_beams);
+#endif
+
+/*
+  (Re)calculate the entry.
+*/
+ ylm->k_r = beams->k_r[0];
+ ylm->k_i = beams->k_i[0];
+ for(i_beams = 0, ang = ylm->ang; i_beams < n_beams; i_beams ++, ang += 3)
+ {
+   ang[0] = (beams+i_beams)->cth_r;
+   ang[1] = (beams+i_beams)->cth_i;
+   ang[2] = (beams+i_beams)->phi;
+ }
+
+ ylm->Yp  = leed_ms_ymat  (ylm->Yp, l_max, beams, n_beams);
+ ylm->Ym  = leed_ms_yp_ym (ylm->Ym,  ylm->Yp);
+ ylm->Yxp = leed_ms_yp_yxp(ylm->Yxp, ylm->Yp);
+ ylm->Yxm = leed_ms_yp_yxm(ylm->Yxm, ylm->Yp);
+
+ return(ylm);
+} /* end of function leed_ms_ymat_cache */
+
+/*======================================================================*/
+/*======================================================================*/
+
+void leed_ms_ymat_cache_free(void)
+
+/************************************************************************
+ Free all entries of the (thread private) Ylm cache.
+*************************************************************************/
+{
+int i_cache;
+
+ for(i_cache = 0; i_cache < n_ylm_cache; i_cache ++)
+ {
+   matfree(ylm_cache[i_cache]->Yp);
+   matfree(ylm_cache[i_cache]->Ym);
+   matfree(ylm_cache[i_cache]->Yxp);
+   matfree(ylm_cache[i_cache]->Yxm);
+   free(ylm_cache[i_cache]->ang);
+   free(ylm_cache[i_cache]);
+ }
+ free(ylm_cache);
+ ylm_cache = NULL;
+ n_ylm_cache = 0;
+} /* end of function leed_ms_ymat_cache_free */
+
+/*======================================================================*/
+/*======================================================================*/
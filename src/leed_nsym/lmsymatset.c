@@ -8,6 +8,7 @@
 
 Changes:
 GH/21.04.95 - copied from leed_ms_ymat
+AG/17.10.26 - static Ylm is thread private.
 
 *********************************************************************/
 
@@ -22,6 +23,9 @@ GH/21.04.95 - copied from leed_ms_ymat
 /*======================================================================*/
 
 static mat Ylm = NULL;
+#ifdef _USE_OPENMP
+#pragma omp threadprivate(Ylm)
+#endif
 
 mat leed_ms_ymat_set ( mat Ymat, int l_max, leed_beam_t *beams, int set)
 
@@ -17,6 +17,9 @@
 Changes:
 GH/22-24.08.94 - Creation
 GH/10.04.95 - correction in leed_ms_yp_ym (remove offm)
+AG/17.10.26 - leed_ms_yp_yxp/yxm: write the transposed matrix with
+              exchanged m/-m columns and signs in one pass (no row
+              buffers, no separate transposition).
 
 *********************************************************************/
 
@@ -41,6 +44,7 @@ mat leed_ms_yp_yxp ( mat Yxmat, mat Ymat)
  INPUT:
 
    mat Yxmat - (output) conjugate and transposed matrix to Ymat: Y*lm(k+).
+               (must be different from Ymat).
    mat Ymat - (input) transformation matrix from angular momentum space
               into k-space: Ylm(k+).
  DESIGN:
@@ -73,74 +77,50 @@ mat leed_ms_yp_yxp ( mat Yxmat, mat Ymat)
 {
 int l,m;                       /* l,m quantum numbers */
 int l_max;
-int offl, offm;                /* offsets in the arrays Ymat and Yxmat */
-int size;
+int n_k, n_lm;                 /* number of k values and (l,m) pairs */
+int i_k, off_x, off_y;         /* offsets in the arrays Yxmat and Ymat */
 
-real *buffer;
-
-real *ptr, *ptr_end;
-
-/*
-  Check arguments:
-*/
+real sign;
+real *ptr_r, *ptr_i;
 
 /*
-  Copy transposed of Ymat into Yxmat
-  - the rows of Yxmat have now the same (l,m) quantum numbers.
+  Allocate Yxmat: transposed dimensions of Ymat.
+  - the rows of Yxmat have the same (l,m) quantum numbers.
     Yxmat->cols = number of k values.
     Yxmat->rows = number of (l,m) pairs.
-  - allocate a buffer of the size of one row.
+  - Yxmat must be different from Ymat.
   - find l_max;
 */
+ n_k  = Ymat->rows;
+ n_lm = Ymat->cols;
 
- Yxmat = mattrans( Yxmat, Ymat);
+ Yxmat = matalloc( Yxmat, n_lm, n_k, NUM_COMPLEX);
 
- size = Yxmat->cols * sizeof(real);
- buffer = (real*)malloc(size);
- 
- l_max = (int)(R_sqrt((real) Yxmat->rows ) + 0.1) - 1;
+ l_max = (int)(R_sqrt((real) n_lm ) + 0.1) - 1;
 #ifdef CONTROL
  fprintf(STDCTR,"(leed_ms_yp_yxp): l_max = %2d\n", l_max);
 #endif
 
 /*
-  Loop over l,m (l>0, m>0):
-  - exchange rows of m with -m
+  Loop over l,m: 
+  row (l,m) of Yxmat = (-1)^m * column (l,-m) of Ymat
 */
-
- for( l = 1, offl =  2*Yxmat->cols + 1; l <= l_max; 
-      l ++,  offl += 2*l* Yxmat->cols)
+ for( l = 0, off_x = 1; l <= l_max; l ++)
  {
-   for( m = 1, offm = Yxmat->cols; m <= l; m++, offm += Yxmat->cols)
+   for( m = -l; m <= l; m ++, off_x += n_k)
    {
-   /* 
-     Exchange row m with row -m 
-     Change sign, if m is odd.
-   */
-     memcpy(buffer,               Yxmat->rel+offl+offm, size);
-     memcpy(Yxmat->rel+offl+offm, Yxmat->rel+offl-offm, size);
-     memcpy(Yxmat->rel+offl-offm, buffer              , size);
-    
-     memcpy(buffer,               Yxmat->iel+offl+offm, size);
-     memcpy(Yxmat->iel+offl+offm, Yxmat->iel+offl-offm, size);
-     memcpy(Yxmat->iel+offl-offm, buffer              , size);
-
-     if (ODD(m))
+     sign = M1P(m);
+     off_y = l*(l+1) - m + 1;
+
+     for( i_k = 0, ptr_r = Yxmat->rel + off_x, ptr_i = Yxmat->iel + off_x; 
+          i_k < n_k; i_k ++, off_y += n_lm, ptr_r ++, ptr_i ++)
      {
-       for( ptr = Yxmat->rel+offl+offm, ptr_end = ptr + Yxmat->cols; 
-            ptr < ptr_end; ptr ++) *ptr = -*ptr;
-       for( ptr = Yxmat->rel+offl-offm, ptr_end = ptr + Yxmat->cols; 
-            ptr < ptr_end; ptr ++) *ptr = -*ptr;
-
-       for( ptr = Yxmat->iel+offl+offm, ptr_end = ptr + Yxmat->cols; 
-            ptr < ptr_end; ptr ++) *ptr = -*ptr;
-       for( ptr = Yxmat->iel+offl-offm, ptr_end = ptr + Yxmat->cols; 
-            ptr < ptr_end; ptr ++) *ptr = -*ptr;
+       *ptr_r = sign * Ymat->rel[off_y];
+       *ptr_i = sign * Ymat->iel[off_y];
      }
    }  /* m */
  }  /* l */
 
- free(buffer);
  return(Yxmat);
 }
  
@@ -157,7 +137,7 @@ mat leed_ms_yp_yxm ( mat Yxmat, mat Ymat)
  INPUT:
 
    mat Yxmat - (output) conjugate and transposed matrix to Ymat(k): 
-               Y*lm(k-).
+               Y*lm(k-) (must be different from Ymat).
    mat Ymat - (input) transformation matrix from angular momentum space
               into k-space: Ylm(k+).
  DESIGN:
@@ -190,75 +170,50 @@ mat leed_ms_yp_yxm ( mat Yxmat, mat Ymat)
 {
 int l,m;                       /* l,m quantum numbers */
 int l_max;
-int offl, offm;                /* offsets in the arrays Ymat and Yxmat */
-int size;
+int n_k, n_lm;                 /* number of k values and (l,m) pairs */
+int i_k, off_x, off_y;         /* offsets in the arrays Yxmat and Ymat */
 
-real *buffer;
-
-real *ptr, *ptr_end;
+real sign;
+real *ptr_r, *ptr_i;
 
 /*
-  Check arguments:
-*/
-
-/*
-  Copy transposed of Ymat into Yxmat
-  - the rows of Yxmat have now the same (l,m) quantum numbers.
+  Allocate Yxmat: transposed dimensions of Ymat.
+  - the rows of Yxmat have the same (l,m) quantum numbers.
     Yxmat->cols = number of k values.
     Yxmat->rows = number of (l,m) pairs.
-  - allocate a buffer of the size of one row.
+  - Yxmat must be different from Ymat.
   - find l_max;
 */
- Yxmat = mattrans( Yxmat, Ymat);
+ n_k  = Ymat->rows;
+ n_lm = Ymat->cols;
 
- size = Yxmat->cols * sizeof(real);
- buffer = (real*)malloc(size);
- 
- l_max = (int)(R_sqrt((real) Yxmat->rows ) + 0.1) - 1;
+ Yxmat = matalloc( Yxmat, n_lm, n_k, NUM_COMPLEX);
 
+ l_max = (int)(R_sqrt((real) n_lm ) + 0.1) - 1;
 #ifdef CONTROL
  fprintf(STDCTR,"(leed_ms_yp_yxm): l_max = %2d\n", l_max);
 #endif
 
 /*
-  Loop over l,m (l>0, m>0):
-  - exchange rows of m with -m
+  Loop over l,m: 
+  row (l,m) of Yxmat = (-1)^l * column (l,-m) of Ymat
 */
-
- for( l = 1, offl =  2*Yxmat->cols + 1; l <= l_max; 
-      l ++,  offl += 2*l* Yxmat->cols)
+ for( l = 0, off_x = 1; l <= l_max; l ++)
  {
-   for( m = 1, offm = Yxmat->cols; m <= l; m++, offm += Yxmat->cols)
+   for( m = -l; m <= l; m ++, off_x += n_k)
    {
- /* 
-   Exchange row m with row -m 
- */
-     memcpy(buffer,               Yxmat->rel+offl+offm, size);
-     memcpy(Yxmat->rel+offl+offm, Yxmat->rel+offl-offm, size);
-     memcpy(Yxmat->rel+offl-offm, buffer              , size);
-    
-     memcpy(buffer,               Yxmat->iel+offl+offm, size);
-     memcpy(Yxmat->iel+offl+offm, Yxmat->iel+offl-offm, size);
-     memcpy(Yxmat->iel+offl-offm, buffer              , size);
-   }  /* m */
+     sign = M1P(l);
+     off_y = l*(l+1) - m + 1;
 
- /* 
-   Change the sign of all rows with the same l, if this is odd.
- */
-   if (ODD(l))
-   {
-     for( ptr = Yxmat->rel+offl-(l*Yxmat->cols), 
-          ptr_end = ptr + (2*l + 1)*Yxmat->cols; 
-          ptr < ptr_end; ptr ++) 
-       *ptr = -*ptr;
-     for( ptr = Yxmat->iel+offl-(l*Yxmat->cols), 
-          ptr_end = ptr + (2*l + 1)*Yxmat->cols; 
-          ptr < ptr_end; ptr ++) 
-       *ptr = -*ptr;
-   }
+     for( i_k = 0, ptr_r = Yxmat->rel + off_x, ptr_i = Yxmat->iel + off_x; 
+          i_k < n_k; i_k ++, off_y += n_lm, ptr_r ++, ptr_i ++)
+     {
+       *ptr_r = sign * Ymat->rel[off_y];
+       *ptr_i = sign * Ymat->iel[off_y];
+     }
+   }  /* m */
  }  /* l */
 
- free(buffer);
  return(Yxmat);
 }
  
@@ -9,11 +9,21 @@
 
  Write header information to output file.
 
+  int leed_output_beam_head(FILE * outfile, leed_beam_t *beams_out, 
+                 int n_beams, int n_eng, real e_ini, real e_fin, 
+                 real e_stp)
+
+ Write the energy and beam information ("#en", "#bn", "#bi").
+
  Changes:
  
  GH/20.07.95 - Creation
  GH/11.08.95 - write only non-evanescent beams to output. Return value
                is a list of nonevanescent beams at eng->fin.
+ AG/17.10.26 - no output if outfile is NULL (create beams_out only).
+ AG/17.10.26 - set i_out (position in beams_out) in beams_all.
+ AG/17.10.26 - "#en", "#bn", "#bi" are written by leed_output_beam_head
+               (also used for non-uniform energy grids).
 
 *********************************************************************/
 
@@ -60,7 +70,7 @@ int leed_output_beam_list(leed_beam_t ** p_beams_out,
             eng->stp = energy step.
         
   FILE * outfile - (input) pointer to the output file were the intensities 
-            are written to.
+            are written to. If NULL, only beams_out is created.
 
  DESIGN:
 
@@ -129,7 +139,7 @@ leed_beam_t *beams_out;
 #ifdef EXIT_ON_ERROR
    exit(1);
 #else
-   return(-1)
+   return(-1);
 #endif
  }
 
@@ -139,14 +149,19 @@ leed_beam_t *beams_out;
   k_max is the square of the maximum pareallel vector component of 
         non-evanescent wave vectors at eng->fin.
   n_beams is set to number of output beams afterwards.
+  i_out of each beam in beams_all is set to its position in beams_out
+  (-1 if not included). It is copied by leed_beam_get_selection and 
+  used to map intensities to output columns (leed_output_int_buf).
 ************************************************************************/
 
  k_max =  2. * eng->fin;
 
  for(i_bm_all = 0, i_bm_out = 0; i_bm_all < n_beams; i_bm_all ++)
  {
+   (beams_all + i_bm_all)->i_out = -1;
    if( (beams_all + i_bm_all)->k_par <= k_max )
    {
+     (beams_all + i_bm_all)->i_out = i_bm_out;
      memcpy( beams_out + i_bm_out, 
              beams_all + i_bm_all, 
              sizeof(leed_beam_t) );
@@ -178,17 +193,58 @@ leed_beam_t *beams_out;
   - 
 ************************************************************************/
 
-/* energies */
- for(faux = eng->ini, n_eng = 0; 
-     faux <= eng->fin; 
-     faux += eng->stp, n_eng++)
- { ; }
+ if(outfile != NULL)
+ {
+  /* energies */
+   for(faux = eng->ini, n_eng = 0; 
+       faux <= eng->fin; 
+       faux += eng->stp, n_eng++)
+   { ; }
+
+   leed_output_beam_head(outfile, beams_out, n_beams, n_eng, 
+                         eng->ini, eng->fin, eng->stp);
+ }
+
+/* write beams_out back to pointer */
+ *p_beams_out = beams_out;
+
+ return(n_beams);
+}  /* end of function leed_output_beam_list */
+/************************************************************************/
+
+int leed_output_beam_head(FILE * outfile, leed_beam_t *beams_out, 
+               int n_beams, int n_eng, real e_ini, real e_fin, real e_stp)
+
+/************************************************************************
+
+ Write energies, number of beams, and beams to output:
+
+  "#en" energies: 
+        number of energies, initial energy, final energy, energy step.
+  "#bn" number of beams
+  "#bi" beam indices: 
+        number (starting from zero), 1st index, 2nd index, beam set.
+ 
+ INPUT:
+
+  FILE * outfile - output file.
+  leed_beam_t *beams_out - output beams (leed_output_beam_list).
+  int n_beams - number of output beams.
+  int n_eng - number of energies (lines of intensities that follow).
+  real e_ini, e_fin, e_stp - initial/final energy and energy step 
+            (atomic units). For a non-uniform energy grid e_stp is the 
+            smallest step.
+
+ RETURN VALUES:
+
+  n_beams.
+
+*************************************************************************/
+{
+int i_bm_out;
 
  fprintf(outfile, "#en %d %f %f %f\n", 
-                   n_eng,
-                   eng->ini*HART, 
-                   eng->fin*HART, 
-                   eng->stp*HART);
+                   n_eng, e_ini*HART, e_fin*HART, e_stp*HART);
 
 /* number of beams */
  fprintf(outfile, "#bn %d\n", n_beams);
@@ -202,12 +258,10 @@ leed_beam_t *beams_out;
                      (beams_out+i_bm_out)->ind_2,
                      (beams_out+i_bm_out)->set);
  }
+
 /* flush output file */
  fflush(outfile);
 
-/* write beams_out back to pointer */
- *p_beams_out = beams_out;
-
  return(n_beams);
-}  /* end of function leed_output_beam_list */
+}  /* end of function leed_output_beam_head */
 /************************************************************************/
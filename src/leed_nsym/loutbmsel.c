@@ -0,0 +1,245 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  leed_output_beam_ctr
+    Read the beam indices used in an R factor control file (*.ctr).
+  leed_output_beam_select
+    Restrict the list of output beams to a list of beam indices.
+
+  By default the intensities of all non-evanescent beams are written
+  (leed_output_beam_list), although only the beams compared with
+  experimental data are used by the R factor program. With a beam
+  selection (option -c <ctr_file> of cleed_nsym and cleed_sym), only
+  the beams that appear in the "ti=" entries of the control file are
+  written; the output file is compatible with cr_rdcleed as long as all
+  beams named in the control file are output beams.
+
+Changes:
+  AG/17.10.26 - Creation
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "leed.h"
+
+#ifndef GEO_TOLERANCE           /* should be defined in "leed_def.h" */
+#define GEO_TOLERANCE 0.0001
+#endif
+
+/*======================================================================*/
+
+int leed_output_beam_ctr(real **p_ind, const char *ctr_file)
+
+/*********************************************************************
+  Read the beam indices used in an R factor control file.
+
+ INPUT:
+
+  real **p_ind - (output) beam indices: (*p_ind)[2*i] and
+         (*p_ind)[2*i+1] are the 1st and 2nd index of beam i.
+         Allocated by the function.
+  const char *ctr_file - name of the control file (see cr_input).
+
+ DESIGN:
+
+  Lines starting with '#' are comments. In all other lines the entry
+  "ti=" is an index list like "(-1.,1.)+(1.,-1.)*0.5" (see cr_intindl);
+  every pair "(<index1>,<index2>)" is added to the list (once).
+
+ RETURN VALUE:
+
+  number of beams in the list.
+  -1 if the file could not be read or contains no beams (and
+         EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+int i_ind, n_ind, n_max;
+real ind_1, ind_2;
+
+char line_buffer[STRSZ];
+char *ptr, *sep;
+real *ind;
+
+FILE *ctr_stream;
+
+ if((ctr_stream = fopen(ctr_file, "r")) == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_output_beam_ctr): "
+           "could not open control file \"%s\"\n", ctr_file);
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+ n_ind = 0;
+ n_max = 16;
+ ind = (real *)malloc(2 * n_max * sizeof(real));
+
+ while( (ind != NULL) && (fgets(line_buffer, STRSZ, ctr_stream) != NULL) )
+ {
+   if( (line_buffer[0] == '#') ||
+       ((ptr = strstr(line_buffer, "ti=")) == NULL) ) continue;
+
+   /* the index list ends at the next ':' */
+   if((sep = strchr(ptr, ':')) != NULL) *sep = '\0';
+
+   while( (ptr = strchr(ptr, '(')) != NULL )
+   {
+     ind_1 = (real)atof(ptr + 1);
+     if((ptr = strchr(ptr, ',')) == NULL) break;
+     ind_2 = (real)atof(ptr + 1);
+
+     for(i_ind = 0; i_ind < n_ind; i_ind ++)
+       if( IS_EQUAL_REAL(ind[2*i_ind], ind_1) &&
+           IS_EQUAL_REAL(ind[2*i_ind + 1], ind_2) ) break;
+
+     if(i_ind == n_ind)
+     {
+       if(n_ind == n_max)
+       {
+         n_max *= 2;
+         ind = (real *)realloc(ind, 2 * n_max * sizeof(real));
+         if(ind == NULL) break;
+       }
+       ind[2*n_ind]     = ind_1;
+       ind[2*n_ind + 1] = ind_2;
+       n_ind ++;
+     }
+   }
+ }
+ fclose(ctr_stream);
+
+ if( (ind == NULL) || (n_ind == 0) )
+ {
+#ifdef ERROR
+   if(ind == NULL)
+     fprintf(STDERR, "*** error (leed_output_beam_ctr): allocation error\n");
+   else
+     fprintf(STDERR, "*** error (leed_output_beam_ctr): "
+             "no beams (\"ti=\") in \"%s\"\n", ctr_file);
+#endif
+   free(ind);
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(leed_output_beam_ctr): %d beams in \"%s\"\n",
+         n_ind, ctr_file);
+#endif
+
+ *p_ind = ind;
+ return(n_ind);
+} /* end of function leed_output_beam_ctr */
+
+/*======================================================================*/
+
+int leed_output_beam_select(leed_beam_t *beams_out, leed_beam_t *beams_all,
+                            real *ind, int n_ind)
+
+/*********************************************************************
+  Restrict the list of output beams to a list of beam indices.
+
+ INPUT:
+
+  leed_beam_t *beams_out - (input/output) output beams as created by
+         leed_output_beam_list. All beams which are not in the list ind
+         are removed; the order of the other beams is kept.
+  leed_beam_t *beams_all - all beams (leed_beam_gen); i_out is updated
+         to the new positions in beams_out (-1 for removed beams).
+  real *ind, int n_ind - indices of the selected beams (see
+         leed_output_beam_ctr).
+
+ DESIGN:
+
+  Beams of the list which are not output beams (evanescent at the
+  final energy or not in beams_all) are reported; cr_rdcleed cannot
+  find them in the output file.
+
+ RETURN VALUE:
+
+  number of output beams.
+
+*********************************************************************/
+{
+int i_bm_all, i_bm_out, n_out;
+int i_ind;
+
+int *found;
+
+ found = (int *)calloc(n_ind + 1, sizeof(int));
+
+/*********************************************************************
+  Remove beams which are not in the list
+*********************************************************************/
+
+ for(i_bm_out = 0, n_out = 0;
+     ! IS_EQUAL_REAL((beams_out + i_bm_out)->k_par, F_END_OF_LIST);
+     i_bm_out ++)
+ {
+   for(i_ind = 0; i_ind < n_ind; i_ind ++)
+     if( (R_fabs((beams_out + i_bm_out)->ind_1 - ind[2*i_ind])
+                                                      < GEO_TOLERANCE) &&
+         (R_fabs((beams_out + i_bm_out)->ind_2 - ind[2*i_ind + 1])
+                                                      < GEO_TOLERANCE) )
+       break;
+
+   if(i_ind < n_ind)
+   {
+     if(found != NULL) found[i_ind] = 1;
+     if(n_out < i_bm_out)
+       memcpy(beams_out + n_out, beams_out + i_bm_out, sizeof(leed_beam_t));
+     n_out ++;
+   }
+ }
+ (beams_out + n_out)->k_par = F_END_OF_LIST;
+
+#ifdef WARNING
+ for(i_ind = 0; (found != NULL) && (i_ind < n_ind); i_ind ++)
+   if(! found[i_ind])
+     fprintf(STDWAR, "* warning (leed_output_beam_select): beam (%.2f,%.2f) "
+             "is not an output beam\n", ind[2*i_ind], ind[2*i_ind + 1]);
+#endif
+ free(found);
+
+/*********************************************************************
+  New positions in beams_out (i_out, see leed_output_beam_list)
+*********************************************************************/
+
+ for(i_bm_all = 0;
+     ! IS_EQUAL_REAL((beams_all + i_bm_all)->k_par, F_END_OF_LIST);
+     i_bm_all ++)
+ {
+   (beams_all + i_bm_all)->i_out = -1;
+   for(i_bm_out = 0; i_bm_out < n_out; i_bm_out ++)
+     if( IS_EQUAL_REAL((beams_all + i_bm_all)->ind_1,
+                       (beams_out + i_bm_out)->ind_1) &&
+         IS_EQUAL_REAL((beams_all + i_bm_all)->ind_2,
+                       (beams_out + i_bm_out)->ind_2) )
+     {
+       (beams_all + i_bm_all)->i_out = i_bm_out;
+       break;
+     }
+ }
+ for(i_bm_out = 0; i_bm_out < n_out; i_bm_out ++)
+   (beams_out + i_bm_out)->i_out = i_bm_out;
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(leed_output_beam_select): %d output beams selected\n",
+         n_out);
+#endif
+
+ return(n_out);
+} /* end of function leed_output_beam_select */
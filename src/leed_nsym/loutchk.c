@@ -0,0 +1,339 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  leed_chk_read
+    Read the energies completed in an existing output file (restart).
+  leed_chk_done
+    Check if an energy is in the list of completed energies.
+  leed_chk_range
+    Read an energy sub-range "e1:e2" (option --energy-range).
+  leed_chk_shard
+    Restrict the energy range to a sub-range or shard.
+
+  The output file (*.res) is the checkpoint of a calculation: each line
+  of intensities is written and flushed as soon as the energy is
+  completed. A restarted run (option --restart) reads the energies
+  present in the file, removes an incomplete last line, and calculates
+  only the remaining energies, appending to the file.
+
+  For a distributed calculation the energy range is split into shards
+  (option --energy-shard i/N) or sub-ranges (--energy-range e1:e2). All
+  shards use the same energy grid and the same list of output beams
+  (determined for the full energy range), so that the output files can
+  be recombined by cleed_merge.
+
+Changes:
+  AG/17.10.26 - Creation
+  AG/17.10.26 - leed_chk_range: check the argument of --energy-range;
+                leed_chk_shard: empty sub-range is an invalid energy range.
+  AG/17.10.26 - leed_chk_shard: eng->fin is kept if the new range ends
+                at the last energy of the grid.
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "leed.h"
+
+#ifndef E_TOLERANCE           /* should be defined in "leed_def.h" */
+#define E_TOLERANCE 0.0001
+#endif
+
+/* energies are written with two decimals (eV) */
+#define CHK_E_TOLERANCE (0.01/HART)
+
+/*======================================================================*/
+
+int leed_chk_read(const char *res_file, int n_out, real **p_done)
+
+/*********************************************************************
+  Read the energies completed in an existing output file.
+
+ INPUT:
+
+  const char *res_file - name of the output file.
+  int n_out - number of output beams of the calculation (must match
+         the "#bn" entry of the file).
+  real **p_done - (output) list of completed energies (Hartree).
+         Allocated by the function if the return value is >= 0.
+
+ DESIGN:
+
+  The file is read as a whole. Everything after the last newline
+  (an incomplete line of an interrupted run) is removed from the file.
+  Lines not starting with '#' contain the intensities of one energy;
+  the energy (eV) is the first entry.
+
+ RETURN VALUE:
+
+  number of completed energies (>= 0) if the file contains a header for
+         n_out beams; output can be appended.
+  -1 if the file does not exist or has no header (start a new file).
+  -2 if the header does not match the calculation (and EXIT_ON_ERROR is
+         not defined).
+
+*********************************************************************/
+{
+int n_bn, n_done;
+long i_c, n_len, n_size;
+
+char *buf, *line;
+real *done;
+
+FILE *chk_stream;
+
+ if((chk_stream = fopen(res_file, "r")) == NULL) return(-1);
+
+ fseek(chk_stream, 0L, SEEK_END);
+ n_size = ftell(chk_stream);
+ rewind(chk_stream);
+
+ buf = (char *)malloc(n_size + 1);
+ if(buf == NULL)
+ {
+   fclose(chk_stream);
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_chk_read): allocation error\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-2);
+#endif
+ }
+ n_size = (long)fread(buf, 1, n_size, chk_stream);
+ fclose(chk_stream);
+
+/* remove incomplete last line */
+ for(n_len = n_size; (n_len > 0) && (buf[n_len - 1] != '\n'); n_len --)
+   ;
+ buf[n_len] = '\0';
+
+/* header */
+ n_bn = -1;
+ line = strstr(buf, "#bn");
+ if( (line != NULL) && ( (line == buf) || (*(line - 1) == '\n') ) )
+   sscanf(line + 3, "%d", &n_bn);
+
+ if(n_bn < 0)
+ {
+#ifdef WARNING
+   fprintf(STDWAR, "* warning (leed_chk_read): no beam header in \"%s\", "
+           "start new file\n", res_file);
+#endif
+   free(buf);
+   return(-1);
+ }
+
+ if(n_bn != n_out)
+ {
+   free(buf);
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_chk_read): \"%s\" contains %d beams, "
+           "calculation has %d beams\n", res_file, n_bn, n_out);
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-2);
+#endif
+ }
+
+/* cut off incomplete line */
+ if(n_len < n_size)
+ {
+#ifdef WARNING
+   fprintf(STDWAR, "* warning (leed_chk_read): incomplete last line "
+           "removed from \"%s\"\n", res_file);
+#endif
+   if((chk_stream = fopen(res_file, "w")) != NULL)
+   {
+     fwrite(buf, 1, n_len, chk_stream);
+     fclose(chk_stream);
+   }
+ }
+
+/* energies */
+ n_done = 0;
+ for(i_c = 0; i_c < n_len; i_c ++)
+   if( (i_c == 0) || (buf[i_c - 1] == '\n') ) n_done ++;
+
+ done = (real *)malloc((n_done + 1) * sizeof(real));
+ if(done == NULL)
+ {
+   free(buf);
+#ifdef ERROR
+   fprintf(STDERR, "*** error (leed_chk_read): allocation error\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-2);
+#endif
+ }
+
+ n_done = 0;
+ for(line = strtok(buf, "\n"); line != NULL; line = strtok(NULL, "\n"))
+   if(line[0] != '#') done[n_done ++] = (real)atof(line) / HART;
+ free(buf);
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(leed_chk_read): %d energies completed in \"%s\"\n",
+         n_done, res_file);
+#endif
+
+ *p_done = done;
+ return(n_done);
+} /* end of function leed_chk_read */
+
+/*======================================================================*/
+
+int leed_chk_done(real energy, real *done, int n_done)
+
+/*********************************************************************
+  Check if an energy (Hartree) is in the list of completed energies
+  (leed_chk_read).
+
+ RETURN VALUE:
+
+  1 if energy is in the list, 0 otherwise.
+
+*********************************************************************/
+{
+int i_eng;
+
+ for(i_eng = 0; i_eng < n_done; i_eng ++)
+   if(R_fabs(energy - done[i_eng]) < CHK_E_TOLERANCE) return(1);
+
+ return(0);
+} /* end of function leed_chk_done */
+
+/*======================================================================*/
+
+int leed_chk_range(const char *str, real *p_lo, real *p_hi)
+
+/*********************************************************************
+  Read an energy sub-range.
+
+ INPUT:
+
+  const char *str - argument of option --energy-range: "e1:e2" (eV).
+  real *p_lo, *p_hi - (output) e1 and e2 (Hartree).
+
+ DESIGN:
+
+  Both energies must be complete numbers (strtod) separated by ':'
+  and e1 must be smaller than e2.
+
+ RETURN VALUE:
+
+  0 if the range is valid.
+  -1 otherwise (*p_lo and *p_hi are unchanged).
+
+*********************************************************************/
+{
+const char *sep;
+char *end;
+real e_lo, e_hi;
+
+ if((sep = strchr(str, ':')) == NULL) return(-1);
+
+ e_lo = (real)strtod(str, &end);
+ if( (end == str) || (end != sep) ) return(-1);
+
+ e_hi = (real)strtod(sep + 1, &end);
+ if( (end == sep + 1) || (*end != '\0') ) return(-1);
+
+ if(e_lo >= e_hi) return(-1);
+
+ *p_lo = e_lo / HART;
+ *p_hi = e_hi / HART;
+ return(0);
+} /* end of function leed_chk_range */
+
+/*======================================================================*/
+
+int leed_chk_shard(leed_energy_t *eng, real e_lo, real e_hi,
+                   int i_shard, int n_shard)
+
+/*********************************************************************
+  Restrict the energy range to a sub-range and/or a shard.
+
+ INPUT:
+
+  leed_energy_t *eng - (input/output) energy range; eng->ini and
+         eng->fin are replaced, eng->stp is unchanged. eng->fin is
+         kept if the new range ends at the last energy of the grid
+         (the "#en" line of the last shard has the original end).
+  real e_lo, e_hi - sub-range (Hartree); ignored if e_lo >= e_hi.
+  int i_shard, n_shard - shard i_shard (1 ... n_shard) of n_shard;
+         ignored if n_shard < 1.
+
+ DESIGN:
+
+  Only energies of the original grid eng->ini + n*eng->stp are used,
+  so that the energies of all shards match. The energies within
+  (e_lo, e_hi) are split into n_shard contiguous blocks of (almost)
+  equal size; shard i_shard is the i_shard-th block.
+
+ RETURN VALUE:
+
+  number of energies in the new range.
+  -1 if the range is empty or the arguments are invalid (and
+         EXIT_ON_ERROR is not defined).
+
+*********************************************************************/
+{
+int i_first, i_last, n_eng, n_all;
+
+ n_eng = n_all = leed_calc_n_eng(eng);
+ i_first = 0;
+ i_last = n_eng - 1;
+
+ if(e_lo < e_hi)
+ {
+   i_first = (int)ceil( (e_lo - eng->ini) / eng->stp - E_TOLERANCE);
+   i_last  = (int)floor((e_hi - eng->ini) / eng->stp + E_TOLERANCE);
+   i_first = MAX(i_first, 0);
+   i_last  = MIN(i_last, n_eng - 1);
+ }
+
+ if(n_shard > 0)
+ {
+   n_eng = i_last - i_first + 1;
+   if( (i_shard < 1) || (i_shard > n_shard) )
+     i_last = i_first - 1;
+   else
+   {
+     i_last  = i_first + (i_shard * n_eng) / n_shard - 1;
+     i_first = i_first + ((i_shard - 1) * n_eng) / n_shard;
+   }
+ }
+
+ if(i_last < i_first)
+ {
+#ifdef ERROR
+   if(n_shard < 1)
+     fprintf(STDERR, "*** error (leed_chk_shard): invalid energy range "
+             "%.2f - %.2f eV (no energies)\n", e_lo*HART, e_hi*HART);
+   else
+     fprintf(STDERR, "*** error (leed_chk_shard): no energies in shard %d/%d "
+             "of range %.2f - %.2f eV\n",
+             i_shard, n_shard, e_lo*HART, e_hi*HART);
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
+#endif
+ }
+
+ if(i_last < n_all - 1) eng->fin = eng->ini + i_last  * eng->stp;
+ eng->ini = eng->ini + i_first * eng->stp;
+
+ return(i_last - i_first + 1);
+} /* end of function leed_chk_shard */
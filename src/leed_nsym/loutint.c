@@ -3,6 +3,10 @@
   file contains function:
 
   leed_output_int(mat Amp, leed_beam_t *beams, leed_var_t *par, FILE * outfile)
+  leed_output_int_buf(real *int_buf, mat Amp, leed_beam_t *beams_now, 
+                      leed_beam_t *beams_out, leed_var_t *par)
+  leed_output_int_list(real *int_buf, int n_out, leed_var_t *par, 
+                       FILE * outfile)
 
  Intensity output function
 
@@ -10,6 +14,14 @@
  
  GH/20.01.95 - Creation
  GH/11.08.95 - Minor changes
+ AG/17.10.26 - add leed_output_int_buf (intensities into a buffer);
+               used by leed_output_int.
+ AG/17.10.26 - map beams to output columns through i_out.
+ AG/17.10.26 - add leed_output_int_list (write intensities from a buffer,
+               e.g. domain averages); used by leed_output_int.
+ AG/17.10.26 - leed_output_int: Int only for the control output.
+ AG/17.10.26 - leed_output_int: declare the variables of the control
+               output only if used.
 
 *********************************************************************/
 
@@ -48,26 +60,34 @@ int leed_output_int(mat Amp, leed_beam_t *beams_now, leed_beam_t *beams_all,
 *************************************************************************/
 {
 
-int i_beams_now, i_beams_all, i_out;
+int n_out;
+#ifdef CONTROL
+int i_beams_now, i_out;
+real k_r;
+#endif
+#ifdef CONTROL_ALL
+int i_beams_all;
+#endif
 
 mat Int;
-real k_r;
+real *int_buf;
 
  Int = NULL;
+ 
+/*********************************************************
+   Print intensities for non-evanescent beams
+*********************************************************/
+
+#ifdef CONTROL
 /*********************************************************
    Calculate intensitied as the square of the moduli of the 
-   amplitudes.
+   amplitudes (only for the control output; the output 
+   intensities are calculated in leed_output_int_buf).
 *********************************************************/
 
  Int = matsqmod(Int, Amp);
-
  k_r = R_sqrt(2*par->eng_v);
- 
-/*********************************************************
-   Print intensities for non-evanescent beams
-*********************************************************/
 
-#ifdef CONTROL
  fprintf(STDCTR,"(leed_output_int):\t     beam\t  intensity\n\t\t\t== %.2f eV ==\n", 
                 par->eng_v*HART);
  for (i_beams_now = 0, i_out = 0; i_beams_now < Int->rows; i_beams_now ++)
@@ -107,35 +127,126 @@ real k_r;
 #endif
 
 
- fprintf(outfile,"%.2f ", par->eng_v*HART);
+ for(n_out = 0; 
+     ! IS_EQUAL_REAL((beams_all + n_out)->k_par, F_END_OF_LIST); n_out ++)
+   ;
+ int_buf = (real *)malloc( (n_out + 1) * sizeof(real) );
+ leed_output_int_buf(int_buf, Amp, beams_now, beams_all, par);
+
+ leed_output_int_list(int_buf, n_out, par, outfile);
+
+ free(int_buf);
+ matfree(Int);
+ return(n_out);
+}  /* end of function leed_output_int */
+
+/************************************************************************/
+
+int leed_output_int_buf(real *int_buf, mat Amp, leed_beam_t *beams_now, 
+                leed_beam_t *beams_out, leed_var_t *par)
+
+/************************************************************************
+
+ Store beam intensities in a buffer.
+ 
+ INPUT:
+
+  real *int_buf - (output) intensities of the beams in beams_out (in the
+           same order). Must have space for all beams in beams_out.
+  mat Amp - (input) vector containing the beam amplitudes of all beams
+           included at the current energy.
+  leed_beam_t *beams_now  -  all beams included at the current energy.
+  leed_beam_t *beams_out  -  output beams (list terminated by 
+           F_END_OF_LIST in k_par).
+  leed_var_t *par - parameters (current vacuum energy eng_v).
+
+ RETURN VALUES:
+
+  number of intensities written to int_buf.
+
+ DESIGN:
+
+  Intensities are the square of the moduli of the amplitudes. Beams 
+  which are evanescent, not included at the current energy or below 
+  INT_TOLERANCE are set to zero.
+
+  The output column of each beam in beams_now is taken from i_out (set
+  by leed_output_beam_list and copied by leed_beam_get_selection), so
+  the mapping is linear in the number of beams. If i_out does not point
+  to a beam with the same indices, beams_out is searched.
+
+*************************************************************************/
+{
+
+int i_beams_now, i_out, n_out;
 
- for(i_beams_all = 0; 
-     ! IS_EQUAL_REAL((beams_all + i_beams_all)->k_par, F_END_OF_LIST);
-     i_beams_all ++)
+real k_r;
+real faux;
+
+ k_r = R_sqrt(2*par->eng_v);
+
+ for(n_out = 0; 
+     ! IS_EQUAL_REAL((beams_out + n_out)->k_par, F_END_OF_LIST); n_out ++)
+   int_buf[n_out] = 0.;
+
+ for(i_beams_now = 0; i_beams_now < Amp->rows; i_beams_now ++)
  {
-   for(i_beams_now = 0; i_beams_now < Int->rows; i_beams_now ++)
+   i_out = (beams_now + i_beams_now)->i_out;
+
+   if( (i_out < 0) || (i_out >= n_out) ||
+       ! IS_EQUAL_REAL((beams_out+i_out)->ind_1, (beams_now+i_beams_now)->ind_1) ||
+       ! IS_EQUAL_REAL((beams_out+i_out)->ind_2, (beams_now+i_beams_now)->ind_2) )
    {
-     if( IS_EQUAL_REAL((beams_all+i_beams_all)->ind_1, (beams_now+i_beams_now)->ind_1) &&
-         IS_EQUAL_REAL((beams_all+i_beams_all)->ind_2, (beams_now+i_beams_now)->ind_2)  )
-     {
-       if((beams_now + i_beams_now)->k_par <= k_r)
-       {
-         if(Int->rel[i_beams_now + 1] > INT_TOLERANCE)
-           fprintf(outfile,"%.6e ", Int->rel[i_beams_now + 1]);
-         else
-           fprintf(outfile,"%.6e ",0.);
-       }
-       else
-         fprintf(outfile,"%.6e ",0.);
-       break;
-     }  /* if index = index */
-   }  /* for i_beams_now */
-
-   if( i_beams_now == Int->rows) fprintf(outfile,"%.6e ",0.);
- } /* for i_beams_all */
+     for(i_out = 0; i_out < n_out; i_out ++)
+       if( IS_EQUAL_REAL((beams_out+i_out)->ind_1, (beams_now+i_beams_now)->ind_1) &&
+           IS_EQUAL_REAL((beams_out+i_out)->ind_2, (beams_now+i_beams_now)->ind_2) )
+         break;
+     if(i_out == n_out) continue;    /* not an output beam */
+   }
+
+   if((beams_now + i_beams_now)->k_par <= k_r)
+   {
+     faux = Amp->rel[i_beams_now + 1] * Amp->rel[i_beams_now + 1] +
+            Amp->iel[i_beams_now + 1] * Amp->iel[i_beams_now + 1];
+     if(faux > INT_TOLERANCE) int_buf[i_out] = faux;
+   }
+ } /* for i_beams_now */
+
+ return(n_out);
+}  /* end of function leed_output_int_buf */
 
+/************************************************************************/
+
+int leed_output_int_list(real *int_buf, int n_out, leed_var_t *par, 
+                         FILE * outfile)
+
+/************************************************************************
+
+ Write one line of beam intensities (energy and n_out intensities) to
+ the output file.
+ 
+ INPUT:
+
+  real *int_buf - intensities of the output beams (see 
+           leed_output_int_buf).
+  int n_out - number of output beams.
+  leed_var_t *par - parameters (current vacuum energy eng_v).
+  FILE * outfile - pointer to the output file.
+
+ RETURN VALUES:
+
+  number of intensities written to outfile.
+
+*************************************************************************/
+{
+int i_out;
+
+ fprintf(outfile,"%.2f ", par->eng_v*HART);
+ for(i_out = 0; i_out < n_out; i_out ++)
+   fprintf(outfile,"%.6e ", int_buf[i_out]);
  fprintf(outfile,"\n");
 
  fflush(outfile);
- return(i_beams_now);
-}  /* end of function leed_output_int */
+
+ return(n_out);
+}  /* end of function leed_output_int_list */
@@ -15,6 +15,8 @@ GH/22.09.00 - output is -kappa * Tmat (according to the definitions in
 GH/23.09.00 - Convergence test is proportional to number of matrix elements
 GH/03.10.00 - bug fix in set up of T_n (T=0): use RMATEL, IMATEL
 GH/11.07.03 - bug fix in output of T_mat for T=0: multiply with (-kappa)
+AG/17.10.26 - static matrices are thread private (energies calculated
+              in parallel, leed_calc_int_list_nd).
 
 *********************************************************************/
 
@@ -37,6 +39,11 @@ static int last_l = -1;
 static mat Mx = NULL,   My = NULL,   Mz = NULL;
 static mat MxMx = NULL, MyMy = NULL, MzMz = NULL;
 
+#ifdef _USE_OPENMP
+#pragma omp threadprivate(n_call, last_l)
+#pragma omp threadprivate(Mx, My, Mz, MxMx, MyMy, MzMz)
+#endif
+
 mat leed_par_cumulative_tl(mat Tmat, mat tl_0, real ux, real uy, real uz, 
              real energy, int l_max_t, int l_max_0)
 
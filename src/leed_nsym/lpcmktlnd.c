@@ -11,6 +11,7 @@ GH/20.08.94 - Creation
 GH/18.07.95 - temperature dependent phase shifts.
 GH/03.05.00 - read non-diagonal t-matrix
 GH/16.09.00 - calculate non-diagonal t-matrix.
+AG/17.10.26 - average t-matrix of mixtures (n_mix > 0).
 
 *********************************************************************/
 
@@ -49,6 +50,12 @@ mat * leed_par_mktl_nd(mat *p_tl, leed_phs_t *phs_shifts, int l_max, real energy
 
  DESIGN:
 
+ For a mixture of phase shift sets (phs_shifts->n_mix > 0, see 
+ leed_inp_phase_mix_nd) the t-matrix is the concentration weighted 
+ average of the t-matrices of the components (average t-matrix 
+ approximation, ATA). The components precede the mixture in the list,
+ i.e. their t-matrices have already been calculated.
+
  FUNCTION CALLS:
 
   - leed_par_temp_tl
@@ -60,11 +67,13 @@ mat * leed_par_mktl_nd(mat *p_tl, leed_phs_t *phs_shifts, int l_max, real energy
 int l, l_set_1;
 int i_set, n_set;
 int i_eng, iaux;
+int i_mix, n_el;
 
 real delta;
 real faux_r, faux_i;
 
 leed_phs_t *ptr;
+mat tl_c;
 
 /*********************************************************
    Search through list "phs_shifts". 
@@ -120,6 +129,39 @@ leed_phs_t *ptr;
 #endif
    } /* neither T_DIAG nor T_NOND */
 
+  /*********************************************************
+    Mixture: average of the t-matrices of the components
+  *********************************************************/
+
+   if(ptr->n_mix > 0)
+   {
+     for(i_mix = 0; i_mix < ptr->n_mix; i_mix ++)
+     {
+       tl_c = p_tl[ptr->mix_type[i_mix]];
+       if(i_mix == 0)
+         p_tl[i_set] = matalloc(p_tl[i_set], tl_c->rows, tl_c->cols, 
+                                NUM_COMPLEX);
+       else if( (tl_c->rows != p_tl[i_set]->rows) ||
+                (tl_c->cols != p_tl[i_set]->cols) )
+       {
+#ifdef ERROR
+         fprintf(STDERR, "*** error (leed_par_mktl_nd): "
+                 "t-matrices of the components of set No. %d do not match\n",
+                 i_set);
+#endif
+         exit(1);
+       }
+
+       n_el = tl_c->rows * tl_c->cols;
+       for(iaux = 1; iaux <= n_el; iaux ++)
+       {
+         p_tl[i_set]->rel[iaux] += ptr->mix_wgt[i_mix] * tl_c->rel[iaux];
+         p_tl[i_set]->iel[iaux] += ptr->mix_wgt[i_mix] * tl_c->iel[iaux];
+       }
+     }
+     continue;
+   } /* mixture */
+
 #ifdef CONTROL_X
    fprintf(STDCTR,
            "(leed_par_mktl_nd):i_set = %d, lmax(set) = %d, neng = %d, t_type = %d\n", 
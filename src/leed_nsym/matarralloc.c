@@ -7,6 +7,7 @@
   Changes:
   
   GH/20.01.95 - Create (copy from matalloc)
+  AG/17.10.26 - Free a non-matching array through matarrfree.
 
 *********************************************************************/
 
@@ -74,12 +75,7 @@ int mat_ch, i_mat;
    else
    {
 /* free attached memory (including terminator), if M is not matching */
-     for(i_mat = 0; 
-         ( (M+i_mat)->mag_no == MATRIX) && 
-         ( (M+i_mat)->blk_type == BLK_ARRAY);
-         i_mat ++)
-       matfree(M+i_mat);
-     matfree(M+i_mat);
+     matarrfree(M);
    }
  }   /* else if mat_ch > 0 */
 
@@ -7,6 +7,8 @@
   Changes:
   
   GH/20.01.95 - Create
+  AG/17.10.26 - Do not call matfree for the array elements (they are not
+                allocated individually).
 
 *********************************************************************/
 
@@ -54,7 +56,11 @@ int i_mat;
  for(i_mat = 0; 
      ( (M+i_mat)->mag_no == MATRIX) && ( (M+i_mat)->blk_type == BLK_ARRAY);
      i_mat ++)
-   matfree(M+i_mat);
+ {
+/* the array elements share one allocation: free only their elements */
+   if ((M+i_mat)->rel != NULL) free((M+i_mat)->rel);
+   if ((M+i_mat)->iel != NULL) free((M+i_mat)->iel);
+ }
 
  free(M);
  return(1);
@@ -0,0 +1,127 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  matbddim
+     Check a block-diagonal matrix and return its dimension.
+  matbdexp
+     Expand a block-diagonal matrix into a full matrix.
+
+  Block-diagonal matrices are matrix arrays (see matarralloc) which
+  contain the square diagonal blocks in the order of their position
+  along the diagonal. A block of dimension 0 (rows = cols = 0) has no
+  elements (rel = iel = NULL).
+
+Changes:
+  AG/17.10.26 - Creation
+  AG/17.10.26 - accept empty (0 x 0) blocks.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mat.h"
+
+/*======================================================================*/
+/*======================================================================*/
+
+int matbddim(mat Mbd)
+
+/*********************************************************************
+  Check a block-diagonal matrix and return its dimension.
+
+  parameters:
+  Mbd - block-diagonal matrix (matrix array of diagonal blocks).
+
+  DESIGN:
+  All blocks must be square and of the same number type.
+
+  return value:
+    number of rows (= number of columns) of the block-diagonal matrix.
+    -1 if Mbd is not a valid block-diagonal matrix.
+
+*********************************************************************/
+{
+int i_blk;
+int n_dim;
+
+ if ( (matcheck(Mbd) < 1) ||
+      ((Mbd->blk_type != BLK_ARRAY) && (Mbd->blk_type != BLK_END)) )
+ {
+#ifdef ERROR
+   fprintf(STDERR,
+     " *** error (matbddim): input is not a matrix array\n");
+#endif
+   return(-1);
+ }
+
+ for(i_blk = 0, n_dim = 0;
+     ( (Mbd+i_blk)->mag_no == MATRIX) &&
+     ( (Mbd+i_blk)->blk_type == BLK_ARRAY);
+     i_blk ++)
+ {
+   if( (((Mbd+i_blk)->rel == NULL) && ((Mbd+i_blk)->rows > 0)) ||
+       ((Mbd+i_blk)->rows != (Mbd+i_blk)->cols)       ||
+       ((Mbd+i_blk)->num_type != Mbd->num_type) )
+   {
+#ifdef ERROR
+     fprintf(STDERR,
+       " *** error (matbddim): block %d is missing or not square\n", i_blk);
+#endif
+     return(-1);
+   }
+   n_dim += (Mbd+i_blk)->rows;
+ }
+
+ return(n_dim);
+}  /* end of function matbddim */
+
+/*======================================================================*/
+/*======================================================================*/
+
+mat matbdexp(mat M, mat Mbd)
+
+/*********************************************************************
+  Expand a block-diagonal matrix into a full matrix.
+
+  parameters:
+  M   - (output) pointer to the full matrix. If NULL, the pointer will
+        be created and returned.
+  Mbd - block-diagonal matrix (matrix array of diagonal blocks).
+
+  DESIGN:
+  All elements outside the diagonal blocks are zero.
+
+  return value: M (NULL if failed)
+
+*********************************************************************/
+{
+int i_blk, n_dim;
+int off;
+
+ n_dim = matbddim(Mbd);
+ if (n_dim < 1)
+ {
+#ifdef ERROR
+   fprintf(STDERR," *** error (matbdexp): invalid input matrix\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(NULL);
+#endif
+ }
+
+ M = matalloc(M, n_dim, n_dim, Mbd->num_type);
+
+ for(i_blk = 0, off = 1;
+     (Mbd+i_blk)->blk_type == BLK_ARRAY; off += (Mbd+i_blk)->rows, i_blk ++)
+ {
+   if((Mbd+i_blk)->rows > 0) matins(M, Mbd+i_blk, off, off);
+ }
+
+ return(M);
+}  /* end of function matbdexp */
+
+/*======================================================================*/
+/*======================================================================*/
@@ -0,0 +1,229 @@
+/*********************************************************************
+  AG/17.10.26
+  file contains functions:
+
+  matbdmul
+     Multiply a block-diagonal matrix with a full matrix: Mr = Mbd * M
+  matmulbd
+     Multiply a full matrix with a block-diagonal matrix: Mr = M * Mbd
+
+  Block-diagonal matrices are matrix arrays (see matarralloc) which
+  contain the square diagonal blocks in the order of their position
+  along the diagonal (see matbddim).
+
+Changes:
+  AG/17.10.26 - Creation
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mat.h"
+
+/*======================================================================*/
+/*======================================================================*/
+
+mat matbdmul( mat Mr, mat Mbd, mat M )
+
+/*********************************************************************
+  Multiply a block-diagonal matrix with a full matrix: Mr = Mbd * M
+
+  parameters:
+  Mr  - pointer to the matrix containing the result of the multiplication.
+        If NULL, the pointer will be created and returned. Mr can be
+        equal to M.
+
+  Mbd - block-diagonal matrix (matrix array of diagonal blocks).
+  M   - full matrix.
+
+  DESIGN:
+  Only the non-zero blocks of Mbd enter the multiplication, i.e.
+  the rows off+1 ... off+n of the result depend only on the diagonal
+  block (off+1 ... off+n) of Mbd and the same rows of M. The order of
+  summation is the same as in matmul. Only complex matrices are
+  implemented.
+
+  return value: Mr (NULL if failed)
+
+*********************************************************************/
+{
+int i_blk, n_dim;
+int off, n_blk;
+int i_r, i_c, i_k;
+
+real rsum, isum;
+real *ptrr1, *ptri1, *ptrr2, *ptri2;
+
+mat Mb, Maux;
+
+/*********************************************************************
+  check input matrices
+*********************************************************************/
+
+ n_dim = matbddim(Mbd);
+ if ((n_dim < 1) || (matcheck(M) < 1))
+ {
+#ifdef ERROR
+  fprintf(STDERR,"*** error (matbdmul): invalid input matrices\n");
+#endif
+#ifdef EXIT_ON_ERROR
+  exit(1);
+#else
+  return(NULL);
+#endif
+ }
+
+ if ((n_dim != M->rows) ||
+     (M->num_type != NUM_COMPLEX) || (Mbd->num_type != NUM_COMPLEX))
+ {
+#ifdef ERROR
+  fprintf(STDERR,
+  "*** error (matbdmul): dimensions/types of input matrices do not match\n");
+#endif
+#ifdef EXIT_ON_ERROR
+  exit(1);
+#else
+  return(NULL);
+#endif
+ }
+
+/*********************************************************************
+  Multiply block by block
+*********************************************************************/
+
+ Maux = matalloc(NULL, M->rows, M->cols, NUM_COMPLEX);
+
+ for(i_blk = 0, off = 0;
+     (Mbd+i_blk)->blk_type == BLK_ARRAY; off += n_blk, i_blk ++)
+ {
+   Mb = Mbd + i_blk;
+   n_blk = Mb->rows;
+
+   for(i_r = 1; i_r <= n_blk; i_r ++)
+   for(i_c = 1; i_c <= M->cols; i_c ++)
+   {
+     rsum = isum = 0.;
+     for(i_k = 1, ptrr1 = Mb->rel + (i_r-1)*n_blk + 1,
+                  ptri1 = Mb->iel + (i_r-1)*n_blk + 1,
+                  ptrr2 = M->rel + off*M->cols + i_c,
+                  ptri2 = M->iel + off*M->cols + i_c;
+         i_k <= n_blk;
+         i_k ++, ptrr1 ++, ptri1 ++, ptrr2 += M->cols, ptri2 += M->cols)
+     {
+       rsum += (*ptrr1 * *ptrr2) - (*ptri1 * *ptri2);
+       isum += (*ptrr1 * *ptri2) + (*ptri1 * *ptrr2);
+     }
+     RMATEL(off + i_r, i_c, Maux) = rsum;
+     IMATEL(off + i_r, i_c, Maux) = isum;
+   }
+ }  /* for i_blk */
+
+ Mr = matcop(Mr, Maux);
+ matfree(Maux);
+ return(Mr);
+}  /* end of function matbdmul */
+
+/*======================================================================*/
+/*======================================================================*/
+
+mat matmulbd( mat Mr, mat M, mat Mbd )
+
+/*********************************************************************
+  Multiply a full matrix with a block-diagonal matrix: Mr = M * Mbd
+
+  parameters:
+  Mr  - pointer to the matrix containing the result of the multiplication.
+        If NULL, the pointer will be created and returned. Mr can be
+        equal to M.
+
+  M   - full matrix.
+  Mbd - block-diagonal matrix (matrix array of diagonal blocks).
+
+  DESIGN:
+  The columns off+1 ... off+n of the result depend only on the diagonal
+  block (off+1 ... off+n) of Mbd and the same columns of M. The order of
+  summation is the same as in matmul. Only complex matrices are
+  implemented.
+
+  return value: Mr (NULL if failed)
+
+*********************************************************************/
+{
+int i_blk, n_dim;
+int off, n_blk;
+int i_r, i_c, i_k;
+
+real rsum, isum;
+real *ptrr1, *ptri1, *ptrr2, *ptri2;
+
+mat Mb, Maux;
+
+/*********************************************************************
+  check input matrices
+*********************************************************************/
+
+ n_dim = matbddim(Mbd);
+ if ((n_dim < 1) || (matcheck(M) < 1))
+ {
+#ifdef ERROR
+  fprintf(STDERR,"*** error (matmulbd): invalid input matrices\n");
+#endif
+#ifdef EXIT_ON_ERROR
+  exit(1);
+#else
+  return(NULL);
+#endif
+ }
+
+ if ((n_dim != M->cols) ||
+     (M->num_type != NUM_COMPLEX) || (Mbd->num_type != NUM_COMPLEX))
+ {
+#ifdef ERROR
+  fprintf(STDERR,
+  "*** error (matmulbd): dimensions/types of input matrices do not match\n");
+#endif
+#ifdef EXIT_ON_ERROR
+  exit(1);
+#else
+  return(NULL);
+#endif
+ }
+
+/*********************************************************************
+  Multiply block by block
+*********************************************************************/
+
+ Maux = matalloc(NULL, M->rows, M->cols, NUM_COMPLEX);
+
+ for(i_blk = 0, off = 0;
+     (Mbd+i_blk)->blk_type == BLK_ARRAY; off += n_blk, i_blk ++)
+ {
+   Mb = Mbd + i_blk;
+   n_blk = Mb->rows;
+
+   for(i_r = 1; i_r <= M->rows; i_r ++)
+   for(i_c = 1; i_c <= n_blk; i_c ++)
+   {
+     rsum = isum = 0.;
+     for(i_k = 1, ptrr1 = M->rel + (i_r-1)*M->cols + off + 1,
+                  ptri1 = M->iel + (i_r-1)*M->cols + off + 1,
+                  ptrr2 = Mb->rel + i_c,
+                  ptri2 = Mb->iel + i_c;
+         i_k <= n_blk;
+         i_k ++, ptrr1 ++, ptri1 ++, ptrr2 += n_blk, ptri2 += n_blk)
+     {
+       rsum += (*ptrr1 * *ptrr2) - (*ptri1 * *ptri2);
+       isum += (*ptrr1 * *ptri2) + (*ptri1 * *ptrr2);
+     }
+     RMATEL(i_r, off + i_c, Maux) = rsum;
+     IMATEL(i_r, off + i_c, Maux) = isum;
+   }
+ }  /* for i_blk */
+
+ Mr = matcop(Mr, Maux);
+ matfree(Maux);
+ return(Mr);
+}  /* end of function matmulbd */
+
+/*======================================================================*/
+/*======================================================================*/
@@ -4,7 +4,9 @@ GH/22.09.00
 
   c_ludcmp
   c_luinv
+  c_luinv_ip
   c_lubksb
+  c_lusolve
 
   (modified program from numerical recipes(NR))
 
@@ -12,6 +14,8 @@ Changes:
 GH/20.07.97 - include output (inv_r/i) in the parameter list in order
             to avoid unfreed memory allocation.
 GH/22.09.00 - include malloc.h at the top of file
+AG/17.10.26 - add c_luinv_ip (inversion in place of the LU decomposition).
+AG/17.10.26 - add c_lusolve (several right hand sides stored as matrix).
 
 *********************************************************************/
 
@@ -320,6 +324,132 @@ real *ptri1, *ptri2;            /* pointers used in innermost loops */
 
 /********************************************************************/
 
+int c_luinv_ip(real * lu_r, real * lu_i, int * indx, int n)
+
+/*
+ Invert a complex matrix A in place from its LU decomposition.
+
+ parameters:
+
+  real * lu_r, * lu_i - (input/output) LU decomposition of A as returned 
+       by c_ludcmp; the inverse of A on output.
+  indx - input: int vector which records the row permutation (as returned 
+       by ludcmp)
+  n  - input: dimension of matrix
+
+  return value:
+       1 if o.k.
+       0 if failed (allocation of the work vector).
+
+ Unlike c_luinv, no second n x n array is needed: with P A = L U,
+ first U is replaced by U^-1, then X = U^-1 L^-1 is obtained column by
+ column from right to left (X L = U^-1), and finally the columns of X 
+ are interchanged in reverse order of the row interchanges (A^-1 = X P).
+ Only a work vector of length n is used.
+*/
+
+{
+int i_c, i_r, i_k;
+
+real sumr, sumi, dum;
+real *wr, *wi;                  /* work vector (column of L) */
+
+real *ptrr1, *ptrr2, *ptr_end;  /* pointers used in innermost loops */
+real *ptri1, *ptri2;            /* pointers used in innermost loops */
+
+ wr = (real *)malloc( 2 * (n+1) * sizeof(real) );
+ if(wr == NULL) return(0);
+ wi = wr + n + 1;
+
+/*
+  U -> U^-1 (column by column, from left to right):
+  u'(i_c,i_c) = 1/u(i_c,i_c)
+  u'(i_r,i_c) = - sum_k u'(i_r,i_k) u(i_k,i_c) * u'(i_c,i_c) (i_r <= i_k < i_c)
+  Rows are processed from top to bottom, so that u(i_k,i_c) (i_k > i_r)
+  has not been overwritten yet.
+*/
+ for (i_c = 1; i_c <= n; i_c ++)
+ {
+   dum = CAB2RI(*(lu_r + (i_c - 1)*n + i_c), *(lu_i + (i_c - 1)*n + i_c));
+   *(lu_r + (i_c - 1)*n + i_c) =   *(lu_r + (i_c - 1)*n + i_c) / dum;
+   *(lu_i + (i_c - 1)*n + i_c) = - *(lu_i + (i_c - 1)*n + i_c) / dum;
+
+   for (i_r = 1; i_r < i_c; i_r ++)
+   {
+     sumr = sumi = 0.;
+     for (ptrr1 = lu_r + (i_r - 1)*n + i_r, ptri1 = lu_i + (i_r - 1)*n + i_r,
+          ptrr2 = lu_r + (i_r - 1)*n + i_c, ptri2 = lu_i + (i_r - 1)*n + i_c,
+          ptr_end = lu_r + (i_r - 1)*n + i_c;
+          ptrr1 < ptr_end; ptrr1 ++, ptrr2 += n, ptri1 ++, ptri2 += n)
+     {
+       sumr += (*ptrr1 * *ptrr2) - (*ptri1 * *ptri2);
+       sumi += (*ptrr1 * *ptri2) + (*ptri1 * *ptrr2);
+     }
+
+     /* multiply by - u'(i_c,i_c) */
+     dum = *(lu_r + (i_c - 1)*n + i_c);
+     *(lu_r + (i_r - 1)*n + i_c) = 
+       - (sumr * dum - sumi * *(lu_i + (i_c - 1)*n + i_c));
+     *(lu_i + (i_r - 1)*n + i_c) = 
+       - (sumr * *(lu_i + (i_c - 1)*n + i_c) + sumi * dum);
+   }
+ }
+
+/*
+  Solve X L = U^-1 for X (L has unit diagonal), columns from right to
+  left: x(:,i_c) = u'(:,i_c) - sum_k x(:,i_k) l(i_k,i_c) (i_k > i_c)
+*/
+ for (i_c = n - 1; i_c >= 1; i_c --)
+ {
+   for (i_k = i_c + 1; i_k <= n; i_k ++)
+   {
+     wr[i_k] = *(lu_r + (i_k - 1)*n + i_c);
+     wi[i_k] = *(lu_i + (i_k - 1)*n + i_c);
+     *(lu_r + (i_k - 1)*n + i_c) = *(lu_i + (i_k - 1)*n + i_c) = 0.;
+   }
+
+   for (i_r = 1; i_r <= n; i_r ++)
+   {
+     sumr = *(lu_r + (i_r - 1)*n + i_c);
+     sumi = *(lu_i + (i_r - 1)*n + i_c);
+     for (i_k = i_c + 1, ptrr1 = lu_r + (i_r - 1)*n + i_c + 1, 
+                         ptri1 = lu_i + (i_r - 1)*n + i_c + 1;
+          i_k <= n; i_k ++, ptrr1 ++, ptri1 ++)
+     {
+       sumr -= (*ptrr1 * wr[i_k]) - (*ptri1 * wi[i_k]);
+       sumi -= (*ptrr1 * wi[i_k]) + (*ptri1 * wr[i_k]);
+     }
+     *(lu_r + (i_r - 1)*n + i_c) = sumr;
+     *(lu_i + (i_r - 1)*n + i_c) = sumi;
+   }
+ }
+
+/*
+  A^-1 = X P: interchange columns in reverse order of the row 
+  interchanges in c_ludcmp.
+*/
+ for (i_c = n - 1; i_c >= 1; i_c --)
+ {
+   i_k = indx[i_c];
+   if (i_k != i_c)
+   {
+     for (ptrr1 = lu_r + i_c, ptri1 = lu_i + i_c, 
+          ptrr2 = lu_r + i_k, ptri2 = lu_i + i_k,
+          ptr_end = lu_r + n*n;
+          ptrr1 <= ptr_end; ptrr1 += n, ptri1 += n, ptrr2 += n, ptri2 += n)
+     {
+       dum = *ptrr1; *ptrr1 = *ptrr2; *ptrr2 = dum;
+       dum = *ptri1; *ptri1 = *ptri2; *ptri2 = dum;
+     }
+   }
+ }
+
+ free(wr);
+ return(1);
+}    /* end of function c_luinv_ip */
+
+/********************************************************************/
+
 int c_lubksb (real * lur, real * lui, int * indx, 
               real * br,  real * bi, 
               int n)
@@ -431,3 +561,93 @@ return(1);
 /* end of function c_lubksb */
 
 /********************************************************************/
+
+/********************************************************************/
+
+int c_lusolve (real * lur, real * lui, int * indx,
+               real * br,  real * bi,
+               int n, int n_rhs)
+
+/*
+ Solve the set of n linear equations A*X = B for a complex matrix A and
+ n_rhs right hand sides (the columns of B).
+
+ parameters:
+
+  lur, lui - input: LU decomposition of A as returned by c_ludcmp.
+  indx - input: int vector which records the row permutation (as returned
+       by c_ludcmp)
+  br, bi - input/output: n x n_rhs matrix B (stored like the matrix
+       elements of mat: element (i,j) is br[(i-1)*n_rhs + j]); replaced
+       by the solution X.
+  n  - input: dimension of A
+  n_rhs - input: number of right hand sides (columns of B)
+
+  return value:
+       1
+
+ Unlike c_lubksb, B does not need to be a column of an n x n matrix.
+ For a small number of right hand sides this is much cheaper than the
+ inversion of A (forward and back substitution are O(n^2) per column).
+*/
+
+{
+int i_r, i_k, i_c;
+
+real sumr, sumi, dum;
+real *ptrr1, *ptrr2, *ptr_end;  /* pointers used in innermost loops */
+real *ptri1, *ptri2;            /* pointers used in innermost loops */
+
+ for (i_c = 1; i_c <= n_rhs; i_c ++)
+ {
+   /* forward substitution (L has unit diagonal), unscramble permutation */
+   for (i_r = 1; i_r <= n; i_r ++)
+   {
+     i_k = indx[i_r];
+     sumr = *(br + (i_k - 1)*n_rhs + i_c);
+     sumi = *(bi + (i_k - 1)*n_rhs + i_c);
+     *(br + (i_k - 1)*n_rhs + i_c) = *(br + (i_r - 1)*n_rhs + i_c);
+     *(bi + (i_k - 1)*n_rhs + i_c) = *(bi + (i_r - 1)*n_rhs + i_c);
+
+     for (ptrr1 = lur + (i_r - 1)*n + 1, ptri1 = lui + (i_r - 1)*n + 1,
+          ptrr2 = br + i_c, ptri2 = bi + i_c,
+          ptr_end = lur + (i_r - 1)*n + i_r;
+          ptrr1 < ptr_end; 
+          ptrr1 ++, ptri1 ++, ptrr2 += n_rhs, ptri2 += n_rhs)
+     {
+       sumr -= (*ptrr1 * *ptrr2) - (*ptri1 * *ptri2);
+       sumi -= (*ptrr1 * *ptri2) + (*ptri1 * *ptrr2);
+     }
+
+     *(br + (i_r - 1)*n_rhs + i_c) = sumr;
+     *(bi + (i_r - 1)*n_rhs + i_c) = sumi;
+   }
+
+   /* back substitution */
+   for (i_r = n; i_r >= 1; i_r --)
+   {
+     sumr = *(br + (i_r - 1)*n_rhs + i_c);
+     sumi = *(bi + (i_r - 1)*n_rhs + i_c);
+
+     for (ptrr1 = lur + (i_r - 1)*n + i_r + 1,
+          ptri1 = lui + (i_r - 1)*n + i_r + 1,
+          ptrr2 = br + i_r*n_rhs + i_c, ptri2 = bi + i_r*n_rhs + i_c,
+          ptr_end = lur + (i_r - 1)*n + n;
+          ptrr1 <= ptr_end; 
+          ptrr1 ++, ptri1 ++, ptrr2 += n_rhs, ptri2 += n_rhs)
+     {
+       sumr -= (*ptrr1 * *ptrr2) - (*ptri1 * *ptri2);
+       sumi -= (*ptrr1 * *ptri2) + (*ptri1 * *ptrr2);
+     }
+
+     dum = CAB2RI(*(lur + (i_r - 1)*n + i_r), *(lui + (i_r - 1)*n + i_r));
+     *(br + (i_r - 1)*n_rhs + i_c) =
+      (sumr* *(lur + (i_r-1)*n + i_r) + sumi* *(lui + (i_r-1)*n + i_r))/dum;
+     *(bi + (i_r - 1)*n_rhs + i_c) =
+      (sumi* *(lur + (i_r-1)*n + i_r) - sumr* *(lui + (i_r-1)*n + i_r))/dum;
+   }
+ }  /* for i_c */
+
+ return(1);
+}
+/* end of function c_lusolve */
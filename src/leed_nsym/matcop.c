@@ -6,6 +6,7 @@
   Changes:
   
   GH/16.08.94 - Check if M1 = M2;
+  AG/17.10.26 - Set blk_type = BLK_SINGLE for a new matrix header.
 
 *********************************************************************/
 
@@ -70,6 +71,7 @@ long int size;
   fprintf(STDCTR," (matcop) M1 = NULL \n");
 #endif
   M1 = ( mat )malloc( sizeof( struct mat_str ));
+  M1->blk_type = BLK_SINGLE;
   M1->rel = NULL;
   M1->iel = NULL;
  }
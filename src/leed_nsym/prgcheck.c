@@ -10,6 +10,7 @@ Changes:
 GH/24.07.95 - Creation
 GH/02.09.97 - Add hostname
 LD/04.06.13 - Add windows headers
+AG/17.10.26 - critical section if called from parallel regions.
 
 *********************************************************************/
 
@@ -61,33 +62,39 @@ RETURN VALUE:
 
 *************************************************************************/
 {
-double new_secs;
+double new_secs, diff_secs;
 static double old_secs = 0.;
 static struct rusage *r_usage = NULL;  /* stucture defined in sys/resource.h 
                                           and sys/time.h (timeval) */
 static char *hostname;
 
- if (r_usage == NULL) 
- {
-   r_usage = (struct rusage *) malloc (sizeof(struct rusage));
-   hostname = (char *) malloc (STRSZ * sizeof(char));
-   gethostname(hostname, STRSZ);
- }
-
- getrusage ( RUSAGE_SELF, r_usage );
-
- new_secs = (double)r_usage->ru_utime.tv_sec + 
-        (double)r_usage->ru_utime.tv_usec * 1.e-6;
-
- if(outp != NULL)
+#ifdef _USE_OPENMP
+#pragma omp critical (leed_cpu_time)
+#endif
  {
-   fprintf(outp,"%s\t", message);
-   fprintf(outp,
-     "(leed_cpu_time) total time on %s: %10.6f s, diff: %10.6f s\n", 
-                hostname, new_secs, new_secs-old_secs);
+   if (r_usage == NULL) 
+   {
+     r_usage = (struct rusage *) malloc (sizeof(struct rusage));
+     hostname = (char *) malloc (STRSZ * sizeof(char));
+     gethostname(hostname, STRSZ);
+   }
+
+   getrusage ( RUSAGE_SELF, r_usage );
+
+   new_secs = (double)r_usage->ru_utime.tv_sec + 
+          (double)r_usage->ru_utime.tv_usec * 1.e-6;
+
+   if(outp != NULL)
+   {
+     fprintf(outp,"%s\t", message);
+     fprintf(outp,
+       "(leed_cpu_time) total time on %s: %10.6f s, diff: %10.6f s\n", 
+                  hostname, new_secs, new_secs-old_secs);
+   }
+   diff_secs = new_secs - old_secs;
+   old_secs = new_secs;
  }
- old_secs = new_secs;
- return(new_secs - old_secs);
+ return(diff_secs);
 }  /* end of function leed_cpu_time */
 
 /*************************************************************************/
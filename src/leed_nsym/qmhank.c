@@ -14,6 +14,10 @@
 
   (Tested for PI/2, PI, i and -i.)
 
+Changes:
+AG/17.10.26 - c_hank1: recurrence with fixed l_max for the common values
+              (qm_lfix.h), complex products written out.
+
 *********************************************************************/
 
 #include <math.h>
@@ -23,6 +27,7 @@
 
 #include "mat.h"
 #include "qm.h"
+#include "qm_lfix.h"
 
 /*======================================================================*/
 /*======================================================================*/
@@ -145,6 +150,43 @@ real *ptr_r, *ptr_i;
 /*======================================================================*/
 /*======================================================================*/
 
+QM_L_CORE void c_hank1_rec(real *h_r, real *h_i, 
+                           real z_inv_r, real z_inv_i, int l_max)
+
+/************************************************************************
+ Recurrence of c_hank1 for l = 2 ... l_max (H0 and H1 in h_r/i[0,1]):
+
+  Hl (z) = (2*l-1)/z Hl-1(z) - Hl-2(z)
+
+ The function is inlined into the copies for fixed l_max (C_HANK1_FIX).
+*************************************************************************/
+{
+int l;
+real faux_r, faux_i;
+
+ for(l = 2; l <= l_max; l++ )
+ {
+   faux_r = (2*l - 1) * z_inv_r;
+   faux_i = (2*l - 1) * z_inv_i;
+
+   h_r[l] = faux_r * h_r[l-1] - faux_i * h_i[l-1] - h_r[l-2];
+   h_i[l] = faux_r * h_i[l-1] + faux_i * h_r[l-1] - h_i[l-2];
+ }   /* l */
+} /* end of function c_hank1_rec */
+
+#define C_HANK1_FIX(L)                                                  \
+static void c_hank1_##L(real *h_r, real *h_i, real z_inv_r, real z_inv_i) \
+{ c_hank1_rec(h_r, h_i, z_inv_r, z_inv_i, L); }
+
+QM_L_FIX_ALL(C_HANK1_FIX)
+
+#define C_HANK1_PTR(L) c_hank1_##L,
+static void (* const c_hank1_fix[])(real *, real *, real, real) =
+  { QM_L_FIX_ALL(C_HANK1_PTR) };
+
+/*======================================================================*/
+/*======================================================================*/
+
 mat c_hank1 ( mat Hl, real z_r, real z_i, int l_max )
 
 /************************************************************************
@@ -187,8 +229,6 @@ mat c_hank1 ( mat Hl, real z_r, real z_i, int l_max )
 
 *************************************************************************/
 {
-int l;                        /* quantum number l */
-
 real faux_r, faux_i;
 real z_inv_r, z_inv_i;
 real *ptr_r, *ptr_i;
@@ -246,19 +286,12 @@ real *ptr_r, *ptr_i;
  
 
 /* 
- loop over l:
-
-  Hl (z) = (2*l-1)/z Hl-1(z) - Hl-2(z)
+ loop over l (copy with fixed l_max for common values)
 */
- for(l = 2; l <= l_max; l++ )
- {
-   faux_r = (2*l - 1) * z_inv_r;
-   faux_i = (2*l - 1) * z_inv_i;
-
-   cri_mul(ptr_r+l, ptr_i+l, faux_r, faux_i, ptr_r[l-1], ptr_i[l-1]);
-   ptr_r[l] -= ptr_r[l-2];
-   ptr_i[l] -= ptr_i[l-2];
- }   /* l */
+ if( QM_L_FIX(l_max) )
+   c_hank1_fix[l_max - QM_L_FIX_MIN](ptr_r, ptr_i, z_inv_r, z_inv_i);
+ else
+   c_hank1_rec(ptr_r, ptr_i, z_inv_r, z_inv_i, l_max);
 
  return(Hl);
 
@@ -22,6 +22,13 @@ GH/03.04.95 - Calculate Yl-m explicitly in c_ylm.
 GH/05.08.95 - mk_ylm_coef is a global function (not static anymore), i.e. 
               it can be called from outside this file.
 GH/10.08.95 - WARNING output at the end of mk_ylm_coef.
+AG/17.10.26 - prefactor arrays r/i_pre(c) are thread private and only 
+              reallocated if l_max has increased. The coefficients (coef) 
+              are shared: mk_ylm_coef must be called for the maximum l 
+              before entering parallel regions.
+AG/17.10.26 - r_ylm: copies of the calculation with fixed l_max for
+              l_max = QM_L_FIX_MIN ... QM_L_FIX_MAX (qm_lfix.h).
+AG/17.10.26 - r_ylm_core: parameters pre_r/i (do not shadow r/i_pre).
 
 *********************************************************************/
 
@@ -31,6 +38,7 @@ GH/10.08.95 - WARNING output at the end of mk_ylm_coef.
 
 #include "mat.h"
 #include "qm.h"
+#include "qm_lfix.h"
 
 #define MEM_BLOCK 256           /* memory block for coef */
 #define UNUSED    -1
@@ -46,6 +54,126 @@ static int l_max_coef = UNUSED;
 static int l_max_r = UNUSED;
 static int l_max_c = UNUSED;
 
+#ifdef _USE_OPENMP
+#pragma omp threadprivate(r_pre, i_pre, r_prec, i_prec, l_max_r, l_max_c)
+#endif
+
+/*======================================================================*/
+/*======================================================================*/
+
+QM_L_CORE void r_ylm_core(real *y_r, real *y_i, real *pre_r, real *pre_i,
+                          real x, real phi, int l_max)
+
+/************************************************************************
+
+ Core of r_ylm: calculate the spherical harmonics up to l = l_max into 
+ y_r/y_i (natural order, first element not occupied) using the arrays 
+ pre_r/i (l_max+1 elements) for the prefactors. 
+ 
+ The function is inlined into the copies for fixed l_max (R_YLM_FIX).
+
+*************************************************************************/
+{
+int iaux, off;
+int l, m;                      /* quantum numbers l,m */
+int lamb;                      /* power of x */
+
+int index;                     /* used to run through coef */
+
+real r_pre_l, r_pre_m;       /* prefactors */
+
+real faux;
+real x_2, sum;
+
+/*
+  Some often used values
+*/
+ x_2 = x*x;
+
+ pre_r[0] = 1.;
+ pre_i[0] = 0.;
+
+ faux = sqrt(1 - x_2);
+ pre_r[1] = faux * cos(phi);
+ pre_i[1] = faux * sin(phi);
+
+/*
+  Y_00:
+*/
+ y_r[1] = coef[0];
+ y_i[1] = 0.;
+
+/* 
+ loop over l 
+*/
+ index = 1;
+ r_pre_l = 1.;
+ for(l = 1; l <= l_max; l++ )
+ {
+ /* 
+   Determine prefactors, 
+   write next value into pre_r/i;
+   determine offset in Ylm -> off
+ */
+   r_pre_l = 1. + x - r_pre_l;
+
+   pre_r[l] = (pre_r[l-1]*pre_r[1]) - (pre_i[l-1]*pre_i[1]);
+   pre_i[l] = (pre_i[l-1]*pre_r[1]) + (pre_r[l-1]*pre_i[1]);
+
+   off = l*(l+1) + 1;
+
+ /* 
+    r_pre_m: for odd (l+m), the lowest power of x is x, for even (l+m), 
+    it is 1.
+ */
+   r_pre_m = r_pre_l;
+   for(m = 0; m <= l; m++ )
+   {
+     sum = 0.;
+     iaux = (l+m+1)/2;
+     for(lamb = l; lamb >= iaux; lamb--, index++ )
+     {
+       sum = sum * x_2 + coef[index];
+     }
+
+     y_r[off + m] = pre_r[m] * r_pre_m * sum;
+     y_i[off + m] = pre_i[m] * r_pre_m * sum;
+    
+     /* -m: (-1)^m */
+     if(ODD(m)) 
+     { 
+       y_r[off - m] = - y_r[off + m];
+       y_i[off - m] =   y_i[off + m];
+     }
+     else
+     {
+       y_r[off - m] =   y_r[off + m];
+       y_i[off - m] = - y_i[off + m];
+     }
+
+     r_pre_m = 1. + x - r_pre_m;
+
+   } /* m */
+ }   /* l */
+
+} /* end of function r_ylm_core */
+
+/*
+  Copies of r_ylm_core for fixed l_max with their own prefactor arrays.
+*/
+#define R_YLM_FIX(L)                                                    \
+static void r_ylm_##L(real *y_r, real *y_i, real x, real phi)           \
+{                                                                       \
+ real r_pre_f[L+1], i_pre_f[L+1];                                       \
+ r_ylm_core(y_r, y_i, r_pre_f, i_pre_f, x, phi, L);                     \
+}
+
+QM_L_FIX_ALL(R_YLM_FIX)
+
+#define R_YLM_PTR(L) r_ylm_##L,
+static void (* const r_ylm_fix[])(real *, real *, real, real) =
+  { QM_L_FIX_ALL(R_YLM_PTR) };
+
 /*======================================================================*/
 /*======================================================================*/
 
@@ -97,17 +225,7 @@ mat r_ylm( mat Ylm, real x, real phi, int l_max )
 
 *************************************************************************/
 {
-int iaux, off;
-int l, m;                      /* quantum numbers l,m */
-int lamb;                      /* power of x */
-
-int index;                     /* used to run through coef */
-
-real r_pre_l, r_pre_m;       /* prefactors */
-
-real faux;
-real x_2, sum;
-
+int iaux;
 
 /*
   Allocate memory for Ylm
@@ -116,8 +234,8 @@ real x_2, sum;
  Ylm = matalloc( Ylm, 1, iaux, NUM_COMPLEX );
 
 /*
-  Calculate coefficients and allocate memory for prefactors r/i_pre 
-  if not done yet or if l_max has changed since last time.
+  Calculate coefficients if not done yet or if l_max has changed since 
+  last time.
 */
  if ( l_max > l_max_coef ) 
  {
@@ -131,85 +249,31 @@ real x_2, sum;
    mk_ylm_coef(l_max);
  }
 
- if ( l_max > l_max_r )
- {
-   if (r_pre == NULL) r_pre = (real *) calloc( (l_max+1) , sizeof(real) );
-   else       r_pre = (real *) realloc( r_pre, (l_max+1) * sizeof(real) );
-
-   if (i_pre == NULL) i_pre = (real *) calloc( (l_max+1) , sizeof(real) );
-   else       i_pre = (real *) realloc( i_pre, (l_max+1) * sizeof(real) );
- }
-
 /*
-  Some often used values
+  Common values of l_max: copy with fixed loop boundaries.
 */
- x_2 = x*x;
-
- r_pre[0] = 1.;
- i_pre[0] = 0.;
-
- faux = sqrt(1 - x_2);
- r_pre[1] = faux * cos(phi);
- i_pre[1] = faux * sin(phi);
+ if ( QM_L_FIX(l_max) )
+ {
+   r_ylm_fix[l_max - QM_L_FIX_MIN](Ylm->rel, Ylm->iel, x, phi);
+   return(Ylm);
+ }
 
 /*
-  Y_00:
-*/
- Ylm->rel[1] = coef[0];
- Ylm->iel[1] = 0.;
-
-/* 
- loop over l 
+  Allocate memory for prefactors r/i_pre if not done yet or if l_max
+  has increased since last time.
 */
- index = 1;
- r_pre_l = 1.;
- for(l = 1; l <= l_max; l++ )
+ if ( l_max > l_max_r )
  {
- /* 
-   Determine prefactors, 
-   write next value into r/i_pre;
-   determine offset in Ylm -> off
- */
-   r_pre_l = 1. + x - r_pre_l;
-
-   r_pre[l] = (r_pre[l-1]*r_pre[1]) - (i_pre[l-1]*i_pre[1]);
-   i_pre[l] = (i_pre[l-1]*r_pre[1]) + (r_pre[l-1]*i_pre[1]);
-
-   off = l*(l+1) + 1;
-
- /* 
-    r_pre_m: for odd (l+m), the lowest power of x is x, for even (l+m), 
-    it is 1.
- */
-   r_pre_m = r_pre_l;
-   for(m = 0; m <= l; m++ )
-   {
-     sum = 0.;
-     iaux = (l+m+1)/2;
-     for(lamb = l; lamb >= iaux; lamb--, index++ )
-     {
-       sum = sum * x_2 + coef[index];
-     }
+   if (r_pre == NULL) r_pre = (real *) calloc( (l_max+1) , sizeof(real) );
+   else       r_pre = (real *) realloc( r_pre, (l_max+1) * sizeof(real) );
 
-     Ylm->rel[off + m] = r_pre[m] * r_pre_m * sum;
-     Ylm->iel[off + m] = i_pre[m] * r_pre_m * sum;
-    
-     /* -m: (-1)^m */
-     if(ODD(m)) 
-     { 
-       Ylm->rel[off - m] = - Ylm->rel[off + m];
-       Ylm->iel[off - m] =   Ylm->iel[off + m];
-     }
-     else
-     {
-       Ylm->rel[off - m] =   Ylm->rel[off + m];
-       Ylm->iel[off - m] = - Ylm->iel[off + m];
-     }
+   if (i_pre == NULL) i_pre = (real *) calloc( (l_max+1) , sizeof(real) );
+   else       i_pre = (real *) realloc( i_pre, (l_max+1) * sizeof(real) );
 
-     r_pre_m = 1. + x - r_pre_m;
+   l_max_r = l_max;
+ }
 
-   } /* m */
- }   /* l */
+ r_ylm_core(Ylm->rel, Ylm->iel, r_pre, i_pre, x, phi, l_max);
 
  return(Ylm);
 
@@ -327,6 +391,8 @@ real sum_r, sum_i;
 
    if (i_pre == NULL) i_pre = (real *) calloc( (l_max+1) , sizeof(real) );
    else       i_pre = (real *) realloc( i_pre, (l_max+1) * sizeof(real) );
+
+   l_max_r = l_max;
  }
 
  if ( l_max > l_max_c)
@@ -336,6 +402,8 @@ real sum_r, sum_i;
 
    if (i_prec == NULL) i_prec = (real *) calloc( (l_max+1) , sizeof(real) );
    else       i_prec = (real *) realloc( i_prec, (l_max+1) * sizeof(real) );
+
+   l_max_c = l_max;
  }
 
 /*
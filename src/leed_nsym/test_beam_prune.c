@@ -0,0 +1,131 @@
+/*********************************************************************
+  AG/17.10.26
+  test_beam_prune
+
+  Test of the beam pruning (lbmprune.c) for the Ni(111)-(2x2)-O example
+  (examples/models/nio/Ni111_2x2O.bul, *.inp): in the energy range
+  E_INI - E_FIN (one validation interval) beams must be removed from
+  the selection (leed_beam_prune_update) and the intensities of all
+  output beams must agree with those calculated without pruning within
+  2*EPS relative to the maximum intensity of each beam in the range
+  (an amplitude error EPS changes an intensity by 2*EPS to first order).
+
+  Usage (CLEED_PHASE must point to the phase shift directory):
+
+    test_beam_prune <bulk file> <overlayer file>
+
+  Return value: 0 if all checks pass, 1 otherwise.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "leed.h"
+
+#define E_INI  230.     /* energy range of the test (eV) */
+#define E_FIN  258.1
+#define E_STP    4.
+
+#define EPS      0.05   /* pruning threshold (relative amplitude) */
+#define N_VAL    8      /* energies per validation interval */
+
+int main(int argc, char *argv[])
+{
+int i_eng, i_out, n_eng, n_out, n_set;
+int n_fail;
+
+real *energies, *int_ref, *int_prune;
+real diff, int_max, faux;
+
+leed_cryst_t *bulk, *over;
+leed_phs_t *phs_shifts;
+leed_var_t *v_par;
+leed_energy_t *eng;
+leed_beam_t *beams_all, *beams_out;
+leed_prune_t *prune;
+
+ if(argc < 3)
+ {
+   fprintf(STDERR, "usage: %s <bulk file> <overlayer file>\n", argv[0]);
+   return(1);
+ }
+
+ bulk = over = NULL;
+ phs_shifts = NULL;
+ v_par = NULL;
+ eng = NULL;
+ beams_all = beams_out = NULL;
+
+ leed_inp_read_bul_nd(&bulk, &phs_shifts, argv[1]);
+ leed_inp_leed_read_par(&v_par, &eng, bulk, argv[1]);
+ leed_read_overlayer_nd(&over, &phs_shifts, bulk, argv[2]);
+ eng->ini = E_INI / HART;
+ eng->fin = E_FIN / HART;
+ eng->stp = E_STP / HART;
+
+ n_set = 0;
+ leed_calc_beams_nd(&beams_all, &beams_out, &n_set, bulk, v_par, eng);
+ leed_ms_gaunt(LEED_GAUNT_II, v_par->l_max);
+ leed_ms_gaunt(LEED_GAUNT_IJ, v_par->l_max);
+ for(n_out = 0;
+     ! IS_EQUAL_REAL((beams_out + n_out)->k_par, F_END_OF_LIST); n_out ++)
+   ;
+ n_eng = leed_calc_n_eng(eng);
+ n_fail = 0;
+
+ energies = (real *)malloc(n_eng * sizeof(real));
+ int_ref = (real *)calloc(n_eng * n_out + 1, sizeof(real));
+ int_prune = (real *)calloc(n_eng * n_out + 1, sizeof(real));
+ for(i_eng = 0; i_eng < n_eng; i_eng ++)
+   energies[i_eng] = eng->ini + i_eng * eng->stp;
+
+/*********************************************************************
+  Intensities without and with pruning
+*********************************************************************/
+
+ prune = leed_beam_prune_alloc(EPS, N_VAL, eng);
+ if( (leed_calc_int_list_nd(int_ref, energies, n_eng, beams_all, n_set,
+                  beams_out, bulk, over, phs_shifts, v_par, NULL) < 0) ||
+     (leed_calc_int_list_nd(int_prune, energies, n_eng, beams_all, n_set,
+                  beams_out, bulk, over, phs_shifts, v_par, prune) < 0) )
+ {
+   fprintf(STDERR, "*** error (test_beam_prune): calculation failed\n");
+   return(1);
+ }
+
+/* the beam set of the interval must shrink */
+ printf("%d energies, %d beams pruned %s\n", n_eng, prune->n_pruned[0],
+        (prune->n_pruned[0] > 0)? "ok": "FAILED");
+ if(prune->n_pruned[0] <= 0) n_fail ++;
+
+/* the intensities of the output beams must be within 2*EPS */
+ diff = 0.;
+ for(i_out = 0; i_out < n_out; i_out ++)
+ {
+   int_max = 0.;
+   for(i_eng = 0; i_eng < n_eng; i_eng ++)
+     int_max = MAX(int_max, int_ref[i_eng*n_out + i_out]);
+   if(int_max <= 0.) continue;
+
+   for(i_eng = 0; i_eng < n_eng; i_eng ++)
+   {
+     faux = R_fabs(int_prune[i_eng*n_out + i_out] -
+                   int_ref[i_eng*n_out + i_out]) / int_max;
+     diff = MAX(diff, faux);
+   }
+ }
+ printf("%d output beams, max. rel. difference %.3e %s\n", n_out, diff,
+        (diff < 2.*EPS)? "ok": "FAILED");
+ if(diff >= 2.*EPS) n_fail ++;
+
+ leed_beam_prune_free(prune);
+ free(energies);
+ free(int_ref);
+ free(int_prune);
+ leed_inp_free_nd(over, 0);
+ leed_inp_free_nd(bulk, 1);
+
+ printf("%s\n", (n_fail)? "FAILED": "all tests passed");
+ return( (n_fail)? 1: 0);
+}
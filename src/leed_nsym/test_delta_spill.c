@@ -0,0 +1,186 @@
+/*********************************************************************
+  AG/17.10.26
+  test_delta_spill
+
+  Test of the scratch files of the delta mode (leed_calc_iv_delta_nd,
+  leed_calc_cache_alloc): for the Ni(111)-(2x2)-O example
+  (examples/models/nio/Ni111_2x2O.bul, *.inp) the memory plan
+  (leed_mem_plan_nd) must choose the scratch files for a budget below
+  the memory of the stored matrices. The intensities are then
+  calculated twice with the scratch files: the first call writes the
+  matrices (R_bulk and overlayer) of each energy to the scratch files,
+  the second call reads them back and reuses all layers. Both must
+  agree with the intensities calculated without delta mode; the
+  scratch files must be removed by leed_calc_cache_free.
+
+  Usage (CLEED_PHASE must point to the phase shift directory):
+
+    test_delta_spill <bulk file> <overlayer file> [<scratch prefix>]
+
+  Return value: 0 if the intensities agree and the scratch files are
+  written, reused and removed; 1 otherwise.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "leed.h"
+
+#define E_INI   70.     /* energy range of the test (eV) */
+#define E_FIN   78.1
+#define E_STP    4.
+
+static real max_diff(real *int_a, real *int_b, int n_buf)
+{
+int i;
+real diff, faux;
+
+ diff = 0.;
+ for(i = 0; i < n_buf; i ++)
+ {
+   faux = R_fabs(int_a[i] - int_b[i]);
+   if(int_a[i] > 0.) faux /= int_a[i];
+   diff = MAX(diff, faux);
+ }
+ return(diff);
+}
+
+static int file_exists(const char *prefix, int i_eng)
+{
+char scr_file[STRSZ];
+FILE *scr_stream;
+
+ sprintf(scr_file, "%s.%d", prefix, i_eng);
+ if( (scr_stream = fopen(scr_file, "rb")) == NULL) return(0);
+ fclose(scr_stream);
+ return(1);
+}
+
+int main(int argc, char *argv[])
+{
+int i_eng, i_call, n_buf, n_eng, n_set;
+int n_fail;
+
+real *int_ref, *int_spill;
+real diff;
+double budget;
+
+const char *scratch;
+
+leed_cryst_t *bulk, *over;
+leed_phs_t *phs_shifts;
+leed_var_t *v_par;
+leed_energy_t *eng;
+leed_beam_t *beams_all, *beams_out;
+leed_calc_cache_t *cache;
+leed_mem_t mem;
+
+ if(argc < 3)
+ {
+   fprintf(STDERR, "usage: %s <bulk file> <overlayer file> [<scratch>]\n",
+           argv[0]);
+   return(1);
+ }
+ scratch = (argc > 3)? argv[3]: "test_delta_spill.scr";
+
+ bulk = over = NULL;
+ phs_shifts = NULL;
+ v_par = NULL;
+ eng = NULL;
+ beams_all = beams_out = NULL;
+
+ leed_inp_read_bul_nd(&bulk, &phs_shifts, argv[1]);
+ leed_inp_leed_read_par(&v_par, &eng, bulk, argv[1]);
+ leed_read_overlayer_nd(&over, &phs_shifts, bulk, argv[2]);
+ eng->ini = E_INI / HART;
+ eng->fin = E_FIN / HART;
+ eng->stp = E_STP / HART;
+
+ n_set = 0;
+ n_buf = leed_calc_beams_nd(&beams_all, &beams_out, &n_set, bulk, v_par, eng);
+ leed_ms_gaunt(LEED_GAUNT_II, v_par->l_max);
+ leed_ms_gaunt(LEED_GAUNT_IJ, v_par->l_max);
+ n_eng = leed_calc_n_eng(eng);
+ n_buf *= n_eng;
+ n_fail = 0;
+
+/*********************************************************************
+  Memory plan: the stored matrices of all energies do not fit into
+  the budget, those of one energy do.
+*********************************************************************/
+
+ leed_mem_estimate_nd(&mem, beams_all, n_set, bulk, over, v_par, n_eng);
+ mem.inv_inplace = 1;                  /* not sufficient by itself */
+ leed_mem_peak_nd(&mem);
+ budget = mem.peak + 1.5 * mem.cache / n_eng;
+ mem.inv_inplace = 0;
+ leed_mem_plan_nd(&mem, budget);
+
+ printf("memory plan: budget %.2f MB, estimate %.2f MB, scratch files %d %s\n",
+        budget / 1048576., (mem.peak + mem.cache) / 1048576., mem.spill,
+        (mem.spill)? "ok": "FAILED");
+ if(! mem.spill) n_fail ++;
+
+/*********************************************************************
+  Intensities without and with scratch files
+*********************************************************************/
+
+ int_ref = (real *)calloc(n_buf + 1, sizeof(real));
+ int_spill = (real *)calloc(n_buf + 1, sizeof(real));
+
+ if(leed_calc_iv_nd(int_ref, n_buf, beams_all, n_set, beams_out,
+                    bulk, over, phs_shifts, v_par, eng) < 0)
+ {
+   fprintf(STDERR, "*** error (test_delta_spill): calculation failed\n");
+   return(1);
+ }
+
+ cache = leed_calc_cache_alloc(scratch);
+ for(i_call = 0; i_call < 2; i_call ++)
+ {
+   if(leed_calc_iv_delta_nd(int_spill, n_buf, beams_all, n_set, beams_out,
+                            bulk, over, phs_shifts, v_par, eng, &cache) < 0)
+   {
+     fprintf(STDERR, "*** error (test_delta_spill): delta mode failed\n");
+     return(1);
+   }
+
+   for(i_eng = 0; i_eng < n_eng; i_eng ++)
+     if( ! file_exists(scratch, i_eng) || ! cache->eng[i_eng].spilled )
+     {
+       printf("call %d: energy %d not in scratch file FAILED\n", i_call, i_eng);
+       n_fail ++;
+     }
+
+   diff = max_diff(int_ref, int_spill, n_buf);
+   printf("call %d: %d layers calculated, %d reused, "
+          "max. rel. difference %.3e %s\n", i_call,
+          cache->n_calc, cache->n_reuse, diff,
+          (diff < 1.e-10)? "ok": "FAILED");
+   if(diff >= 1.e-10) n_fail ++;
+ }
+
+/* all layers of the second call must have been reused */
+ if(cache->n_reuse != cache->n_calc)
+ {
+   printf("layers of the second call recalculated FAILED\n");
+   n_fail ++;
+ }
+
+ leed_calc_cache_free(cache);
+ for(i_eng = 0; i_eng < n_eng; i_eng ++)
+   if(file_exists(scratch, i_eng))
+   {
+     printf("scratch file %s.%d not removed FAILED\n", scratch, i_eng);
+     n_fail ++;
+   }
+
+ free(int_ref);
+ free(int_spill);
+ leed_inp_free_nd(over, 0);
+ leed_inp_free_nd(bulk, 1);
+
+ printf("%s\n", (n_fail)? "FAILED": "all tests passed");
+ return( (n_fail)? 1: 0);
+}
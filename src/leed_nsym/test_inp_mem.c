@@ -0,0 +1,175 @@
+/*********************************************************************
+  AG/17.10.26
+  test_inp_mem
+
+  Test of the in-memory input (linpmemnd.c): the Ni(111)-(2x2)-O
+  example (examples/models/nio/Ni111_2x2O.bul, *.inp) is set up once
+  from the input files and once from arrays; the intensities of both
+  must be the same.
+  The structures of the in-memory input are set up twice to check
+  that they can be reused.
+
+  Usage (CLEED_PHASE must point to the phase shift directory):
+
+    test_inp_mem <bulk file> <overlayer file>
+
+  Return value: 0 if the intensities agree, 1 otherwise.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "leed.h"
+
+#define E_INI   70.     /* energy range of the test (eV) */
+#define E_FIN   78.1
+#define E_STP    4.
+#define DR_NI    0.025  /* rms displacements (A) */
+#define DR_O     0.061
+
+static void set_atom(leed_atom_t *atom, int type, real x, real y, real z)
+{
+ atom->type = type;
+ atom->t_type = T_DIAG;
+ atom->pos[0] = 0.;
+ atom->pos[1] = x / BOHR;
+ atom->pos[2] = y / BOHR;
+ atom->pos[3] = z / BOHR;
+ atom->dwf = 0.;
+}
+
+static void set_dr(real *dr, real dr_1)
+{
+ dr[1] = dr[2] = dr[3] = dr_1 / BOHR;
+ dr[0] = SQUARE(dr[1]) + SQUARE(dr[2]) + SQUARE(dr[3]);
+}
+
+int main(int argc, char *argv[])
+{
+int i, i_run, n_buf, n_eng;
+int n_set_f, n_set_m;
+int t_ni, t_o;
+
+real a1[4] = {0.,  1.2450/BOHR, -2.1564/BOHR,  0.};
+real a2[4] = {0.,  1.2450/BOHR,  2.1564/BOHR,  0.};
+real a3[4] = {0.,  0.,           0.,          -6.0990/BOHR};
+real m_super[5] = {0., 2., 0., 0., 2.};
+real dr_ni[4], dr_o[4];
+real *int_f, *int_m;
+real diff, faux;
+
+char ph_ni[] = "Ni_Wakoh_cs";          /* phase shift files */
+char ph_o[] = "O_CO_Pendry_cs";
+
+leed_atom_t at_bul[3], at_over[9];
+
+leed_cryst_t *bulk_f, *over_f, *bulk_m, *over_m;
+leed_phs_t *phs_shifts;
+leed_var_t *v_par_f, *v_par_m;
+leed_energy_t *eng_f, *eng_m;
+leed_beam_t *beams_all_f, *beams_out_f, *beams_all_m, *beams_out_m;
+
+ if(argc < 3)
+ {
+   fprintf(STDERR, "usage: %s <bulk file> <overlayer file>\n", argv[0]);
+   return(1);
+ }
+
+ bulk_f = over_f = bulk_m = over_m = NULL;
+ phs_shifts = NULL;
+ v_par_f = v_par_m = NULL;
+ eng_f = eng_m = NULL;
+ beams_all_f = beams_out_f = beams_all_m = beams_out_m = NULL;
+
+/*********************************************************************
+  Input files
+*********************************************************************/
+
+ leed_inp_read_bul_nd(&bulk_f, &phs_shifts, argv[1]);
+ leed_inp_leed_read_par(&v_par_f, &eng_f, bulk_f, argv[1]);
+ leed_read_overlayer_nd(&over_f, &phs_shifts, bulk_f, argv[2]);
+ eng_f->ini = E_INI / HART;
+ eng_f->fin = E_FIN / HART;
+ eng_f->stp = E_STP / HART;
+
+/*********************************************************************
+  The same in memory (set up twice)
+*********************************************************************/
+
+ set_dr(dr_ni, DR_NI);
+ set_dr(dr_o, DR_O);
+ t_ni = leed_inp_phase_nd(ph_ni, dr_ni, T_DIAG, &phs_shifts);
+ t_o  = leed_inp_phase_nd(ph_o, dr_o, T_DIAG, &phs_shifts);
+
+ set_atom(at_bul + 0, t_ni, 0.0000,  0.0000,  0.0000);
+ set_atom(at_bul + 1, t_ni, 1.2450, -0.7188, -2.0330);
+ set_atom(at_bul + 2, t_ni, 1.2450,  0.7188, -4.0660);
+
+ set_atom(at_over + 0, t_o,   0.0000,  0.0000, 5.2000);
+ set_atom(at_over + 1, t_ni,  1.2450, -0.7188, 4.1000);
+ set_atom(at_over + 2, t_ni, -1.2450, -0.7188, 4.1000);
+ set_atom(at_over + 3, t_ni,  2.4900,  1.4376, 4.1000);
+ set_atom(at_over + 4, t_ni,  0.0000,  1.4376, 4.1000);
+ set_atom(at_over + 5, t_ni,  1.2450,  0.7188, 2.0000);
+ set_atom(at_over + 6, t_ni, -1.2450,  0.7188, 2.0000);
+ set_atom(at_over + 7, t_ni,  0.0000, -1.4376, 2.0000);
+ set_atom(at_over + 8, t_ni, -2.4900, -1.4376, 2.0000);
+
+ for(i_run = 0; i_run < 2; i_run ++)
+ {
+   if( (leed_inp_bul_mem_nd(&bulk_m, a1, a2, a3, m_super, at_bul, 3,
+                            -8./HART, 4./HART, 0.) < 0) ||
+       (leed_inp_over_mem_nd(&over_m, bulk_m, at_over, 9) < 0) ||
+       (leed_inp_par_mem(&v_par_m, &eng_m, bulk_m,
+                         E_INI/HART, E_FIN/HART, E_STP/HART,
+                         0., 0., 7, 1.e-2, 0.) < 0) )
+   {
+     fprintf(STDERR, "*** error (test_inp_mem): in-memory input failed\n");
+     return(1);
+   }
+ }
+
+/*********************************************************************
+  Intensities
+*********************************************************************/
+
+ n_set_f = n_set_m = 0;
+ leed_calc_beams_nd(&beams_all_f, &beams_out_f, &n_set_f, bulk_f, v_par_f,
+                    eng_f);
+ n_buf = leed_calc_beams_nd(&beams_all_m, &beams_out_m, &n_set_m, bulk_m,
+                            v_par_m, eng_m);
+ leed_ms_gaunt(LEED_GAUNT_II, v_par_f->l_max);
+ leed_ms_gaunt(LEED_GAUNT_IJ, v_par_f->l_max);
+ n_eng = leed_calc_n_eng(eng_m);
+ n_buf *= n_eng;
+
+ int_f = (real *)calloc(n_buf + 1, sizeof(real));
+ int_m = (real *)calloc(n_buf + 1, sizeof(real));
+
+ if( (n_set_f != n_set_m) || (n_eng != leed_calc_n_eng(eng_f)) ||
+     (leed_calc_iv_nd(int_f, n_buf, beams_all_f, n_set_f, beams_out_f,
+                      bulk_f, over_f, phs_shifts, v_par_f, eng_f) < 0) ||
+     (leed_calc_iv_nd(int_m, n_buf, beams_all_m, n_set_m, beams_out_m,
+                      bulk_m, over_m, phs_shifts, v_par_m, eng_m) < 0) )
+ {
+   fprintf(STDERR, "*** error (test_inp_mem): calculation failed\n");
+   return(1);
+ }
+
+ diff = 0.;
+ for(i = 0; i < n_buf; i ++)
+ {
+   faux = R_fabs(int_f[i] - int_m[i]);
+   if(int_f[i] > 0.) faux /= int_f[i];
+   diff = MAX(diff, faux);
+ }
+
+ printf("%d energies, %d intensities, max. rel. difference %.3e\n",
+        n_eng, n_buf, diff);
+
+ leed_inp_free_nd(over_m, 0);
+ leed_inp_free_nd(bulk_m, 1);
+
+ return( (diff < 1.e-10)? 0: 1);
+}
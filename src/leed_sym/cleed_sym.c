@@ -19,6 +19,14 @@ Changes:
 version 1.1
  GH/27.09.00 - version 1.1
  LD/21.04.14 - added --help and --version arguments
+ AG/17.10.26 - restart from an interrupted output file (--restart) and
+               energy sub-ranges/shards (--energy-range, --energy-shard).
+               The output file is opened after the input has been read.
+ AG/17.10.26 - output only the beams of an R factor control file 
+               (-c <ctr_file>, leed_output_beam_select).
+ AG/17.10.26 - --energy-range checked by leed_chk_range (invalid or empty
+               range is an error).
+ AG/17.10.26 - --energy-range/--energy-shard without value is an error.
 *********************************************************************/
 
 #include <stdio.h>
@@ -68,9 +76,15 @@ int i_c, i_arg;
 int n_beams_now, n_beams_set;
 int i_set, n_set, offset;
 int i_layer;
+int n_out, n_done, restart;
+int i_shard, n_shard;
+int n_sel;
 
 real energy;
 real vec[4];
+real e_lo, e_hi;
+real *eng_done;
+real *ind_sel;
 
 char linebuffer[STRSZ];
 
@@ -78,6 +92,7 @@ char bul_file[STRSZ];                 /* input/output files */
 char par_file[STRSZ];
 char pro_name[STRSZ];
 char res_file[STRSZ];
+char ctr_file[STRSZ];
 
 FILE *pro_stream;
 FILE *res_stream;
@@ -100,6 +115,13 @@ FILE *res_stream;
  
  n_set = 0;
 
+ restart = 0;
+ n_done = -1;
+ i_shard = n_shard = 0;
+ e_lo = e_hi = 0.;
+ eng_done = NULL;
+ ind_sel = NULL;
+
 /*********************************************************************
   Preset parameters set by arguments
 *********************************************************************/
@@ -115,6 +137,7 @@ FILE *res_stream;
   strncpy(par_file,"---", STRSZ);
   strncpy(res_file,"leed.res", STRSZ);
   strncpy(pro_name,"leed.pro", STRSZ);
+  strncpy(ctr_file,"---", STRSZ);
 
   ctr_flag = FLAG_NONE;
 
@@ -126,10 +149,21 @@ FILE *res_stream;
     -i <par_file> - (mandatory input file) overlayer parameters of all 
                     parameters (if bul_file does not exist).
     -o <res_file> - (output file) IV output.
+    -c <ctr_file> - (optional) R factor control file: only the beams 
+                    used in ctr_file ("ti=") are written to res_file.
     -r <pro_name> - (input file) to read parameters and scattering
                     matrices from.
     -w <pro_name> - (output file) top write parameters and scattering
                     matrices to.
+    --restart     - (optional) continue an interrupted calculation: 
+                    energies already in res_file are not calculated 
+                    again, output is appended.
+    --energy-range <e1>:<e2> 
+                  - (optional) calculate only energies e1 <= E <= e2 
+                    (eV) of the energy grid.
+    --energy-shard <i>/<N>
+                  - (optional) calculate only the i-th of N blocks of
+                    energies (merge the output files with cleed_merge).
 *********************************************************************/
 
  for (i_arg = 1; i_arg < argc; i_arg++)
@@ -139,7 +173,10 @@ FILE *res_stream;
 #ifdef ERROR
    fprintf(STDERR,"*** error (%s):\tsyntax error:\n", LEED_NAME);
    fprintf(STDERR,"\tusage: \tleed -i <par_file> -o <res_file>");
-   fprintf(STDERR," [-b <bul_file> -r <pro_name> -w <pro_name> -h -V]\n");
+   fprintf(STDERR," [-b <bul_file> -c <ctr_file> -r <pro_name> -w <pro_name>"
+                  " -h -V]\n");
+   fprintf(STDERR,"\t\t[--restart --energy-range <e1>:<e2>"
+                  " --energy-shard <i>/<N>]\n");
 #endif
    exit(1);
   }
@@ -181,12 +218,63 @@ FILE *res_stream;
    {
     i_arg++;
     strncpy(res_file, argv[i_arg], STRSZ);
-    if ((res_stream = fopen(res_file,"w")) == NULL)
+   }
+
+/* Read R factor control file (output beams) */
+   if(strncmp(argv[i_arg], "-c", 2) == 0)
+   {
+    i_arg++;
+    strncpy(ctr_file, argv[i_arg], STRSZ);
+   }
+
+/* Restart from existing output file */
+   if(strcmp(argv[i_arg], "--restart") == 0)
+   {
+    restart = 1;
+   }
+
+/* Energy sub-range (eV) */
+   if(strcmp(argv[i_arg], "--energy-range") == 0)
+   {
+    if(i_arg + 1 >= argc)
+    {
+#ifdef ERROR
+     fprintf(STDERR,
+     "*** error (%s):\tsyntax error: no value of --energy-range\n", LEED_NAME);
+#endif
+     exit(1);
+    }
+    i_arg++;
+    if(leed_chk_range(argv[i_arg], &e_lo, &e_hi) < 0)
+    {
+#ifdef ERROR
+     fprintf(STDERR,
+     "*** error (%s): invalid energy range \"%s\"\n", 
+     LEED_NAME, argv[i_arg]);
+#endif
+     exit(1);
+    }
+   }
+
+/* Energy shard */
+   if(strcmp(argv[i_arg], "--energy-shard") == 0)
+   {
+    if(i_arg + 1 >= argc)
+    {
+#ifdef ERROR
+     fprintf(STDERR,
+     "*** error (%s):\tsyntax error: no value of --energy-shard\n", LEED_NAME);
+#endif
+     exit(1);
+    }
+    i_arg++;
+    if( (sscanf(argv[i_arg], "%d/%d", &i_shard, &n_shard) != 2) ||
+        (i_shard < 1) || (i_shard > n_shard) )
     {
 #ifdef ERROR
      fprintf(STDERR,
-     "*** error (%s): could not open output file \"%s\"\n", 
-     LEED_NAME, res_file);
+     "*** error (%s): invalid energy shard \"%s\"\n", 
+     LEED_NAME, argv[i_arg]);
 #endif
      exit(1);
     }
@@ -256,16 +344,20 @@ FILE *res_stream;
            "* warning (%s): no output file (option -o) specified\n", LEED_NAME);
    fprintf(STDWAR,"\toutput will be written to file \"%s\"\n", res_file);
 #endif
+ }
 
-   if ((res_stream = fopen(res_file,"w")) == NULL)
-   {
+/* 
+  the matrices in the project file are stored for all energies in
+  sequence: no energies can be skipped.
+*/
+ if( (ctr_flag != FLAG_NONE) && 
+     ( restart || (e_lo < e_hi) || (n_shard > 0) ) )
+ {
 #ifdef ERROR
-     fprintf(STDERR,
-     "*** error (%s): could not open output file \"%s\"\n",
-     LEED_NAME, res_file);
+   fprintf(STDERR, "*** error (%s): --restart, --energy-range and "
+           "--energy-shard cannot be combined with -r/-w\n", LEED_NAME);
 #endif
-     exit(1);
-   } 
+   exit(1);
  }
 
 /*********************************************************************
@@ -321,8 +413,49 @@ FILE *res_stream;
  }  /* switch */
    
 /**** leed_inp_show_beam_op(bulk, over, phs_shifts);***/
- leed_out_head_2 (LEED_VERSION, LEED_NAME, res_stream);
- leed_output_beam_list (&beams_out, beams_all, eng, res_stream);
+
+/*********************************************************************
+  Output beams (always for the full energy range, so that all shards 
+  have the same beams), energy range of this run, and output file.
+  With --restart, the output of an interrupted run is continued.
+*********************************************************************/
+
+ n_out = leed_output_beam_list (&beams_out, beams_all, eng, NULL);
+
+ if(strncmp(ctr_file, "---", 3) != 0)
+ {
+   if( (n_sel = leed_output_beam_ctr(&ind_sel, ctr_file)) < 1) exit(1);
+   n_out = leed_output_beam_select(beams_out, beams_all, ind_sel, n_sel);
+   free(ind_sel);
+ }
+
+ if( (e_lo < e_hi) || (n_shard > 0) )
+ {
+   if(leed_chk_shard(eng, e_lo, e_hi, i_shard, n_shard) < 1) exit(1);
+ }
+
+ if(restart)
+ {
+   n_done = leed_chk_read(res_file, n_out, &eng_done);
+   if(n_done < -1) exit(1);
+ }
+
+ if ((res_stream = fopen(res_file, (n_done < 0)? "w": "a")) == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR,
+   "*** error (%s): could not open output file \"%s\"\n",
+   LEED_NAME, res_file);
+#endif
+   exit(1);
+ }
+
+ if(n_done < 0)
+ {
+   leed_out_head_2 (LEED_VERSION, LEED_NAME, res_stream);
+   leed_output_beam_head(res_stream, beams_out, n_out, leed_calc_n_eng(eng),
+                         eng->ini, eng->fin, eng->stp);
+ }
 
 /*********************************************************************
  Prepare some often used parameters.
@@ -342,6 +475,9 @@ FILE *res_stream;
 
   for( energy = eng->ini; energy <= eng->fin + E_TOLERANCE; energy += eng->stp)
   {
+    /* skip energies completed in a previous run (--restart) */
+    if( (n_done > 0) && leed_chk_done(energy, eng_done, n_done) ) continue;
+
     leed_par_update(v_par, phs_shifts, energy);
     n_beams_now = leed_beam_get_selection(&beams_now, beams_all, v_par, bulk->dmin);
 
@@ -601,6 +737,7 @@ FILE *res_stream;
 /**** No scattering at pot. step ****/
     Amp = leed_ld_potstep0(Amp, R_tot, beams_now, v_par->eng_v, vec);
     leed_output_iint_sym(Amp, beams_now, beams_out, v_par, res_stream);
+    fflush(res_stream);     /* output file is the checkpoint */
 
 /**Write cpu time to output**/
    sprintf(linebuffer,"  %.1f   %d  ",energy * HART,n_beams_now);
@@ -619,6 +756,7 @@ FILE *res_stream;
    fclose(pro_stream);
 
  fclose(res_stream);
+ free(eng_done);
 
 #ifdef CONTROL
  fprintf(STDCTR, "\n\n(%s):\tCORRECT TERMINATION", LEED_NAME);
@@ -26,6 +26,7 @@ WB/04.09.98 - change sign of angles and add 2PI for negative angles
 WB/07.09.98 - bezug auf einheitlichen Winkel(zur 1.Ebene)
               geht perfekt
             - neqb_b (set 0) = 2*n_mir 
+AG/17.10.26 - set set_end = 0 (beams are not sorted for leed_beam_get_selection)
 *********************************************************************/
 
 #include <math.h>
@@ -750,6 +751,7 @@ needed in the routines bravelsym and complsym
   /* beam set */
 
         (beams + i_beams)->set = i_set;
+        (beams + i_beams)->set_end = 0;  /* not sorted by k_par */
         i_beams ++;
 
        }/*if wedge...**/
@@ -1403,6 +1405,7 @@ needed in the routines bravelsym and complsym
        }  /* for i_layers */
 
       (beams + i_beams)->set = i_set;
+      (beams + i_beams)->set_end = 0;    /* not sorted by k_par */
       i_beams++;
 
       }/* if ctrol != 1*/
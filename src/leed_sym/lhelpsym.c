@@ -9,6 +9,8 @@ LD/24.04.14
      Provides version information then exits
   
 Changes:
+AG/17.10.26 - restart and energy shard options.
+AG/17.10.26 - option -c (output beams from R factor control file).
 
 *********************************************************************/
 
@@ -22,7 +24,12 @@ void usage_sym(FILE *output) {
     fprintf(output, "  -i <par_file>        : filepath to parameter input file\n");
     fprintf(output, "  -o <res_file>        : filepath to output file\n");
     fprintf(output, "  -b <bul_file>        : filepath to bulk parameter file\n");
+    fprintf(output, "  -c <ctr_file>        : write only the beams used in R factor control file\n");
     fprintf(output, "  -e                   : early return option\n");
+    fprintf(output, "  --restart            : continue an interrupted run (append to res_file)\n");
+    fprintf(output, "  --energy-range e1:e2 : calculate only energies e1 <= E <= e2 (eV)\n");
+    fprintf(output, "  --energy-shard i/N   : calculate only the i-th of N energy blocks\n");
+    fprintf(output, "                         (merge the output files with cleed_merge)\n");
     fprintf(output, "  -h --help            : print help and exit\n");
     fprintf(output, "  -V --version         : print version and information about this program\n");
     fprintf(output, "\n");
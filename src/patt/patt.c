@@ -56,6 +56,8 @@ Version 1.4: 11.06.13 (LD)
 14.06.13:	Added title using '--title' option
 16.06.13:	Partial fix vectors text placement bug
 17.06.13:	Added stdin default (with prompts) if no input file specified
+17.10.26:	Raster PNG output through libpng ('-f png', compile with _USE_PNG);
+			equivalent domains are drawn only once.
 
 NOTES
 	Compile with: gcc -lm pattern.c -o pattern
@@ -71,6 +73,9 @@ NOTES
 #include <ctype.h>
 
 #include "patt.h"
+#ifdef _USE_PNG
+#include "patt_raster.h"
+#endif
 
 /*========================================================================*/
 
@@ -166,6 +171,37 @@ int patt_draw(FILE *out_stream, drawing_t *drawing, int format)
   pattern_t *pat; 
   patt_color_rgb_t *color = PATT_BLACK;
   
+  #ifdef _USE_PNG
+  /* fast raster backend for batch rendering (no labels or vectors) */
+  if (format == PATT_PNG)
+  {
+    patt_raster_t *raster = patt_raster_init(PATT_RASTER_SIZE, 
+                                             PATT_RASTER_SIZE);
+    if (raster == NULL) return -1;
+    
+    for (i = 0; i < drawing->n_files; i++)
+    {
+      in_stream = fopen(drawing->input_files[i], "r");
+      if (in_stream == NULL)
+      {
+        fprintf(stderr, "error (patt_draw): cannot read file '%s'\n", 
+                drawing->input_files[i]);
+        continue;
+      }
+      pat = pattern_read(in_stream);
+      fclose(in_stream);
+      if (pat == NULL) continue;
+      
+      patt_raster_draw_pattern(raster, pat, i);
+      pattern_free(pat);
+    }
+    
+    i = patt_raster_write_png(raster, drawing->output_filename);
+    patt_raster_free(raster);
+    return (int)i;
+  }
+  #endif
+  
   #ifdef _USE_CAIRO
   cairo_surface_t *surface;
   cairo_t *cr;
@@ -328,6 +328,12 @@ int parse_patt_args(int argc, char *argv[],
        if (i_arg+1 < argc)
        {
 
+         #ifdef _USE_PNG
+         /* raster backend (libpng), no cairo needed */
+         if (strcasecmp(argv[i_arg+1], "png") == 0) 
+             *format = PATT_PNG;
+         else
+         #endif
              
          #ifdef _USE_CAIRO
          
@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include "patt.h"
 
+char line_buffer[STRSZ];
+
 char *fget_nocomm(char *buffer, FILE *in_stream, FILE *out_stream)
 /* 
  Lines beginning with '#' are interpreted as comments. 
@@ -0,0 +1,539 @@
+/****************************************************************************
+                        patt_match.c
+FUNCTIONS
+	patt_kdtree_build - build k-d tree of measured spot positions.
+	patt_kdtree_nearest - nearest neighbour search.
+	patt_match_symmetry - point group of substrate lattice.
+	patt_match_candidates - enumerate superstructures up to max. det.
+	patt_match_score - score candidates against measured spots.
+	patt_match_sort - sort candidates by score.
+
+DESCRIPTION
+	Automated matching of superstructure candidates against an
+experimental spot list. All commensurate superlattices with |det M| up to
+a given maximum are enumerated once each (Hermite normal form), the
+symmetry equivalent superlattices are combined into domains. The spots of
+each candidate are generated with pattern_calculate_superstructure_spots
+and compared with the measured positions through a k-d tree.
+
+AUTHOR(S)
+	agent <agent@local>
+
+CHANGE-LOG
+2026-10-17/AG - initial implementation
+2026-10-17/AG - patt_match_score: error flag as OpenMP reduction
+2026-10-17/AG - patt_match_cmp_score: ordered comparisons instead of !=
+
+***************************************************************************/
+
+#include "patt_match.h"
+#include "patt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#ifdef _USE_OPENMP
+#include <omp.h>        /* compile with '-fopenmp' */
+#endif
+
+/*======================================================================*/
+/* k-d tree                                                             */
+/*======================================================================*/
+
+static void patt_kdtree_swap(patt_kdtree_t *tree, size_t i, size_t j)
+{
+  double faux;
+  size_t iaux;
+
+  faux = tree->x[i]; tree->x[i] = tree->x[j]; tree->x[j] = faux;
+  faux = tree->y[i]; tree->y[i] = tree->y[j]; tree->y[j] = faux;
+  iaux = tree->index[i]; tree->index[i] = tree->index[j]; tree->index[j] = iaux;
+}
+
+/* move the k-th smallest element of [lo, hi) along axis to position k */
+static void patt_kdtree_select(patt_kdtree_t *tree, size_t lo, size_t hi,
+                               size_t k, int axis)
+{
+  size_t i, store;
+  double pivot;
+  double *v = (axis == 0) ? tree->x : tree->y;
+
+  while (hi - lo > 1)
+  {
+    patt_kdtree_swap(tree, (lo + hi) / 2, hi - 1);
+    pivot = v[hi - 1];
+
+    for (store = lo, i = lo; i < hi - 1; i++)
+    {
+      if (v[i] < pivot) patt_kdtree_swap(tree, i, store++);
+    }
+    patt_kdtree_swap(tree, store, hi - 1);
+
+    if (store == k) return;
+    else if (k < store) hi = store;
+    else lo = store + 1;
+  }
+}
+
+static void patt_kdtree_split(patt_kdtree_t *tree, size_t lo, size_t hi,
+                              int depth)
+{
+  size_t mid;
+
+  if (hi - lo < 2) return;
+
+  mid = (lo + hi) / 2;
+  patt_kdtree_select(tree, lo, hi, mid, depth % 2);
+  patt_kdtree_split(tree, lo, mid, depth + 1);
+  patt_kdtree_split(tree, mid + 1, hi, depth + 1);
+}
+
+patt_kdtree_t *patt_kdtree_build(const double *x, const double *y,
+                                 size_t n_points)
+{
+  size_t i;
+  patt_kdtree_t *tree = (patt_kdtree_t*) malloc(sizeof(patt_kdtree_t));
+
+  if (tree == NULL) return NULL;
+
+  tree->x = (double*) malloc(sizeof(double) * (n_points + 1));
+  tree->y = (double*) malloc(sizeof(double) * (n_points + 1));
+  tree->index = (size_t*) malloc(sizeof(size_t) * (n_points + 1));
+  if ( (tree->x == NULL) || (tree->y == NULL) || (tree->index == NULL) )
+  {
+    patt_kdtree_free(tree);
+    return NULL;
+  }
+
+  for (i = 0; i < n_points; i++)
+  {
+    tree->x[i] = x[i];
+    tree->y[i] = y[i];
+    tree->index[i] = i;
+  }
+  tree->n_points = n_points;
+
+  patt_kdtree_split(tree, 0, n_points, 0);
+
+  return tree;
+}
+
+void patt_kdtree_free(patt_kdtree_t *tree)
+{
+  if (tree == NULL) return;
+  free(tree->x);
+  free(tree->y);
+  free(tree->index);
+  free(tree);
+}
+
+static void patt_kdtree_search(const patt_kdtree_t *tree, size_t lo,
+                               size_t hi, int depth, double x, double y,
+                               size_t *i_best, double *d2_best)
+{
+  size_t mid;
+  double dx, dy, d2, delta;
+
+  if (lo >= hi) return;
+
+  mid = (lo + hi) / 2;
+  dx = tree->x[mid] - x;
+  dy = tree->y[mid] - y;
+  d2 = dx*dx + dy*dy;
+  if (d2 < *d2_best)
+  {
+    *d2_best = d2;
+    *i_best = mid;
+  }
+
+  /* signed distance from splitting line */
+  delta = (depth % 2 == 0) ? (x - tree->x[mid]) : (y - tree->y[mid]);
+
+  if (delta < 0.)
+  {
+    patt_kdtree_search(tree, lo, mid, depth + 1, x, y, i_best, d2_best);
+    if (delta*delta < *d2_best)
+      patt_kdtree_search(tree, mid + 1, hi, depth + 1, x, y, i_best, d2_best);
+  }
+  else
+  {
+    patt_kdtree_search(tree, mid + 1, hi, depth + 1, x, y, i_best, d2_best);
+    if (delta*delta < *d2_best)
+      patt_kdtree_search(tree, lo, mid, depth + 1, x, y, i_best, d2_best);
+  }
+}
+
+size_t patt_kdtree_nearest(const patt_kdtree_t *tree,
+                           double x, double y, double *dist)
+{
+  size_t i_best = tree->n_points;
+  double d2_best = DBL_MAX;
+
+  patt_kdtree_search(tree, 0, tree->n_points, 0, x, y, &i_best, &d2_best);
+
+  if (i_best >= tree->n_points)
+  {
+    *dist = DBL_MAX;
+    return tree->n_points;
+  }
+
+  *dist = sqrt(d2_best);
+  return tree->index[i_best];
+}
+
+/*======================================================================*/
+/* superstructure candidates                                            */
+/*======================================================================*/
+
+/* integer floor division */
+static int patt_match_floordiv(int a, int b)
+{
+  int q = a / b;
+  if ( (a % b != 0) && ((a < 0) != (b < 0)) ) q--;
+  return q;
+}
+
+/*
+ * Hermite normal form of the rows of M = (M11, M12, M21, M22):
+ * rows (a, 0) and (b, d) with a, d > 0 and 0 <= b < a. Two integer
+ * matrices generate the same superlattice if their HNFs are identical.
+ */
+static void patt_match_hnf(int *M)
+{
+  int q, t;
+
+  /* Euclid on second column: M12 -> 0 */
+  while (M[1] != 0)
+  {
+    q = M[3] / M[1];
+    M[2] -= q * M[0];
+    M[3] -= q * M[1];
+
+    t = M[0]; M[0] = M[2]; M[2] = t;
+    t = M[1]; M[1] = M[3]; M[3] = t;
+  }
+
+  if (M[0] < 0) M[0] = -M[0];
+  if (M[3] < 0)
+  {
+    M[2] = -M[2];
+    M[3] = -M[3];
+  }
+
+  if (M[0] != 0) M[2] -= patt_match_floordiv(M[2], M[0]) * M[0];
+}
+
+static int patt_match_cmp_M(const int *M1, const int *M2)
+{
+  int i;
+  for (i = 0; i < 4; i++)
+  {
+    if (M1[i] != M2[i]) return (M1[i] < M2[i]) ? -1 : 1;
+  }
+  return 0;
+}
+
+int patt_match_symmetry(const pattern_t *pat, int S[][4])
+{
+  int s11, s12, s21, s22, n_sym = 0;
+  double g11, g12, g22, h11, h12, h22, tol;
+
+  /* metric tensor of real space lattice */
+  g11 = pat->a1.x*pat->a1.x + pat->a1.y*pat->a1.y;
+  g12 = pat->a1.x*pat->a2.x + pat->a1.y*pat->a2.y;
+  g22 = pat->a2.x*pat->a2.x + pat->a2.y*pat->a2.y;
+  tol = 1.e-3 * (g11 + g22);
+
+  /*
+   * Operations a_i' = sum_j S_ij a_j that preserve the metric;
+   * entries of S are in [-2, 2] for reduced lattice vectors a1, a2.
+   */
+  for (s11 = -2; s11 <= 2; s11++)
+  for (s12 = -2; s12 <= 2; s12++)
+  for (s21 = -2; s21 <= 2; s21++)
+  for (s22 = -2; s22 <= 2; s22++)
+  {
+    if (abs(s11*s22 - s12*s21) != 1) continue;
+
+    h11 = s11*s11*g11 + 2*s11*s12*g12 + s12*s12*g22;
+    h12 = s11*s21*g11 + (s11*s22 + s12*s21)*g12 + s12*s22*g22;
+    h22 = s21*s21*g11 + 2*s21*s22*g12 + s22*s22*g22;
+
+    if ( (fabs(h11 - g11) < tol) && (fabs(h12 - g12) < tol) &&
+         (fabs(h22 - g22) < tol) && (n_sym < PATT_MATCH_MAX_SYM) )
+    {
+      S[n_sym][0] = s11; S[n_sym][1] = s12;
+      S[n_sym][2] = s21; S[n_sym][3] = s22;
+      n_sym++;
+    }
+  }
+
+  return n_sym;
+}
+
+patt_candidate_t *patt_match_candidates(const pattern_t *pat, int det_max,
+                                        size_t *n_cand)
+{
+  int S[PATT_MATCH_MAX_SYM][4];
+  int M[4], M_op[4];
+  int n_sym, i_sym, i_dom;
+  int det, a, b, d;
+  bool is_min;
+  size_t n_alloc = 16;
+  patt_candidate_t *cand, *c;
+
+  *n_cand = 0;
+  n_sym = patt_match_symmetry(pat, S);
+
+  cand = (patt_candidate_t*) malloc(sizeof(patt_candidate_t) * n_alloc);
+  if (cand == NULL) return NULL;
+
+  for (det = 2; det <= det_max; det++)
+  {
+    for (a = 1; a <= det; a++)
+    {
+      if (det % a != 0) continue;
+      d = det / a;
+
+      for (b = 0; b < a; b++)
+      {
+        M[0] = a; M[1] = 0; M[2] = b; M[3] = d;
+
+        if (*n_cand >= n_alloc)
+        {
+          n_alloc *= 2;
+          c = (patt_candidate_t*) realloc(cand,
+                                          sizeof(patt_candidate_t) * n_alloc);
+          if (c == NULL)
+          {
+            free(cand);
+            return NULL;
+          }
+          cand = c;
+        }
+        c = cand + *n_cand;
+        memcpy(c->M, M, sizeof(M));
+        c->n_domains = 0;
+
+        /* domains: M' = M * S, keep M only if it is the smallest in orbit */
+        is_min = true;
+        for (i_sym = 0; (i_sym < n_sym) && is_min; i_sym++)
+        {
+          M_op[0] = M[0]*S[i_sym][0] + M[1]*S[i_sym][2];
+          M_op[1] = M[0]*S[i_sym][1] + M[1]*S[i_sym][3];
+          M_op[2] = M[2]*S[i_sym][0] + M[3]*S[i_sym][2];
+          M_op[3] = M[2]*S[i_sym][1] + M[3]*S[i_sym][3];
+          patt_match_hnf(M_op);
+
+          if (patt_match_cmp_M(M_op, M) < 0) is_min = false;
+
+          for (i_dom = 0; i_dom < c->n_domains; i_dom++)
+          {
+            if (patt_match_cmp_M(M_op, c->M_dom[i_dom]) == 0) break;
+          }
+          if (i_dom == c->n_domains)
+          {
+            memcpy(c->M_dom[c->n_domains], M_op, sizeof(M_op));
+            c->n_domains++;
+          }
+        }
+
+        if (n_sym == 0)
+        {
+          memcpy(c->M_dom[0], M, sizeof(M));
+          c->n_domains = 1;
+        }
+
+        if (is_min) (*n_cand)++;
+      } /* for b */
+    } /* for a */
+  } /* for det */
+
+  return cand;
+}
+
+/*======================================================================*/
+/* scoring                                                              */
+/*======================================================================*/
+
+/* predicted spot: integer index key in units of 1/det */
+typedef struct patt_match_spot_t
+{
+  long key[2];
+  double x;
+  double y;
+} patt_match_spot_t;
+
+static int patt_match_cmp_spot(const void *p1, const void *p2)
+{
+  const patt_match_spot_t *s1 = (const patt_match_spot_t*) p1;
+  const patt_match_spot_t *s2 = (const patt_match_spot_t*) p2;
+
+  if (s1->key[0] != s2->key[0]) return (s1->key[0] < s2->key[0]) ? -1 : 1;
+  if (s1->key[1] != s2->key[1]) return (s1->key[1] < s2->key[1]) ? -1 : 1;
+  return 0;
+}
+
+static int patt_match_score_one(const pattern_t *pat,
+                                const patt_kdtree_t *measured, double tol,
+                                patt_candidate_t *c, bool *hit)
+{
+  pattern_t pat_c;
+  matrix_2x2_t M_SS[PATT_MATCH_MAX_SYM];
+  size_t domains[PATT_MATCH_MAX_SYM];
+  size_t n_unique, i_dom, i_spot, n_spots, n_alloc, i_near;
+  int det;
+  double dist, sum2;
+  spots_t *spots;
+  patt_match_spot_t *pred, *p;
+
+  /* pattern with the domains of the candidate */
+  memcpy(&pat_c, pat, sizeof(pattern_t));
+  pat_c.M_SS = M_SS;
+  pat_c.n_domains = (size_t)c->n_domains;
+  for (i_dom = 0; i_dom < pat_c.n_domains; i_dom++)
+  {
+    M_SS[i_dom].M11 = c->M_dom[i_dom][0];
+    M_SS[i_dom].M12 = c->M_dom[i_dom][1];
+    M_SS[i_dom].M21 = c->M_dom[i_dom][2];
+    M_SS[i_dom].M22 = c->M_dom[i_dom][3];
+  }
+  det = abs(c->M[0]*c->M[3] - c->M[1]*c->M[2]);
+
+  /* union of SS spots (including GS spots) of all domains */
+  n_spots = 0;
+  n_alloc = 256;
+  pred = (patt_match_spot_t*) malloc(sizeof(patt_match_spot_t) * n_alloc);
+  if (pred == NULL) return -1;
+
+  n_unique = pattern_get_unique_domains(&pat_c, domains);
+  for (i_dom = 0; i_dom < n_unique; i_dom++)
+  {
+    spots = pattern_calculate_superstructure_spots(&pat_c, domains[i_dom]);
+    if (spots == NULL) continue;
+
+    for (i_spot = 0; i_spot < spots->n_spots; i_spot++)
+    {
+      if (n_spots >= n_alloc)
+      {
+        n_alloc *= 2;
+        p = (patt_match_spot_t*) realloc(pred,
+                                      sizeof(patt_match_spot_t) * n_alloc);
+        if (p == NULL)
+        {
+          free(pred);
+          spots_free(spots);
+          return -1;
+        }
+        pred = p;
+      }
+      pred[n_spots].key[0] = lround(spots->spots[i_spot].index.h * det);
+      pred[n_spots].key[1] = lround(spots->spots[i_spot].index.k * det);
+      pred[n_spots].x = spots->spots[i_spot].x;
+      pred[n_spots].y = spots->spots[i_spot].y;
+      n_spots++;
+    }
+    spots_free(spots);
+  }
+
+  /* remove spots shared by several domains */
+  if (n_spots > 1)
+  {
+    qsort(pred, n_spots, sizeof(patt_match_spot_t), patt_match_cmp_spot);
+    for (i_near = 0, i_spot = 1; i_spot < n_spots; i_spot++)
+    {
+      if (patt_match_cmp_spot(pred + i_spot, pred + i_near) != 0)
+        pred[++i_near] = pred[i_spot];
+    }
+    n_spots = i_near + 1;
+  }
+
+  /* compare with measured spots */
+  memset(hit, 0, sizeof(bool) * (measured->n_points + 1));
+  c->n_spots = n_spots;
+  c->n_matched = 0;
+  c->n_explained = 0;
+  sum2 = 0.;
+
+  for (i_spot = 0; i_spot < n_spots; i_spot++)
+  {
+    i_near = patt_kdtree_nearest(measured, pred[i_spot].x, pred[i_spot].y,
+                                 &dist);
+    if ( (i_near < measured->n_points) && (dist <= tol) )
+    {
+      c->n_matched++;
+      sum2 += dist*dist;
+      if (!hit[i_near])
+      {
+        hit[i_near] = true;
+        c->n_explained++;
+      }
+    }
+  }
+  free(pred);
+
+  c->rms = (c->n_matched > 0) ? sqrt(sum2 / c->n_matched) : 0.;
+
+  /* F-score of precision (matched/predicted) and recall (explained/measured) */
+  if ( (c->n_matched > 0) && (measured->n_points > 0) )
+  {
+    double precision = (double)c->n_matched / (double)c->n_spots;
+    double recall = (double)c->n_explained / (double)measured->n_points;
+    c->score = 2. * precision * recall / (precision + recall);
+  }
+  else c->score = 0.;
+
+  return 0;
+}
+
+int patt_match_score(const pattern_t *pat, const patt_kdtree_t *measured,
+                     double tol, patt_candidate_t *cand, size_t n_cand)
+{
+  long i_cand;
+  int failed = 0;            /* private to each thread, combined by OR */
+
+  #ifdef _USE_OPENMP
+  #pragma omp parallel reduction(|:failed)
+  #endif
+  {
+    /* flags of measured spots, one array per thread */
+    bool *hit = (bool*) malloc(sizeof(bool) * (measured->n_points + 1));
+
+    #ifdef _USE_OPENMP
+    #pragma omp for schedule(dynamic)
+    #endif
+    for (i_cand = 0; i_cand < (long)n_cand; i_cand++)
+    {
+      if ( (hit == NULL) ||
+           (patt_match_score_one(pat, measured, tol, cand + i_cand, hit) < 0) )
+      {
+        cand[i_cand].score = 0.;
+        failed = 1;
+      }
+    }
+    free(hit);
+  }
+
+  return (failed) ? -1 : 0;
+}
+
+static int patt_match_cmp_score(const void *p1, const void *p2)
+{
+  const patt_candidate_t *c1 = (const patt_candidate_t*) p1;
+  const patt_candidate_t *c2 = (const patt_candidate_t*) p2;
+
+  if (c1->score > c2->score) return -1;
+  if (c1->score < c2->score) return 1;
+  /* prefer smaller unit cells and better agreement */
+  if (c1->n_spots != c2->n_spots) return (c1->n_spots < c2->n_spots) ? -1 : 1;
+  if (c1->rms < c2->rms) return -1;
+  if (c1->rms > c2->rms) return 1;
+  return 0;
+}
+
+void patt_match_sort(patt_candidate_t *cand, size_t n_cand)
+{
+  qsort(cand, n_cand, sizeof(patt_candidate_t), patt_match_cmp_score);
+}
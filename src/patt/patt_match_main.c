@@ -0,0 +1,170 @@
+/****************************************************************************
+                        PATT_MATCH (agent 17.10.26)
+NAME
+	patt_match -- score superstructure candidates against measured spots
+
+SYNOPSIS
+	patt_match -a1 <x> <y> -a2 <x> <y> -s <spots> [-r <radius>]
+	           [-d <det_max>] [-t <tolerance>] [-n <n_best>]
+
+DESCRIPTION
+	All commensurate superstructures with |det M| <= det_max (default 7)
+are enumerated together with their symmetry domains, their spot patterns
+are generated and compared with the measured spot positions. The n_best
+candidates (default 10) are printed in order of decreasing score.
+
+	a1, a2 and radius have the same meaning as in the patt input file.
+The spot file contains one measured spot per line ('x y', lines starting
+with '#' are ignored) in the units of the patt drawing: origin at the
+(0,0) spot and radius MAX_RADIUS (200) for the screen, i.e. mkiv
+positions must be shifted to the (0,0) spot and scaled accordingly.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "patt_match.h"
+#include "patt.h"
+
+static void patt_match_usage(FILE *output)
+{
+  fprintf(output, "syntax:\npatt_match -a1 <x> <y> -a2 <x> <y> -s <spots> "
+          "(-r <radius> -d <det_max> -t <tol> -n <n_best>)\n\n");
+  fprintf(output, "-a1/-a2 <x> <y>\treal space lattice vectors.\n");
+  fprintf(output, "-s <spots>\tfile of measured spot positions (x y).\n");
+  fprintf(output, "-r <radius>\tradius of Ewald construction "
+          "(default: 1).\n");
+  fprintf(output, "-d <det_max>\tmax. determinant of SS matrices "
+          "(default: 7).\n");
+  fprintf(output, "-t <tol>\tmax. distance of matching spots "
+          "(default: %.1f).\n", RADIUS_SS);
+  fprintf(output, "-n <n_best>\tnumber of candidates printed "
+          "(default: 10).\n");
+}
+
+int main(int argc, char *argv[])
+{
+  int i_arg, i_dom;
+  int det_max = 7;
+  size_t n_best = 10;
+  size_t i_cand, n_cand, n_spots, n_alloc;
+  double tol = RADIUS_SS;
+  double *x, *y;
+  char line[STRSZ];
+  char *spots_filename = NULL;
+  FILE *file;
+
+  pattern_t pat;
+  patt_kdtree_t *measured;
+  patt_candidate_t *cand;
+
+  memset(&pat, 0, sizeof(pattern_t));
+  pat.radius = 1.;
+  pat.square = false;
+
+  for (i_arg = 1; i_arg < argc; i_arg++)
+  {
+    if ( (strcmp(argv[i_arg], "-a1") == 0) && (i_arg + 2 < argc) )
+    {
+      pat.a1.x = atof(argv[++i_arg]);
+      pat.a1.y = atof(argv[++i_arg]);
+    }
+    else if ( (strcmp(argv[i_arg], "-a2") == 0) && (i_arg + 2 < argc) )
+    {
+      pat.a2.x = atof(argv[++i_arg]);
+      pat.a2.y = atof(argv[++i_arg]);
+    }
+    else if ( (strcmp(argv[i_arg], "-s") == 0) && (i_arg + 1 < argc) )
+      spots_filename = argv[++i_arg];
+    else if ( (strcmp(argv[i_arg], "-r") == 0) && (i_arg + 1 < argc) )
+      pat.radius = atof(argv[++i_arg]);
+    else if ( (strcmp(argv[i_arg], "-d") == 0) && (i_arg + 1 < argc) )
+      det_max = atoi(argv[++i_arg]);
+    else if ( (strcmp(argv[i_arg], "-t") == 0) && (i_arg + 1 < argc) )
+      tol = atof(argv[++i_arg]);
+    else if ( (strcmp(argv[i_arg], "-n") == 0) && (i_arg + 1 < argc) )
+      n_best = (size_t)atoi(argv[++i_arg]);
+    else
+    {
+      patt_match_usage(stderr);
+      exit(1);
+    }
+  }
+
+  if (spots_filename == NULL)
+  {
+    patt_match_usage(stderr);
+    exit(1);
+  }
+
+  /* read measured spots */
+  if ((file = fopen(spots_filename, "r")) == NULL)
+  {
+    fprintf(stderr, "*** error (patt_match): cannot open '%s'\n",
+            spots_filename);
+    exit(1);
+  }
+
+  n_spots = 0;
+  n_alloc = 64;
+  x = (double*) malloc(sizeof(double) * n_alloc);
+  y = (double*) malloc(sizeof(double) * n_alloc);
+  while (fgets(line, STRSZ, file) != NULL)
+  {
+    if (line[0] == '#') continue;
+    if (n_spots >= n_alloc)
+    {
+      n_alloc *= 2;
+      x = (double*) realloc(x, sizeof(double) * n_alloc);
+      y = (double*) realloc(y, sizeof(double) * n_alloc);
+    }
+    if (sscanf(line, "%lf %lf", x + n_spots, y + n_spots) == 2) n_spots++;
+  }
+  fclose(file);
+
+  measured = patt_kdtree_build(x, y, n_spots);
+  free(x);
+  free(y);
+  if (measured == NULL)
+  {
+    fprintf(stderr, "*** error (patt_match): allocation error\n");
+    exit(1);
+  }
+
+  /* enumerate and score candidates */
+  cand = patt_match_candidates(&pat, det_max, &n_cand);
+  if (cand == NULL)
+  {
+    fprintf(stderr, "*** error (patt_match): allocation error\n");
+    exit(1);
+  }
+
+  patt_match_score(&pat, measured, tol, cand, n_cand);
+  patt_match_sort(cand, n_cand);
+
+  printf("# %u measured spots, %u candidates (det <= %d)\n",
+         (unsigned int)n_spots, (unsigned int)n_cand, det_max);
+  printf("#  score  spots matched explained   rms  M11 M12 M21 M22  domains\n");
+  for (i_cand = 0; (i_cand < n_cand) && (i_cand < n_best); i_cand++)
+  {
+    printf("%8.4f %6u %7u %9u %5.2f  %3d %3d %3d %3d  %d\n",
+           cand[i_cand].score, (unsigned int)cand[i_cand].n_spots,
+           (unsigned int)cand[i_cand].n_matched,
+           (unsigned int)cand[i_cand].n_explained, cand[i_cand].rms,
+           cand[i_cand].M[0], cand[i_cand].M[1],
+           cand[i_cand].M[2], cand[i_cand].M[3], cand[i_cand].n_domains);
+    for (i_dom = 1; i_dom < cand[i_cand].n_domains; i_dom++)
+    {
+      printf("#%46s %3d %3d %3d %3d\n", "",
+             cand[i_cand].M_dom[i_dom][0], cand[i_cand].M_dom[i_dom][1],
+             cand[i_cand].M_dom[i_dom][2], cand[i_cand].M_dom[i_dom][3]);
+    }
+  }
+
+  free(cand);
+  patt_kdtree_free(measured);
+
+  return 0;
+}
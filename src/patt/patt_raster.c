@@ -0,0 +1,272 @@
+/****************************************************************************
+                        patt_raster.c
+FUNCTIONS
+	patt_raster_init - allocate RGB raster image.
+	patt_raster_draw_spots - draw list of spots into raster.
+	patt_raster_draw_pattern - draw GS and SS spots of pattern.
+	patt_raster_write_png - write raster as PNG file (libpng).
+
+DESCRIPTION
+	Raster backend for batch rendering of many patterns, e.g. for
+indexing experimental patterns against candidate superstructures. The
+spots are filled directly into an RGB buffer (one horizontal span per
+pixel row) instead of creating one vector path per spot. Spot indices,
+titles and vectors are not drawn.
+
+AUTHOR(S)
+	agent <agent@local>
+
+CHANGE-LOG
+2026-10-17/AG - initial implementation
+
+***************************************************************************/
+
+#include "patt_raster.h"
+#include "patt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <png.h>
+
+patt_raster_t *patt_raster_init(size_t width, size_t height)
+{
+  patt_raster_t *raster = (patt_raster_t*) malloc(sizeof(patt_raster_t));
+
+  if (raster == NULL) return NULL;
+
+  raster->pixels = (unsigned char*) malloc(sizeof(unsigned char) *
+                                           3 * width * height);
+  if (raster->pixels == NULL)
+  {
+    free(raster);
+    return NULL;
+  }
+
+  raster->width = width;
+  raster->height = height;
+
+  /* screen (radius MAX_RADIUS) plus 5% margin fits into the image */
+  raster->scale = ((width < height) ? width : height) / (2.1 * MAX_RADIUS);
+
+  patt_raster_clear(raster, &PATT_WHITE);
+
+  return raster;
+}
+
+void patt_raster_free(patt_raster_t *raster)
+{
+  if (raster == NULL) return;
+  free(raster->pixels);
+  free(raster);
+}
+
+void patt_raster_clear(patt_raster_t *raster, const patt_color_rgb_t *color)
+{
+  size_t i_pix, n_pix = raster->width * raster->height;
+  unsigned char rgb[3];
+
+  rgb[0] = (unsigned char)(255. * color->red + 0.5);
+  rgb[1] = (unsigned char)(255. * color->green + 0.5);
+  rgb[2] = (unsigned char)(255. * color->blue + 0.5);
+
+  for (i_pix = 0; i_pix < n_pix; i_pix++)
+  {
+    memcpy(raster->pixels + 3*i_pix, rgb, 3);
+  }
+}
+
+/* fill pixels x_min..x_max (drawing units) of pixel row j */
+static void patt_raster_span(patt_raster_t *raster, long j,
+                             double x_min, double x_max,
+                             const unsigned char *rgb)
+{
+  long i, i_min, i_max;
+  unsigned char *row;
+
+  if ( (j < 0) || (j >= (long)raster->height) ) return;
+
+  i_min = (long)ceil(x_min * raster->scale + 0.5*raster->width - 0.5);
+  i_max = (long)floor(x_max * raster->scale + 0.5*raster->width - 0.5);
+  if (i_min < 0) i_min = 0;
+  if (i_max >= (long)raster->width) i_max = (long)raster->width - 1;
+
+  row = raster->pixels + 3 * j * raster->width;
+  for (i = i_min; i <= i_max; i++)
+  {
+    memcpy(row + 3*i, rgb, 3);
+  }
+}
+
+/* draw single spot: disc (r_in = 0), ring or square */
+static void patt_raster_spot(patt_raster_t *raster, double x, double y,
+                             double r_out, double r_in, bool square,
+                             const unsigned char *rgb)
+{
+  long j, j_min, j_max;
+  double yj, dy, half_out, half_in;
+
+  /* pixel rows covered by the spot (y points up) */
+  j_min = (long)ceil(0.5*raster->height - (y + r_out) * raster->scale - 0.5);
+  j_max = (long)floor(0.5*raster->height - (y - r_out) * raster->scale - 0.5);
+
+  for (j = j_min; j <= j_max; j++)
+  {
+    yj = (0.5*raster->height - 0.5 - j) / raster->scale;
+    dy = fabs(yj - y);
+
+    if (square)
+    {
+      if ( (r_in > 0.) && (dy < r_in) )
+      {
+        patt_raster_span(raster, j, x - r_out, x - r_in, rgb);
+        patt_raster_span(raster, j, x + r_in, x + r_out, rgb);
+      }
+      else patt_raster_span(raster, j, x - r_out, x + r_out, rgb);
+      continue;
+    }
+
+    if (dy > r_out) continue;
+    half_out = sqrt(r_out*r_out - dy*dy);
+
+    if ( (r_in > 0.) && (dy < r_in) )
+    {
+      half_in = sqrt(r_in*r_in - dy*dy);
+      patt_raster_span(raster, j, x - half_out, x - half_in, rgb);
+      patt_raster_span(raster, j, x + half_in, x + half_out, rgb);
+    }
+    else patt_raster_span(raster, j, x - half_out, x + half_out, rgb);
+  }
+}
+
+void patt_raster_draw_spots(patt_raster_t *raster, const spots_t *spots,
+                            const patt_color_rgb_t *color)
+{
+  size_t i_spot;
+  double r_out, r_in;
+  bool square = (spots->shape != PATT_CIRCLE);
+  unsigned char rgb[3];
+
+  rgb[0] = (unsigned char)(255. * color->red + 0.5);
+  rgb[1] = (unsigned char)(255. * color->green + 0.5);
+  rgb[2] = (unsigned char)(255. * color->blue + 0.5);
+
+  /* keep spots visible: at least one pixel */
+  r_out = spots->radius;
+  if (r_out * raster->scale < 0.5) r_out = 0.5 / raster->scale;
+
+  if (square) r_out /= 1.4;
+
+  r_in = 0.;
+  if (!spots->fill)
+  {
+    r_in = r_out - ((spots->stroke_width > 1. / raster->scale) ?
+                    spots->stroke_width : 1. / raster->scale);
+    if (r_in < 0.) r_in = 0.;
+  }
+
+  for (i_spot = 0; i_spot < spots->n_spots; i_spot++)
+  {
+    patt_raster_spot(raster, spots->spots[i_spot].x, spots->spots[i_spot].y,
+                     r_out, r_in, square, rgb);
+  }
+}
+
+int patt_raster_draw_pattern(patt_raster_t *raster, const pattern_t *pat,
+                             size_t i_file)
+{
+  size_t i_dom, n_unique;
+  size_t *domains;
+  spots_t *spots;
+  const patt_color_rgb_t *color;
+
+  /* substrate spots */
+  spots = pattern_calculate_substrate_spots(pat);
+  if (spots == NULL) return -1;
+
+  spots->radius = RADIUS_GS;
+  color = patt_get_named_color((char*)colors[i_file % NUM_COLORS][SPOT_GS]);
+  patt_raster_draw_spots(raster, spots, color);
+  spots_free(spots);
+
+  /* superstructure spots: each set of equivalent domains only once */
+  domains = (size_t*) malloc(sizeof(size_t) * (pat->n_domains + 1));
+  if (domains == NULL) return -1;
+
+  n_unique = pattern_get_unique_domains(pat, domains);
+  color = patt_get_named_color((char*)colors[i_file % NUM_COLORS][SPOT_SS]);
+
+  for (i_dom = 0; i_dom < n_unique; i_dom++)
+  {
+    spots = pattern_calculate_superstructure_spots(pat, domains[i_dom]);
+    if (spots == NULL) continue;
+
+    spots->radius = RADIUS_SS;
+    spots->shape = (patt_shape_t)(i_dom % PATT_SHAPE_UNKNOWN);
+    patt_raster_draw_spots(raster, spots, color);
+    spots_free(spots);
+  }
+
+  free(domains);
+
+  return 0;
+}
+
+int patt_raster_write_png(const patt_raster_t *raster, const char *filename)
+{
+  FILE *file;
+  png_structp png_ptr;
+  png_infop info_ptr;
+  size_t j;
+
+  file = fopen(filename, "wb");
+  if (file == NULL)
+  {
+    fprintf(stderr, "*** error (patt_raster_write_png): "
+            "cannot open '%s'\n", filename);
+    return -1;
+  }
+
+  png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  if (png_ptr == NULL)
+  {
+    fclose(file);
+    return -1;
+  }
+
+  info_ptr = png_create_info_struct(png_ptr);
+  if (info_ptr == NULL)
+  {
+    png_destroy_write_struct(&png_ptr, NULL);
+    fclose(file);
+    return -1;
+  }
+
+  if (setjmp(png_jmpbuf(png_ptr)))
+  {
+    fprintf(stderr, "*** error (patt_raster_write_png): "
+            "failed to write '%s'\n", filename);
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    fclose(file);
+    return -1;
+  }
+
+  png_init_io(png_ptr, file);
+  png_set_IHDR(png_ptr, info_ptr,
+               (png_uint_32)raster->width, (png_uint_32)raster->height,
+               8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+               PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png_ptr, info_ptr);
+
+  for (j = 0; j < raster->height; j++)
+  {
+    png_write_row(png_ptr,
+                  (png_bytep)(raster->pixels + 3 * j * raster->width));
+  }
+
+  png_write_end(png_ptr, NULL);
+  png_destroy_write_struct(&png_ptr, &info_ptr);
+  fclose(file);
+
+  return 0;
+}
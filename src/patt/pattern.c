@@ -29,6 +29,9 @@ AUTHOR(S)
 
 CHANGE-LOG
 2014-07-13/LD - initial implementation
+2026-10-17/AG - single pass spot generation bounded to screen; 
+                detection of equivalent domains
+2026-10-17/AG - SS range of the multiple scattering spots from 2 r_max
 
 ***************************************************************************/
 
@@ -39,6 +42,7 @@ CHANGE-LOG
 #include <stdbool.h>
 #include <strings.h>
 #include <math.h>
+#include <float.h>
 
 
 pattern_t *pattern_alloc(size_t n_domains)
@@ -405,26 +409,64 @@ bool pattern_domain_is_commensurate(const pattern_t *pat, size_t domain)
   }
 }
 
-/*! \fn spots_t *pattern_calculate_substrate_spots(const pattern_t *pat)
- *  \brief Calculate LEED spots substrate 
+/*! \fn static void pattern_index_bounds(const double *b1, const double *b2,
+ *                                       double r_max, int *n1, int *n2)
+ *  \brief Bounds for the indices of lattice points within a disc.
+ *  \param *b1 First (reciprocal) lattice vector.
+ *  \param *b2 Second (reciprocal) lattice vector.
+ *  \param r_max Radius of the disc.
+ *  \param *n1 Maximum value of |n1| for points n1*b1 + n2*b2 within r_max.
+ *  \param *n2 Maximum value of |n2| for points n1*b1 + n2*b2 within r_max.
+ *
+ * The index n1 is the projection of the point onto the dual vector 
+ * of b1, i.e. |n1| <= r_max * |b2| / |b1 x b2| (and vice versa for n2).
+ */ 
+static void pattern_index_bounds(const double *b1, const double *b2, 
+                                 double r_max, int *n1, int *n2)
+{
+  double area = fabs(b1[0]*b2[1] - b1[1]*b2[0]);
+
+  if (area < DBL_EPSILON)
+  {
+    *n1 = *n2 = 0;
+    return;
+  }
+  
+  *n1 = (int)ceil(r_max * sqrt(b2[0]*b2[0] + b2[1]*b2[1]) / area);
+  *n2 = (int)ceil(r_max * sqrt(b1[0]*b1[0] + b1[1]*b1[1]) / area);
+}
+
+/*! \fn static bool pattern_spot_on_screen(const pattern_t *pat, 
+ *                                         double x, double y)
+ *  \brief Check whether position is within the valid area of the pattern.
  *  \param *pat Pointer to pattern_t structure.
+ *  \param x x position of spot.
+ *  \param y y position of spot.
+ *  \return true if (x, y) is within the disc (or square) of MAX_RADIUS.
+ */ 
+static bool pattern_spot_on_screen(const pattern_t *pat, double x, double y)
+{
+  if (pattern_is_square(pat))
+    return ( (fabs(x) <= MAX_RADIUS) && (fabs(y) <= MAX_RADIUS) );
+  else
+    return ( (x*x + y*y) <= MAX_RADIUS*MAX_RADIUS );
+}
+
+/*! \fn static void pattern_get_reciprocal_vectors(const pattern_t *pat, 
+ *                                                 double *a1, double *a2)
+ *  \brief Substrate (GS) reciprocal lattice vectors in drawing units.
+ *  \param *pat Pointer to pattern_t structure.
+ *  \param *a1 First reciprocal lattice vector (output).
+ *  \param *a2 Second reciprocal lattice vector (output).
  *
+ * The vectors are scaled such that the longer real space vector 
+ * corresponds to a distance of MAX_RADIUS / radius.
  */ 
-spots_t *pattern_calculate_substrate_spots(const pattern_t *pat)
+static void pattern_get_reciprocal_vectors(const pattern_t *pat, 
+                                           double *a1, double *a2)
 {
-  spots_t *spots;
-  double a1[2];
-  double a2[2];
-  double xi, yi;
   double radius = pat->radius;
-  /* double spot_radius = SPOT_GS; */
   
-  int h, k, h_max, k_max;
-  size_t i_spot = 0, n_spots = 0;
-
-  /* scale spot sizes by radius */
-  /* if (rg_flag == true) spot_radius /= radius; */
- 
   if( (pat->a1.x*pat->a1.x + pat->a1.y*pat->a1.y) > 
             (pat->a2.x*pat->a2.x + pat->a2.y*pat->a2.y))
   {
@@ -442,48 +484,77 @@ spots_t *pattern_calculate_substrate_spots(const pattern_t *pat)
   a1[1] = -radius*pat->a2.x;
   a2[0] = -radius*pat->a1.y;
   a2[1] =  radius*pat->a1.x;
+}
+
+/*! \fn static size_t pattern_estimate_n_spots(const double *b1, 
+ *                                             const double *b2)
+ *  \brief Estimated number of lattice points within the screen.
+ *
+ * Screen area divided by the unit cell area plus a margin for the 
+ * boundary, used as the initial size of the spot list.
+ */ 
+static size_t pattern_estimate_n_spots(const double *b1, const double *b2)
+{
+  double area = fabs(b1[0]*b2[1] - b1[1]*b2[0]);
+  double len = sqrt(b1[0]*b1[0] + b1[1]*b1[1]) + 
+               sqrt(b2[0]*b2[0] + b2[1]*b2[1]);
+  
+  if (area < DBL_EPSILON) return 1;
+  
+  /* square screen area (4 R^2) includes the disc (pi R^2) */
+  return (size_t)( (4.*MAX_RADIUS*MAX_RADIUS + 8.*MAX_RADIUS*len) / area ) + 1;
+}
+
+/*! \fn spots_t *pattern_calculate_substrate_spots(const pattern_t *pat)
+ *  \brief Calculate LEED spots substrate 
+ *  \param *pat Pointer to pattern_t structure.
+ *
+ * Single pass over the index range which can reach the screen 
+ * (see pattern_index_bounds), the list grows with spots_append
+ * if the initial estimate is exceeded.
+ */ 
+spots_t *pattern_calculate_substrate_spots(const pattern_t *pat)
+{
+  spots_t *spots;
+  spot_t spot;
+  double a1[2];
+  double a2[2];
+  double r_max;
+  
+  int h, k, h_max, k_max;
+
+  pattern_get_reciprocal_vectors(pat, a1, a2);
   
   #if (DEBUG == 1)
   printf("a1: %.1f %.1f\n", a1[0], a1[1]);
   printf("a2: %.1f %.1f\n", a2[0], a2[1]);
   #endif 
  
-  /* define max. values */
-  h_max = 5 * (int)( MAX_RADIUS / sqrt(a1[0]*a1[0] + a1[1]*a1[1]) );
-  k_max = 5 * (int)( MAX_RADIUS / sqrt(a2[0]*a2[0] + a2[1]*a2[1]) );
+  /* define max. values (corners of square screen) */
+  r_max = (pattern_is_square(pat)) ? MAX_RADIUS*M_SQRT2 : MAX_RADIUS;
+  pattern_index_bounds(a1, a2, r_max, &h_max, &k_max);
   
-  /* first pass to calculate number of spots */
-  for (h = -h_max; h <= h_max; h ++)
-  {
-    for (k = -k_max; k <= k_max; k ++)
-    {
-      xi = h * a1[0] + k * a2[0];
-      yi = h * a1[1] + k * a2[1];
-      if ( ((xi*xi + yi*yi) <= MAX_RADIUS*MAX_RADIUS) || 
-            (pattern_is_square(pat))) n_spots++;
-    }
-  }
   /* initialise spots */
-  spots = spots_init(n_spots);
+  spots = spots_init(pattern_estimate_n_spots(a1, a2));
   if (spots == NULL) return NULL;
+  spots->n_spots = 0;
+  
+  spot.label = NULL;
+  spot.index.l = 0.;
   
   /* calculate substrate spots */
   for (h = -h_max; h <= h_max; h ++)
   {
     for (k = -k_max; k <= k_max; k ++)
     {
-      xi = h * a1[0] + k * a2[0];
-      yi = h * a1[1] + k * a2[1];
-      if ( ((xi*xi + yi*yi) <= MAX_RADIUS*MAX_RADIUS) || 
-            (pattern_is_square(pat)))
+      spot.x = h * a1[0] + k * a2[0];
+      spot.y = h * a1[1] + k * a2[1];
+      if (pattern_spot_on_screen(pat, spot.x, spot.y))
       {
-        spots->spots[i_spot].index.h = h;
-        spots->spots[i_spot].index.k = k;
-        spots->spots[i_spot].x = xi;
-        spots->spots[i_spot].y = yi;
-        i_spot++;
+        spot.index.h = h;
+        spot.index.k = k;
+        spots_append(spots, spot);
       }
-        
     }
   }
   
@@ -491,67 +562,42 @@ spots_t *pattern_calculate_substrate_spots(const pattern_t *pat)
   
 }
 
-spots_t *calculate_superstructure_spots(const pattern_t *pat, size_t domain)
+/*! \fn spots_t *pattern_calculate_superstructure_spots(const pattern_t *pat, 
+ *                                                      size_t domain)
+ *  \brief Calculate LEED spots of superstructure domain.
+ *  \param *pat Pointer to pattern_t structure.
+ *  \param domain Index of the superstructure domain.
+ *
+ * Single pass over the SS index range which can reach the screen.
+ * For incommensurate superstructures the multiple scattering spots
+ * (GS + SS) are added in the same way; as GS and GS + SS are both on
+ * the screen, the SS range of these spots is bounded by 2 r_max.
+ */ 
+spots_t *pattern_calculate_superstructure_spots(const pattern_t *pat, 
+                                                size_t domain)
 {
   spots_t *spots;
+  spot_t spot;
   double a1[2], a2[2];                /* substrate basis vectors */
   double b1[2], b2[2];                /* superstructure basis vectors */
   double xi, yi;
-  double x=0, y=0;
-  double aux1, aux2;
-  float det;                          /* Det of SS-matrix */
-  int det_int;                        /* Det of SS-matrix */
-  int smax_1, smax_2;
-  double ind_1, ind_2;                /* SS index */
-  double ind_1_int, ind_2_int;        /* SS index */
+  double aux1;
+  double det;                         /* Det of SS-matrix */
   double m11, m12, m21, m22;
-  double radius = pat->radius;
-  double spot_radius = SPOT_GS;
+  double r_max;
   bool commensurate;
   
   int h, k, h_max, k_max;
-  int s1, s2, s_max1, s_max2;
-  size_t i_spot = 0, n_spots = 0;
-  
-  int imax_1, imax_2;
+  int s1, s2, smax_1, smax_2;
+  int ms_max1, ms_max2;
   
-  bool rs_flag = false;
-
-  if (domain > pat->n_domains) 
+  if (domain >= pat->n_domains) 
   {
     return NULL; /* invalid domain index */
   }
   
-  /* scale spot sizes by radius */
-  if (rs_flag == true)
-    spot_radius /= radius;
- 
-  if( (pat->a1.x*pat->a1.x + pat->a1.y*pat->a1.y) > 
-            (pat->a2.x*pat->a2.x + pat->a2.y*pat->a2.y))
-  {
-    radius *= sqrt(pat->a1.x*pat->a1.x + pat->a1.y*pat->a1.y);
-  }
-  else
-  {
-    radius *= sqrt(pat->a2.x*pat->a2.x + pat->a2.y*pat->a2.y);
-  }
-  
-  radius = MAX_RADIUS / radius;
+  pattern_get_reciprocal_vectors(pat, a1, a2);
 
-  /* calculate GS vectors */
-  a1[0] =  radius*pat->a2.y;
-  a1[1] = -radius*pat->a2.x;
-  a2[0] = -radius*pat->a1.y;
-  a2[1] =  radius*pat->a1.x;
-
-  /* define max. values */
-  h_max = 5 * (int)( MAX_RADIUS / sqrt(a1[0]*a1[0] + a1[1]*a1[1]) );
-  k_max = 5 * (int)( MAX_RADIUS / sqrt(a2[0]*a2[0] + a2[1]*a2[1]) );
-
-  /*
-   * SS SPOT
-   */
-   
   /* set local superstructure matrix elements */
   m11 = pat->M_SS[domain].M11;
   m12 = pat->M_SS[domain].M12;
@@ -563,8 +609,8 @@ spots_t *calculate_superstructure_spots(const pattern_t *pat, size_t domain)
 
   /* determinant of matrix */
   det  = m11*m22 - m12*m21;
+  if (fabs(det) < DBL_EPSILON) return NULL;
   aux1 = 1/det;
-  det = fabs(det);
 
   /* calculate SS vectors */
   b1[0] = aux1 *(m22*a1[0] - m21*a2[0]);
@@ -572,107 +618,78 @@ spots_t *calculate_superstructure_spots(const pattern_t *pat, size_t domain)
   b2[0] = aux1 *(m11*a2[0] - m12*a1[0]);
   b2[1] = aux1 *(m11*a2[1] - m12*a1[1]);
 
+  /* define max. values */
+  r_max = (pattern_is_square(pat)) ? MAX_RADIUS*M_SQRT2 : MAX_RADIUS;
+  pattern_index_bounds(b1, b2, r_max, &smax_1, &smax_2);
+
+  spots = spots_init(pattern_estimate_n_spots(b1, b2));
+  if (spots == NULL) return NULL;
+  spots->n_spots = 0;
+  
+  spot.label = NULL;
+  spot.index.l = 0.;
+
   /* 
    * SS spots 
    */
-   
-  /* define max. values */
-  smax_1 = 5* (int)( MAX_RADIUS / sqrt(b1[0]*b1[0] + b1[1]*b1[1]) );
-  smax_2 = 5* (int)( MAX_RADIUS / sqrt(b2[0]*b2[0] + b2[1]*b2[1]) );
-
-  /* determine number of spots */
-  for (s1 = -smax_1; s1 < smax_1; s1 ++)
+  for (s1 = -smax_1; s1 <= smax_1; s1 ++)
   {
-    for (s2 = -smax_2; s2 < smax_2; s2 ++)
+    for (s2 = -smax_2; s2 <= smax_2; s2 ++)
     {
-      if (((x*x + y*y) <= MAX_RADIUS*MAX_RADIUS) || (pattern_is_square(pat)))
+      spot.x = s1 * b1[0] + s2 * b2[0];
+      spot.y = s1 * b1[1] + s2 * b2[1];
+      if (pattern_spot_on_screen(pat, spot.x, spot.y))
       {
-        n_spots++;
+        /* indices in units of the GS reciprocal lattice */
+        spot.index.h = (s1*m22 - s2*m12) * aux1;
+        spot.index.k = (s2*m11 - s1*m21) * aux1;
+        spots_append(spots, spot);
       }
     }
   }
   
-  if (!commensurate)
-  {
-  
-    /* write SS spot positions to output */
-    for (s1 = -smax_1; s1 < smax_1; s1 ++)
-    {
-      for (s2 = -smax_2; s2 < smax_2; s2 ++)
-      {
-        x = s1 * b1[0] + s2 * b2[0];
-        y = s1 * b1[1] + s2 * b2[1];
-        if ( ((x*x + y*y) <= MAX_RADIUS*MAX_RADIUS) || (pattern_is_square(pat))) 
-        {
-
-          ind_1 = (s1*m22 - s2*m12);
-          ind_2 = (s2*m11 - s1*m21);
-          /*
-           * write indices
-           */
-
-          spots->spots[i_spot].index.h = ind_1;
-          spots->spots[i_spot].index.k = ind_2;
-          spots->spots[i_spot].x = x;
-          spots->spots[i_spot].y = y;
-          i_spot++;
-        }
- 
-      }
-    }
-  
-  }
 /* 
  * If the Mii are not integer, the superstructure is incommensurate.
  * In this case the multiple scattering spots must be calculated
  * separately.
  */
-
   if (!commensurate)
   {
+    pattern_index_bounds(a1, a2, r_max, &h_max, &k_max);
+    pattern_index_bounds(b1, b2, 2.*r_max, &ms_max1, &ms_max2);
+    
     /* add multiple scattering SS spots to list */
     for (h = -h_max; h <= h_max; h ++)
     {
       for (k = -k_max; k <= k_max; k ++)
       {
-        if( (h != 0) || (k != 0) )
+        if( (h == 0) && (k == 0) ) continue;
+        
+        xi = h * a1[0] + k * a2[0];
+        yi = h * a1[1] + k * a2[1];
+        
+        if (!pattern_spot_on_screen(pat, xi, yi)) continue;
+        
+        for (s1 = -ms_max1; s1 <= ms_max1; s1 ++)
         {
-          xi = h * a1[0] + k * a2[0];
-          yi = h * a1[1] + k * a2[1];
-          
-          if( (xi*xi + yi*yi) <= MAX_RADIUS*MAX_RADIUS) 
+          for (s2 = -ms_max2; s2 <= ms_max2; s2 ++)
           {
-            for (s1 = -smax_1; s1 < smax_1; s1 ++)
+            if ( (s1 == 0) && (s2 == 0) ) continue;
+            
+            spot.x = xi + s1 * b1[0] + s2 * b2[0];
+            spot.y = yi + s1 * b1[1] + s2 * b2[1];
+            
+            if (pattern_spot_on_screen(pat, spot.x, spot.y))
             {
-              for (s2 = -smax_2; s2 < smax_2; s2 ++)
-              {
-                x = xi + s1 * b1[0] + s2 * b2[0];
-                y = yi + s1 * b1[1] + s2 * b2[1];
-              
-                if( ((x*x + y*y) <= MAX_RADIUS*MAX_RADIUS) &&
-                    ((s1 != 0) || (s2 != 0)) )
-                {
-                  spots->spots[i_spot].index.h = h;
-                  spots->spots[i_spot].index.k = k;
-                  spots->spots[i_spot].x = x;
-                  spots->spots[i_spot].y = y;
-                  i_spot++;
-                  
-                /*
-                  fprintf(out_stream, " %.1f %.1f %.1f 0 360 "
-                          "arc gsave %s %s grestore stroke\n", 
-                          x, y, spot_ss, ps_color(color_flag, ii, 
-                          ifiles, SPOT_SS, i_dom), fill_ss);
-                */
-                }
-        
-              } /* for s2 */
-            } /* for s1 */
-          }  /* if < MAX_RADIUS */
-        }   /* if != 0  */
-      }    /* for i1/2 */
-    }
-  }     /* if fabs .. */
+              spot.index.h = h;
+              spot.index.k = k;
+              spots_append(spots, spot);
+            }
+          } /* for s2 */
+        } /* for s1 */
+      } /* for k */
+    } /* for h */
+  } /* if !commensurate */
   #if (DEBUG == 1)
   else printf("commensurate\n");
   #endif
@@ -681,6 +698,79 @@ spots_t *calculate_superstructure_spots(const pattern_t *pat, size_t domain)
   
 }
 
+/*! \fn bool pattern_domains_are_equivalent(const pattern_t *pat, 
+ *                                          size_t i_dom, size_t j_dom)
+ *  \brief Check whether two domains produce the same spots.
+ *  \param *pat Pointer to pattern_t structure.
+ *  \param i_dom Index of first domain.
+ *  \param j_dom Index of second domain.
+ *  \return true if the superstructure lattices of both domains coincide.
+ *
+ * The lattices M_i * a and M_j * a are identical if M_i = U * M_j with
+ * an integer matrix U of determinant +/-1, i.e. the spots (and the 
+ * multiple scattering spots) of domain j are a repetition of domain i.
+ */ 
+bool pattern_domains_are_equivalent(const pattern_t *pat, 
+                                    size_t i_dom, size_t j_dom)
+{
+  const matrix_2x2_t *mi, *mj;
+  double det, u11, u12, u21, u22;
+  
+  if ( (i_dom >= pat->n_domains) || (j_dom >= pat->n_domains) ) return false;
+  if (i_dom == j_dom) return true;
+  
+  mi = &pat->M_SS[i_dom];
+  mj = &pat->M_SS[j_dom];
+  
+  det = mj->M11*mj->M22 - mj->M12*mj->M21;
+  if (fabs(det) < DBL_EPSILON) return false;
+  
+  /* U = M_i * M_j^-1 */
+  u11 = ( mi->M11*mj->M22 - mi->M12*mj->M21) / det;
+  u12 = (-mi->M11*mj->M12 + mi->M12*mj->M11) / det;
+  u21 = ( mi->M21*mj->M22 - mi->M22*mj->M21) / det;
+  u22 = (-mi->M21*mj->M12 + mi->M22*mj->M11) / det;
+  
+  #define PATT_IS_INT(x) (fabs((x) - floor((x) + 0.5)) < 1.e-4)
+  
+  if (!PATT_IS_INT(u11) || !PATT_IS_INT(u12) || 
+      !PATT_IS_INT(u21) || !PATT_IS_INT(u22)) return false;
+  
+  det = u11*u22 - u12*u21;
+  
+  #undef PATT_IS_INT
+  
+  return (fabs(fabs(det) - 1.) < 1.e-4);
+}
+
+/*! \fn size_t pattern_get_unique_domains(const pattern_t *pat, 
+ *                                        size_t *domains)
+ *  \brief List the domains which produce distinct spots.
+ *  \param *pat Pointer to pattern_t structure.
+ *  \param *domains Array of at least pat->n_domains elements (output):
+ *  index of the first equivalent domain for each unique domain.
+ *  \return Number of unique domains.
+ *
+ * Domains generated by symmetry operations frequently reproduce the 
+ * same lattice (e.g. a rotation by 180 deg); their spots need to be 
+ * calculated and drawn only once.
+ */ 
+size_t pattern_get_unique_domains(const pattern_t *pat, size_t *domains)
+{
+  size_t i_dom, j_unique, n_unique = 0;
+  
+  for (i_dom = 0; i_dom < pat->n_domains; i_dom++)
+  {
+    for (j_unique = 0; j_unique < n_unique; j_unique++)
+    {
+      if (pattern_domains_are_equivalent(pat, domains[j_unique], i_dom)) break;
+    }
+    if (j_unique == n_unique) domains[n_unique++] = i_dom;
+  }
+  
+  return n_unique;
+}
+
 bool pattern_is_square(const pattern_t *pat)
 {
   return pat->square;
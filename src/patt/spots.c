@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include <strings.h>
 #include <math.h>
 
@@ -13,7 +14,7 @@ spots_t *spots_alloc(size_t n_spots)
   }
   if (n_spots > 0)
   {
-    spots->spots = (spot_t *) malloc(sizeof(spot_t) * n_spots+1);
+    spots->spots = (spot_t *) malloc(sizeof(spot_t) * (n_spots+1));
     if (spots->spots == NULL)
     {
       free(spots);
@@ -34,7 +35,7 @@ spots_t *spots_init(size_t n_spots)
   
   spots->fill = true;
   spots->visible = false;
-  spots->color = PATT_COLOR;
+  spots->color = PATT_BLACK;
   spots->shape = PATT_CIRCLE;
   spots->stroke_width = RADIUS_GS/10.;
   spots->stroke_style = PATT_SOLID_STROKE;
@@ -48,13 +49,13 @@ spots_t *spots_init(size_t n_spots)
 
 int spots_list_realloc(spots_t *spots, size_t size)
 {
-  spot_t *temp = spots->spots;
+  spot_t *temp = (spot_t*) realloc(spots->spots, sizeof(spot_t)*size);
   
-  if ((spot_t*) realloc(spots->spots, sizeof(spot_t)*size) == NULL)
+  if (temp == NULL)
   {
-    spots->spots = temp;
     return -3;
   }
+  spots->spots = temp;
   
   if (size < spots->n_spots)
   {
@@ -97,7 +98,7 @@ void spots_set_list(spots_t *spots, spot_t *spot, size_t n_spots)
 
 }
 
-void spots_set_color(spots_t *spots, int color)
+void spots_set_color(spots_t *spots, patt_color_rgb_t color)
 {
   spots->color = color;
 }
@@ -106,7 +107,7 @@ void spots_set_fill(spots_t *spots, bool fill)
 {
   spots->fill = fill;
 }
-void spots_set_shape(spots_t *spots, int shape)
+void spots_set_shape(spots_t *spots, patt_shape_t shape)
 {
   spots->shape = shape;
 }
@@ -141,59 +142,59 @@ void spots_set_visible(spots_t *spots, bool visible)
   spots->visible = visible;
 }
 
-int spots_get_color(spots_t *spots)
+patt_color_rgb_t *spots_get_color(const spots_t *spots)
 {
-  return spots->color;
+  return (patt_color_rgb_t *)&spots->color;
 }
 
-bool spots_get_fill(spots_t *spots)
+bool spots_get_fill(const spots_t *spots)
 {
   return spots->fill;
 }
 
-bool spots_get_visible(spots_t *spots)
+bool spots_get_visible(const spots_t *spots)
 {
   return spots->visible;
 }
 
-int spots_get_shape(spots_t *spots)
+patt_shape_t *spots_get_shape(const spots_t *spots)
 {
-  return spots->shape;
+  return (patt_shape_t *)&spots->shape;
 }
 
-int spots_get_stroke_style(spots_t *spots)
+patt_stroke_t *spots_get_stroke_style(const spots_t *spots)
 {
-  return spots->stroke_style;
+  return (patt_stroke_t *)&spots->stroke_style;
 }
 
-double spots_get_stroke_width(spots_t *spots)
+double spots_get_stroke_width(const spots_t *spots)
 {
   return spots->stroke_width;
 }
 
-double spots_get_font_size(spots_t *spots)
+double spots_get_font_size(const spots_t *spots)
 {
   return spots->font_size;
 }
 
-const char* spots_get_font_name(spots_t *spots)
+const char* spots_get_font_name(const spots_t *spots)
 {
   char *name = (char*)malloc(sizeof(char) * strlen(spots->font_name));
   strcpy(name, spots->font_name);
   return (const char*)name;
 }
 
-double spots_get_radius(spots_t *spots)
+double spots_get_radius(const spots_t *spots)
 {
   return spots->radius;
 }
 
-size_t spots_get_n_spots(spots_t *spots)
+size_t spots_get_n_spots(const spots_t *spots)
 {
   return spots->n_spots;
 }
 
-const spot_t *spots_get_list(spots_t *spots)
+const spot_t *spots_get_list(const spots_t *spots)
 {
   const spot_t* list = spots->spots;
   return list;
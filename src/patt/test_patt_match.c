@@ -0,0 +1,197 @@
+/****************************************************************************
+                        test_patt_match.c
+FUNCTIONS
+	test_kdtree - patt_kdtree_nearest against a brute force search.
+	test_candidates - number of domains found by patt_match_candidates.
+	test_score - patt_match_score for a (sqrt3 x sqrt3)R30 structure.
+	main - run all checks.
+
+DESCRIPTION
+	patt_kdtree_nearest must find the same distances as a brute force
+search. patt_match_candidates must find each superlattice with
+2 <= |det M| <= det_max exactly once among the domains of all candidates,
+i.e. the total number of domains is the number of HNF matrices, sigma(det).
+The spots of a (sqrt3 x sqrt3)R30 structure must be matched best (score 1)
+by the candidate they were generated from.
+	The results must be the same with and without -fopenmp -D_USE_OPENMP.
+
+RETURNS
+	0: all checks pass
+	1: at least one check failed (details on stdout)
+
+AUTHOR(S)
+	agent <agent@local>
+
+CHANGE-LOG
+2026-10-17/AG - initial implementation
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "patt_match.h"
+#include "patt.h"
+
+#define N_POINTS 500                /* points of the k-d tree test */
+#define N_QUERY  2000               /* queries of the k-d tree test */
+#define DET_MAX  4                  /* max. determinant of candidates */
+
+static double rnd(void)
+{
+  return 2. * rand() / (double)RAND_MAX - 1.;
+}
+
+static int test_kdtree(void)
+{
+  double x[N_POINTS], y[N_POINTS];
+  double qx, qy, dist, d2, d2_min;
+  size_t i, i_q, i_near;
+  int n_fail = 0;
+  patt_kdtree_t *tree;
+
+  srand(1);
+  for (i = 0; i < N_POINTS; i++)
+  {
+    x[i] = rnd();
+    y[i] = rnd();
+  }
+  tree = patt_kdtree_build(x, y, N_POINTS);
+
+  for (i_q = 0; i_q < N_QUERY; i_q++)
+  {
+    qx = 1.2 * rnd();
+    qy = 1.2 * rnd();
+
+    d2_min = DBL_MAX;
+    for (i = 0; i < N_POINTS; i++)
+    {
+      d2 = (x[i] - qx)*(x[i] - qx) + (y[i] - qy)*(y[i] - qy);
+      if (d2 < d2_min) d2_min = d2;
+    }
+
+    i_near = patt_kdtree_nearest(tree, qx, qy, &dist);
+    if ( (i_near >= N_POINTS) || (fabs(dist - sqrt(d2_min)) > 1.e-12) ||
+         (fabs(hypot(x[i_near] - qx, y[i_near] - qy) - dist) > 1.e-12) )
+      n_fail++;
+  }
+  patt_kdtree_free(tree);
+
+  printf("k-d tree: %d queries, %d wrong %s\n", N_QUERY, n_fail,
+         (n_fail) ? "FAILED" : "ok");
+  return (n_fail);
+}
+
+static int test_candidates(const pattern_t *pat)
+{
+  size_t i_cand, n_cand;
+  int det, a, n_hnf = 0, n_dom = 0;
+  patt_candidate_t *cand;
+
+  /* number of HNF matrices: sum of divisors of det */
+  for (det = 2; det <= DET_MAX; det++)
+    for (a = 1; a <= det; a++)
+      if (det % a == 0) n_hnf += a;
+
+  cand = patt_match_candidates(pat, DET_MAX, &n_cand);
+  if (cand == NULL)
+  {
+    printf("candidates: allocation error FAILED\n");
+    return 1;
+  }
+  for (i_cand = 0; i_cand < n_cand; i_cand++)
+    n_dom += cand[i_cand].n_domains;
+  free(cand);
+
+  printf("candidates (det <= %d): %u, %d domains (HNF: %d) %s\n", DET_MAX,
+         (unsigned int)n_cand, n_dom, n_hnf, (n_dom == n_hnf) ? "ok" : "FAILED");
+  return (n_dom != n_hnf);
+}
+
+static int test_score(const pattern_t *pat)
+{
+  pattern_t pat_r3;
+  matrix_2x2_t M_r3 = {1., 1., -1., 2.};  /* (sqrt3 x sqrt3)R30 */
+  spots_t *spots;
+  patt_kdtree_t *measured;
+  patt_candidate_t *cand;
+  size_t i, n_cand;
+  double *x, *y;
+  int det, n_fail = 0;
+
+  /* measured spots: all spots of the (sqrt3 x sqrt3)R30 structure */
+  memcpy(&pat_r3, pat, sizeof(pattern_t));
+  pat_r3.M_SS = &M_r3;
+  pat_r3.n_domains = 1;
+  spots = pattern_calculate_superstructure_spots(&pat_r3, 0);
+  if (spots == NULL)
+  {
+    printf("score: no spots FAILED\n");
+    return 1;
+  }
+
+  x = (double*) malloc(sizeof(double) * (spots->n_spots + 1));
+  y = (double*) malloc(sizeof(double) * (spots->n_spots + 1));
+  for (i = 0; i < spots->n_spots; i++)
+  {
+    x[i] = spots->spots[i].x;
+    y[i] = spots->spots[i].y;
+  }
+  measured = patt_kdtree_build(x, y, spots->n_spots);
+
+  cand = patt_match_candidates(pat, DET_MAX, &n_cand);
+  if ( (measured == NULL) || (cand == NULL) ||
+       (patt_match_score(pat, measured, RADIUS_SS, cand, n_cand) < 0) )
+  {
+    printf("score: failed FAILED\n");
+    n_fail++;
+  }
+  else
+  {
+    patt_match_sort(cand, n_cand);
+    det = abs(cand[0].M[0]*cand[0].M[3] - cand[0].M[1]*cand[0].M[2]);
+    if ( (det != 3) || (cand[0].n_domains != 1) ||
+         (fabs(cand[0].score - 1.) > 1.e-12) ||
+         (cand[0].n_spots != spots->n_spots) ||
+         ( (n_cand > 1) && (cand[1].score >= cand[0].score) ) )
+      n_fail++;
+
+    printf("score: %u spots, best %d %d %d %d (score %.4f, next %.4f) %s\n",
+           (unsigned int)spots->n_spots,
+           cand[0].M[0], cand[0].M[1], cand[0].M[2], cand[0].M[3],
+           cand[0].score, (n_cand > 1) ? cand[1].score : 0.,
+           (n_fail) ? "FAILED" : "ok");
+  }
+
+  free(cand);
+  patt_kdtree_free(measured);
+  free(x);
+  free(y);
+  spots_free(spots);
+  return (n_fail);
+}
+
+int main()
+{
+  int n_fail = 0;
+  pattern_t pat;
+
+  /* hexagonal substrate */
+  memset(&pat, 0, sizeof(pattern_t));
+  pat.a1.x = 1.;
+  pat.a1.y = 0.;
+  pat.a2.x = 0.5;
+  pat.a2.y = sqrt(3.) / 2.;
+  pat.radius = 1.;
+  pat.square = false;
+
+  n_fail += test_kdtree();
+  n_fail += test_candidates(&pat);
+  n_fail += test_score(&pat);
+
+  printf("%s\n", (n_fail) ? "FAILED" : "all tests passed");
+  return (n_fail) ? 1 : 0;
+}
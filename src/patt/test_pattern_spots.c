@@ -0,0 +1,236 @@
+/****************************************************************************
+                        test_pattern_spots.c
+FUNCTIONS
+	main - compare pattern_calculate_superstructure_spots with the
+	       enumeration used before the bounded index ranges.
+
+DESCRIPTION
+	The reference enumeration takes the SS indices |s_i| <= 5 R / |b_i|
+and the GS indices |h| <= 5 R / |a_1|, |k| <= 5 R / |a_2| and keeps each
+spot which is on the screen. For incommensurate superstructures both must
+give the same spots (position and index), including the multiple
+scattering spots GS + SS with R < |SS| <= 2R.
+
+RETURNS
+	0: the spot lists agree
+	1: a spot list differs (details on stdout/stderr)
+
+AUTHOR(S)
+	agent <agent@local>
+
+CHANGE-LOG
+2026-10-17/AG - initial implementation
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "pattern.h"
+#include "patt.h"
+
+#define EPS 1.e-9
+
+typedef struct
+{
+  double x, y, h, k;
+} ref_spot_t;
+
+static int ref_cmp(const void *p1, const void *p2)
+{
+  const ref_spot_t *a = (const ref_spot_t *)p1;
+  const ref_spot_t *b = (const ref_spot_t *)p2;
+
+  if (fabs(a->x - b->x) > EPS) return (a->x < b->x) ? -1 : 1;
+  if (fabs(a->y - b->y) > EPS) return (a->y < b->y) ? -1 : 1;
+  if (fabs(a->h - b->h) > EPS) return (a->h < b->h) ? -1 : 1;
+  if (fabs(a->k - b->k) > EPS) return (a->k < b->k) ? -1 : 1;
+  return 0;
+}
+
+static int on_screen(double x, double y)
+{
+  return ( (x*x + y*y) <= MAX_RADIUS*MAX_RADIUS );
+}
+
+static void add_spot(ref_spot_t **list, size_t *n, size_t *n_max,
+                     double x, double y, double h, double k)
+{
+  if (*n >= *n_max)
+  {
+    *n_max = 2 * (*n_max) + 64;
+    *list = (ref_spot_t *) realloc(*list, *n_max * sizeof(ref_spot_t));
+  }
+  (*list)[*n].x = x;
+  (*list)[*n].y = y;
+  (*list)[*n].h = h;
+  (*list)[*n].k = k;
+  (*n)++;
+}
+
+/*
+ * Old enumeration (circular screen): returns the number of spots in
+ * *p_list and the number of MS spots with |SS| > R in *p_n_far.
+ */
+static size_t old_spots(const pattern_t *pat, ref_spot_t **p_list,
+                        size_t *p_n_far)
+{
+  double a1[2], a2[2], b1[2], b2[2];
+  double radius, aux1, xi, yi, x, y;
+  double m11, m12, m21, m22;
+  int h, k, h_max, k_max, s1, s2, smax_1, smax_2;
+  size_t n = 0, n_max = 0;
+
+  /* GS vectors as in pattern_get_reciprocal_vectors */
+  radius = pat->radius;
+  if( (pat->a1.x*pat->a1.x + pat->a1.y*pat->a1.y) >
+            (pat->a2.x*pat->a2.x + pat->a2.y*pat->a2.y))
+    radius *= sqrt(pat->a1.x*pat->a1.x + pat->a1.y*pat->a1.y);
+  else
+    radius *= sqrt(pat->a2.x*pat->a2.x + pat->a2.y*pat->a2.y);
+  radius = MAX_RADIUS / radius;
+
+  a1[0] =  radius*pat->a2.y;
+  a1[1] = -radius*pat->a2.x;
+  a2[0] = -radius*pat->a1.y;
+  a2[1] =  radius*pat->a1.x;
+
+  h_max = 5 * (int)( MAX_RADIUS / sqrt(a1[0]*a1[0] + a1[1]*a1[1]) );
+  k_max = 5 * (int)( MAX_RADIUS / sqrt(a2[0]*a2[0] + a2[1]*a2[1]) );
+
+  m11 = pat->M_SS[0].M11;
+  m12 = pat->M_SS[0].M12;
+  m21 = pat->M_SS[0].M21;
+  m22 = pat->M_SS[0].M22;
+  aux1 = 1. / (m11*m22 - m12*m21);
+
+  b1[0] = aux1 *(m22*a1[0] - m21*a2[0]);
+  b1[1] = aux1 *(m22*a1[1] - m21*a2[1]);
+  b2[0] = aux1 *(m11*a2[0] - m12*a1[0]);
+  b2[1] = aux1 *(m11*a2[1] - m12*a1[1]);
+
+  smax_1 = 5 * (int)( MAX_RADIUS / sqrt(b1[0]*b1[0] + b1[1]*b1[1]) );
+  smax_2 = 5 * (int)( MAX_RADIUS / sqrt(b2[0]*b2[0] + b2[1]*b2[1]) );
+
+  *p_list = NULL;
+  *p_n_far = 0;
+
+  /* SS spots */
+  for (s1 = -smax_1; s1 <= smax_1; s1 ++)
+    for (s2 = -smax_2; s2 <= smax_2; s2 ++)
+    {
+      x = s1 * b1[0] + s2 * b2[0];
+      y = s1 * b1[1] + s2 * b2[1];
+      if (on_screen(x, y))
+        add_spot(p_list, &n, &n_max, x, y,
+                 (s1*m22 - s2*m12) * aux1, (s2*m11 - s1*m21) * aux1);
+    }
+
+  /* multiple scattering spots */
+  for (h = -h_max; h <= h_max; h ++)
+    for (k = -k_max; k <= k_max; k ++)
+    {
+      if ( (h == 0) && (k == 0) ) continue;
+      xi = h * a1[0] + k * a2[0];
+      yi = h * a1[1] + k * a2[1];
+      if (!on_screen(xi, yi)) continue;
+
+      for (s1 = -smax_1; s1 <= smax_1; s1 ++)
+        for (s2 = -smax_2; s2 <= smax_2; s2 ++)
+        {
+          if ( (s1 == 0) && (s2 == 0) ) continue;
+          x = xi + s1 * b1[0] + s2 * b2[0];
+          y = yi + s1 * b1[1] + s2 * b2[1];
+          if (on_screen(x, y))
+          {
+            add_spot(p_list, &n, &n_max, x, y, h, k);
+            if (!on_screen(x - xi, y - yi)) (*p_n_far)++;
+          }
+        }
+    }
+
+  return n;
+}
+
+static int test_matrix(const pattern_t *pat_gs, double m11, double m12,
+                       double m21, double m22)
+{
+  pattern_t pat;
+  matrix_2x2_t M;
+  spots_t *spots;
+  ref_spot_t *ref, *new_list;
+  size_t i, n_ref, n_far;
+  int n_fail = 0;
+
+  M.M11 = m11; M.M12 = m12; M.M21 = m21; M.M22 = m22;
+  memcpy(&pat, pat_gs, sizeof(pattern_t));
+  pat.M_SS = &M;
+  pat.n_domains = 1;
+
+  spots = pattern_calculate_superstructure_spots(&pat, 0);
+  n_ref = old_spots(&pat, &ref, &n_far);
+  if (spots == NULL)
+  {
+    printf("M = (%.2f %.2f %.2f %.2f): no spots FAILED\n", m11, m12, m21, m22);
+    free(ref);
+    return 1;
+  }
+
+  new_list = (ref_spot_t *) malloc((spots->n_spots + 1) * sizeof(ref_spot_t));
+  for (i = 0; i < spots->n_spots; i++)
+  {
+    new_list[i].x = spots->spots[i].x;
+    new_list[i].y = spots->spots[i].y;
+    new_list[i].h = spots->spots[i].index.h;
+    new_list[i].k = spots->spots[i].index.k;
+  }
+
+  qsort(ref, n_ref, sizeof(ref_spot_t), ref_cmp);
+  qsort(new_list, spots->n_spots, sizeof(ref_spot_t), ref_cmp);
+
+  if (n_ref != spots->n_spots) n_fail++;
+  for (i = 0; (i < n_ref) && !n_fail; i++)
+    if (ref_cmp(ref + i, new_list + i) != 0) n_fail++;
+
+  /* the test must contain MS spots with |SS| > R */
+  if (n_far == 0) n_fail++;
+
+  printf("M = (%.2f %.2f %.2f %.2f): %u spots (old enumeration %u, "
+         "%u MS spots with |SS| > R) %s\n", m11, m12, m21, m22,
+         (unsigned int)spots->n_spots, (unsigned int)n_ref,
+         (unsigned int)n_far, (n_fail) ? "FAILED" : "ok");
+
+  free(ref);
+  free(new_list);
+  spots_free(spots);
+  return (n_fail);
+}
+
+int main()
+{
+  int n_fail = 0;
+  pattern_t pat;
+
+  /* hexagonal substrate, first and second order GS spots on screen */
+  memset(&pat, 0, sizeof(pattern_t));
+  pat.a1.x = 1.;
+  pat.a1.y = 0.;
+  pat.a2.x = 0.5;
+  pat.a2.y = sqrt(3.) / 2.;
+  pat.radius = 2.;
+  pat.square = false;
+
+  n_fail += test_matrix(&pat, 1.3, 0., 0., 1.3);
+  n_fail += test_matrix(&pat, 1.15, 0.4, -0.4, 1.15);
+  n_fail += test_matrix(&pat, 2.7, 0., 0.2, 1.1);
+
+  /* square substrate */
+  pat.a2.x = 0.;
+  pat.a2.y = 1.;
+  n_fail += test_matrix(&pat, 1.25, 0., 0., 1.25);
+
+  printf("%s\n", (n_fail) ? "FAILED" : "all tests passed");
+  return (n_fail) ? 1 : 0;
+}
@@ -33,7 +33,7 @@ struct crargs  args;              /* program parameters from argument list */
 struct crivcur *iv_cur;           /* input data */
 
 char rfversion[STRSZ];            /* current program version */
-char t[1], e[1];
+char t[2], e[2];                  /* "t", "e" and the terminating 0 */
 
 strcpy(t, "t");strcpy(e, "e");
 
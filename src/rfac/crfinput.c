@@ -15,6 +15,8 @@ Changes:
  GH/11.08.95 - Creation (copy from rfinput.c)
  GH/15.08.95 - Include the_file in parameter list.
  WB/05.10.98 - cur_list[i_cur -1].group_id = I_END_OF_LIST;
+ AG/17.10.26 - allocate n_cur + 1 elements (the list pointers of the
+               element after the last curve are reset).
  
 *********************************************************************/
 
@@ -111,7 +113,7 @@ char line_buffer[STRSZ],    /* buffer for a single command line */
 #ifdef CONTROL_X
  fprintf(STDCTR,"(cr_input): n_cur = %d\n", n_cur);
 #endif
- cur_list = (struct crivcur *) calloc(n_cur, sizeof(struct crivcur));
+ cur_list = (struct crivcur *) calloc(n_cur + 1, sizeof(struct crivcur));
 
 /*********************************************************************
  Scan through control file.
@@ -8,6 +8,8 @@ Do a Lorentzian smooth for experimental or theoretiacl IV curves
 
 Changes:
   GH/05.10.92
+  AG/17.10.26 - resample non-equidistant theor. IV curves (e.g. from
+                cleed_nsym -a) onto an equidistant grid before smoothing.
 ********************************************************************/
 /*
 #define WRITE
@@ -25,6 +27,8 @@ Changes:
 #define  EPSILON   0.001    /* determines the integration range 
                                for smooth */
 
+static int cr_equidist( struct crivcur *iv_cur);
+
 int cr_lorentz( struct crivcur *iv_cur, real vi, char *ctr)
 
 /********************************************************************
@@ -103,6 +107,9 @@ FILE *str_old, *str_new;
     str_new = fopen("rflorentz.new.the","w");
 #endif
 
+    if (!iv_cur->the_equidist)
+      cr_equidist(iv_cur);
+
     if (iv_cur->the_equidist)
     {
       e_step = iv_cur->the_list[1].energy - iv_cur->the_list[0].energy;
@@ -328,3 +335,72 @@ FILE *str_old, *str_new;
 
  return (1);
 }
+
+/********************************************************************/
+
+static int cr_equidist( struct crivcur *iv_cur)
+
+/********************************************************************
+ Resample a sorted, non-equidistant theor. IV curve onto an
+ equidistant energy grid by cubic spline interpolation. The step is
+ the smallest energy difference in the original list, the grid
+ starts at the first energy and does not extend beyond the last one.
+ Negative intensities (spline overshoot) are set to zero.
+
+ parameters: iv_cur: data structure containing the theor. IV curve.
+             the_list, the_leng, the_last_eng and the_equidist are
+             modified after return.
+
+ return value: 1, if successful.
+               I_FAIL, if failed (iv_cur is unchanged).
+********************************************************************/
+{
+int i, n_eng;
+
+real e_step;
+struct crelist *list;
+
+ if (iv_cur->the_leng < 3) return(I_FAIL);
+
+ e_step = iv_cur->the_list[1].energy - iv_cur->the_list[0].energy;
+ for (i = 2; i < iv_cur->the_leng; i ++)
+   e_step = MIN(e_step,
+                iv_cur->the_list[i].energy - iv_cur->the_list[i-1].energy);
+
+ if (e_step < ENG_TOLERANCE) return(I_FAIL);
+
+ n_eng = 1 + (int) ( (iv_cur->the_list[iv_cur->the_leng-1].energy -
+                      iv_cur->the_list[0].energy + ENG_TOLERANCE) / e_step );
+
+ if( (list = (struct crelist *)malloc(n_eng * sizeof(struct crelist)) ) 
+     == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR,"*** error (cr_lorentz): allocation error (list)\n");
+#endif
+   exit(1);
+ }
+
+ cr_spline(iv_cur->the_list, iv_cur->the_leng);
+ for (i = 0; i < n_eng; i ++)
+ {
+   list[i].energy = iv_cur->the_list[0].energy + i * e_step;
+   list[i].intens = cr_splint(list[i].energy, 
+                              iv_cur->the_list, iv_cur->the_leng);
+   list[i].intens = MAX(list[i].intens, 0.);
+   list[i].deriv2 = 0.;
+ }
+
+#ifdef CONTROL
+ fprintf(STDCTR,"(cr_lorentz): (the) resampled %d -> %d energies, "
+         "e_step: %.1f\n", iv_cur->the_leng, n_eng, e_step);
+#endif
+
+ free(iv_cur->the_list);
+ iv_cur->the_list = list;
+ iv_cur->the_leng = n_eng;
+ iv_cur->the_last_eng = list[n_eng-1].energy;
+ iv_cur->the_equidist = 1;
+
+ return(1);
+}
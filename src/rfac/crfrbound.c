@@ -0,0 +1,384 @@
+/********************************************************************
+AG/17.10.26
+file contains functions:
+
+   real cr_rbound( struct crivcur *iv_cur, struct crargs *args)
+
+ Lower bound of the R factor for incomplete theoretical IV curves
+
+   double cr_rbound_args(int argc, char *argv[])
+
+ Same for the input files of crfac (argument list of crfac)
+
+ Used by the search program to stop a LEED calculation as soon as the
+ R factor of the final IV curves cannot be better than a threshold.
+ The theoretical input file is read while the LEED program is still
+ writing it (cr_rdcleed_part).
+
+Changes:
+AG/17.10.26 - Creation
+AG/17.10.26 - settle the extrapolated grid points of complete curves;
+              N_SPLINE_MARGIN 10 -> 16, document the spline dependence.
+AG/17.10.26 - cr_rbound_args: writable "t"/"e" arguments of cr_lorentz.
+
+********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "crfac.h"          /* specific definitions etc. */
+
+/*
+#define CONTROL
+*/
+#define WARNING
+#define ERROR
+
+#define LORENTZ_EPSILON 0.001  /* integration range of cr_lorentz */
+#define N_SPLINE_MARGIN 16     /* knots excluded at the end of an
+                                  incomplete theor. IV curve (spline) */
+#define N_BISECT        30     /* bisection steps in cr_rp_bound */
+
+static real cr_rp_bound(real , real , real *, real *, int , real );
+
+real cr_rbound( struct crivcur *iv_cur, struct crargs *args)
+
+/********************************************************************
+ Lower bound of the R factor (cr_rmin) for incomplete theoretical
+ IV curves.
+
+INPUT:
+
+  struct crivcur *iv_cur - (input) IV curves as prepared for cr_rmin
+          (smoothed, splines prepared). The theoretical curves may be
+          incomplete (the_front_eng < the_end_eng, see cr_rdcleed_part);
+          curves with less than two energies need not be prepared.
+
+  struct crargs args - (input) argument list (vi, s_ini, s_fin, s_step,
+          r_type).
+
+DESIGN:
+
+  Only for Pendry's R factor; the other R factors are normalised with
+  the integrated intensities of the complete curves.
+
+  The energy grid of each curve and shift (cr_mklide) is determined by
+  the first theoretical energy and the last energy of the complete
+  theoretical file, i.e. it is known before the curve is complete.
+
+  The theoretical intensities are "settled" up to the energy from which
+  on the Lorentzian smooth of cr_lorentz reaches the end of the
+  incomplete curve, less N_SPLINE_MARGIN knots for the cubic spline.
+  Up to there the sums of cr_rp are calculated as for the complete
+  curve. At the remaining grid points only |Yt| <= 1/(2 vi) is known;
+  the R factor of the curve is minimised with respect to these values
+  (cr_rp_bound). All grid points of a complete curve are settled,
+  including those beyond its last energy, where cr_mklide extrapolates
+  the spline.
+
+  Curves without theoretical intensities so far contribute zero with
+  the largest possible energy overlap. The bound is the minimum over
+  all shifts of the weighted average of these lower bounds. For
+  complete curves it equals the result of cr_rmin.
+
+  The bound is heuristic in one respect: the natural cubic spline of
+  the complete curve depends on all knots, i.e. the "settled" values
+  still change when further energies are added. The change decreases
+  by a factor of 2 - sqrt(3) = 0.27 per knot (equidistant knots), i.e.
+  to less than 1e-9 of the change at the end of the curve after
+  N_SPLINE_MARGIN knots. The smooth of cr_lorentz is truncated after
+  its integration range and does not add to this.
+
+RETURN VALUE:
+  lower bound of the R factor (0. if there is no bound).
+
+********************************************************************/
+{
+int i_list;
+int i_elo, n_eng, n_range, n_set, n_rest;
+
+real shift, energy, e_first, e_last, e_lo, e_set;
+real e_step, L, Y_exp, Y_the, y_max;
+real e_int, t_int, e_int_old, t_int_old, e_old;
+real rf_sum, exp_y_sum, the_y_sum;
+real faux, norm, rfac, r_min;
+
+real *y_rest, *e_rest;
+
+struct crivcur *cur;
+
+ if(args->r_type != RP_FACTOR) return(0.);
+
+/* Ye and energy steps of the grid points which are not settled */
+ n_rest = cr_rleng(iv_cur, args);
+ y_rest = (real *)malloc(2 * n_rest * sizeof(real));
+ if(y_rest == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (cr_rbound): allocation error\n");
+#endif
+   return(0.);
+ }
+ e_rest = y_rest + n_rest;
+
+ y_max = 1. / (2. * args->vi);
+ r_min = -1.;
+ t_int = t_int_old = 0.;
+
+ for(shift = args->s_ini; shift <= args->s_fin; shift += args->s_step)
+ {
+   rfac = 0.;
+   norm = 0.;
+   for(i_list = 0; iv_cur[i_list].group_id != I_END_OF_LIST; i_list ++)
+   {
+     cur = iv_cur + i_list;
+
+/* first theor. energy (not yet known: next energy of the file) */
+     e_lo = (cur->the_leng > 0)? cur->the_first_eng: cur->the_front_eng;
+
+/* settled part of the theor. curve (all of a complete curve) */
+     e_set = e_lo - 1.;
+     if(cur->the_leng > 1)
+     {
+       if(cur->the_front_eng < cur->the_end_eng - ENG_TOLERANCE)
+       {
+         e_step = cur->the_list[1].energy - cur->the_list[0].energy;
+         n_range = (int) R_nint(0.5 * args->vi *
+                                R_sqrt(1./LORENTZ_EPSILON - 1.) / e_step);
+         n_set = cur->the_leng - n_range - N_SPLINE_MARGIN;
+         if(n_set > 0) e_set = cur->the_list[n_set-1].energy;
+       }
+       else                       /* upper end of energy - shift below */
+         e_set = cur->the_end_eng - 2. * shift;
+     }
+
+/* first expt. energy within the theor. energy range (cr_mklide) */
+     for(i_elo = 0;
+         (i_elo < cur->exp_leng) &&
+         ( (cur->exp_list+i_elo)->energy < (e_lo - shift) );
+         i_elo ++)
+     { ; }
+     if(i_elo == cur->exp_leng) continue;
+
+/* sums of cr_rp */
+     exp_y_sum = 0.;
+     the_y_sum = 0.;
+     rf_sum = 0.;
+     n_rest = 0;
+     e_int_old = e_old = 0.;
+     e_first = e_last = (cur->exp_list+i_elo)->energy;
+     for(energy = (cur->exp_list+i_elo)->energy, n_eng = 0;
+         (energy <= (cur->exp_list+cur->exp_leng-1)->energy) &&
+         (energy < (cur->the_end_eng - shift) );
+         energy += args->s_step, n_eng ++)
+     {
+       e_int = cr_splint(energy, cur->exp_list, cur->exp_leng);
+       if(energy - shift <= e_set)
+         t_int = cr_splint(energy - shift, cur->the_list, cur->the_leng);
+
+       if(n_eng > 0)
+       {
+         e_step = energy - e_old;
+
+         L = (e_int - e_int_old) / (e_step * 0.5 * (e_int + e_int_old));
+         Y_exp = L/ ( 1. + L*L*args->vi*args->vi);
+
+         if(energy - shift <= e_set)
+         {
+           exp_y_sum += SQUARE(Y_exp)*e_step;
+
+           L = (t_int - t_int_old) / (e_step * 0.5 * (t_int + t_int_old));
+           Y_the = L/ ( 1. + L*L*args->vi*args->vi);
+           the_y_sum += SQUARE(Y_the)*e_step;
+           rf_sum += SQUARE(Y_the - Y_exp)*e_step;
+         }
+         else
+         {
+           y_rest[n_rest] = Y_exp;
+           e_rest[n_rest] = e_step;
+           n_rest ++;
+         }
+       }
+
+       e_old = e_last = energy;
+       e_int_old = e_int;
+       t_int_old = t_int;
+     }
+
+     if(n_eng > 1)
+     {
+       faux = (e_last - e_first) * cur->weight;
+       norm += faux;
+       if(n_rest > 0)
+         rf_sum = cr_rp_bound(rf_sum, exp_y_sum + the_y_sum,
+                              y_rest, e_rest, n_rest, y_max);
+       else
+         rf_sum /= (exp_y_sum + the_y_sum);
+       rfac += faux * rf_sum;
+     }
+   }  /* for i_list */
+
+   if(norm > 0.)
+   {
+     rfac /= norm;
+#ifdef CONTROL
+     fprintf(STDCTR, "(cr_rbound): shift = %4.1f, bound = %.6f\n",
+             shift, rfac);
+#endif
+     if( (r_min < 0.) || (rfac < r_min) ) r_min = rfac;
+   }
+ }  /* for shift */
+
+ free(y_rest);
+
+ return( (r_min < 0.)? 0.: r_min );
+}  /* end of function cr_rbound */
+
+/*======================================================================*/
+
+static real cr_rp_bound(real rf_sum, real norm_sum,
+                        real *y_exp, real *e_step, int n_rest, real y_max)
+
+/********************************************************************
+ Minimum of Pendry's R factor of a curve with respect to the unknown
+ theoretical Y functions of some grid points.
+
+INPUT:
+
+  real rf_sum, norm_sum - sums S(Ye - Yt)^2 and S(Ye^2 + Yt^2) of the
+          known grid points.
+  real *y_exp, *e_step - Ye and energy step of the n_rest unknown grid
+          points.
+  real y_max - bound of the Y function: |Yt| <= y_max = 1/(2 vi).
+
+DESIGN:
+
+  R = min (rf_sum + S(Ye - Yt)^2) / (norm_sum + S(Ye^2 + Yt^2)) is the
+  root of the decreasing function
+
+  g(R) = rf_sum - R norm_sum + S min{ (Ye - Yt)^2 - R (Ye^2 + Yt^2) }
+
+  where the minimum is taken for each point with respect to
+  |Yt| <= y_max (at Yt = Ye/(1-R) or at the boundaries). The root is
+  found by bisection in [0, 2] and the lower end of the final interval
+  is returned.
+
+RETURN VALUE:
+  lower bound of the R factor of the curve.
+
+********************************************************************/
+{
+int i_bis, i_rest;
+real r_lo, r_hi, r_mid;
+real g, g_min, faux, y;
+
+ r_lo = 0.;
+ r_hi = 2.;
+ for(i_bis = 0; i_bis < N_BISECT; i_bis ++)
+ {
+   r_mid = 0.5 * (r_lo + r_hi);
+
+   g = rf_sum - r_mid * norm_sum;
+   for(i_rest = 0; i_rest < n_rest; i_rest ++)
+   {
+     /* boundaries */
+     g_min = SQUARE(y_exp[i_rest] - y_max) -
+             r_mid * (SQUARE(y_exp[i_rest]) + SQUARE(y_max));
+     faux  = SQUARE(y_exp[i_rest] + y_max) -
+             r_mid * (SQUARE(y_exp[i_rest]) + SQUARE(y_max));
+     g_min = MIN(g_min, faux);
+
+     /* stationary point */
+     if(r_mid < 1.)
+     {
+       y = y_exp[i_rest] / (1. - r_mid);
+       if(R_fabs(y) <= y_max)
+       {
+         faux = SQUARE(y_exp[i_rest] - y) -
+                r_mid * (SQUARE(y_exp[i_rest]) + SQUARE(y));
+         g_min = MIN(g_min, faux);
+       }
+     }
+
+     g += g_min * e_step[i_rest];
+   }
+
+   if(g > 0.) r_lo = r_mid;
+   else       r_hi = r_mid;
+ }
+
+ return(r_lo);
+}  /* end of function cr_rp_bound */
+
+/*======================================================================*/
+
+double cr_rbound_args(int argc, char *argv[])
+
+/********************************************************************
+ Lower bound of the R factor calculated by crfac with the same
+ argument list while the theoretical input file is incomplete.
+
+INPUT:
+
+  int argc, char *argv[] - argument list of crfac (see cr_rdargs);
+          argv[0] is not used.
+
+DESIGN:
+
+  The input files are read (cr_input, the theoretical file in part),
+  smoothed and splined as in crfac; then the bound is calculated by
+  cr_rbound.
+
+RETURN VALUE:
+  lower bound of the R factor (0. if there is no bound).
+
+********************************************************************/
+{
+int i_list, old_part;
+real rfac;
+
+char t[2], e[2];                  /* "t", "e" and the terminating 0 */
+
+struct crargs args;
+struct crivcur *iv_cur;
+
+ strcpy(t, "t"); strcpy(e, "e");
+ args = cr_rdargs(argc, argv);
+
+ old_part = cr_rdcleed_part(1);
+ iv_cur = cr_input(args.ctrfile, args.thefile);
+ cr_rdcleed_part(old_part);
+
+/* smooth and prepare cubic spline as in crfac */
+ for(i_list = 0; iv_cur[i_list].group_id != I_END_OF_LIST; i_list ++)
+ {
+   cr_lorentz(iv_cur+i_list, args.vi / 2., e);
+   cr_spline((iv_cur+i_list)->exp_list, (iv_cur+i_list)->exp_leng);
+   (iv_cur+i_list)->exp_spline = 1;
+
+   if((iv_cur+i_list)->the_leng > 1)
+   {
+     cr_lorentz(iv_cur+i_list, args.vi / 2., t);
+     cr_spline((iv_cur+i_list)->the_list, (iv_cur+i_list)->the_leng);
+     (iv_cur+i_list)->the_spline = 1;
+   }
+ }
+
+ rfac = cr_rbound(iv_cur, &args);
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(cr_rbound_args): bound = %.6f\n", rfac);
+#endif
+
+/* free IV curves (the last curve carries the terminator) */
+ for(i_list = 0; ; i_list ++)
+ {
+   free((iv_cur+i_list)->exp_list);
+   free((iv_cur+i_list)->the_list);
+   if(iv_cur[i_list].group_id == I_END_OF_LIST) break;
+ }
+ free(iv_cur);
+
+ return((double)rfac);
+}  /* end of function cr_rbound_args */
@@ -9,6 +9,7 @@ Changes:
   GH/27.10.92 - Creation
   GH/30.08.95 - Adaptation to CRFAC
   LD/07.03.14 - Added POSIX style arguments
+  AG/17.10.26 - removed debug output (called repeatedly by cr_rbound_args)
 *********************************************************************/
 #include <math.h>
 #include <stdio.h>
@@ -126,7 +127,6 @@ structure containing all program parameters:
 /*********************************************************************
  decode arguments 
 *********************************************************************/
-  printf("got here\n");
   if( argc == 1)
   {
     rf_help(stderr);
@@ -1,7 +1,7 @@
 /********************************************************************
 GH/11.08.95
 
-  file contains function:
+  file contains functions:
 
   struct crelist *cr_rdcleed( struct crivcur *iv_cur,
                                char *buffer,
@@ -9,10 +9,16 @@ GH/11.08.95
 
  Read theoretical IV curves from CLEED program
 
+  int cr_rdcleed_part(int part)
+
+ Accept theoretical input files with fewer energies than announced
+
  Changes:
 
  GH/11.08.95 - Creation (copy from rfrdvhbeams.c)
  GH/12.10.00 - bug fixed in comparing neng with number of lines.
+ AG/17.10.26 - partial input (cr_rdcleed_part) for files which are
+               still being written; the_front_eng, the_end_eng.
 
 ********************************************************************/
 #include <math.h>
@@ -35,6 +41,33 @@ GH/11.08.95
 #define LENGTH_OF_NUMBER 15   /* > number of characters per intensity in
                                  input file */
 
+static int rdcleed_part = 0;
+
+/*======================================================================*/
+
+int cr_rdcleed_part(int part)
+
+/*********************************************************************
+ Switch the partial input of cr_rdcleed on or off.
+
+ parameters: - part: 1 - a file with fewer lines of intensities than
+               given by "#en" is read up to the last complete line
+               (e.g. while the LEED program is still writing it).
+               0 - such a file is an error (default).
+               Negative values leave the setting unchanged.
+
+ return value: previous setting.
+*********************************************************************/
+{
+int old_part;
+
+ old_part = rdcleed_part;
+ if(part >= 0) rdcleed_part = part;
+ return(old_part);
+}  /* end of function cr_rdcleed_part */
+
+/*======================================================================*/
+
 struct crelist *cr_rdcleed( struct crivcur *iv_cur,
 			    char *buffer, 
 			    char *index_list )
@@ -79,10 +112,12 @@ return value: pointer to the IV curve (struct crelist). The
   int i_eng, i_beam;                /* counters */
   int lines, len;
   int n_beam, n_eng;
+  int i_line, lines_all;
 
   long offs, data_offs;
   long buffer_len;
 
+  real e_line_0, e_line_1;         /* energies of the first two lines */
   real max_int,                    /* list of max. intensity */ 
        int_sum;                    /* sum of all intensities */
 
@@ -213,7 +248,12 @@ return value: pointer to the IV curve (struct crelist). The
   }
 
   /* Changed 12.10.00: if( (lines = rf_nclines(buffer+offs) ) != n_eng) */
-  if( (lines = rf_nclines(buffer+data_offs) ) != n_eng)
+  lines = rf_nclines(buffer+data_offs);
+  lines_all = n_eng;
+  /* an incomplete last line (no '\n') is not counted */
+  if( rdcleed_part && (lines < n_eng) ) n_eng = lines;
+
+  if( lines != n_eng )
   {
     #ifdef ERROR
     fprintf(STDERR, "*** error (cr_rdcleed): "
@@ -262,10 +302,13 @@ return value: pointer to the IV curve (struct crelist). The
   max_int = 0.;
   int_sum = 0.;
   i_eng = 0;
+  i_line = 0;
+  e_line_0 = e_line_1 = 0.;
+  iv_cur->the_front_eng = 0.;
   
   for ( offs = data_offs ;
       ((len = bgets(buffer, offs, buffer_len, line_buffer)) > -1) && 
-      (i_eng < n_eng);  
+      (i_eng < n_eng) && (i_line < lines);  
       offs += (long)len)
   {
     if(line_buffer[0] != '#')      /* no comment */
@@ -284,6 +327,11 @@ return value: pointer to the IV curve (struct crelist). The
       #ifdef REAL_IS_FLOAT
       sscanf(line_buffer+i_str, "%f", &(list[i_eng].energy) );
       #endif
+
+      iv_cur->the_front_eng = list[i_eng].energy;
+      if(i_line == 0)      e_line_0 = list[i_eng].energy;
+      else if(i_line == 1) e_line_1 = list[i_eng].energy;
+      i_line ++;
       
       /* go to end of line ? */
       while(line_buffer[i_str] == ' ') i_str++;
@@ -377,8 +425,18 @@ return value: pointer to the IV curve (struct crelist). The
  write all available information to structure iv_cur
 */
   iv_cur->the_leng = i_eng;
-  iv_cur->the_first_eng = list[0].energy;
-  iv_cur->the_last_eng = list[i_eng-1].energy;
+  if(i_eng > 0)
+  {
+    iv_cur->the_first_eng = list[0].energy;
+    iv_cur->the_last_eng = list[i_eng-1].energy;
+  }
+  else
+    iv_cur->the_first_eng = iv_cur->the_last_eng = iv_cur->the_front_eng;
+
+  /* last energy of the complete file (equidistant energies) */
+  iv_cur->the_end_eng = iv_cur->the_front_eng;
+  if( (lines_all > i_line) && (i_line > 1) )
+    iv_cur->the_end_eng = e_line_0 + (lines_all - 1) * (e_line_1 - e_line_0);
   iv_cur->the_max_int = max_int;
  
 /*
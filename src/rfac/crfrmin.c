@@ -1,15 +1,29 @@
 /********************************************************************
 GH/12.09.95
-file contains function:
+file contains functions:
 
    real cr_rmin( struct crivcur *iv_cur, struct crargs *args,
                 real *p_r_min, real *p_s_min, real *p_e_range)
 
  Calculate R factor and find minimum with respect to shift
 
+   int cr_rleng( struct crivcur *iv_cur, struct crargs *args)
+
+ Length of the energy/intensity lists needed for cr_rshift
+
+   real cr_rshift( struct crivcur *iv_cur, struct crargs *args,
+                   real shift, real *eng, real *e_int, real *t_int,
+                   real *p_norm, real *p_e_range)
+
+ Calculate the (not normalised) R factor sum for a single shift
+
 Changes:
 GH/30.08.95 - Creation
 GH/12.09.95 - Output of IV curves for the best overlap
+AG/17.10.26 - R factor for one shift moved to cr_rshift (used by the
+              multi-angle R factor in caoi_rfac)
+AG/17.10.26 - cr_rmin: the IV output loop runs to the end of the list
+              (no separate counting loop).
   
 ********************************************************************/
 #include <stdio.h>
@@ -54,7 +68,7 @@ RETURN VALUE:
 ********************************************************************/
 {
 
-int i_list, n_list;
+int i_list;
 int i_leng, n_leng;
 
 real faux;
@@ -68,35 +82,19 @@ char r_name[STRSZ];
 FILE *out_stream;
 
 /********************************************************************
-  Find number of IV curves
-  Allocate storage space for cr_mklist.
+  Allocate storage space for cr_mklide/cr_mklist.
 ********************************************************************/
  rfac = 0.;
- n_leng = 0;
- for(n_list = 0; iv_cur[n_list].group_id != I_END_OF_LIST; n_list ++)
- { 
-#ifdef SHIFT_DE
-   faux = ((iv_cur+n_list)->exp_list + (iv_cur+n_list)->exp_leng -1)->energy  -
-          ((iv_cur+n_list)->exp_list)->energy;
-   n_leng = MAX(n_leng, (int)(faux/args->s_step) );
-   faux = ((iv_cur+n_list)->the_list + (iv_cur+n_list)->the_leng -1)->energy  -
-          ((iv_cur+n_list)->the_list)->energy;
-   n_leng = MAX(n_leng, (int)(faux/args->s_step) );
-#else
-   n_leng = MAX(n_leng, (iv_cur+n_list)->exp_leng);
-   n_leng = MAX(n_leng, (iv_cur+n_list)->the_leng); 
-#endif
- }
+ n_leng = cr_rleng(iv_cur, args);
 
 #ifdef CONTROL
    fprintf(STDCTR,
-   "(cr_rmin): start of function, n_list = %d, n_leng = %d\n",
-   n_list, n_leng);
+   "(cr_rmin): start of function, n_leng = %d\n", n_leng);
 #endif
 
- eng   = (real *)malloc( n_leng * sizeof(real)*13);
- e_int = (real *)malloc( n_leng * sizeof(real)*13);
- t_int = (real *)malloc( n_leng * sizeof(real)*13);
+ eng   = (real *)malloc( n_leng * sizeof(real));
+ e_int = (real *)malloc( n_leng * sizeof(real));
+ t_int = (real *)malloc( n_leng * sizeof(real));
 
 /********************************************************************
   Scan through shift and find min. R factor
@@ -106,52 +104,8 @@ FILE *out_stream;
 
  for(shift = args->s_ini; shift <= args->s_fin; shift += args->s_step)
  {
-   rfac = 0.;
-   norm = 0.;
-   e_range = 0.;
-   for(i_list = 0; i_list < n_list; i_list ++)
-   {
-
-#ifdef SHIFT_DE
-     n_leng = cr_mklide(eng, e_int, t_int, args->s_step, shift,
-              (iv_cur+i_list)->exp_list, (iv_cur+i_list)->exp_leng,
-              (iv_cur+i_list)->the_list, (iv_cur+i_list)->the_leng);
-#else
-     n_leng = cr_mklist(eng, e_int, t_int, shift,
-              (iv_cur+i_list)->exp_list, (iv_cur+i_list)->exp_leng,
-              (iv_cur+i_list)->the_list, (iv_cur+i_list)->the_leng);
-#endif
-
-     if(n_leng > 1) 
-     {
-       e_range += faux = (eng[n_leng-1] - eng[0]);
-       norm += faux *= (iv_cur+i_list)->weight;
-
-       if(args->r_type == RP_FACTOR)
-         faux *= cr_rp(eng, e_int, t_int, args->vi);
-       else if (args->r_type == R1_FACTOR)
-         faux *= cr_r1(eng, e_int, t_int);
-       else if (args->r_type == R2_FACTOR)
-         faux *= cr_r2(eng, e_int, t_int);
-       else if (args->r_type == RB_FACTOR)
-         faux *= cr_rb(eng, e_int, t_int);
-       else 
-       {
-#ifdef ERROR
-         fprintf(STDERR,
-         "*** error (cr_rmin): invalid R factor selection %d\n", args->r_type);
-#endif
-         exit(1);
-       }
-       rfac += faux;
-     }
-#ifdef WARNING
-     else
-       fprintf(STDWAR,
-       "* warning (cr_rmin): No overlap in IV curve No. %d for shift %.1f eV\n",
-       i_list, shift);
-#endif
-   }  /* for i_list */
+   rfac = cr_rshift(iv_cur, args, shift, eng, e_int, t_int,
+                    &norm, &e_range);
 
    if(IS_EQUAL_REAL(norm, 0.))
    {
@@ -190,7 +144,7 @@ FILE *out_stream;
  
  if(args->iv_out == 1)
  {
-   for(i_list = 0; i_list < n_list; i_list ++)
+   for(i_list = 0; iv_cur[i_list].group_id != I_END_OF_LIST; i_list ++)
    {
 
 #ifdef SHIFT_DE
@@ -297,3 +251,129 @@ FILE *out_stream;
 
  return (*p_r_min);
 }  /* end of function cr_rmin */
+
+/*======================================================================*/
+
+int cr_rleng( struct crivcur *iv_cur, struct crargs *args)
+
+/********************************************************************
+ Length of the lists eng, e_int, t_int needed by cr_mklide/cr_mklist.
+
+INPUT:
+
+  struct crivcur *iv_cur - (input) IV curves.
+  struct crargs args - (input) argument list (s_step).
+
+RETURN VALUE: 
+  number of elements to be allocated for each list.
+
+********************************************************************/
+{
+int n_list, n_leng;
+real faux;
+
+ n_leng = 0;
+ for(n_list = 0; iv_cur[n_list].group_id != I_END_OF_LIST; n_list ++)
+ { 
+#ifdef SHIFT_DE
+   faux = ((iv_cur+n_list)->exp_list + (iv_cur+n_list)->exp_leng -1)->energy  -
+          ((iv_cur+n_list)->exp_list)->energy;
+   n_leng = MAX(n_leng, (int)(faux/args->s_step) );
+   faux = ((iv_cur+n_list)->the_list + (iv_cur+n_list)->the_leng -1)->energy  -
+          ((iv_cur+n_list)->the_list)->energy;
+   n_leng = MAX(n_leng, (int)(faux/args->s_step) );
+#else
+   n_leng = MAX(n_leng, (iv_cur+n_list)->exp_leng);
+   n_leng = MAX(n_leng, (iv_cur+n_list)->the_leng); 
+#endif
+ }
+
+ return(n_leng * 13);
+}  /* end of function cr_rleng */
+
+/*======================================================================*/
+
+real cr_rshift( struct crivcur *iv_cur, struct crargs *args, real shift,
+                real *eng, real *e_int, real *t_int,
+                real *p_norm, real *p_e_range)
+
+/********************************************************************
+ Calculate the R factor sum over all IV curves for a single shift.
+
+INPUT:
+
+  struct crivcur *iv_cur - (input) IV curves (splines prepared).
+  struct crargs args - (input) argument list (vi, s_step, r_type).
+  real shift - (input) shift between energy axes.
+  real *eng, *e_int, *t_int - work space of cr_rleng elements each.
+         Must be private to the calling thread.
+  real *p_norm - (output) sum of weighted energy overlaps.
+  real *p_e_range - (output) sum of energy overlaps.
+
+DESIGN:
+
+  The R factor of the data set is the return value divided by *p_norm.
+  The function does not change iv_cur and can be called in parallel
+  for different shifts or data sets.
+
+RETURN VALUE: 
+  Sum of R factors weighted with overlap and weight of the IV curves.
+
+********************************************************************/
+{
+int i_list, n_leng;
+real faux;
+real e_range, norm, rfac;
+
+ rfac = 0.;
+ norm = 0.;
+ e_range = 0.;
+ for(i_list = 0; iv_cur[i_list].group_id != I_END_OF_LIST; i_list ++)
+ {
+
+#ifdef SHIFT_DE
+   n_leng = cr_mklide(eng, e_int, t_int, args->s_step, shift,
+            (iv_cur+i_list)->exp_list, (iv_cur+i_list)->exp_leng,
+            (iv_cur+i_list)->the_list, (iv_cur+i_list)->the_leng);
+#else
+   n_leng = cr_mklist(eng, e_int, t_int, shift,
+            (iv_cur+i_list)->exp_list, (iv_cur+i_list)->exp_leng,
+            (iv_cur+i_list)->the_list, (iv_cur+i_list)->the_leng);
+#endif
+
+   if(n_leng > 1) 
+   {
+     e_range += faux = (eng[n_leng-1] - eng[0]);
+     norm += faux *= (iv_cur+i_list)->weight;
+
+     if(args->r_type == RP_FACTOR)
+       faux *= cr_rp(eng, e_int, t_int, args->vi);
+     else if (args->r_type == R1_FACTOR)
+       faux *= cr_r1(eng, e_int, t_int);
+     else if (args->r_type == R2_FACTOR)
+       faux *= cr_r2(eng, e_int, t_int);
+     else if (args->r_type == RB_FACTOR)
+       faux *= cr_rb(eng, e_int, t_int);
+     else 
+     {
+#ifdef ERROR
+       fprintf(STDERR,
+       "*** error (cr_rshift): invalid R factor selection %d\n", args->r_type);
+#endif
+       exit(1);
+     }
+     rfac += faux;
+   }
+#ifdef WARNING
+   else
+     fprintf(STDWAR,
+     "* warning (cr_rshift): No overlap in IV curve No. %d for shift %.1f eV\n",
+     i_list, shift);
+#endif
+ }  /* for i_list */
+
+ *p_norm = norm;
+ *p_e_range = e_range;
+
+ return(rfac);
+}  /* end of function cr_rshift */
@@ -9,6 +9,10 @@ version 0.1
  GH/29.12.95 - include option d (initial displacement).
                print version number to log file
  LD/03.04.14 - added double quotes around pathnames to enable spaces
+ AG/17.10.26 - include option a (early abort of LEED calculations).
+ AG/17.10.26 - include option f (low fidelity screening).
+ AG/17.10.26 - include option l (in-process LEED calculation).
+ AG/17.10.26 - include option m (memory budget of option l).
 ***********************************************************************/
 
 /* Driver for routine AMOEBA */
@@ -31,7 +35,10 @@ int main(int argc, char *argv[])
   int ndim;
   int search_type;
 
+  int lofi_lm;
   real delta;
+  real lofi_es, lofi_ep;
+  char *ptr;
 
   char inp_file[STRSZ];
   char bak_file[STRSZ];
@@ -50,6 +57,21 @@ int main(int argc, char *argv[])
     -v <bak_file> - (optional input file) vertex.
 
     -s <search_type> - (optional) default is "simplex"
+
+    -a - (optional) abort LEED calculations as soon as the R factor
+         cannot improve the simplex (Pendry R factor only).
+
+    -f <lm>[,<e_step>[,<eps>]] - (optional) screen the trial geometries
+         of the simplex with a low fidelity calculation (l_max, energy
+         step, epsilon; 0 or missing: as in the bulk file).
+
+    -l - (optional) calculate the IV curves in-process and reuse the
+         matrices of unchanged layers from the previous evaluation
+         (instead of running CSEARCH_LEED; -a has no effect).
+
+    -m <budget> - (optional) memory budget (MB) of option -l; if the
+         matrices of all energies do not fit, they are kept in scratch
+         files.
 *********************************************************************/
 
   sr_project = (char *) malloc(STRSZ * sizeof(char) );
@@ -76,6 +98,50 @@ int main(int argc, char *argv[])
     else
     {
 
+      /* Early abort of LEED calculations */
+      if(strcmp(argv[i_arg], "-a") == 0)
+        sr_rf_abort_mode(1);
+
+      /* In-process LEED calculation */
+      if(strcmp(argv[i_arg], "-l") == 0)
+        sr_leed_mode(1);
+
+      /* Memory budget of the in-process LEED calculation */
+      if(strcmp(argv[i_arg], "-m") == 0)
+      {
+        i_arg++;
+        if (i_arg < argc)
+          sr_leed_budget(atof(argv[i_arg]));
+        else
+        {
+          #ifdef ERROR
+          fprintf(STDERR,"*** error (SEARCH): no memory budget specified\n");
+          #endif
+          exit(1);
+        }
+      }
+
+      /* Low fidelity screening */
+      if(strcmp(argv[i_arg], "-f") == 0)
+      {
+        i_arg++;
+        if (i_arg < argc)
+        {
+          lofi_es = lofi_ep = 0.;
+          lofi_lm = (int)strtol(argv[i_arg], &ptr, 10);
+          if(*ptr == ',') lofi_es = (real)strtod(ptr + 1, &ptr);
+          if(*ptr == ',') lofi_ep = (real)strtod(ptr + 1, &ptr);
+          sr_lofi_mode(lofi_lm, lofi_es, lofi_ep);
+        }
+        else
+        {
+          #ifdef ERROR
+          fprintf(STDERR,"*** error (SEARCH): no low fidelity parameters specified\n");
+          #endif
+          exit(1);
+        }
+      }
+
       /* Read initial displacement */
       if(strncmp(argv[i_arg], "-d", 2) == 0)
       {
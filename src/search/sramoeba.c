@@ -15,6 +15,8 @@ BN/   07.93 - Copy vertex to *.ver after each iteration.
 GH/12.09.95 - Criterion of termination is absolute deviation in vertex
               rather than relative deviation.
 LD/30.04.14 - Removed dependence on 'cp' and 'date' system calls
+AG/17.10.26 - amotry: the worst vertex is the R factor threshold of the
+              trial point (sr_rf_threshold, early abort of LEED runs).
 
 ***********************************************************************/
 #include <math.h>
@@ -154,7 +156,10 @@ real amotry(real **p, real *y, real *psum, int ndim,
 	fac1=(1.0-fac)/ndim;
 	fac2=fac1-fac;
 	for (j=1;j<=ndim;j++) ptry[j]=psum[j]*fac1-p[ihi][j]*fac2;
+	/* the trial point is only used if it is better than the worst vertex */
+	sr_rf_threshold((double)y[ihi]);
 	ytry=(*funk)(ptry);
+	sr_rf_threshold(0.);
 	++(*nfunk);
 	if (ytry < y[ihi]) {
 		y[ihi]=ytry;
@@ -22,9 +22,26 @@ GH/09.08.04  - use modified bulk file *.bsr and copy to *.bmin if a
                minimum is reached.
 LD/30.04.14  - removed dependence on 'cp' system call, now uses 
                copy_file(char* old_filename, char *new_filename) function.
+AG/17.10.26  - write the concentration parameters of the occupancy search
+               to the log file.
+AG/17.10.26  - log the concentrations (sr_occ_conc) rather than the search
+               parameters.
+AG/17.10.26  - abort the LEED program as soon as the R factor exceeds the
+               threshold of the search algorithm (sr_leed_stream).
+AG/17.10.26  - low fidelity screening of trial geometries (sr_lofi_eval).
+AG/17.10.26  - copy minimum files to *.rmin, *.pmin, *.bmin (the suffix
+               was appended to the source file name).
+AG/17.10.26  - calculate IV curves in-process (sr_leed_delta) if selected
+               by sr_leed_mode.
+AG/17.10.26  - pass the time of the full calculation to sr_lofi_calib.
+AG/17.10.26  - time of the full calculation from sr_lofi_time (the
+               resolution of time() is 1 s).
+AG/17.10.26  - writable copies of the options in the argument list of the
+               R factor program (rf_argv).
 
 ***********************************************************************/
 #include <stdio.h>
+#include <string.h>
 #include <strings.h>
 #include <time.h>
 #include <math.h>
@@ -81,16 +98,24 @@ static int n_eval  = 0;
 static int n_calc  = 0;
 
 int iaux;
-int i_par;
+int i_par, i_atoms;
 real faux;
-real rgeo, rfac;
+real rgeo, rfac, r_lo;
+double rf_thr, rf_bound;
 
 struct tm *l_time;
 time_t t_time;
+double t_full;
 
 char line_buffer[STRSZ];
 char log_file[STRSZ];
 char par_file[STRSZ];
+char res_file[STRSZ];
+char ctr_file[STRSZ];
+char shift_arg[STRSZ];
+char rf_opt[4][3];                /* "-t", "-c", "-r", "-s" */
+char rf_typ[STRSZ];
+char *rf_argv[9];
 
 FILE *io_stream, *log_stream;
 
@@ -98,9 +123,12 @@ FILE *io_stream, *log_stream;
   Set initial values
 ***********************************************************************/
  iaux = 0;
+ r_lo = -1.;
  n_eval ++;
  sprintf(log_file,"%s.log", sr_project);
  sprintf(par_file,"%s.par", sr_project);
+ sprintf(res_file,"%s.res", sr_project);
+ sprintf(ctr_file,"%s.ctr", sr_project);
 
 /***********************************************************************
   Check whether environment variables CSEARCH_LEED and CSEARCH_RFAC exist
@@ -195,20 +223,128 @@ FILE *io_stream, *log_stream;
 
 #else
 
- sprintf(line_buffer,                 /* added quotation for filepath safety */
-         "\"%s\" -b \"%s.bsr\" -i \"%s\" -o \"%s.res\" > \"%s.out\"",
-         getenv("CSEARCH_LEED"),      /* LEED program name */
-         sr_project,                  /* project name for modified bulk file */
-         par_file,                    /* parameter file for overlayer */
-         sr_project,                  /* project name for results file */
-         sr_project);                 /* project name for output file */
-       
+/*
+  Threshold for the R factor (without rgeo) set by the search algorithm
+  (-1: none).
+*/
+ rf_thr = sr_rf_threshold(-1.);
+ rf_thr = (rf_thr > 0.)? MAX(rf_thr - rgeo, 0.): -1.;
+
+/***********************************************************************
+  Low fidelity screening: return the estimated R factor (+ rgeo), if
+  the geometry will be rejected by the search algorithm anyway.
+***********************************************************************/
+
+ if( sr_lofi_mode(-1, 0., 0.) && (rf_thr >= 0.) )
+ {
+   if (sr_lofi_eval(&r_lo) < 0) {SYS_ERROR_TO_LOG("low fidelity calculation");}
+
+   if (! sr_lofi_screen(r_lo, (real)rf_thr, &rfac))
+   {
 #ifdef CONTROL
- fprintf(STDCTR,"(sr_evalrf %d): calculate IV curves:\n %s\n", 
-         n_eval, line_buffer); 
+     fprintf(STDCTR," screened: r_lo = %.4f rtot = %.4f\n",
+             r_lo, rgeo + rfac);
 #endif
+     rfac_max = MAX(rfac, rfac_max);
 
- if (system (line_buffer)) {SYS_ERROR_TO_LOG(line_buffer);}
+     log_stream = fopen(log_file, "a");
+
+     fprintf(log_stream,"#%3d par:", n_eval);
+     for(i_par=1; i_par <= sr_search->n_par; i_par++)
+       fprintf(log_stream," %.3f", par[i_par]);
+     fprintf(log_stream," rlo:%.4f **rf~%.4f** rg:%.4f rt:%.4f ",
+             r_lo, rfac, rgeo, rfac + rgeo);
+
+     t_time = time(NULL);
+     l_time = localtime(&t_time);
+     fprintf(log_stream," dt: %s", asctime(l_time) );
+
+     fclose(log_stream);
+     return(rfac + rgeo);
+   }
+ }
+
+/***********************************************************************
+  Full calculation: in-process (sr_leed_mode, layer matrices are reused)
+  or by the LEED program.
+***********************************************************************/
+
+ t_full = sr_lofi_time();
+
+ if(sr_leed_mode(-1))
+ {
+   sprintf(line_buffer, "%s.bsr", sr_project);
+   if (sr_leed_delta(line_buffer, par_file, res_file) < 0)
+   {SYS_ERROR_TO_LOG("in-process LEED calculation");}
+ }
+ else
+ {
+   sprintf(line_buffer,                 /* added quotation for filepath safety */
+           "\"%s\" -b \"%s.bsr\" -i \"%s\" -o \"%s.res\" > \"%s.out\"",
+           getenv("CSEARCH_LEED"),      /* LEED program name */
+           sr_project,                  /* project name for modified bulk file */
+           par_file,                    /* parameter file for overlayer */
+           sr_project,                  /* project name for results file */
+           sr_project);                 /* project name for output file */
+
+#ifdef CONTROL
+   fprintf(STDCTR,"(sr_evalrf %d): calculate IV curves:\n %s\n", 
+           n_eval, line_buffer); 
+#endif
+
+/*
+  Early abort (sr_rf_abort_mode): the LEED program is aborted as soon as
+  the R factor of the results written so far cannot be below the
+  threshold (sr_leed_stream).
+*/
+   if(! sr_rf_abort_mode(-1)) rf_thr = -1.;
+
+   sprintf(shift_arg, "%.2f,%.2f,%.2f",
+           - RFAC_SHIFT_RANGE, + RFAC_SHIFT_RANGE, RFAC_SHIFT_STEP);
+   strcpy(rf_opt[0], "-t"); strcpy(rf_opt[1], "-c");
+   strcpy(rf_opt[2], "-r"); strcpy(rf_opt[3], "-s");
+   strcpy(rf_typ, RFAC_TYP);
+   rf_argv[0] = getenv("CSEARCH_RFAC");
+   rf_argv[1] = rf_opt[0]; rf_argv[2] = res_file;
+   rf_argv[3] = rf_opt[1]; rf_argv[4] = ctr_file;
+   rf_argv[5] = rf_opt[2]; rf_argv[6] = rf_typ;
+   rf_argv[7] = rf_opt[3]; rf_argv[8] = shift_arg;
+
+   iaux = sr_leed_stream(line_buffer, res_file, 9, rf_argv, rf_thr, &rf_bound);
+   if (iaux < 0) {SYS_ERROR_TO_LOG(line_buffer);}
+
+ } /* sr_leed_mode */
+
+/***********************************************************************
+  Return the lower bound of the R factor (+ rgeo), if the LEED program
+  was aborted. The bound exceeds the threshold, i.e. the search
+  algorithm will reject the result.
+***********************************************************************/
+
+ if (iaux == 1)
+ {
+   rfac = (real)rf_bound;
+#ifdef CONTROL
+   fprintf(STDCTR," aborted: rfac > %.4f rtot = %.4f\n", rfac, rgeo + rfac);
+#endif
+   rfac_max = MAX(rfac, rfac_max);
+
+   log_stream = fopen(log_file, "a");
+
+   fprintf(log_stream,"#%3d par:", n_eval);
+   for(i_par=1; i_par <= sr_search->n_par; i_par++)
+     fprintf(log_stream," %.3f", par[i_par]);
+   if(r_lo >= 0.) fprintf(log_stream," rlo:%.4f", r_lo);
+   fprintf(log_stream," **rf>%.4f** rg:%.4f rt:%.4f ",
+           rfac, rgeo, rfac + rgeo);
+
+   t_time = time(NULL);
+   l_time = localtime(&t_time);
+   fprintf(log_stream," dt: %s", asctime(l_time) );
+
+   fclose(log_stream);
+   return(rfac + rgeo);
+ }
 
 /***********************************************************************
   Calculate R factor
@@ -274,14 +410,14 @@ FILE *io_stream, *log_stream;
  if(rfac < rfac_min)
  {
    /* removed dependence on cp system call */
-   char old_path[strlen(sr_project)+5];
-   char new_path[strlen(sr_project)+5];
+   char old_path[strlen(sr_project)+6];
+   char new_path[strlen(sr_project)+6];
    
    /* res file */
    strcpy(old_path, sr_project);
    strcat(old_path, ".res");
    strcpy(new_path, sr_project);
-   strcat(old_path, ".rmin");
+   strcat(new_path, ".rmin");
    if (copy_file(old_path, new_path)) 
    {
      COPY_ERROR_TO_LOG(old_path, new_path);
@@ -291,7 +427,7 @@ FILE *io_stream, *log_stream;
    strcpy(old_path, sr_project);
    strcat(old_path, ".par");
    strcpy(new_path, sr_project);
-   strcat(old_path, ".pmin");
+   strcat(new_path, ".pmin");
    if (copy_file(old_path, new_path)) 
    {
      COPY_ERROR_TO_LOG(old_path, new_path);
@@ -301,7 +437,7 @@ FILE *io_stream, *log_stream;
    strcpy(old_path, sr_project);
    strcat(old_path, ".bsr");
    strcpy(new_path, sr_project);
-   strcat(old_path, ".bmin");
+   strcat(new_path, ".bmin");
    if (copy_file(old_path, new_path)) 
    {
      COPY_ERROR_TO_LOG(old_path, new_path);
@@ -311,6 +447,10 @@ FILE *io_stream, *log_stream;
  }
 
  rfac_max = MAX(rfac, rfac_max);
+
+/* calibrate the low fidelity screening */
+ if(r_lo >= 0.)
+   sr_lofi_calib(r_lo, rfac, (real)(sr_lofi_time() - t_full));
 #endif /* SHORTCUT */
 
 /***********************************************************************
@@ -333,7 +473,23 @@ FILE *io_stream, *log_stream;
   fprintf(log_stream," phi:%.2f",  (par[sr_search->i_par_phi  ]*FAC_PHI)  ); 
   }
 
+/* concentrations (occupancy search) */
+ if(sr_search->sr_occ)
+ {
+   for(i_par = sr_search->n_par - sr_search->n_par_occ + 1;
+       i_par <= sr_search->n_par; i_par ++)
+   {
+     for(i_atoms = 0; ((sr_atoms + i_atoms)->type != I_END_OF_LIST) &&
+                      ((sr_atoms + i_atoms)->i_par_occ != i_par); i_atoms ++)
+       ;
+     if((sr_atoms + i_atoms)->type != I_END_OF_LIST)
+       fprintf(log_stream," occ:%.3f",
+               sr_occ_conc((sr_atoms + i_atoms)->name, par[i_par]*FAC_OCC));
+   }
+ }
+
 
+ if(r_lo >= 0.) fprintf(log_stream," rlo:%.4f", r_lo);
  fprintf(log_stream," rf:%.4f sh: %.1f rg:%.4f rt:%.4f ", 
          rfac, shift, rgeo, rfac + rgeo);
 
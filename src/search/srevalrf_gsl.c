@@ -22,6 +22,14 @@ GH/09.08.04  - use modified bulk file *.bsr and copy to *.bmin if a
                minimum is reached.
 LD/30.04.14  - removed dependence on 'cp' system call, now uses 
                copy_file(char* old_filename, char *new_filename) function.
+AG/17.10.26  - write the concentration parameters of the occupancy search
+               to the log file.
+AG/17.10.26  - log the concentrations (sr_occ_conc) rather than the search
+               parameters.
+AG/17.10.26  - copy minimum files to *.rmin, *.pmin, *.bmin (the suffix
+               was appended to the source file name).
+AG/17.10.26  - calculate IV curves in-process (sr_leed_delta) if selected
+               by sr_leed_mode.
 
 ***********************************************************************/
 #include <stdio.h>
@@ -82,7 +90,7 @@ static int n_eval  = 0;
 static int n_calc  = 0;
 
 int iaux;
-int i_par;
+int i_par, i_atoms;
 real faux;
 real rgeo, rfac;
 
@@ -92,6 +100,7 @@ time_t t_time;
 char line_buffer[STRSZ];
 char log_file[STRSZ];
 char par_file[STRSZ];
+char res_file[STRSZ];
 
 FILE *io_stream, *log_stream;
 
@@ -197,20 +206,31 @@ FILE *io_stream, *log_stream;
 
 #else
 
- sprintf(line_buffer,                 /* added quotation for filepath safety */
-         "\"%s\" -b \"%s.bsr\" -i \"%s\" -o \"%s.res\" > \"%s.out\"",
-         getenv("CSEARCH_LEED"),      /* LEED program name */
-         sr_project,                  /* project name for modified bulk file */
-         par_file,                    /* parameter file for overlayer */
-         sr_project,                  /* project name for results file */
-         sr_project);                 /* project name for output file */
-       
+/* in-process calculation (sr_leed_mode) or LEED program */
+ if(sr_leed_mode(-1))
+ {
+   sprintf(line_buffer, "%s.bsr", sr_project);
+   sprintf(res_file, "%s.res", sr_project);
+   if (sr_leed_delta(line_buffer, par_file, res_file) < 0)
+   {SYS_ERROR_TO_LOG("in-process LEED calculation");}
+ }
+ else
+ {
+   sprintf(line_buffer,                 /* added quotation for filepath safety */
+           "\"%s\" -b \"%s.bsr\" -i \"%s\" -o \"%s.res\" > \"%s.out\"",
+           getenv("CSEARCH_LEED"),      /* LEED program name */
+           sr_project,                  /* project name for modified bulk file */
+           par_file,                    /* parameter file for overlayer */
+           sr_project,                  /* project name for results file */
+           sr_project);                 /* project name for output file */
+
 #ifdef CONTROL
- fprintf(STDCTR,"(sr_evalrf %d): calculate IV curves:\n %s\n", 
-         n_eval, line_buffer); 
+   fprintf(STDCTR,"(sr_evalrf %d): calculate IV curves:\n %s\n", 
+           n_eval, line_buffer); 
 #endif
 
- if (system (line_buffer)) {SYS_ERROR_TO_LOG(line_buffer);}
+   if (system (line_buffer)) {SYS_ERROR_TO_LOG(line_buffer);}
+ }
 
 /***********************************************************************
   Calculate R factor
@@ -276,14 +296,14 @@ FILE *io_stream, *log_stream;
  if(rfac < rfac_min)
  {
    /* removed dependence on cp system call */
-   char old_path[strlen(sr_project)+5];
-   char new_path[strlen(sr_project)+5];
+   char old_path[strlen(sr_project)+6];
+   char new_path[strlen(sr_project)+6];
    
    /* res file */
    strcpy(old_path, sr_project);
    strcat(old_path, ".res");
    strcpy(new_path, sr_project);
-   strcat(old_path, ".rmin");
+   strcat(new_path, ".rmin");
    if (copy_file(old_path, new_path)) 
    {
      COPY_ERROR_TO_LOG(old_path, new_path);
@@ -293,7 +313,7 @@ FILE *io_stream, *log_stream;
    strcpy(old_path, sr_project);
    strcat(old_path, ".par");
    strcpy(new_path, sr_project);
-   strcat(old_path, ".pmin");
+   strcat(new_path, ".pmin");
    if (copy_file(old_path, new_path)) 
    {
      COPY_ERROR_TO_LOG(old_path, new_path);
@@ -303,7 +323,7 @@ FILE *io_stream, *log_stream;
    strcpy(old_path, sr_project);
    strcat(old_path, ".bsr");
    strcpy(new_path, sr_project);
-   strcat(old_path, ".bmin");
+   strcat(new_path, ".bmin");
    if (copy_file(old_path, new_path)) 
    {
      COPY_ERROR_TO_LOG(old_path, new_path);
@@ -337,6 +357,22 @@ FILE *io_stream, *log_stream;
           gsl_vector_get(par, (sr_search->i_par_phi)-1)*FAC_PHI); 
   }
 
+/* concentrations (occupancy search) */
+ if(sr_search->sr_occ)
+ {
+   for(i_par = sr_search->n_par - sr_search->n_par_occ + 1;
+       i_par <= sr_search->n_par; i_par ++)
+   {
+     for(i_atoms = 0; ((sr_atoms + i_atoms)->type != I_END_OF_LIST) &&
+                      ((sr_atoms + i_atoms)->i_par_occ != i_par); i_atoms ++)
+       ;
+     if((sr_atoms + i_atoms)->type != I_END_OF_LIST)
+       fprintf(log_stream," occ:%.3f",
+               sr_occ_conc((sr_atoms + i_atoms)->name,
+                           gsl_vector_get(par, i_par-1)*FAC_OCC));
+   }
+ }
+
 
  fprintf(log_stream," rf:%.4f sh: %.1f rg:%.4f rt:%.4f ", 
          rfac, shift, rgeo, rfac + rgeo);
@@ -18,7 +18,10 @@ SRP/27.09.02 - inserted a 'flag' for testing purposes, writes a brief message
                to the control file.
 SRP/31.03.03 - Inserted a routine to write the angles to the log file for the angle search
 GH/30.12.04 - calculate original and mirrored geometry at the same time and average IV curves.
-
+AG/17.10.26 - write the concentration parameters of the occupancy search
+               to the log file.
+AG/17.10.26 - log the concentrations (sr_occ_conc) rather than the search
+               parameters.
 
 ***********************************************************************/
 #include <stdio.h>
@@ -86,7 +89,7 @@ static int n_eval  = 0;
 static int n_calc  = 0;
 
 int iaux;
-int i_par;
+int i_par, i_atoms;
 real faux;
 real rgeo, rfac;
 
@@ -363,6 +366,21 @@ char *new_path;
   fprintf(log_stream, " phi:%.2f",  (par[sr_search->i_par_phi  ]*FAC_PHI)  ); 
   }
 
+/* concentrations (occupancy search) */
+ if(sr_search->sr_occ)
+ {
+   for(i_par = sr_search->n_par - sr_search->n_par_occ + 1;
+       i_par <= sr_search->n_par; i_par ++)
+   {
+     for(i_atoms = 0; ((sr_atoms + i_atoms)->type != I_END_OF_LIST) &&
+                      ((sr_atoms + i_atoms)->i_par_occ != i_par); i_atoms ++)
+       ;
+     if((sr_atoms + i_atoms)->type != I_END_OF_LIST)
+       fprintf(log_stream," occ:%.3f",
+               sr_occ_conc((sr_atoms + i_atoms)->name, par[i_par]*FAC_OCC));
+   }
+ }
+
 
  fprintf(log_stream," rf:%.4f sh: %.1f rg:%.4f rt:%.4f ", 
          rfac, shift, rgeo, rfac + rgeo);
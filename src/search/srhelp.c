@@ -19,13 +19,21 @@ void search_usage(FILE *output) {
     fprintf(output, "      \t   [-d <delta> -v <vertex_file> -s <search_type> ...]\n");
     fprintf(output, "\n");
     fprintf(output, "Options:\n");
+    fprintf(output, "  -a                    : abort LEED calculations which cannot\n"
+                    "                         improve the simplex (Pendry R factor)\n");
     fprintf(output, "  -b <bul_file>         : bulk parameter input file\n"
                     "                         (assumed same prefix as <inp_file>)\n");
 	fprintf(output, "  -c <ctr_file>         : control file for IV curves\n"
                     "                         (assumed same prefix as <inp_file>)\n");
     fprintf(output, "  -d <delta>            : initial displacement\n");
+    fprintf(output, "  -f <lm>[,<es>[,<ep>]] : screen simplex trials with low fidelity\n"
+                    "                         (l_max, energy step, epsilon)\n");
     fprintf(output, "  -h --help             : print help and exit\n");
 	fprintf(output, "  -i <inp_file>         : surface parameter input file\n");
+    fprintf(output, "  -l                    : calculate IV curves in-process, reusing\n"
+                    "                         unchanged layers\n");
+    fprintf(output, "  -m <budget>           : memory budget (MB) of -l, spill matrices\n"
+                    "                         to scratch files if exceeded\n");
 	fprintf(output, "  -s <search_type>      : can be \n"
                     "                          'ga' = genetic algorithm\n"
                     "                          'sa' = simulated annealing\n"
@@ -0,0 +1,275 @@
+/***********************************************************************
+ AG/17.10.26
+
+ file contains functions:
+
+  int sr_leed_mode(int mode)
+    Switch the in-process LEED calculation on or off.
+  double sr_leed_budget(double budget)
+    Set the memory budget of the in-process LEED calculation.
+  int sr_leed_delta(char *bsr_file, char *par_file, char *res_file)
+    Calculate IV curves in-process, reusing the layer matrices of the
+    previous evaluation.
+
+ In-process LEED calculation (csearch option -l): instead of running
+ the LEED program (CSEARCH_LEED) for each geometry, the input files
+ written by sr_mkinp are read by the LEED library and the intensities
+ are calculated by leed_calc_iv_delta_nd. The layer matrices of all
+ energies are kept between the evaluations; only the layers whose
+ atoms (positions, Debye-Waller factors, phase shifts, concentrations)
+ have changed are recalculated. The results file has the same format
+ as the output of cleed_nsym, i.e. the R factor program is used as
+ before.
+
+ With a memory budget (csearch option -m) the memory needed for all
+ energies is estimated before the first calculation; if it exceeds
+ the budget, matrices are inverted in place and/or the matrices of
+ each energy are written to scratch files <res_file>.scr.<i_eng>
+ (leed_mem_plan_nd), which are removed at the end of the program.
+
+ This file uses the LEED definitions (leed.h); the interface to the
+ search functions uses file names only.
+
+ Changes:
+
+AG/17.10.26 - Creation
+AG/17.10.26 - memory budget (sr_leed_budget, scratch files).
+
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "leed.h"
+
+#ifdef _USE_OPENMP
+#include <omp.h>        /* compile with '-fopenmp' */
+#endif
+
+#define ERROR
+
+static int leed_mode = 0;          /* 1: in-process LEED calculation */
+
+static leed_phs_t *phs_shifts = NULL;     /* kept between the calls */
+static leed_var_t *v_par = NULL;
+static leed_energy_t *eng = NULL;
+static leed_calc_cache_t *cache = NULL;   /* layer matrices */
+static int l_max_gnt = -1;         /* l_max of the Gaunt coefficients */
+static double mem_budget = 0.;     /* memory budget in MB (0: none) */
+
+/*======================================================================*/
+
+static void sr_leed_cleanup(void)
+
+/***********************************************************************
+ Free the stored layer matrices and remove the scratch files (called
+ at the end of the program, see atexit in sr_leed_delta).
+***********************************************************************/
+{
+ leed_calc_cache_free(cache);
+ cache = NULL;
+} /* end of function sr_leed_cleanup */
+
+/*======================================================================*/
+
+int sr_leed_mode(int mode)
+
+/***********************************************************************
+ Switch the in-process LEED calculation on or off.
+
+INPUT:
+ int mode - 1: sr_evalrf calculates the IV curves by sr_leed_delta.
+            0: the LEED program is run (default).
+            Negative values leave the setting unchanged.
+
+RETURN VALUE:
+ previous setting.
+***********************************************************************/
+{
+int old_mode;
+
+ old_mode = leed_mode;
+ if(mode >= 0) leed_mode = mode;
+ return(old_mode);
+} /* end of function sr_leed_mode */
+
+/*======================================================================*/
+
+double sr_leed_budget(double budget)
+
+/***********************************************************************
+ Set the memory budget of the in-process LEED calculation.
+
+INPUT:
+ double budget - memory budget in MB; 0 means no budget.
+            Negative values leave the setting unchanged. The budget is
+            applied when the layer matrices are first stored.
+
+RETURN VALUE:
+ previous setting.
+***********************************************************************/
+{
+double old_budget;
+
+ old_budget = mem_budget;
+ if(budget >= 0.) mem_budget = budget;
+ return(old_budget);
+} /* end of function sr_leed_budget */
+
+/*======================================================================*/
+
+int sr_leed_delta(char *bsr_file, char *par_file, char *res_file)
+
+/***********************************************************************
+ Calculate the IV curves of the geometry in par_file in-process.
+
+INPUT:
+ char *bsr_file - bulk and non-geometrical parameters (*.bsr).
+ char *par_file - overlayer parameters (*.par).
+ char *res_file - (output) results file.
+
+DESIGN:
+ Bulk, overlayer and the parameters of the calculation are read from
+ the input files at each call (the angles of incidence may change in
+ an angle search); the phase shifts are read only once. The beams
+ are generated for the parameters of the current call; the stored
+ layer matrices are discarded by leed_calc_iv_delta_nd if energies,
+ beams or parameters have changed.
+
+RETURN VALUE:
+ 0 if successful.
+ -1 if failed.
+***********************************************************************/
+{
+int i_eng, i_phs;
+int n_set, n_out, n_eng;
+int ret;
+
+real *int_buf;
+
+char scratch[STRSZ];
+
+leed_mem_t mem;
+
+leed_cryst_t *bulk, *over;
+leed_beam_t *beams_all, *beams_out;
+
+FILE *res_stream;
+
+ bulk = over = NULL;
+ beams_all = beams_out = NULL;
+
+/***********************************************************************
+  Read input files (the scattering factors of the previous call are
+  freed; they are recalculated for each energy).
+***********************************************************************/
+
+ if( (v_par != NULL) && (v_par->p_tl != NULL) )
+ {
+   for(i_phs = 0; (phs_shifts + i_phs)->lmax != I_END_OF_LIST; i_phs ++)
+     matfree(v_par->p_tl[i_phs]);
+   free(v_par->p_tl);
+   v_par->p_tl = NULL;
+ }
+
+ leed_inp_read_bul_nd(&bulk, &phs_shifts, bsr_file);
+ leed_inp_leed_read_par(&v_par, &eng, bulk, bsr_file);
+ leed_read_overlayer_nd(&over, &phs_shifts, bulk, par_file);
+
+ n_out = leed_calc_beams_nd(&beams_all, &beams_out, &n_set, bulk, v_par,
+                            eng);
+ if(v_par->l_max != l_max_gnt)
+ {
+   leed_ms_gaunt(LEED_GAUNT_II, v_par->l_max);
+   leed_ms_gaunt(LEED_GAUNT_IJ, v_par->l_max);
+   l_max_gnt = v_par->l_max;
+ }
+
+/***********************************************************************
+  Memory budget: choose the memory saving settings before the layer
+  matrices are stored for the first time.
+***********************************************************************/
+
+ n_eng = leed_calc_n_eng(eng);
+
+ if( (cache == NULL) && (mem_budget > 0.) )
+ {
+   leed_mem_estimate_nd(&mem, beams_all, n_set, bulk, over, v_par, n_eng);
+   leed_mem_plan_nd(&mem, mem_budget * 1048576.);
+
+   if(mem.inv_inplace) matinvmode(MAT_INV_INPLACE);
+#ifdef _USE_OPENMP
+   omp_set_num_threads(mem.n_threads);
+#endif
+   if(mem.spill)
+   {
+     sprintf(scratch, "%s.scr", res_file);
+     cache = leed_calc_cache_alloc(scratch);
+     atexit(sr_leed_cleanup);
+   }
+
+#ifdef CONTROL
+   fprintf(STDCTR, "(sr_leed_delta): memory estimate %.1f MB "
+           "(budget %.1f MB), in-place inversion: %d, scratch files: %d\n",
+           (mem.peak + mem.cache) / 1048576., mem_budget, mem.inv_inplace,
+           mem.spill);
+#endif
+ }
+
+/***********************************************************************
+  Calculate and write IV curves
+***********************************************************************/
+
+ ret = -1;
+ int_buf = (real *)malloc( (n_eng * n_out + 1) * sizeof(real) );
+
+ if(int_buf == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, " *** error (sr_leed_delta): allocation error\n");
+#endif
+ }
+ else if(leed_calc_iv_delta_nd(int_buf, n_eng * n_out, beams_all, n_set,
+                               beams_out, bulk, over, phs_shifts, v_par,
+                               eng, &cache) < 0)
+ {
+#ifdef ERROR
+   fprintf(STDERR, " *** error (sr_leed_delta): calculation failed\n");
+#endif
+ }
+ else if( (res_stream = fopen(res_file, "w")) == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, " *** error (sr_leed_delta): could not open \"%s\"\n",
+           res_file);
+#endif
+ }
+ else
+ {
+   leed_out_head(res_stream);
+   leed_output_beam_head(res_stream, beams_out, n_out, n_eng,
+                         eng->ini, eng->fin, eng->stp);
+   for(i_eng = 0; i_eng < n_eng; i_eng ++)
+   {
+     v_par->eng_v = eng->ini + i_eng * eng->stp;
+     leed_output_int_list(int_buf + i_eng*n_out, n_out, v_par, res_stream);
+   }
+   fclose(res_stream);
+   ret = 0;
+ }
+
+/***********************************************************************
+  Free bulk and overlayer (over shares m_plane with bulk)
+***********************************************************************/
+
+ free(int_buf);
+ free(beams_all);
+ free(beams_out);
+ leed_inp_free_nd(over, 0);
+ free(over);
+ leed_inp_free_nd(bulk, 1);
+ free(bulk);
+
+ return(ret);
+} /* end of function sr_leed_delta */
@@ -0,0 +1,419 @@
+/***********************************************************************
+ AG/17.10.26
+
+ file contains functions:
+
+  int sr_lofi_mode(int lm, real e_step, real eps)
+    Switch the low fidelity screening on or off.
+  int sr_lofi_eval(real *p_rlo)
+    Calculate the R factor at low fidelity.
+  int sr_lofi_screen(real r_lo, real rf_thr, real *p_rest)
+    Decide whether a full evaluation is needed.
+  void sr_lofi_calib(real r_lo, real r_hi, real t_hi)
+    Calibrate the screening with a pair of R factors.
+  double sr_lofi_time(void)
+    Wall clock time (s) for the timing of the calculations.
+
+ Multi-fidelity evaluation: a trial geometry of the simplex is first
+ calculated with reduced l_max, a coarser energy grid and/or a larger
+ epsilon (beam cutoff). These parameters are replaced in a copy of the
+ bulk file (*.bsl); results and R factor output are written to *.rlo
+ and *.dlo. Only if the low fidelity R factor, corrected by the
+ calibrated margin, can be better than the worst vertex, the geometry
+ is calculated at full accuracy. The screening is switched off if
+ the geometries it saves cannot pay for the low fidelity calculations.
+
+ Changes:
+
+AG/17.10.26 - Creation
+AG/17.10.26 - calibrate with mean + LOFI_K * sd of r_lo - r_hi; switch
+              the screening off if it does not save time.
+AG/17.10.26 - wall clock time with sub-second resolution (sr_lofi_time);
+              the time is compared also for fast calculations.
+
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <sys/time.h>
+#endif
+
+#include "search.h"
+
+#define WARNING
+#define ERROR
+
+/*
+  Define the following parameters if not yet defined in "search_def.h"
+*/
+#ifndef SR_EVAL_DEF
+#define RFAC_TYP    "rp"
+#define RFAC_SHIFT_STEP   0.5
+#define RFAC_SHIFT_RANGE  5.
+#endif
+
+#define LOFI_N_CALIB  5    /* number of full evaluations before screening */
+#define LOFI_K        3.   /* deviation r_lo - r_hi: mean + LOFI_K * sd */
+#define LOFI_N_CHECK  10   /* screenings between checks of the time */
+
+extern char *sr_project;
+
+static int  lofi_on = 0;         /* 1: low fidelity screening on */
+static int  lofi_lm = 0;         /* l_max (0: as in bulk file) */
+static real lofi_es = 0.;        /* energy step (0: as in bulk file) */
+static real lofi_ep = 0.;        /* epsilon (0: as in bulk file) */
+
+static int  lofi_n_pair = 0;     /* number of pairs (r_lo, r_hi) */
+static real lofi_sum = 0.;       /* sum of the deviations r_lo - r_hi */
+static real lofi_sum2 = 0.;      /* sum of the squared deviations */
+
+static int  lofi_n_lo = 0;       /* number of low fidelity calculations */
+static real lofi_t_lo = 0.;      /* their total time (s) */
+static real lofi_t_hi = 0.;      /* total time of the n_pair full calc. */
+static int  lofi_n_scr = 0;      /* screenings after the calibration */
+static int  lofi_n_skip = 0;     /* full calculations saved by these */
+
+/*======================================================================*/
+
+int sr_lofi_mode(int lm, real e_step, real eps)
+
+/***********************************************************************
+ Switch the low fidelity screening on or off.
+
+INPUT:
+ int lm - l_max of the low fidelity calculations.
+ real e_step - energy step (eV) of the low fidelity calculations.
+ real eps - epsilon (beam cutoff) of the low fidelity calculations.
+
+             Values <= 0 of e_step, eps and lm = 0 leave the value of
+             the bulk file unchanged; the screening is switched on if
+             any of the values is changed, otherwise it is switched off.
+             Negative lm leaves all settings unchanged.
+
+RETURN VALUE:
+ 1 if the screening is on, 0 otherwise (after the call).
+***********************************************************************/
+{
+ if(lm >= 0)
+ {
+   lofi_lm = lm;
+   lofi_es = (e_step > 0.)? e_step: 0.;
+   lofi_ep = (eps > 0.)? eps: 0.;
+   lofi_on = (lofi_lm > 0) || (lofi_es > 0.) || (lofi_ep > 0.);
+ }
+ return(lofi_on);
+} /* end of function sr_lofi_mode */
+
+/*======================================================================*/
+
+int sr_lofi_eval(real *p_rlo)
+
+/***********************************************************************
+ Calculate IV curves and R factor at low fidelity.
+
+INPUT:
+ real *p_rlo - (output) low fidelity R factor.
+
+DESIGN:
+ The input files of the full calculation (*.par, *.bsr, see sr_mkinp)
+ must exist. *.bsr is copied to *.bsl where the lines "lm:", "es:" and
+ "ep:" are replaced (or appended) according to sr_lofi_mode. The LEED
+ and R factor programs are the same as in sr_evalrf.
+
+RETURN VALUE:
+ 0 if successful.
+ -1 if failed.
+***********************************************************************/
+{
+int i_str;
+int new_lm, new_es, new_ep;
+int iaux;
+real faux, shift;
+
+double t_start;
+
+char line_buffer[STRSZ];
+char bsr_file[STRSZ];
+char bsl_file[STRSZ];
+
+FILE *io_stream, *bsr_stream;
+
+/***********************************************************************
+  Low fidelity bulk file
+***********************************************************************/
+
+ t_start = sr_lofi_time();
+
+ sprintf(bsr_file, "%s.bsr", sr_project);
+ sprintf(bsl_file, "%s.bsl", sr_project);
+
+ if( (bsr_stream = fopen(bsr_file, "r")) == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, " *** error (sr_lofi_eval): could not open \"%s\"\n",
+           bsr_file);
+#endif
+   return(-1);
+ }
+ if( (io_stream = fopen(bsl_file, "w")) == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, " *** error (sr_lofi_eval): could not open \"%s\"\n",
+           bsl_file);
+#endif
+   fclose(bsr_stream);
+   return(-1);
+ }
+
+ /* 1: parameter to be written */
+ new_lm = (lofi_lm > 0);
+ new_es = (lofi_es > 0.);
+ new_ep = (lofi_ep > 0.);
+
+ while( fgets(line_buffer, STRSZ, bsr_stream) != NULL)
+ {
+   /* find first non blank character */
+   for( i_str = 0;  *(line_buffer+i_str) == ' '; i_str ++);
+
+   if( (lofi_lm > 0) && !strncasecmp(line_buffer+i_str, "lm:", 3) )
+   {
+     fprintf(io_stream, "lm: %d\n", lofi_lm);
+     new_lm = 0;
+   }
+   else if( (lofi_es > 0.) && !strncasecmp(line_buffer+i_str, "es:", 3) )
+   {
+     fprintf(io_stream, "es: %.2f\n", lofi_es);
+     new_es = 0;
+   }
+   else if( (lofi_ep > 0.) && !strncasecmp(line_buffer+i_str, "ep:", 3) )
+   {
+     fprintf(io_stream, "ep: %.2e\n", lofi_ep);
+     new_ep = 0;
+   }
+   else
+     fprintf(io_stream, "%s", line_buffer);
+ }
+
+ /* parameters not in the bulk file */
+ if(new_lm) fprintf(io_stream, "lm: %d\n", lofi_lm);
+ if(new_es) fprintf(io_stream, "es: %.2f\n", lofi_es);
+ if(new_ep) fprintf(io_stream, "ep: %.2e\n", lofi_ep);
+
+ fclose(bsr_stream);
+ fclose(io_stream);
+
+/***********************************************************************
+  Calculate IV curves
+***********************************************************************/
+
+ sprintf(line_buffer,
+         "\"%s\" -b \"%s.bsl\" -i \"%s.par\" -o \"%s.rlo\" > \"%s.olo\"",
+         getenv("CSEARCH_LEED"),      /* LEED program name */
+         sr_project,                  /* low fidelity bulk file */
+         sr_project,                  /* parameter file for overlayer */
+         sr_project,                  /* low fidelity results file */
+         sr_project);                 /* low fidelity output file */
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(sr_lofi_eval): calculate IV curves:\n %s\n", line_buffer);
+#endif
+
+ if (system (line_buffer))
+ {
+#ifdef ERROR
+   fprintf(STDERR, " *** error (sr_lofi_eval): \"%s\" failed\n", line_buffer);
+#endif
+   return(-1);
+ }
+
+/***********************************************************************
+  Calculate R factor
+***********************************************************************/
+
+ sprintf(line_buffer,
+         "\"%s\" -t \"%s.rlo\" -c \"%s.ctr\" -r \"%s\" -s %.2f,%.2f,%.2f > \"%s.dlo\"",
+         getenv("CSEARCH_RFAC"),      /* R factor program name */
+         sr_project,                  /* low fidelity results file */
+         sr_project,                  /* project name for control file */
+         RFAC_TYP,                    /* type of R factor */
+         - RFAC_SHIFT_RANGE,          /* initial shift */
+         + RFAC_SHIFT_RANGE,          /* final shift */
+         RFAC_SHIFT_STEP,             /* step of shift */
+         sr_project);                 /* low fidelity R factor output */
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(sr_lofi_eval): calculate R factor:\n %s\n", line_buffer);
+#endif
+
+ if (system (line_buffer))
+ {
+#ifdef ERROR
+   fprintf(STDERR, " *** error (sr_lofi_eval): \"%s\" failed\n", line_buffer);
+#endif
+   return(-1);
+ }
+
+/* Read R factor value from output file */
+
+ sprintf(line_buffer, "%s.dlo", sr_project);
+ if( (io_stream = fopen(line_buffer, "r")) == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, " *** error (sr_lofi_eval): could not open \"%s\"\n",
+           line_buffer);
+#endif
+   return(-1);
+ }
+
+ iaux = 0;
+ while( fgets(line_buffer, STRSZ, io_stream) != NULL)
+ {
+   if(
+#ifdef REAL_IS_DOUBLE
+       (iaux = sscanf(line_buffer, "%lf %lf %lf", p_rlo, &faux, &shift) )
+#endif
+#ifdef REAL_IS_FLOAT
+       (iaux = sscanf(line_buffer, "%f %f %f",    p_rlo, &faux, &shift) )
+#endif
+       == 3) break;
+ }
+ fclose(io_stream);
+
+ if(iaux != 3)
+ {
+#ifdef ERROR
+   fprintf(STDERR, " *** error (sr_lofi_eval): "
+           "could not read R factor from \"%s.dlo\"\n", sr_project);
+#endif
+   return(-1);
+ }
+
+/* time of the low fidelity calculation (sr_lofi_screen) */
+ lofi_t_lo += (real)(sr_lofi_time() - t_start);
+ lofi_n_lo ++;
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(sr_lofi_eval): r_lo = %.4f\n", *p_rlo);
+#endif
+
+ return(0);
+} /* end of function sr_lofi_eval */
+
+/*======================================================================*/
+
+int sr_lofi_screen(real r_lo, real rf_thr, real *p_rest)
+
+/***********************************************************************
+ Decide whether a geometry must be calculated at full accuracy.
+
+INPUT:
+ real r_lo - low fidelity R factor.
+ real rf_thr - threshold for the R factor: the search algorithm rejects
+             the geometry if R >= rf_thr.
+ real *p_rest - (output) estimate of the full R factor if no full
+             calculation is needed (> rf_thr).
+
+DESIGN:
+ As long as less than LOFI_N_CALIB pairs are known (sr_lofi_calib), all
+ geometries are calculated at full accuracy. Afterwards the full R
+ factor is estimated as r_lo - dev where dev = mean + LOFI_K * sd of
+ the deviations r_lo - r_hi found so far; if this estimate is above
+ the threshold, the geometry is not calculated at full accuracy.
+
+ The screening pays if the time of the saved full calculations exceeds
+ the time of the low fidelity calculations, i.e. if
+ n_skip * <t_hi> > n_scr * <t_lo> (n_scr screenings after the
+ calibration, n_skip of them without full calculation). This is checked
+ after every LOFI_N_CHECK screenings (directly after the calibration:
+ <t_lo> < <t_hi>); if it fails, the screening is switched off for the
+ rest of the search.
+
+RETURN VALUE:
+ 1 if a full calculation is needed.
+ 0 otherwise.
+***********************************************************************/
+{
+real mean, sd, t_lo, t_hi;
+
+ if(lofi_n_pair < LOFI_N_CALIB) return(1);
+
+/*
+  Switch off if the saved time cannot pay for the screening: directly
+  after the calibration if a low fidelity calculation is not faster
+  than a full one, later if too few geometries were screened out.
+*/
+ t_lo = (lofi_n_lo > 0)? lofi_t_lo / lofi_n_lo: 0.;
+ t_hi = lofi_t_hi / lofi_n_pair;
+ if( (lofi_n_scr % LOFI_N_CHECK == 0) &&
+     ( ( (lofi_n_scr == 0) && (t_lo >= t_hi) ) ||
+       ( (lofi_n_scr > 0) && (lofi_n_skip * t_hi <= lofi_n_scr * t_lo) ) ) )
+ {
+   lofi_on = 0;
+#ifdef WARNING
+   fprintf(STDWAR, "* warning (sr_lofi_screen): screening switched off "
+           "(%d of %d saved, t_lo = %.3f s, t_hi = %.3f s)\n",
+           lofi_n_skip, lofi_n_scr, t_lo, t_hi);
+#endif
+   return(1);
+ }
+
+ mean = lofi_sum / lofi_n_pair;
+ sd = (lofi_sum2 - lofi_n_pair * mean * mean) / (lofi_n_pair - 1);
+ sd = (sd > 0.)? R_sqrt(sd): 0.;
+
+ lofi_n_scr ++;
+ *p_rest = r_lo - (mean + LOFI_K * sd);
+ if(*p_rest > rf_thr)
+ {
+   lofi_n_skip ++;
+   return(0);
+ }
+
+ return(1);
+} /* end of function sr_lofi_screen */
+
+/*======================================================================*/
+
+void sr_lofi_calib(real r_lo, real r_hi, real t_hi)
+
+/***********************************************************************
+ Calibrate the screening with the R factors of a geometry calculated
+ at low (r_lo) and full (r_hi) accuracy; t_hi is the time (s) of the
+ full calculation.
+***********************************************************************/
+{
+ lofi_sum  += r_lo - r_hi;
+ lofi_sum2 += SQUARE(r_lo - r_hi);
+ lofi_t_hi += t_hi;
+ lofi_n_pair ++;
+
+#ifdef CONTROL
+ fprintf(STDCTR, "(sr_lofi_calib): %d pairs, mean deviation %.4f\n",
+         lofi_n_pair, lofi_sum / lofi_n_pair);
+#endif
+} /* end of function sr_lofi_calib */
+
+/*======================================================================*/
+
+double sr_lofi_time(void)
+
+/***********************************************************************
+ Wall clock time (s) with sub-second resolution. The full calculation
+ may run in a separate process, so the CPU time of the search is not
+ a measure of its cost.
+***********************************************************************/
+{
+#ifndef _WIN32
+struct timeval tv;
+
+ gettimeofday(&tv, NULL);
+ return( (double)tv.tv_sec + 1.e-6 * (double)tv.tv_usec );
+#else
+ return( (double)clock() / CLOCKS_PER_SEC );  /* elapsed time on Windows */
+#endif
+} /* end of function sr_lofi_time */
@@ -13,6 +13,9 @@ GH/22.08.95 - Creation (copy from srmkinp.c)
 SRP/31.03.03 - Added a section for the angle search
 GH/09.08.04 - Copy bulk parameters (except angles from *.bul and write to *.bsr
 LD/01.07.2014 - Modified to use GNU Scientific Library Structures
+AG/17.10.26 - Concentrations of mixtures for the occupancy search.
+AG/17.10.26 - line_buffer is static (name is also used in the R factor
+              library which is linked to the search library).
 
 ***********************************************************************/
 
@@ -29,10 +32,14 @@ LD/01.07.2014 - Modified to use GNU Scientific Library Structures
 #define FAC_PHI   50.
 #endif
 
+#ifndef FAC_OCC
+#define FAC_OCC   1.
+#endif
+
 extern struct sratom_str *sr_atoms;
 extern struct search_str *sr_search;
 
-char line_buffer[STRSZ];
+static char line_buffer[STRSZ];
 
 int sr_mkinp_gsl(const gsl_vector *par, int i_call, const char *filename)
 
@@ -47,6 +54,8 @@ INPUT:
 int i_atoms, i_par;
 int i_str;
 
+char occ_name[STRSZ];  /* mixture for the occupancy search */
+
 real faux;
 real x, y, z;
 real theta, phi; /* Added for the angle search (SRP 31.03.03) */
@@ -97,8 +106,14 @@ FILE *iv_bul_out;
      z += faux * (sr_atoms + i_atoms)->z_par[i_par];
    }
 
+   if((sr_atoms + i_atoms)->i_par_occ > 0)
+     sr_occ_name(occ_name, (sr_atoms + i_atoms)->name, FAC_OCC *
+                 gsl_vector_get(par, (sr_atoms + i_atoms)->i_par_occ - 1));
+   else
+     strncpy(occ_name, (sr_atoms + i_atoms)->name, STRSZ);
+
    fprintf(iv_par, "po: %s %f %f %f dr1 %f\n",
-                  (sr_atoms + i_atoms)->name,
+                  occ_name,
                   x, y, z, 
                   (sr_atoms + i_atoms)->dr);
  } /* for i_atoms */
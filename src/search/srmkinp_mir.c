@@ -14,6 +14,9 @@ GH/30.12.04 - introduce bul for mirrored geometry
 
 GH/22.08.95 - Creation (copy from srmkinp.c)
 SRP/31.03.03 - Added a section for the angle search
+AG/17.10.26 - Concentrations of mixtures for the occupancy search.
+AG/17.10.26 - line_buffer is static (name is also used in the R factor
+              library which is linked to the search library).
 
 ***********************************************************************/
 
@@ -30,10 +33,14 @@ SRP/31.03.03 - Added a section for the angle search
 #define FAC_PHI   50.
 #endif
 
+#ifndef FAC_OCC
+#define FAC_OCC   1.
+#endif
+
 extern struct sratom_str *sr_atoms;
 extern struct search_str *sr_search;
 
-char line_buffer[STRSZ];
+static char line_buffer[STRSZ];
 
 int sr_mkinp_mir(real *par, int i_call, char *filename)
 
@@ -48,6 +55,8 @@ INPUT:
 int i_atoms, i_par;
 int i_str;
 
+char occ_name[STRSZ];  /* mixture for the occupancy search */
+
 real x, y, z;
 real theta, phi; /* Added for the angle search (SRP 31.03.03) */
 
@@ -100,8 +109,14 @@ FILE *iv_bul_mir;
      z += par[i_par] * (sr_atoms + i_atoms)->z_par[i_par];
    }
 
+   if((sr_atoms + i_atoms)->i_par_occ > 0)
+     sr_occ_name(occ_name, (sr_atoms + i_atoms)->name,
+                 par[(sr_atoms + i_atoms)->i_par_occ] * FAC_OCC);
+   else
+     strncpy(occ_name, (sr_atoms + i_atoms)->name, STRSZ);
+
    fprintf(iv_par,"po: %s %f %f %f dr1 %f\n",
-                  (sr_atoms + i_atoms)->name,
+                  occ_name,
                   x, y, z, 
                   (sr_atoms + i_atoms)->dr);
  } /* for i_atoms */
@@ -0,0 +1,173 @@
+/***********************************************************************
+ AG/17.10.26
+
+ file contains function:
+
+  int sr_occ_name(char *mix_name, const char *name, real d_occ)
+  real sr_occ_conc(const char *name, real d_occ)
+
+ Change the concentrations of a mixture (average t matrix).
+
+ Changes:
+
+AG/17.10.26 - Creation
+AG/17.10.26 - sr_occ_conc: concentration of the first component (log file).
+
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "search.h"
+
+#define ERROR
+
+int sr_occ_name(char *mix_name, const char *name, real d_occ)
+
+/***********************************************************************
+ Change the concentration of the first component of a mixture.
+
+INPUT:
+ char *mix_name - (output) new mixture (at least STRSZ characters).
+ const char *name - mixture "<phs>*<c>+<phs>*<c>+..." as used in the
+             "po:" lines of the LEED input (see leed_inp_phase_mix_nd);
+             a missing concentration is 1.
+ real d_occ - change of the concentration of the first component.
+
+DESIGN:
+ The concentration c1 of the first component becomes
+ c1' = c1 + d_occ, confined to [0, 1]. The concentrations of all other
+ components are scaled such that the sum of all concentrations (and
+ therefore the vacancy concentration 1 - sum) is unchanged, i.e. the
+ first component substitutes the others. If c1' exceeds the original
+ sum, the other components are zero and the vacancy concentration
+ decreases.
+
+RETURN VALUE:
+ number of components.
+ -1 if failed (mix_name is a copy of name).
+***********************************************************************/
+{
+int i_mix, n_mix;
+int i_str, len;
+
+real c_sum, c_rest, fac;
+
+real *conc;
+const char **comp;
+const char *ptr;
+
+ strncpy(mix_name, name, STRSZ);
+ mix_name[STRSZ - 1] = '\0';
+
+/*
+  Split into components (pointers to the phase names) and
+  concentrations.
+*/
+ for(n_mix = 1, ptr = name; (ptr = strchr(ptr, '+')) != NULL; ptr ++)
+   n_mix ++;
+
+ conc = (real *)malloc(n_mix * sizeof(real));
+ comp = (const char **)malloc(n_mix * sizeof(char *));
+ if( (conc == NULL) || (comp == NULL) )
+ {
+#ifdef ERROR
+   fprintf(STDERR, " *** error (sr_occ_name): allocation error\n");
+#endif
+   free(conc);
+   free((void *)comp);
+   return(-1);
+ }
+
+ c_sum = 0.;
+ for(i_mix = 0, ptr = name; i_mix < n_mix; i_mix ++)
+ {
+   comp[i_mix] = ptr;
+   conc[i_mix] = 1.;
+   for(len = 0; (ptr[len] != '\0') && (ptr[len] != '+'); len ++)
+     if(ptr[len] == '*') conc[i_mix] = (real)atof(ptr + len + 1);
+
+   c_sum += conc[i_mix];
+   ptr += len + 1;
+ }
+
+/* new concentrations */
+ c_rest = c_sum - conc[0];
+
+ conc[0] += d_occ;
+ if(conc[0] < 0.) conc[0] = 0.;
+ if(conc[0] > 1.) conc[0] = 1.;
+
+ if(c_rest > 0.)
+ {
+   fac = (c_sum - conc[0]) / c_rest;
+   if(fac < 0.) fac = 0.;
+   for(i_mix = 1; i_mix < n_mix; i_mix ++) conc[i_mix] *= fac;
+ }
+
+/* write new mixture */
+ for(i_mix = 0, i_str = 0; i_mix < n_mix; i_mix ++)
+ {
+   for(len = 0;
+       (comp[i_mix][len] != '\0') && (comp[i_mix][len] != '+') &&
+       (comp[i_mix][len] != '*'); len ++)
+     ;
+
+   if(i_str + len + 10 >= STRSZ)
+   {
+#ifdef ERROR
+     fprintf(STDERR, " *** error (sr_occ_name): mixture \"%s\" too long\n",
+             name);
+#endif
+     strncpy(mix_name, name, STRSZ);
+     mix_name[STRSZ - 1] = '\0';
+     n_mix = -1;
+     break;
+   }
+
+   if(i_mix > 0) mix_name[i_str ++] = '+';
+   strncpy(mix_name + i_str, comp[i_mix], len);
+   i_str += len;
+   i_str += sprintf(mix_name + i_str, "*%.4f", conc[i_mix]);
+ }
+
+ free(conc);
+ free((void *)comp);
+
+ return(n_mix);
+} /* end of function sr_occ_name */
+
+/*======================================================================*/
+
+real sr_occ_conc(const char *name, real d_occ)
+
+/***********************************************************************
+ Concentration of the first component of a mixture after a change.
+
+INPUT:
+ const char *name - mixture (see sr_occ_name).
+ real d_occ - change of the concentration of the first component.
+
+DESIGN:
+ Same mapping as in sr_occ_name: c1' = c1 + d_occ, confined to [0, 1].
+ Used to write the concentration (rather than the search parameter)
+ to the log file.
+
+RETURN VALUE:
+ new concentration c1' of the first component.
+***********************************************************************/
+{
+int len;
+real conc;
+
+ conc = 1.;
+ for(len = 0; (name[len] != '\0') && (name[len] != '+'); len ++)
+   if(name[len] == '*') conc = (real)atof(name + len + 1);
+
+ conc += d_occ;
+ if(conc < 0.) conc = 0.;
+ if(conc > 1.) conc = 1.;
+
+ return(conc);
+} /* end of function sr_occ_conc */
@@ -20,6 +20,7 @@ WB/29.09.98 - change BUFSZ and some CONTROLS ...
               set for allocation sr_atoms : n_atoms+2 
 GH/29.09.00 - calculate dr2 for dmt input in function leed_inp_debye_temp
 GH/31.03.03 - Added theta_0 and phi_0 for the angle search, use i_par_theta/phi
+AG/17.10.26 - Read "so:" (occupancy search), set i_par_occ of mixtures.
 
 ***********************************************************************/
 
@@ -220,6 +221,8 @@ struct type_str *types;      /* this vector of structure type_str is
   sr_search->b_lat[iaux] = 0.;
 
  sr_search->sr_angle = 0; /* added for the angle search */
+ sr_search->sr_occ = 0;   /* occupancy search */
+ sr_search->n_par_occ = 0;
  sr_search->z_only = 0;
  sr_search->rot_deg = 1;
  sr_search->rot_axis[1] = sr_search->rot_axis[2] = 0.;
@@ -614,6 +617,7 @@ po:
 
      (sr_atoms+n_atoms)->ref  = I_END_OF_LIST;
      (sr_atoms+n_atoms)->nref = I_END_OF_LIST;
+     (sr_atoms+n_atoms)->i_par_occ = 0;
 
      #ifdef REAL_IS_DOUBLE
        iaux = sscanf(buf+i_str+3 ," %s %lf %lf %lf %s %lf %lf %lf",
@@ -955,6 +959,23 @@ sa:
        #endif
    } /* sa */
 
+/***********************************
+so:
+  1 = occupancy search on: the concentration of the first component
+      of each mixture ("<phs>*<c>+<phs>*<c>", average t matrix) is
+      an additional search parameter,
+  0 = occupancy search is off (default)
+***********************************/
+   else if( !strncasecmp(buf+i_str,"so:",3) )
+   {
+       iaux = sscanf(buf+i_str+3 ," %d", &(sr_search->sr_occ) );
+       if(iaux < 1) sr_search->sr_occ = 1;
+       #ifdef CONTROL
+         if (sr_search->sr_occ) 
+           fprintf(STDCTR, "(sr_rdinp): Occupancy search is on\n");
+       #endif
+   } /* so */
+
 
 /***********************************
 spn:
@@ -1311,5 +1332,43 @@ zr:
    sr_search->i_par_theta = 0;
  }
 
+/* 
+  one more parameter for each mixture in the occupancy search;
+  atoms with the same mixture share the parameter.
+*/
+ sr_search->n_par_occ = 0;
+ if(sr_search->sr_occ)
+ {
+   for(i_atoms = 0; i_atoms < n_atoms; i_atoms ++)
+   {
+     if(strchr((sr_atoms + i_atoms)->name, '*') == NULL) continue;
+
+     for(iaux = 0; iaux < i_atoms; iaux ++)
+       if( ((sr_atoms + iaux)->i_par_occ > 0) &&
+           (strcmp((sr_atoms + iaux)->name, (sr_atoms + i_atoms)->name) == 0) )
+         break;
+
+     if(iaux < i_atoms)
+       (sr_atoms + i_atoms)->i_par_occ = (sr_atoms + iaux)->i_par_occ;
+     else
+     {
+       sr_search->n_par_occ ++;
+       sr_search->n_par ++;
+       n_par ++;
+       (sr_atoms + i_atoms)->i_par_occ = n_par;
+     }
+   }
+
+   #ifdef CONTROL
+     fprintf(STDCTR,"(sr_rdinp): %d concentration parameters\n",
+             sr_search->n_par_occ);
+   #endif
+   #ifdef WARNING
+     if(sr_search->n_par_occ == 0)
+       fprintf(STDWAR,"* warning (sr_rdinp): occupancy search without "
+               "mixtures (\"<phs>*<c>+...\")\n");
+   #endif
+ }
+
  return(n_par);
 }
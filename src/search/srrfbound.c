@@ -0,0 +1,241 @@
+/***********************************************************************
+ AG/17.10.26
+
+ file contains functions:
+
+  int sr_rf_abort_mode(int abort)
+    Switch the early abort of LEED calculations on or off.
+  double sr_rf_threshold(double rf_thr)
+    Set the R factor threshold of the next evaluations
+    (also used by the low fidelity screening, srlofi.c).
+  int sr_leed_stream(const char *leed_cmd, const char *res_file,
+                     int rf_argc, char *rf_argv[], double rf_thr,
+                     double *p_bound)
+    Run the LEED program and abort if the R factor exceeds a threshold.
+
+ The LEED programs write (and flush) the intensities of each energy as
+ soon as they are calculated. While the LEED program is running, the
+ R factor program's input is read in part and a lower bound of the
+ final R factor is calculated (cr_rbound_args, R factor library). If
+ the bound exceeds the threshold given by the search algorithm (e.g.
+ the worst vertex of the simplex), the result is known to be rejected
+ and the LEED program is terminated.
+
+ This file uses the R factor definitions (crfac.h: real is float); the
+ interface to the search functions uses double.
+
+ Changes:
+
+AG/17.10.26 - Creation
+AG/17.10.26 - sr_rf_threshold: the threshold is set independently of
+              the abort mode.
+
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+#include "crfac.h"
+
+#define ERROR
+#define WARNING
+
+#define SR_POLL_NS 200000000L      /* 0.2 s between checks of res_file */
+
+static int rf_abort = 0;           /* 1: early abort switched on */
+static double rf_thr_next = 0.;    /* threshold of the next evaluations */
+
+/*======================================================================*/
+
+int sr_rf_abort_mode(int abort)
+
+/***********************************************************************
+ Switch the early abort of LEED calculations on or off.
+
+INPUT:
+ int abort - 1: sr_leed_stream is used by sr_evalrf (on).
+             0: the LEED program is run by system() (default).
+             Negative values leave the setting unchanged.
+
+RETURN VALUE:
+ previous setting.
+***********************************************************************/
+{
+int old_abort;
+
+ old_abort = rf_abort;
+ if(abort >= 0) rf_abort = abort;
+ return(old_abort);
+} /* end of function sr_rf_abort_mode */
+
+/*======================================================================*/
+
+double sr_rf_threshold(double rf_thr)
+
+/***********************************************************************
+ Set the threshold of the next evaluations of the R factor.
+
+INPUT:
+ double rf_thr - value of the function to be minimised above which an
+             evaluation is not used by the search algorithm
+             (R factor + geometrical penalty, see sr_evalrf).
+             0 switches the threshold off; negative values leave it
+             unchanged.
+
+RETURN VALUE:
+ previous threshold (0. if none).
+***********************************************************************/
+{
+double old_thr;
+
+ old_thr = rf_thr_next;
+ if(rf_thr >= 0.) rf_thr_next = rf_thr;
+ return(old_thr);
+} /* end of function sr_rf_threshold */
+
+/*======================================================================*/
+
+int sr_leed_stream(const char *leed_cmd, const char *res_file,
+                   int rf_argc, char *rf_argv[], double rf_thr,
+                   double *p_bound)
+
+/***********************************************************************
+ Run the LEED program and abort as soon as the R factor of the results
+ cannot be below a threshold.
+
+INPUT:
+ const char *leed_cmd - command line of the LEED program (as for
+             system()).
+ const char *res_file - results file written by the LEED program.
+ int rf_argc, char *rf_argv[] - argument list of the R factor program
+             (see cr_rdargs), used for the lower bound.
+ double rf_thr - threshold for the R factor. If negative, the LEED
+             program is run without monitoring.
+ double *p_bound - (output) lower bound of the R factor if the
+             calculation was aborted.
+
+DESIGN:
+ The old res_file is removed and the LEED program is started in a
+ child process (its own process group, so that worker processes of the
+ LEED program are terminated as well). Whenever new lines of
+ intensities appear in res_file, the lower bound of the R factor is
+ calculated (cr_rbound_args). If it exceeds rf_thr, the process group
+ is terminated.
+ Without fork (_WIN32) the LEED program is run by system().
+
+RETURN VALUE:
+ 0 if the LEED program has finished successfully.
+ 1 if the calculation was aborted (*p_bound > rf_thr).
+ -1 if the LEED program failed.
+***********************************************************************/
+{
+#ifndef _WIN32
+int n_lines, n_checked;
+int status;
+int c, comment, new_line;
+double bound;
+
+pid_t pid, w_pid;
+struct timespec t_poll;
+FILE *res_stream;
+#endif
+
+ if(rf_thr < 0.)
+   return( system(leed_cmd)? -1: 0 );
+
+#ifdef _WIN32
+
+ return( system(leed_cmd)? -1: 0 );
+
+#else
+
+/***********************************************************************
+  Start the LEED program
+  (the old results must not be read as results of this calculation)
+***********************************************************************/
+
+ remove(res_file);
+
+ fflush(NULL);
+ pid = fork();
+ if(pid < 0)
+ {
+#ifdef WARNING
+   fprintf(STDWAR, "* warning (sr_leed_stream): fork failed, "
+           "LEED program is not monitored\n");
+#endif
+   return( system(leed_cmd)? -1: 0 );
+ }
+
+ if(pid == 0)
+ {
+   setpgid(0, 0);
+   execl("/bin/sh", "sh", "-c", leed_cmd, (char *)NULL);
+   _exit(127);
+ }
+ setpgid(pid, pid);
+
+/***********************************************************************
+  Check the R factor bound whenever new energies are available
+***********************************************************************/
+
+ t_poll.tv_sec = 0;
+ t_poll.tv_nsec = SR_POLL_NS;
+
+ n_checked = 0;
+ while( (w_pid = waitpid(pid, &status, WNOHANG)) == 0 )
+ {
+   nanosleep(&t_poll, NULL);
+
+   /* complete lines of intensities */
+   n_lines = 0;
+   if( (res_stream = fopen(res_file, "r")) != NULL)
+   {
+     comment = 0;
+     new_line = 1;
+     while( (c = fgetc(res_stream)) != EOF )
+     {
+       if(new_line) comment = (c == '#');
+       new_line = (c == '\n');
+       if(new_line && ! comment) n_lines ++;
+     }
+     fclose(res_stream);
+   }
+   if(n_lines <= n_checked) continue;
+   n_checked = n_lines;
+
+   bound = cr_rbound_args(rf_argc, rf_argv);
+   if(bound > rf_thr)
+   {
+     kill(-pid, SIGTERM);
+     waitpid(pid, &status, 0);
+
+#ifdef CONTROL
+     fprintf(STDCTR, "(sr_leed_stream): aborted after %d energies, "
+             "R >= %.4f > %.4f\n", n_lines, bound, rf_thr);
+#endif
+
+     *p_bound = bound;
+     return(1);
+   }
+ }
+
+ if( (w_pid == pid) && WIFEXITED(status) && (WEXITSTATUS(status) == 0) )
+   return(0);
+
+#ifdef ERROR
+ fprintf(STDERR, "*** error (sr_leed_stream): \"%s\" failed\n", leed_cmd);
+#endif
+ return(-1);
+
+#endif /* _WIN32 */
+} /* end of function sr_leed_stream */